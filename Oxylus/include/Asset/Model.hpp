@@ -39,6 +39,12 @@ struct Model {
     glm::vec3 scale = {1.f, 1.f, 1.f};
   };
 
+  // What mesh colliders are cooked from, kept on the CPU once the render data went to the GPU.
+  struct CollisionMesh {
+    std::vector<glm::vec3> positions = {};
+    std::vector<Index> indices = {};
+  };
+
   enum class LightType { Directional, Spot, Point };
 
   struct Light {
@@ -57,6 +63,7 @@ struct Model {
   std::vector<Light> lights = {};
   std::vector<u32> lod0_meshlet_counts = {};
   std::vector<GPU::Mesh> gpu_meshes = {};
+  std::vector<CollisionMesh> collision_meshes = {};
   std::vector<option<u32>> material_indices = {}; // these are per mesh, not per MeshGroup
   std::vector<vuk::Unique<vuk::Buffer>> gpu_mesh_buffers = {};
 
@@ -12,6 +12,7 @@ namespace ox {
 class AudioEngine {
 public:
   constexpr static auto MODULE_NAME = "AudioEngine";
+  constexpr static auto SKIP_HEADLESS = true;
 
   enum AttenuationModelType : u32 { None = 0, Inverse, Linear, Exponential };
 
@@ -39,6 +39,12 @@ public:
   auto with_working_directory(this App& self, const std::filesystem::path& dir) -> App&;
   auto with_assets_directory(this App& self, const std::filesystem::path& dir) -> App&;
 
+  // Runs without a window or any `ModuleSkipsHeadless` module, like `--headless` on the command line.
+  // Has to come before the modules are added.
+  auto with_headless(this App& self, bool headless = true) -> App&;
+  // Fixed rate a headless app steps at when no frame limit is set. `--tick-rate <hz>` overrides it.
+  auto with_tick_rate(this App& self, f64 ticks_per_second) -> App&;
+
   // Sets the number of worker threads for the JobManager, overriding the default hardware-based auto-detection.
   auto with_workers(this App& self, const u32 count) -> App&;
 
@@ -54,6 +60,13 @@ public:
   auto with(this App& self, Args&&... args) -> App& {
     ZoneScoped;
 
+    if constexpr (ModuleSkipsHeadless<T>) {
+      if (self.headless) {
+        OX_LOG_INFO("Headless, skipping module {}.", T::MODULE_NAME);
+        return self;
+      }
+    }
+
     self.registry.add<T>(std::forward<Args>(args)...);
 
     return self;
@@ -85,6 +98,8 @@ public:
 
   auto get_command_line_args(this const App& self) -> const AppCommandLineArgs&;
 
+  static auto is_headless() -> bool;
+
   static auto get_window() -> const Window&;
   static auto get_rendercontext() -> RenderContext&;
   static auto get_timestep() -> const Timestep&;
@@ -115,6 +130,8 @@ private:
 
   Timestep timestep = {};
   i32 frame_limit = 0;
+  bool headless = false;
+  f64 tick_rate = 60.0;
 
   bool is_running = true;
 
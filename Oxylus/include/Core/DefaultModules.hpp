@@ -14,6 +14,7 @@
 #include "UI/RmlUI.hpp"
 
 namespace ox {
+// Headless apps leave out the audio, rendering and UI modules on their own.
 using DefaultModules = std::tuple<
   LuaManager,
   AssetManager,
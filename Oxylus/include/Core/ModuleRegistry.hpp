@@ -22,6 +22,10 @@ concept Module = requires(T t) {
 template <typename T>
 concept ModuleHasUpdate = requires(T t, const Timestep& timestep) { t.update(timestep); };
 
+// Modules that only present things to a player, left out of headless apps.
+template <typename T>
+concept ModuleSkipsHeadless = requires { requires T::SKIP_HEADLESS; };
+
 template <typename T>
 concept ModuleHasRender = requires(T t, vuk::Extent3D extent, vuk::Format format) { t.render(extent, format); };
 
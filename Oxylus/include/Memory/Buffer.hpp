@@ -8,6 +8,26 @@
 #include "Core/Types.hpp"
 
 namespace ox {
+// Maps signed values to unsigned ones so that small magnitudes stay small as varints.
+constexpr auto zigzag_encode(i32 value) -> u32 {
+  return (static_cast<u32>(value) << 1) ^ static_cast<u32>(value >> 31);
+}
+
+constexpr auto zigzag_decode(u32 value) -> i32 {
+  return static_cast<i32>(value >> 1) ^ -static_cast<i32>(value & 1);
+}
+
+constexpr auto zigzag_encode(i64 value) -> u64 {
+  return (static_cast<u64>(value) << 1) ^ static_cast<u64>(value >> 63);
+}
+
+constexpr auto zigzag_decode(u64 value) -> i64 {
+  return static_cast<i64>(value >> 1) ^ -static_cast<i64>(value & 1);
+}
+
+// Worst case size of a varint encoded u64.
+constexpr static usize MAX_VARINT_SIZE = 10;
+
 struct BufferWriter {
   BufferWriter(void* buffer_, usize length) : buffer(std::span{static_cast<u8*>(buffer_), length}), offset(0) {}
 
@@ -46,6 +66,18 @@ struct BufferWriter {
     return true;
   }
 
+  // LEB128, 7 bits per byte, so small values take a single byte.
+  auto write_varint(this BufferWriter& self, u64 value) -> bool {
+    while (value >= 0x80) {
+      if (!self.write(static_cast<u8>(value | 0x80))) {
+        return false;
+      }
+      value >>= 7;
+    }
+
+    return self.write(static_cast<u8>(value));
+  }
+
   auto data(this const BufferWriter& self) -> const u8* { return self.buffer.data(); }
 
   auto size(this const BufferWriter& self) -> usize { return self.offset; }
@@ -109,6 +141,23 @@ struct BufferReader {
     return result;
   }
 
+  auto read_varint(this BufferReader& self) -> option<u64> {
+    auto value = 0_u64;
+    for (auto shift = 0_u32; shift < 64; shift += 7) {
+      if (self.offset >= self.buffer.size()) {
+        return nullopt;
+      }
+
+      const auto byte = self.buffer[self.offset++];
+      value |= static_cast<u64>(byte & 0x7f) << shift;
+      if ((byte & 0x80) == 0) {
+        return value;
+      }
+    }
+
+    return nullopt;
+  }
+
   auto remaining(this const BufferReader& self) -> usize { return self.buffer.size() - self.offset; }
 
   auto eof(this const BufferReader& self) -> bool { return self.offset >= self.buffer.size(); }
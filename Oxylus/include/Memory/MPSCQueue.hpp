@@ -0,0 +1,80 @@
+#pragma once
+
+#include <atomic>
+#include <bit>
+#include <memory>
+#include <new>
+
+#include "Core/Option.hpp"
+#include "Core/Types.hpp"
+
+namespace ox {
+// https://www.1024cores.net/home/lock-free-algorithms/queues/bounded-mpmc-queue
+// Bounded lock-free ring for any number of producer threads and one consumer thread. Every cell
+// carries a sequence number telling producers and the consumer whose turn it is, so producers
+// only contend on the tail index.
+template <typename T>
+struct MPSCQueue {
+  using Self = MPSCQueue<T>;
+
+  explicit MPSCQueue(usize capacity) :
+      cells(std::make_unique<Cell[]>(std::bit_ceil(capacity))),
+      mask(std::bit_ceil(capacity) - 1) {
+    for (usize i = 0; i <= mask; i++) {
+      cells[i].sequence.store(i, std::memory_order_relaxed);
+    }
+  }
+
+  // Any thread. `value` is left untouched when the queue is full.
+  auto try_push(this Self& self, T&& value) -> bool {
+    auto position = self.tail.load(std::memory_order_relaxed);
+    Cell* cell = nullptr;
+    while (true) {
+      cell = &self.cells[position & self.mask];
+      const auto sequence = cell->sequence.load(std::memory_order_acquire);
+      const auto diff = static_cast<i64>(sequence) - static_cast<i64>(position);
+      if (diff == 0) {
+        if (self.tail.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+          break;
+        }
+      } else if (diff < 0) {
+        return false;
+      } else {
+        position = self.tail.load(std::memory_order_relaxed);
+      }
+    }
+
+    cell->value = std::move(value);
+    cell->sequence.store(position + 1, std::memory_order_release);
+    return true;
+  }
+
+  // Consumer only.
+  auto try_pop(this Self& self) -> option<T> {
+    auto& cell = self.cells[self.head & self.mask];
+    const auto sequence = cell.sequence.load(std::memory_order_acquire);
+    if (sequence != self.head + 1) {
+      return nullopt;
+    }
+
+    auto value = std::move(cell.value);
+    cell.sequence.store(self.head + self.mask + 1, std::memory_order_release);
+    self.head += 1;
+    return value;
+  }
+
+  auto capacity(this const Self& self) -> usize { return self.mask + 1; }
+
+private:
+  struct Cell {
+    std::atomic<usize> sequence = 0;
+    T value = {};
+  };
+
+  std::unique_ptr<Cell[]> cells = nullptr;
+  usize mask = 0;
+
+  alignas(std::hardware_destructive_interference_size) std::atomic<usize> tail = 0;
+  alignas(std::hardware_destructive_interference_size) usize head = 0;
+};
+} // namespace ox
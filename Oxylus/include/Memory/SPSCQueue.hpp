@@ -0,0 +1,63 @@
+#pragma once
+
+#include <atomic>
+#include <bit>
+#include <new>
+#include <vector>
+
+#include "Core/Option.hpp"
+#include "Core/Types.hpp"
+
+namespace ox {
+// Bounded lock-free ring for exactly one producer thread and one consumer thread. Capacity is
+// rounded up to a power of two and fixed, a full queue makes `try_push` fail instead of growing.
+template <typename T>
+struct SPSCQueue {
+  using Self = SPSCQueue<T>;
+
+  explicit SPSCQueue(usize capacity) : slots(std::bit_ceil(capacity)), mask(slots.size() - 1) {}
+
+  // Producer only. `value` is left untouched when the queue is full.
+  auto try_push(this Self& self, T&& value) -> bool {
+    const auto tail = self.tail.load(std::memory_order_relaxed);
+    if (tail - self.producer_head == self.slots.size()) {
+      self.producer_head = self.head.load(std::memory_order_acquire);
+      if (tail - self.producer_head == self.slots.size()) {
+        return false;
+      }
+    }
+
+    self.slots[tail & self.mask] = std::move(value);
+    self.tail.store(tail + 1, std::memory_order_release);
+    return true;
+  }
+
+  // Consumer only.
+  auto try_pop(this Self& self) -> option<T> {
+    const auto head = self.head.load(std::memory_order_relaxed);
+    if (head == self.consumer_tail) {
+      self.consumer_tail = self.tail.load(std::memory_order_acquire);
+      if (head == self.consumer_tail) {
+        return nullopt;
+      }
+    }
+
+    auto value = std::move(self.slots[head & self.mask]);
+    self.head.store(head + 1, std::memory_order_release);
+    return value;
+  }
+
+  auto capacity(this const Self& self) -> usize { return self.slots.size(); }
+
+private:
+  std::vector<T> slots = {};
+  usize mask = 0;
+
+  // Each side owns a cache line with its index and the last index it saw of the other side, the
+  // other side's line is only read when the queue looks full or empty.
+  alignas(std::hardware_destructive_interference_size) std::atomic<usize> tail = 0;
+  usize producer_head = 0;
+  alignas(std::hardware_destructive_interference_size) std::atomic<usize> head = 0;
+  usize consumer_tail = 0;
+};
+} // namespace ox
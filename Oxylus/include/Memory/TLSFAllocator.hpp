@@ -1,14 +1,21 @@
 #pragma once
 
+#include <vector>
+
+#include "Core/Option.hpp"
 #include "Core/Types.hpp"
 
 namespace ox {
 // http://www.gii.upv.es/tlsf/files/papers/ecrts04_tlsf.pdf
+// Offset allocator, it hands out ranges of a `capacity` sized region and leaves what backs that
+// region to the user. Both allocating and freeing are O(1).
 struct TLSFAllocator {
   constexpr static usize SL_INDEX_COUNT_LOG2 = 5;
   constexpr static usize SL_INDEX_COUNT = 1 << SL_INDEX_COUNT_LOG2;
   constexpr static usize FL_INDEX_MAX = 30;
   constexpr static usize SMALL_BLOCK_SIZE = 256;
+  // Every size is rounded up to this, so every offset is aligned to it.
+  constexpr static u32 ALIGNMENT = 16;
 
   enum struct NodeID : u32 { Invalid = ~0_u32 };
   struct Node {
@@ -21,7 +28,31 @@ struct TLSFAllocator {
     NodeID next_free = NodeID::Invalid;
   };
 
+  struct Allocation {
+    u32 offset = 0;
+    NodeID node = NodeID::Invalid;
+  };
+
   u32 first_level_bitmap = 0;
   u32 second_level_bitmap[FL_INDEX_MAX] = {};
+  NodeID free_lists[FL_INDEX_MAX][SL_INDEX_COUNT] = {};
+  std::vector<Node> nodes = {};
+  std::vector<NodeID> unused_nodes = {};
+  u32 capacity = 0;
+  u32 free_size = 0;
+
+  // Starts over with one free block spanning `capacity`, which has to stay below 2^FL_INDEX_MAX.
+  auto init(this TLSFAllocator&, u32 capacity) -> void;
+  auto allocate(this TLSFAllocator&, u32 size) -> option<Allocation>;
+  auto free(this TLSFAllocator&, NodeID node_id) -> void;
+  auto size_of(this const TLSFAllocator& self, NodeID node_id) -> u32 {
+    return self.nodes[static_cast<u32>(node_id)].size;
+  }
+
+private:
+  auto insert_free(this TLSFAllocator&, NodeID node_id) -> void;
+  auto remove_free(this TLSFAllocator&, NodeID node_id) -> void;
+  auto find_free(this TLSFAllocator&, u32 size) -> NodeID;
+  auto new_node(this TLSFAllocator&) -> NodeID;
 };
 } // namespace ox
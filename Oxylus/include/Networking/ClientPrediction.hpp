@@ -0,0 +1,103 @@
+#pragma once
+
+#include <functional>
+#include <tracy/Tracy.hpp>
+#include <vector>
+
+#include "Networking/SnapshotInterpolator.hpp"
+
+namespace ox {
+// Client side prediction for the entity the local player controls. Inputs are applied to the local
+// state right away and kept until a snapshot shows the server applied them too, through the
+// entity's `NetInputAck`. Every such snapshot restarts the prediction from the server's state and
+// replays the inputs the server hadn't seen yet, so a misprediction gets corrected without waiting
+// a round trip for every input. `simulate` has to do what the server does with an input for the
+// replay to land where the server will.
+template <typename Input, typename State = TransformComponent>
+struct ClientPrediction {
+  using Simulate = std::function<void(State& state, const Input& input, f64 delta_ms)>;
+
+  struct PendingInput {
+    u32 sequence = 0;
+    Input input = {};
+    f64 delta_ms = 0.0;
+  };
+
+  // Past this many unacked inputs the oldest are forgotten, the server is gone or far behind.
+  constexpr static usize MAX_PENDING = 256;
+
+  Simulate simulate = {};
+  State state = {};
+  std::vector<PendingInput> pending = {};
+  u32 next_sequence = 1;
+  u32 acked_sequence = 0;
+  bool has_snapshot = false;
+  u8 snapshot_sequence = 0;
+
+  ClientPrediction(Simulate simulate_, const State& state_ = {}) : simulate(std::move(simulate_)), state(state_) {}
+
+  // Applies `input` to `state`. Send it to the server with the returned sequence, which the server
+  // puts into the entity's `NetInputAck` once it applied the input.
+  auto predict(this ClientPrediction& self, const Input& input, f64 delta_ms) -> u32 {
+    ZoneScoped;
+
+    if (self.pending.size() >= MAX_PENDING) {
+      self.pending.erase(self.pending.begin());
+    }
+
+    const auto sequence = self.next_sequence++;
+    self.pending.push_back({.sequence = sequence, .input = input, .delta_ms = delta_ms});
+    self.simulate(self.state, input, delta_ms);
+
+    return sequence;
+  }
+
+  // `authoritative` is the server's state after every input up to `acked`.
+  auto reconcile(this ClientPrediction& self, u32 acked, const State& authoritative) -> void {
+    ZoneScoped;
+
+    if (static_cast<i32>(acked - self.acked_sequence) < 0) {
+      return;
+    }
+
+    self.acked_sequence = acked;
+    std::erase_if(self.pending, [acked](const PendingInput& pending) {
+      return static_cast<i32>(pending.sequence - acked) <= 0;
+    });
+
+    self.state = authoritative;
+    for (const auto& pending : self.pending) {
+      self.simulate(self.state, pending.input, pending.delta_ms);
+    }
+  }
+
+  // Reads the entity's state and `NetInputAck` out of a received snapshot. Snapshots older than
+  // the last one reconciled against are ignored. False if the snapshot lacks either component.
+  auto reconcile(
+    this ClientPrediction& self,
+    u8 sequence,
+    const SceneState& snapshot,
+    flecs::entity_t entity_id,
+    flecs::id_t state_id,
+    flecs::id_t ack_id
+  ) -> bool {
+    ZoneScoped;
+
+    if (self.has_snapshot && static_cast<i8>(sequence - self.snapshot_sequence) <= 0) {
+      return false;
+    }
+
+    auto authoritative = read_replicated<State>(snapshot, entity_id, state_id);
+    auto ack = read_replicated<NetInputAck>(snapshot, entity_id, ack_id);
+    if (!authoritative.has_value() || !ack.has_value()) {
+      return false;
+    }
+
+    self.has_snapshot = true;
+    self.snapshot_sequence = sequence;
+    self.reconcile(ack->sequence, authoritative.value());
+
+    return true;
+  }
+};
+} // namespace ox
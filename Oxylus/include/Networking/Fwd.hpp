@@ -5,8 +5,19 @@
 namespace ox {
 struct NetServer;
 struct NetClient;
+struct NetIOThread;
+struct SnapshotInterpolator;
+struct NetCompressor;
 
 enum class NetClientID : u64 { Invalid = ~0_u64 };
+enum class NetEventKind : u32 {
+  Connect = 0,
+  Receive,
+  Disconnect,
+  // Fresh peer counters from an I/O thread.
+  Stats,
+};
+
 enum : u32 {
   NET_CHANNEL_UNRELIABLE = 0,
   NET_CHANNEL_RELIABLE,
@@ -20,6 +31,7 @@ struct NetStats {
   u32 sent_packets = 0;
   u32 packets_lost = 0;
   u32 rtt = 0;
+  u32 rtt_variance = 0;
 
   u32 last_sent_bytes = 0;
   u32 last_received_bytes = 0;
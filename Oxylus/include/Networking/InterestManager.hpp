@@ -0,0 +1,68 @@
+#pragma once
+
+#include <ankerl/unordered_dense.h>
+#include <flecs.h>
+#include <glm/vec3.hpp>
+#include <vector>
+
+#include "Core/Types.hpp"
+#include "Scene/SceneSnapshot.hpp"
+
+namespace ox {
+// Relevancy state of one client, lives on the server side `NetClient`.
+struct ClientInterest {
+  struct Entry {
+    u32 last_update_tick = 0;
+  };
+
+  // Entity the client controls, its area of interest is centered on it. Without one the client only
+  // sees always relevant entities.
+  flecs::entity_t viewer = 0;
+  // In grid cells (Chebyshev distance). Relevant entities are kept for one extra cell so one sitting on
+  // a cell border doesn't enter and leave every other tick.
+  u32 radius_cells = 2;
+  // Most entities updated per snapshot, the rest keep what the client was sent last. 0 for no limit.
+  u32 max_updates = 0;
+
+  ankerl::unordered_dense::map<flecs::entity_t, Entry> relevant = {};
+  // Results of the last `InterestManager::filter`.
+  std::vector<flecs::entity_t> entered = {};
+  std::vector<flecs::entity_t> left = {};
+};
+
+// Spatial hash over the replicated entities, rebuilt once per server tick and shared by all clients.
+// Filtering a client only visits the cells around its viewer, so the cost is per client area of
+// interest rather than world size times client count.
+struct InterestManager {
+  struct EntityInfo {
+    glm::ivec3 cell = {};
+    bool spatial = false;
+    f32 priority = 1.0f;
+    u32 update_interval = 1;
+  };
+
+  f32 cell_size = 32.0f;
+  u32 tick = 0;
+  ankerl::unordered_dense::map<u64, std::vector<flecs::entity_t>> cells = {};
+  ankerl::unordered_dense::map<flecs::entity_t, EntityInfo> entities = {};
+  // Tagged `AlwaysRelevant`, or without a transform to place them by.
+  std::vector<flecs::entity_t> always_relevant = {};
+
+  // Buckets the entities of this tick's snapshot, call before filtering any client.
+  auto update(this InterestManager&, flecs::world& world, const SceneState& state) -> void;
+  // Fills `out` with the part of `state` relevant to `client`. `previous` is the last state sent to
+  // this client, entities that are relevant but not picked this tick keep their state from it.
+  auto filter(
+    this InterestManager&, ClientInterest& client, const SceneState& state, const SceneState* previous, SceneState& out
+  ) -> void;
+
+  auto cell_of(this const InterestManager&, const glm::vec3& position) -> glm::ivec3;
+  static auto cell_key(const glm::ivec3& cell) -> u64;
+
+private:
+  ankerl::unordered_dense::set<flecs::entity_t> candidates = {};
+  std::vector<std::pair<f32, flecs::entity_t>> scored = {};
+  // Entities going into the filtered state, and whether they are sent fresh this tick.
+  std::vector<std::pair<flecs::entity_t, bool>> picked = {};
+};
+} // namespace ox
@@ -0,0 +1,96 @@
+#pragma once
+
+#include <ankerl/unordered_dense.h>
+#include <memory>
+#include <random>
+#include <vector>
+
+#include "Networking/NetTransport.hpp"
+
+namespace ox {
+// How the simulated link treats traffic, the same in both directions of every connection.
+struct NetLinkConditions {
+  // One way.
+  f64 latency_ms = 0.0;
+  // Every packet takes up to this much longer, picked uniformly.
+  f64 jitter_ms = 0.0;
+  // Chance of a packet getting lost. Lost reliable packets are resent a round trip later, like ENet does.
+  f64 loss = 0.0;
+  // Chance of an unreliable packet arriving twice.
+  f64 duplication = 0.0;
+  // Bytes per second each direction carries, 0 for no cap. Packets past it queue up behind each other.
+  u32 bandwidth = 0;
+};
+
+struct LoopbackConnection;
+struct LoopbackTransport;
+
+// In-process stand-in for the network between any number of `LoopbackTransport`s. Nothing arrives
+// until `advance` lets time pass, runs with the same seed and the same traffic play out the same.
+// Has to outlive every transport on it.
+struct LoopbackNetwork {
+  NetLinkConditions conditions = {};
+  f64 now_ms = 0.0;
+
+  explicit LoopbackNetwork(u64 seed = 0);
+  ~LoopbackNetwork();
+
+  auto advance(this LoopbackNetwork&, f64 ms) -> void;
+
+  auto listen(this LoopbackNetwork&, u16 port, LoopbackTransport* transport) -> bool;
+  auto listener(this LoopbackNetwork&, u16 port) -> LoopbackTransport*;
+  auto open(this LoopbackNetwork&, LoopbackTransport* from, LoopbackTransport* to) -> LoopbackConnection&;
+  auto find(this LoopbackNetwork&, const ENetPeer* peer) -> LoopbackConnection*;
+  // Puts `packet`'s bytes on the link from `peer` to the other end of its connection.
+  auto transmit(this LoopbackNetwork&, LoopbackConnection& connection, u32 from, ENetPacket* packet, bool reliable)
+    -> void;
+  // Closes every connection of `transport`, the other ends hear about it one trip later.
+  auto drop(this LoopbackNetwork&, LoopbackTransport* transport) -> void;
+
+  auto chance(this LoopbackNetwork&, f64 probability) -> bool;
+  auto trip_time(this LoopbackNetwork&) -> f64;
+
+  ankerl::unordered_dense::map<u16, LoopbackTransport*> listeners = {};
+  // Kept for the network's lifetime, peers handed out stay valid after their connection closed.
+  std::vector<std::unique_ptr<LoopbackConnection>> connections = {};
+  ankerl::unordered_dense::map<const ENetPeer*, LoopbackConnection*> peer_connections = {};
+  std::mt19937_64 random;
+};
+
+struct LoopbackDelivery {
+  f64 at = 0.0;
+  // Keeps deliveries due at the same time in the order they were sent.
+  u64 order = 0;
+  NetIOEvent event = {};
+  // nullptr for a connect attempt that found nobody listening.
+  LoopbackConnection* connection = nullptr;
+};
+
+// One end on a `LoopbackNetwork`. `host_name` is ignored when connecting, every transport on the
+// network is reachable by its port.
+struct LoopbackTransport final : NetTransport {
+  LoopbackNetwork* network = nullptr;
+  // 0 for an end that only connects out.
+  u16 port = 0;
+  // Min heap on (`at`, `order`).
+  std::vector<LoopbackDelivery> inbox = {};
+  u64 delivery_counter = 0;
+
+  LoopbackTransport(LoopbackNetwork& network_, u16 port_ = 0);
+  ~LoopbackTransport() override;
+
+  auto deliver(LoopbackDelivery&& delivery) -> void;
+
+  auto poll() -> option<NetIOEvent> override;
+  auto connect(std::string_view host_name, u16 port) -> bool override;
+  auto disconnect(ENetPeer* peer, bool immediate, u32 data) -> void override;
+  auto reset() -> void override;
+  auto send(ENetPeer* peer, ENetPacket* packet, bool reliable) -> void override;
+  auto broadcast(ENetPacket* packet, bool reliable) -> void override;
+  auto release(ENetPacket* packet) -> void override;
+  auto peer_counters(ENetPeer* peer) -> option<NetPeerCounters> override;
+
+private:
+  auto clear_inbox() -> void;
+};
+} // namespace ox
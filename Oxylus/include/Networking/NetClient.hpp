@@ -4,7 +4,11 @@
 
 #include "Core/Types.hpp"
 #include "Networking/Fwd.hpp"
+#include "Networking/InterestManager.hpp"
+#include "Networking/NetCompression.hpp"
 #include "Networking/NetPacket.hpp"
+#include "Networking/NetTransport.hpp"
+#include "Scene/SnapshotCodec.hpp"
 #include "Utils/Timestep.hpp"
 
 namespace ox {
@@ -17,11 +21,12 @@ enum class NetClientStatus : u32 {
 };
 
 // `client` is the instance that raised the event. The bus is global, so a handler serving one scene
-// has to compare it against its own client before acting.
+// has to compare it against its own client before acting. `scene_state` is the client's own copy,
+// only valid for the duration of the handler.
 struct ClientSceneSnapshotEvent {
   NetClient* client;
   u8 sequence;
-  SceneState scene_state;
+  const SceneState* scene_state;
 };
 
 struct ServerConnectEvent {
@@ -37,7 +42,8 @@ struct ServerDisconnectEvent {
 struct NetClient {
   NetClientStatus status = NetClientStatus::None;
   NetStats stats = {};
-  ENetHost* local_host = nullptr;
+  // Shared with the server for its remote clients.
+  NetTransport* transport = nullptr;
   ENetPeer* remote_peer = nullptr;
   u64 net_id = 0;
   f64 timeout_elapsed = 0.0f;
@@ -45,27 +51,67 @@ struct NetClient {
   f64 tick_interval = 1000.0f / 20.0f;
   f64 tick_accum = 0.0f;
 
+  // Newest snapshot the other end has acked, on the server this is what deltas get encoded against.
+  bool has_baseline = false;
+  u8 baseline_sequence = 0;
+  // Needed to decode `SceneDelta` packets, has to be built from the same components as the server's.
+  const SnapshotCodec* snapshot_codec = nullptr;
+  // Client side, every decoded snapshot is pushed into it when set.
+  SnapshotInterpolator* interpolator = nullptr;
+  // Set before connecting to offer compression at handshake. Server side, the server's.
+  NetCompressor* compressor = nullptr;
+  // What both ends agreed on at handshake.
+  NetCompression compression = NetCompression::None;
+  // Snapshots exchanged with the other end, kept as baselines for the deltas that follow. What the
+  // server sent this client, or what the client decoded.
+  SceneSnapshotBuilder snapshots = {};
+  // Server side, decides what part of the scene this client gets.
+  ClientInterest interest = {};
+  // Decode target for the rare delta whose baseline sits in the slot it is about to be stored into.
+  SceneState decode_scratch = {};
+
   ankerl::unordered_dense::map<u64, NetRPCPacket::Callback> rpcs = {};
+  // Hashes of `rpcs` in registration order, a proc's index here is its id on the wire.
+  std::vector<u64> proc_hashes = {};
+  // The other end's ids for its procs, from its handshake.
+  ankerl::unordered_dense::map<u64, u32> remote_proc_ids = {};
+  // Calls waiting for `flush_rpcs`, one batch per channel.
+  std::array<RPCBatch, NET_CHANNEL_COUNT> rpc_batches = {};
+  std::vector<u8> rpc_params_scratch = {};
 
-  NetClient(ENetHost* local_host_) : local_host(local_host_) { add_builtin_procs(); }
-  NetClient(ENetPeer* remote_peer_, u64 net_id_) : remote_peer(remote_peer_), net_id(net_id_) { add_builtin_procs(); }
+  NetClient(NetTransport* transport_) : transport(transport_) { add_builtin_procs(); }
+  NetClient(NetTransport* transport_, ENetPeer* remote_peer_, u64 net_id_) :
+      transport(transport_),
+      remote_peer(remote_peer_),
+      net_id(net_id_) {
+    add_builtin_procs();
+  }
   virtual ~NetClient() = default;
 
   auto set_tick_rate(this NetClient&, f64 tick_rate) -> void;
   auto update_stats(this NetClient&) -> void;
+  auto update_stats(this NetClient&, const NetPeerCounters& counters) -> void;
   auto connect(this NetClient&, std::string_view host_name, u16 port, f64 timeout) -> bool;
   auto disconnect(this NetClient&, bool immediate, u32 data = 0) -> void;
   auto tick(this NetClient&, const Timestep& ts) -> bool;
+  auto handle_event(this NetClient&, NetIOEvent& event) -> void;
   auto handle_packet(this NetClient&, NetPacket& packet) -> void;
+  auto ack_snapshot(this NetClient&, u8 sequence) -> void;
 
   auto add_builtin_procs(this NetClient&) -> void;
   auto register_proc(this NetClient&, std::string_view identifier, NetRPCPacket::Callback&& cb) -> void;
 
   auto send_reliable(this NetClient&, NetPacket& packet) -> void;
   auto send_unreliable(this NetClient&, NetPacket& packet) -> void;
+  // Compresses a packet about to be sent to this end with the negotiated codec, when it is worth it.
+  auto compress(this NetClient&, NetPacket& packet) -> bool;
 
+  // Queued with every other call of this tick, they go out as one packet per channel on the next
+  // `tick` or `flush_rpcs`.
   auto call_server(this NetClient&, std::string_view proc, std::span<const RPCParameter> params, bool reliable) -> bool;
+  auto queue_rpc(this NetClient&, u64 proc_hash, std::span<const u8> encoded_params, bool reliable) -> void;
+  auto flush_rpcs(this NetClient&) -> void;
 
-  virtual auto on_scene_snapshot(u8 sequence, SceneState&& state) -> void {};
+  virtual auto on_scene_snapshot(u8 sequence, const SceneState& state) -> void {};
 };
 } // namespace ox
@@ -0,0 +1,96 @@
+#pragma once
+
+#include <span>
+#include <vector>
+
+#include "Core/Option.hpp"
+#include "Core/Types.hpp"
+#include "Networking/NetPacket.hpp"
+
+struct ZSTD_CCtx_s;
+struct ZSTD_DCtx_s;
+struct ZSTD_CDict_s;
+struct ZSTD_DDict_s;
+
+namespace ox {
+enum class NetCompression : u8 {
+  None = 0,
+  // Fast on both ends, for links where CPU matters more than bytes.
+  LZ4,
+  // Smaller, much more so with a dictionary trained on the game's own snapshots.
+  Zstd,
+};
+
+// What `NetCompressor::supported()` sets for `codec`.
+constexpr auto net_compression_bit(NetCompression codec) -> u8 {
+  return codec == NetCompression::None ? 0 : static_cast<u8>(1u << static_cast<u8>(codec));
+}
+
+struct NetCompressionStats {
+  // Packets that went out compressed, and their size before and after.
+  u64 compressed_packets = 0;
+  u64 raw_bytes = 0;
+  u64 compressed_bytes = 0;
+  // Below the threshold, or didn't get any smaller.
+  u64 skipped_packets = 0;
+  u64 decompressed_packets = 0;
+  f64 compress_ms = 0.0;
+  f64 decompress_ms = 0.0;
+
+  auto ratio(this const NetCompressionStats& self) -> f64 {
+    return self.compressed_bytes ? static_cast<f64>(self.raw_bytes) / static_cast<f64>(self.compressed_bytes) : 1.0;
+  }
+};
+
+// Compresses whole packets into `NetPacketType::Compressed` ones and back. Both ends advertise what
+// they can handle at handshake and the server picks one codec per connection, zstd only when both
+// ends hold the same dictionary or neither has one. Not thread safe, each `NetServer` or `NetClient`
+// uses its own from its own thread.
+struct NetCompressor {
+  constexpr static u32 MAX_DECOMPRESSED_SIZE = 4 * 1024 * 1024;
+  // Packets that would shrink further are sent as they are, so a peer can't make the other end
+  // allocate megabytes for a few bytes it sent.
+  constexpr static u32 MAX_COMPRESSION_RATIO = 256;
+
+  bool enable_lz4 = true;
+  bool enable_zstd = true;
+  // Packets smaller than this go out as they are, they'd barely shrink.
+  u32 threshold = 512;
+  i32 zstd_level = 3;
+  NetCompressionStats stats = {};
+
+  NetCompressor();
+  ~NetCompressor();
+  NetCompressor(const NetCompressor&) = delete;
+  NetCompressor& operator=(const NetCompressor&) = delete;
+
+  // Zstd only talks to ends that use the same dictionary, identified by the id zstd stores in it.
+  auto set_dictionary(this NetCompressor&, std::vector<u8> dictionary) -> bool;
+  auto dictionary_id(this const NetCompressor&) -> u32;
+  // Bit per `NetCompression`, what goes into the handshake.
+  auto supported(this const NetCompressor&) -> u8;
+  // Best codec both ends support.
+  auto negotiate(this const NetCompressor&, u8 remote_supported, u32 remote_dictionary_id) -> NetCompression;
+
+  // Replaces `packet` with a compressed copy when that comes out smaller. `packet` must not have
+  // been sent or shared yet, the original is destroyed.
+  auto compress(this NetCompressor&, NetPacket& packet, NetCompression codec) -> bool;
+  // The packet `packet` was made from, owned by the caller. nullopt if it is malformed or wasn't
+  // compressed with `codec`, the one negotiated with the end that sent it.
+  auto decompress(this NetCompressor&, NetPacket& packet, NetCompression codec) -> option<NetPacket>;
+
+  // Dictionary of at most `capacity` bytes from example packets, a few hundred of them or more.
+  static auto train_dictionary(std::span<const std::vector<u8>> samples, usize capacity) -> std::vector<u8>;
+
+private:
+  std::vector<u8> dictionary = {};
+  u32 dictionary_id_ = 0;
+  ZSTD_CCtx_s* zstd_compress_context = nullptr;
+  ZSTD_DCtx_s* zstd_decompress_context = nullptr;
+  ZSTD_CDict_s* zstd_compress_dictionary = nullptr;
+  ZSTD_DDict_s* zstd_decompress_dictionary = nullptr;
+  std::vector<u8> scratch = {};
+
+  auto free_dictionaries(this NetCompressor&) -> void;
+};
+} // namespace ox
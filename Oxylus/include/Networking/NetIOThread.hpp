@@ -0,0 +1,113 @@
+#pragma once
+
+#include <deque>
+#include <string>
+#include <thread>
+
+#include "Core/Types.hpp"
+#include "Memory/MPSCQueue.hpp"
+#include "Memory/SPSCQueue.hpp"
+#include "Networking/Fwd.hpp"
+
+namespace ox {
+// Raw ENet peer counters, turned into `NetStats` by whoever owns the peer's `NetClient`.
+struct NetPeerCounters {
+  u64 sent_bytes = 0;
+  u64 received_bytes = 0;
+  u32 sent_packets = 0;
+  u32 packets_lost = 0;
+  u32 ping_interval = 0;
+  u32 rtt = 0;
+  u32 rtt_variance = 0;
+};
+
+// What `enet_host_service` reported, plus the counters of `peer` for `NetEventKind::Stats`.
+struct NetIOEvent {
+  NetEventKind kind = NetEventKind::Connect;
+  ENetPeer* peer = nullptr;
+  // Owned by whoever pops a `Receive` event.
+  ENetPacket* packet = nullptr;
+  u32 data = 0;
+  NetPeerCounters counters = {};
+};
+
+enum class NetIOCommandKind : u8 {
+  // Destroys `packet` when it can't be sent and nobody else holds a reference to it.
+  Send = 0,
+  Broadcast,
+  // Drops the reference the game thread held on `packet`, destroying it if nobody else has one.
+  Release,
+  Connect,
+  DisconnectNow,
+  DisconnectLater,
+  // Resets every peer of the host.
+  Reset,
+};
+
+struct NetIOCommand {
+  NetIOCommandKind kind = NetIOCommandKind::Send;
+  bool reliable = false;
+  u16 port = 0;
+  u32 data = 0;
+  ENetPeer* peer = nullptr;
+  ENetPacket* packet = nullptr;
+  std::string host_name = {};
+};
+
+auto read_peer_counters(const ENetPeer* peer) -> NetPeerCounters;
+auto to_net_io_event(const ENetEvent& event) -> NetIOEvent;
+// Destroys `packet` when it can't be sent and nobody else holds a reference to it. A null `peer`
+// means the connection went away before the packet was handed over.
+auto send_peer_packet(ENetPeer* peer, ENetPacket* packet, bool reliable) -> void;
+auto broadcast_host_packet(ENetHost* host, ENetPacket* packet, bool reliable) -> void;
+// Drops one reference to `packet`, destroying it if nobody else has one.
+auto release_packet(ENetPacket* packet) -> void;
+auto reset_host_peers(ENetHost* host) -> void;
+
+// Services one `ENetHost` on its own thread, so acks go out and packets come in on time no matter
+// how long the game thread's frame takes. ENet isn't thread safe, while the thread runs it is the
+// only one touching the host and its peers. The game thread hands it work through `commands`, from
+// any thread, and takes what arrived from `events`. RPCs and every other packet are still handled
+// on the game thread.
+struct NetIOThread {
+  constexpr static usize COMMAND_CAPACITY = 4096;
+  constexpr static usize EVENT_CAPACITY = 4096;
+  // How long one `enet_host_service` waits for traffic before looking at `commands` again.
+  constexpr static u32 SERVICE_TIMEOUT_MS = 1;
+  constexpr static f64 STATS_INTERVAL_MS = 100.0;
+
+  ENetHost* host = nullptr;
+  MPSCQueue<NetIOCommand> commands{COMMAND_CAPACITY};
+  SPSCQueue<NetIOEvent> events{EVENT_CAPACITY};
+
+  NetIOThread(ENetHost* host_) : host(host_) {}
+  NetIOThread(const NetIOThread&) = delete;
+  NetIOThread(NetIOThread&&) = delete;
+  ~NetIOThread();
+
+  auto operator=(const NetIOThread&) -> NetIOThread& = delete;
+  auto operator=(NetIOThread&&) -> NetIOThread& = delete;
+
+  auto start(this NetIOThread&) -> void;
+  // Runs what is left in `commands` and joins. Events that were never popped are dropped.
+  auto stop(this NetIOThread&) -> void;
+  auto is_running(this const NetIOThread& self) -> bool { return self.thread.joinable(); }
+
+  // Waits for room while the queue is full. The I/O thread never waits on the game thread, events
+  // that don't fit in `events` are held back and handed over once there is room again.
+  auto push(this NetIOThread&, NetIOCommand&& command) -> void;
+  auto send(this NetIOThread&, ENetPeer* peer, ENetPacket* packet, bool reliable) -> void;
+  auto broadcast(this NetIOThread&, ENetPacket* packet, bool reliable) -> void;
+  auto release(this NetIOThread&, ENetPacket* packet) -> void;
+
+private:
+  auto run(this NetIOThread&, std::stop_token stop_token) -> void;
+  auto execute(this NetIOThread&, NetIOCommand& command) -> void;
+  auto publish(this NetIOThread&, NetIOEvent&& event) -> void;
+  auto flush_overflow(this NetIOThread&) -> void;
+
+  // Only touched by the I/O thread, and by `stop` once it has joined.
+  std::deque<NetIOEvent> overflow = {};
+  std::jthread thread = {};
+};
+} // namespace ox
@@ -23,12 +23,22 @@ enum class NetPacketType : u8 {
   SceneSnapshot,
   ClientAck,
   RPC,
+  SceneDelta,
+  // Another packet, compressed with the codec negotiated at handshake. See `NetCompressor`.
+  Compressed,
 };
 
 // Builtin packets
 struct NetHandshakePacket {
   u32 version = 0;
   u64 net_id = ~0_u64;
+  // Hashes of the procs the sender can be called with. Calls name a listed proc by its index here
+  // instead of its full hash.
+  std::vector<u64> procs = {};
+  // `NetCompression` bits the sender can decompress, the server answers with the one it picked.
+  u8 compression = 0;
+  // Id of the sender's zstd dictionary, 0 without one.
+  u32 dictionary_id = 0;
 };
 
 struct NetSceneSnapshotPacket {
@@ -36,23 +46,33 @@ struct NetSceneSnapshotPacket {
   SceneState state = {};
 };
 
+// `payload` is a `SnapshotCodec` delta against the receiver's copy of `baseline_sequence`. On the
+// receiving end it points into the packet it was read from.
+struct NetSceneDeltaPacket {
+  u8 sequence = 0;
+  bool has_baseline = false;
+  u8 baseline_sequence = 0;
+  std::span<const u8> payload = {};
+};
+
 struct NetClientAckPacket {
   u8 acked = 0;
 };
 
+// Parameters never own their data. Sent ones point at the caller's, received ones into the packet.
 struct RPCParameter {
-  // The alternative index is what goes over the wire, only ever append to this list.
+  // The alternative index is the type tag that goes over the wire, only ever append to this list.
   using Value = std::variant<
-    std::monostate,     // none
-    u8,                 // byte
-    u16,                // short
-    i32,                // int
-    i64,                // int64
-    f32,                // float
-    f64,                // double
-    std::string,        // string
-    std::array<u8, 16>, // uuid
-    std::vector<u8>>;   // byte array
+    std::monostate,        // none
+    u8,                    // byte
+    u16,                   // short
+    i32,                   // int
+    i64,                   // int64
+    f32,                   // float
+    f64,                   // double
+    std::string_view,      // string
+    std::array<u8, 16>,    // uuid
+    std::span<const u8>>;  // byte array
 
   Value value = {};
 
@@ -62,7 +82,7 @@ struct RPCParameter {
   auto as_uuid(this const RPCParameter&) -> option<UUID>;
   template <typename T>
   auto as_span(this const RPCParameter& self) -> std::span<const T> {
-    const auto* bytes = std::get_if<std::vector<u8>>(&self.value);
+    const auto* bytes = std::get_if<std::span<const u8>>(&self.value);
     if (!bytes) {
       return {};
     }
@@ -71,13 +91,41 @@ struct RPCParameter {
   }
 };
 
-struct NetRPCPacket {
-  using Callback = std::function<void(NetClientID, std::span<RPCParameter>)>;
+// Type tagged flat encoding, appended to `out`.
+auto encode_rpc_parameters(std::span<const RPCParameter> params, std::vector<u8>& out) -> void;
+
+// Calls to one peer on one channel, gathered over a tick and sent as a single packet.
+struct RPCBatch {
+  // Keeps a batch within one datagram, a full batch gets flushed early.
+  constexpr static usize MAX_SIZE = 1200;
 
+  u32 call_count = 0;
+  std::vector<u8> bytes = {};
+
+  // `proc_id` is the receiver's index for the proc, calls to procs it didn't list go by hash.
+  auto push(this RPCBatch&, option<u32> proc_id, u64 proc_hash, std::span<const u8> encoded_params) -> void;
+  auto clear(this RPCBatch&) -> void;
+  auto empty(this const RPCBatch& self) -> bool { return self.call_count == 0; }
+};
+
+struct NetRPCCall {
+  // 0 when it named an id the receiver doesn't know.
   u64 proc_hash = 0;
   ankerl::svector<RPCParameter, 8> parameters = {};
 };
 
+// A received batch, `calls` points into the packet.
+struct NetRPCPacket {
+  using Callback = std::function<void(NetClientID, std::span<RPCParameter>)>;
+
+  u32 call_count = 0;
+  std::span<const u8> calls = {};
+
+  // Decodes the next call, `proc_hashes` are the receiver's procs in the order it sent them at
+  // handshake. False once every call was read, or on a malformed one.
+  auto next(this NetRPCPacket&, std::span<const u64> proc_hashes, NetRPCCall& call) -> bool;
+};
+
 struct NetPacket {
   NetPacketType type = NetPacketType::Unknown;
   ENetPacket* inner = nullptr;
@@ -85,7 +133,10 @@ struct NetPacket {
   static auto handshake(const NetHandshakePacket& info) -> option<NetPacket>;
   static auto scene_snapshot(const SceneState& state, u8 sequence) -> option<NetPacket>;
   static auto client_ack(const NetClientAckPacket& info) -> option<NetPacket>;
+  static auto scene_delta(const NetSceneDeltaPacket& info) -> option<NetPacket>;
+  // A single call by hash, see `rpc_batch` for the usual path.
   static auto rpc(std::string_view proc, std::span<const RPCParameter> params) -> option<NetPacket>;
+  static auto rpc_batch(const RPCBatch& batch) -> option<NetPacket>;
 
   static auto from_packet(ENetPacket* packet) -> option<NetPacket>;
 
@@ -97,6 +148,7 @@ struct NetPacket {
   auto get_handshake(this NetPacket&) -> option<NetHandshakePacket>;
   auto get_scene_snapshot(this NetPacket&) -> option<NetSceneSnapshotPacket>;
   auto get_client_ack(this NetPacket&) -> option<NetClientAckPacket>;
+  auto get_scene_delta(this NetPacket&) -> option<NetSceneDeltaPacket>;
   auto get_rpc(this NetPacket&) -> option<NetRPCPacket>;
 
   operator ENetPacket*() { return inner; }
@@ -16,6 +16,14 @@ struct ClientDisconnectEvent {
   NetServer* server;
   NetClientID client_id;
 };
+// Entities that entered or left the client's area of interest with the snapshot just sent. The spans
+// are only valid during dispatch.
+struct ClientRelevancyEvent {
+  NetServer* server;
+  NetClientID client_id;
+  std::span<const flecs::entity_t> entered;
+  std::span<const flecs::entity_t> left;
+};
 struct ClientAckEvent {
   NetServer* server;
   NetClientID client_id;
@@ -23,19 +31,29 @@ struct ClientAckEvent {
 };
 
 struct NetServer {
-  ENetHost* local_host = nullptr;
+  NetTransport* transport = nullptr;
   SlotMap<NetClient, NetClientID> remote_clients = {};
   u64 net_id_counter = 0;
   f64 tick_interval = 1000.0f / 20.0f;
   f64 tick_accum = 0.0f;
 
   ankerl::unordered_dense::map<u64, NetRPCPacket::Callback> rpcs = {};
+  // Hashes of `rpcs` in registration order, a proc's index here is its id on the wire.
+  std::vector<u64> proc_hashes = {};
+  std::vector<u8> rpc_params_scratch = {};
+  // Scratch for the per client filtered snapshot, kept around so filtering doesn't allocate.
+  SceneState relevant_state = {};
+  // Encoded deltas are staged here and copied once, into the packet they are sent in.
+  std::vector<u8> delta_payload = {};
+  // Offered to clients at handshake, snapshots are compressed with whatever each client agreed to.
+  NetCompressor* compressor = nullptr;
 
-  NetServer(ENetHost* local_host_) : local_host(local_host_) {};
+  NetServer(NetTransport* transport_) : transport(transport_) {};
   virtual ~NetServer() = default;
 
   auto set_tick_rate(this NetServer&, f64 tick_rate) -> void;
   auto tick(this NetServer&, const Timestep& ts) -> bool;
+  auto handle_event(this NetServer&, NetIOEvent& event) -> void;
   auto handle_packet(this NetServer&, ENetPeer* remote_peer, NetPacket& packet) -> void;
 
   auto register_proc(this NetServer&, std::string_view identifier, NetRPCPacket::Callback&& cb) -> void;
@@ -45,15 +63,28 @@ struct NetServer {
 
   auto send_to_client(this NetServer&, NetClientID client_id, NetPacket& packet, bool reliable) -> bool;
   auto broadcast(this NetServer&, NetPacket& packet, bool reliable) -> void;
+  // Sends the current snapshot of `snapshots` to every client as a delta against what that client last
+  // acked. Call before `snapshots.advance()`.
+  auto send_snapshots(this NetServer&, SceneSnapshotBuilder& snapshots, const SnapshotCodec& codec) -> void;
+  // Same, but every client only gets what `interest` finds relevant to it. `interest.update()` has to
+  // have seen the current snapshot.
+  auto send_snapshots(
+    this NetServer&, SceneSnapshotBuilder& snapshots, const SnapshotCodec& codec, InterestManager& interest
+  ) -> void;
 
+  // Both queue the call on the clients' batches, see `NetClient::call_server`.
   auto call_client(
     this NetServer&, NetClientID client_id, std::string_view proc, std::span<const RPCParameter> params, bool reliable
   ) -> bool;
   auto broadcast_call(this NetServer&, std::string_view proc, std::span<const RPCParameter> params, bool reliable)
     -> bool;
+  auto flush_rpcs(this NetServer&) -> void;
 
   virtual auto on_client_connect(NetClientID client_id) -> void {};
   virtual auto on_client_disconnect(NetClientID client_id) -> void {};
+  virtual auto on_client_relevancy(
+    NetClientID client_id, std::span<const flecs::entity_t> entered, std::span<const flecs::entity_t> left
+  ) -> void {};
 
   // packets
   virtual auto on_client_ack(NetClientID client_id, NetClientAckPacket& packet) -> void {};
@@ -0,0 +1,51 @@
+#pragma once
+
+#include <memory>
+#include <string_view>
+
+#include "Core/Option.hpp"
+#include "Core/Types.hpp"
+#include "Networking/Fwd.hpp"
+#include "Networking/NetIOThread.hpp"
+
+namespace ox {
+// What `NetServer` and `NetClient` move their packets through. Peers and packets are ENet's types
+// whatever sits underneath, a transport that isn't ENet hands out peers of its own.
+struct NetTransport {
+  virtual ~NetTransport() = default;
+
+  // Next event that came in, nullopt once there is nothing left to handle this tick.
+  virtual auto poll() -> option<NetIOEvent> = 0;
+  // The peer shows up with a `NetEventKind::Connect` event, a failed attempt as a `Disconnect`.
+  virtual auto connect(std::string_view host_name, u16 port) -> bool = 0;
+  virtual auto disconnect(ENetPeer* peer, bool immediate, u32 data) -> void = 0;
+  // Drops every connection and connection attempt without telling the other end.
+  virtual auto reset() -> void = 0;
+  // Destroys `packet` when it can't be sent and nobody else holds a reference to it.
+  virtual auto send(ENetPeer* peer, ENetPacket* packet, bool reliable) -> void = 0;
+  virtual auto broadcast(ENetPacket* packet, bool reliable) -> void = 0;
+  // Drops the reference the caller took to share `packet` between sends.
+  virtual auto release(ENetPacket* packet) -> void = 0;
+  // nullopt when the counters arrive as `NetEventKind::Stats` events instead.
+  virtual auto peer_counters(ENetPeer* peer) -> option<NetPeerCounters> = 0;
+};
+
+// ENet over UDP. Serviced from `poll` on the calling thread, or on an `NetIOThread` of its own.
+struct EnetTransport final : NetTransport {
+  ENetHost* host = nullptr;
+  std::unique_ptr<NetIOThread> io_thread = nullptr;
+
+  // Takes ownership of `host_`.
+  EnetTransport(ENetHost* host_, bool threaded);
+  ~EnetTransport() override;
+
+  auto poll() -> option<NetIOEvent> override;
+  auto connect(std::string_view host_name, u16 port) -> bool override;
+  auto disconnect(ENetPeer* peer, bool immediate, u32 data) -> void override;
+  auto reset() -> void override;
+  auto send(ENetPeer* peer, ENetPacket* packet, bool reliable) -> void override;
+  auto broadcast(ENetPacket* packet, bool reliable) -> void override;
+  auto release(ENetPacket* packet) -> void override;
+  auto peer_counters(ENetPeer* peer) -> option<NetPeerCounters> override;
+};
+} // namespace ox
@@ -3,48 +3,58 @@
 #include <ankerl/svector.h>
 #include <expected>
 #include <memory>
+#include <mutex>
 #include <string>
 
 #include "Core/Types.hpp"
 #include "Memory/TLSFAllocator.hpp"
+#include "Networking/LoopbackTransport.hpp"
 #include "Networking/NetClient.hpp"
 #include "Networking/NetServer.hpp"
+#include "Networking/NetTransport.hpp"
 #include "Utils/Timestep.hpp"
 
 namespace ox {
 struct NetServer;
 struct NetClient;
 
-enum class NetEventKind : u32 {
-  Connect = 0,
-  Receive,
-  Disconnect,
-};
-
 struct NetworkManager {
   constexpr static auto MODULE_NAME = "NetworkManager";
 
+  // Backs every ENet allocation, packets included. Anything that doesn't fit falls back to malloc.
+  constexpr static u32 PACKET_POOL_SIZE = 16 * 1024 * 1024;
   TLSFAllocator allocator = {};
+  std::unique_ptr<u8[]> allocator_memory = nullptr;
+  std::mutex allocator_mutex = {};
   ankerl::svector<std::unique_ptr<NetServer>, 1> servers = {};
   ankerl::svector<std::unique_ptr<NetClient>, 1> clients = {};
+  // Servers and clients created while this is set get their host serviced on a thread of its own.
+  bool threaded_io = false;
+  // Servers and clients created while this is set talk over it, in process, instead of over sockets.
+  LoopbackNetwork* loopback = nullptr;
+  ankerl::svector<std::unique_ptr<NetTransport>, 2> transports = {};
 
   auto init(this NetworkManager&) -> std::expected<void, std::string>;
   auto deinit(this NetworkManager&) -> std::expected<void, std::string>;
   auto update(this NetworkManager&, const Timestep& timestep) -> void;
 
+  auto pool_allocate(this NetworkManager&, usize size) -> void*;
+  auto pool_free(this NetworkManager&, void* memory) -> void;
+
 private:
-  auto create_server_handle(this NetworkManager&, u16 port, u32 max_clients) -> ENetHost*;
-  auto create_client_handle(this NetworkManager&) -> ENetHost*;
+  auto create_server_transport(this NetworkManager&, u16 port, u32 max_clients) -> NetTransport*;
+  auto create_client_transport(this NetworkManager&) -> NetTransport*;
+  auto destroy_transport(this NetworkManager&, NetTransport* transport) -> void;
 
 public:
   template <typename T = NetServer, typename... Args>
   auto create_server(this NetworkManager& self, u16 port, u32 max_clients, Args&&... args) -> T* {
-    auto* host = self.create_server_handle(port, max_clients);
-    if (!host) {
+    auto* transport = self.create_server_transport(port, max_clients);
+    if (!transport) {
       return nullptr;
     }
 
-    auto server = std::make_unique<T>(host, std::forward<Args>(args)...);
+    auto server = std::make_unique<T>(transport, std::forward<Args>(args)...);
     auto server_ptr = server.get();
     self.servers.emplace_back(std::move(server));
 
@@ -53,12 +63,12 @@ public:
 
   template <typename T = NetClient, typename... Args>
   auto create_client(this NetworkManager& self, Args&&... args) -> T* {
-    auto* host = self.create_client_handle();
-    if (!host) {
+    auto* transport = self.create_client_transport();
+    if (!transport) {
       return nullptr;
     }
 
-    auto client = std::make_unique<T>(host, std::forward<Args>(args)...);
+    auto client = std::make_unique<T>(transport, std::forward<Args>(args)...);
     auto client_ptr = client.get();
     self.clients.emplace_back(std::move(client));
 
@@ -0,0 +1,86 @@
+#pragma once
+
+#include <cstring>
+#include <flecs.h>
+#include <span>
+#include <vector>
+
+#include "Core/Option.hpp"
+#include "Core/Types.hpp"
+#include "Scene/Components.hpp"
+#include "Scene/SceneSnapshot.hpp"
+
+namespace ox {
+// Copy of a trivially copyable component out of a received state, nullopt when the entity doesn't have it.
+template <typename T>
+auto read_replicated(const SceneState& state, flecs::entity_t entity_id, flecs::id_t component_id) -> option<T> {
+  const auto* entity = state.find(entity_id);
+  const auto* component = entity ? state.find_component(*entity, component_id) : nullptr;
+  if (!component || component->size != sizeof(T)) {
+    return nullopt;
+  }
+
+  auto value = T{};
+  std::memcpy(&value, state.bytes_of(*component).data(), sizeof(T));
+  return value;
+}
+
+// Jitter buffer for the snapshots a client receives. Replays the replicated `TransformComponent`s
+// `delay_ms` behind the newest snapshot, blending between the two snapshots around that point, so
+// one that arrives late or not at all still has a later one to move towards. The playback clock
+// runs a little faster or slower to stay at the delay instead of jumping whenever arrival times
+// wobble.
+struct SnapshotInterpolator {
+  constexpr static u32 MAX_FRAMES = 32;
+
+  struct Frame {
+    // Server time of the snapshot, its unwrapped sequence times `snapshot_interval`.
+    f64 time = 0.0;
+    // Sorted, with the transform of each entity at the same index.
+    std::vector<flecs::entity_t> entities = {};
+    std::vector<TransformComponent> transforms = {};
+  };
+
+  struct Sample {
+    // The server's id, mapping it onto a local entity is up to the caller.
+    flecs::entity_t entity_id = 0;
+    TransformComponent transform = {};
+  };
+
+  // Id of `TransformComponent` in the codec's world.
+  flecs::id_t transform_id = 0;
+  // How far apart the server sends snapshots, its `NetServer::tick_interval`.
+  f64 snapshot_interval = 1000.0 / 20.0;
+  // Two snapshot intervals ride out one lost snapshot, add the expected jitter on top of that.
+  f64 delay_ms = 2.0 * (1000.0 / 20.0);
+  // Skipped, for the entity the client predicts itself.
+  flecs::entity_t predicted_entity = 0;
+
+  SnapshotInterpolator() = default;
+  SnapshotInterpolator(flecs::id_t transform_id_, f64 snapshot_interval_);
+
+  // Snapshots may come in any order, ones that are older than the playback position are dropped.
+  auto push(this SnapshotInterpolator&, u8 sequence, const SceneState& state) -> void;
+  // Moves the playback clock on by `delta_ms` and samples every entity at the new position.
+  auto update(this SnapshotInterpolator&, f64 delta_ms) -> std::span<const Sample>;
+  auto find(this const SnapshotInterpolator&, flecs::entity_t entity_id) -> const TransformComponent*;
+  auto reset(this SnapshotInterpolator&) -> void;
+
+  // Sorted by time, the oldest first.
+  std::vector<Frame> frames = {};
+  // Frames played past, kept for their memory.
+  std::vector<Frame> spare_frames = {};
+  // Result of the last `update`, sorted by entity.
+  std::vector<Sample> samples = {};
+  f64 playback_time = 0.0;
+  // Local time passed since the newest snapshot arrived.
+  f64 since_newest = 0.0;
+  bool playing = false;
+  i64 newest_tick = 0;
+  u8 newest_sequence = 0;
+
+private:
+  auto claim_frame(this SnapshotInterpolator&, f64 time) -> Frame*;
+  auto sample(this SnapshotInterpolator&, const Frame& from, const Frame& to, f32 t) -> void;
+};
+} // namespace ox
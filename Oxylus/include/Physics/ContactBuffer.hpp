@@ -0,0 +1,90 @@
+#pragma once
+
+// clang-format off
+#include <Jolt/Jolt.h>
+#include <Jolt/Physics/Body/BodyID.h>
+#include <Jolt/Physics/Collision/Shape/SubShapeID.h>
+// clang-format on
+
+#include <glm/vec3.hpp>
+#include <mutex>
+#include <vector>
+
+#include "Core/Types.hpp"
+
+namespace JPH {
+class Body;
+class ContactManifold;
+class ContactSettings;
+} // namespace JPH
+
+namespace ox {
+enum class ContactEventKind : u8 {
+  Added = 0,
+  Persisted,
+  Removed,
+};
+
+// One pair of bodies touching, starting to or no longer touching during a physics step. `body1` always
+// has the lower id.
+struct ContactEvent {
+  ContactEventKind kind = ContactEventKind::Added;
+  JPH::BodyID body1 = {};
+  JPH::BodyID body2 = {};
+  // Entities the bodies belong to, from their user data. 0 once a body is gone.
+  u64 entity1 = 0;
+  u64 entity2 = 0;
+  // Everything below is from the deepest of the pair's sub shape contacts and unset for removed ones.
+  JPH::SubShapeID sub_shape1 = {};
+  JPH::SubShapeID sub_shape2 = {};
+  // World space, pointing from `body1` to `body2`.
+  glm::vec3 normal = {};
+  // World space, on the surface of `body1`.
+  glm::vec3 point = {};
+  f32 penetration_depth = 0.0f;
+  f32 friction = 0.0f;
+  f32 restitution = 0.0f;
+  // Sub shape contacts that were collapsed into this one.
+  u32 contact_count = 1;
+};
+
+// Collects contacts from Jolt's workers while `PhysicsSystem::Update` runs, without them ever
+// waiting on each other, and hands them over in one batch afterwards. Every job manager worker
+// records into a list of its own, picked by its worker id, and so does the main thread, which runs
+// jobs too while it waits on a step. Any other thread shares one behind a lock.
+struct ContactBuffer {
+  // Off while nobody listens, recording is skipped then.
+  bool enabled = false;
+
+  // One list per worker, plus the main thread's. Only call while no step is running.
+  auto init(this ContactBuffer&, u32 worker_count) -> void;
+
+  auto record(
+    this ContactBuffer&,
+    ContactEventKind kind,
+    const JPH::Body& body1,
+    const JPH::Body& body2,
+    const JPH::ContactManifold& manifold,
+    const JPH::ContactSettings& settings
+  ) -> void;
+  auto record_removed(this ContactBuffer&, const JPH::BodyID& body1, const JPH::BodyID& body2) -> void;
+
+  // Moves everything recorded since the last call into `out`, one event per pair of bodies and
+  // sorted by body ids. A pair that was added or removed on some sub shapes while others stayed in
+  // contact comes out as persisted. Only call while no step is running. Returns how many contacts
+  // were recorded before collapsing.
+  auto merge(this ContactBuffer&, std::vector<ContactEvent>& out) -> usize;
+  auto clear(this ContactBuffer&) -> void;
+
+private:
+  struct alignas(64) ThreadEvents {
+    std::vector<ContactEvent> events = {};
+  };
+
+  std::vector<ThreadEvents> threads = {};
+  ThreadEvents shared = {};
+  std::mutex shared_mutex = {};
+
+  auto push(this ContactBuffer&, const ContactEvent& event) -> void;
+};
+} // namespace ox
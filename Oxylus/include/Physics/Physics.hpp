@@ -4,6 +4,7 @@
 #include <expected>
 
 #include "Physics/PhysicsInterfaces.hpp"
+#include "Physics/ShapeCache.hpp"
 #include "Render/DebugRenderer.hpp"
 
 #include <Jolt/Core/JobSystemThreadPool.h>
@@ -13,28 +14,45 @@
 namespace ox {
 class RayCast;
 
+// Sizes a `JPH::PhysicsSystem` is created with, Jolt cannot grow them afterwards.
+struct PhysicsCapacity {
+  u32 max_bodies = 1024;
+  u32 max_body_pairs = 1024;
+  u32 max_contact_constraints = 1024;
+  // 0 lets Jolt pick one per hardware thread.
+  u32 body_mutexes = 0;
+  // Not part of the system, the shared temp allocator is grown to it instead.
+  usize temp_allocator_size = 10 * 1024 * 1024;
+
+  auto operator==(const PhysicsCapacity&) const -> bool = default;
+};
+
 class Physics {
 public:
   constexpr static auto MODULE_NAME = "Physics";
 
-  static constexpr uint32_t MAX_BODIES = 1024;
-  static constexpr uint32_t MAX_BODY_PAIRS = 1024;
-  static constexpr uint32_t MAX_CONTACT_CONSTRAINS = 1024;
   BPLayerInterfaceImpl layer_interface;
   ObjectVsBroadPhaseLayerFilterImpl object_vs_broad_phase_layer_filter_interface;
   ObjectLayerPairFilterImpl object_layer_pair_filter_interface;
+  // Shared by every scene, so the same mesh collides through one shape everywhere.
+  ShapeCache shape_cache = {};
 
   auto init(this Physics& self) -> std::expected<void, std::string>;
   auto deinit(this Physics& self) -> std::expected<void, std::string>;
 
-  auto new_system(this const Physics& self) -> std::unique_ptr<JPH::PhysicsSystem>;
+  auto new_system(this const Physics& self, const PhysicsCapacity& capacity = {})
+    -> std::unique_ptr<JPH::PhysicsSystem>;
+  // Replaces the temp allocator with a bigger one when it is smaller than `size`. Only call while no
+  // system is being updated.
+  auto reserve_temp_allocator(this Physics& self, usize size) -> void;
   auto new_debug_renderer(this const Physics& self) -> std::unique_ptr<PhysicsDebugRenderer>;
 
-  auto get_temp_allocator(this const Physics& self) -> JPH::TempAllocatorImpl* { return self.temp_allocator.get(); }
+  auto get_temp_allocator(this const Physics& self) -> JPH::TempAllocator* { return self.temp_allocator.get(); }
   auto get_job_system(this const Physics& self) -> JPH::JobSystemWithBarrier* { return self.job_system.get(); }
 
 private:
-  std::unique_ptr<JPH::TempAllocatorImpl> temp_allocator = nullptr;
+  std::unique_ptr<JPH::TempAllocator> temp_allocator = nullptr;
+  usize temp_allocator_size = 0;
   std::unique_ptr<JPH::JobSystemWithBarrier> job_system = nullptr;
 };
 } // namespace ox
@@ -0,0 +1,31 @@
+#pragma once
+
+#include <simdjson.h>
+
+#include "Physics/Physics.hpp"
+#include "Utils/CVars.hpp"
+#include "Utils/JsonWriter.hpp"
+
+namespace ox {
+struct PhysicsCVar {
+  CVarSystem system;
+
+  PhysicsCVar();
+
+  auto init(this PhysicsCVar& self) -> void;
+
+  auto to_json(this const PhysicsCVar& self, JsonWriter& writer) -> void;
+  auto from_json(this const PhysicsCVar& self, simdjson::ondemand::value& json) -> void;
+
+  // What a scene of `body_count` bodies, `moving_count` of them dynamic or kinematic, gets created
+  // with. The CVars are the lower bound, with auto capacity on everything grows to fit the scene.
+  auto capacity(this const PhysicsCVar& self, u32 body_count, u32 moving_count) -> PhysicsCapacity;
+
+  AutoCVar_Int cvar_auto_capacity;
+  AutoCVar_Int cvar_max_bodies;
+  AutoCVar_Int cvar_max_body_pairs;
+  AutoCVar_Int cvar_max_contact_constraints;
+  AutoCVar_Int cvar_body_mutexes;
+  AutoCVar_Int cvar_temp_allocator_mb;
+};
+} // namespace ox
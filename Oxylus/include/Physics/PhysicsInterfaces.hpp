@@ -5,6 +5,8 @@
 #include <Jolt/Physics/Collision/ContactListener.h>
 #include <Jolt/Physics/Collision/ObjectLayer.h>
 
+#include "Physics/ContactBuffer.hpp"
+
 namespace ox {
 class Scene;
 }
@@ -66,9 +68,11 @@ public:
                          [[maybe_unused]] JPH::uint64 inBodyUserData) override;
 };
 
+// Called from Jolt's workers, contacts are only recorded here and handed out by the scene after the step.
 class Physics3DContactListener : public JPH::ContactListener {
 public:
-  Physics3DContactListener(ox::Scene* scene) : _scene(scene) {}
+  ContactBuffer contacts = {};
+
   JPH::ValidateResult OnContactValidate(const JPH::Body& inBody1,
                                         const JPH::Body& inBody2,
                                         JPH::RVec3Arg inBaseOffset,
@@ -87,7 +91,6 @@ public:
   void OnContactRemoved(const JPH::SubShapeIDPair& inSubShapePair) override;
 
 private:
-  ox::Scene* _scene = nullptr;
   static void GetFrictionAndRestitution(const JPH::Body& inBody,
                                         const JPH::SubShapeID& inSubShapeID,
                                         float& outFriction,
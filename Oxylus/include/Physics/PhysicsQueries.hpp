@@ -0,0 +1,107 @@
+#pragma once
+
+// clang-format off
+#include <Jolt/Jolt.h>
+#include <Jolt/Physics/Body/BodyID.h>
+// clang-format on
+
+#include <glm/vec3.hpp>
+#include <span>
+#include <vector>
+
+#include "Core/Types.hpp"
+
+namespace JPH {
+class PhysicsSystem;
+} // namespace JPH
+
+namespace ox {
+class JobManager;
+
+enum class PhysicsQueryKind : u8 {
+  Ray = 0,
+  SphereCast,
+  SphereOverlap,
+};
+
+struct PhysicsQuery {
+  PhysicsQueryKind kind = PhysicsQueryKind::Ray;
+  glm::vec3 origin = {};
+  // The whole cast, its length is the distance. Unused by overlaps.
+  glm::vec3 direction = {};
+  f32 radius = 0.0f;
+  // Left out of the results, usually the querying entity's own body.
+  JPH::BodyID ignore_body = {};
+};
+
+struct PhysicsQueryHit {
+  JPH::BodyID body = {};
+  // From the body's user data.
+  u64 entity = 0;
+  // World space, on the surface of the body that was hit.
+  glm::vec3 point = {};
+  // World space, pointing out of the body that was hit.
+  glm::vec3 normal = {};
+  // How far along the cast the hit is, 0 for overlaps.
+  f32 fraction = 0.0f;
+};
+
+// Results of a batch in flat arrays: query `i` owns `max_hits` slots in `hits` starting at
+// `i * max_hits`, of which `hit_counts[i]` are used, closest first.
+struct PhysicsQueryResults {
+  u32 max_hits = 0;
+  std::vector<u32> hit_counts = {};
+  std::vector<PhysicsQueryHit> hits = {};
+
+  auto hits_of(this const PhysicsQueryResults& self, usize query) -> std::span<const PhysicsQueryHit> {
+    return {self.hits.data() + query * self.max_hits, self.hit_counts[query]};
+  }
+};
+
+// Queries collected over a tick and run against the physics system in one go, spread over the job
+// manager's workers. Neither the batch nor the results allocate once they have grown to the
+// largest batch seen, so both are meant to be kept around and refilled.
+struct PhysicsQueryBatch {
+  // Batches of fewer queries run on the calling thread.
+  constexpr static u32 PARALLEL_THRESHOLD = 256;
+  constexpr static u32 MIN_CHUNK_SIZE = 64;
+
+  std::vector<PhysicsQuery> queries = {};
+  // 1 keeps only the closest hit of every cast and any one body an overlap touches.
+  u32 max_hits = 1;
+
+  auto add_ray(
+    this PhysicsQueryBatch& self, const glm::vec3& origin, const glm::vec3& direction, JPH::BodyID ignore = {}
+  ) -> u32;
+  auto add_sphere_cast(
+    this PhysicsQueryBatch& self,
+    const glm::vec3& origin,
+    const glm::vec3& direction,
+    f32 radius,
+    JPH::BodyID ignore = {}
+  ) -> u32;
+  auto add_sphere_overlap(this PhysicsQueryBatch& self, const glm::vec3& center, f32 radius, JPH::BodyID ignore = {})
+    -> u32;
+  auto clear(this PhysicsQueryBatch& self) -> void { self.queries.clear(); }
+  auto size(this const PhysicsQueryBatch& self) -> usize { return self.queries.size(); }
+
+  // Safe to call from a job, as long as no bodies are added or removed while it runs. `job_manager`
+  // can be null to run everything on the calling thread.
+  auto run(
+    this const PhysicsQueryBatch& self,
+    const JPH::PhysicsSystem& system,
+    JobManager* job_manager,
+    PhysicsQueryResults& results
+  ) -> void;
+  // Runs `[begin, end)` only, for callers that spread the batch over their own jobs. `results` has
+  // to be sized by `prepare_results` first.
+  auto run_range(
+    this const PhysicsQueryBatch& self,
+    const JPH::PhysicsSystem& system,
+    usize begin,
+    usize end,
+    PhysicsQueryResults& results
+  ) -> void;
+  auto prepare_results(this const PhysicsQueryBatch& self, PhysicsQueryResults& results) -> void;
+};
+} // namespace ox
@@ -0,0 +1,39 @@
+#pragma once
+
+// clang-format off
+#include <Jolt/Jolt.h>
+#include <Jolt/Physics/Body/BodyManager.h>
+// clang-format on
+
+#include <flecs.h>
+#include <vector>
+
+#include "Core/Types.hpp"
+
+namespace JPH {
+class PhysicsSystem;
+} // namespace JPH
+
+namespace ox {
+// Copies rigidbody poses from Jolt into `RigidBodyComponent` and `TransformComponent`, visiting only
+// the bodies Jolt reports as awake. A level full of sleeping bodies costs nothing between steps.
+struct RigidBodySync {
+  // Entities whose `TransformComponent` `step` or `interpolate` wrote, for the caller to upload in
+  // one go and clear.
+  std::vector<flecs::entity> written = {};
+
+  // After every physics step, outside of `PhysicsSystem::Update`. Awake bodies get their new pose to
+  // interpolate towards, bodies that fell asleep during the step are put to rest at their final one.
+  auto step(this RigidBodySync&, flecs::world& world, const JPH::PhysicsSystem& system) -> void;
+  // Every frame, `alpha` of the way from the pose before the last step to the one after it.
+  auto interpolate(this RigidBodySync&, flecs::world& world, f32 alpha) -> void;
+  auto clear(this RigidBodySync&) -> void;
+
+  auto awake_count(this const RigidBodySync& self) -> usize { return self.moving.size(); }
+
+private:
+  JPH::BodyIDVector awake_bodies = {};
+  JPH::BodyIDVector last_awake_bodies = {};
+  std::vector<flecs::entity> moving = {};
+};
+} // namespace ox
@@ -0,0 +1,65 @@
+#pragma once
+
+// clang-format off
+#include <Jolt/Jolt.h>
+#include <Jolt/Physics/Collision/Shape/Shape.h>
+// clang-format on
+
+#include <ankerl/unordered_dense.h>
+#include <filesystem>
+#include <glm/vec3.hpp>
+#include <mutex>
+#include <span>
+
+#include "Core/Types.hpp"
+
+namespace ox {
+enum class CookedShapeType : u8 {
+  // `JPH::MeshShape`, for static and kinematic bodies only.
+  Triangles = 0,
+  ConvexHull,
+  // A compound of hulls around the concave parts of the mesh.
+  ConvexParts,
+};
+
+// Cooks collision shapes out of mesh data once and hands the same shape to every body using the
+// same mesh. Cooked shapes are also written to a cache directory, named by a hash of the mesh, so
+// later loads read them back instead of cooking again.
+struct ShapeCache {
+  constexpr static u32 MAX_CONVEX_PARTS = 64;
+
+  struct Stats {
+    u64 shared = 0;
+    u64 loaded = 0;
+    u64 cooked = 0;
+  };
+
+  Stats stats = {};
+
+  // `cache_directory` can be empty to keep the shape in memory only.
+  auto get_or_cook(
+    this ShapeCache&,
+    std::span<const glm::vec3> positions,
+    std::span<const u32> indices,
+    CookedShapeType type,
+    u32 max_convex_parts,
+    const std::filesystem::path& cache_directory
+  ) -> JPH::ShapeSettings::ShapeResult;
+  auto clear(this ShapeCache&) -> void;
+
+  static auto cook(
+    std::span<const glm::vec3> positions, std::span<const u32> indices, CookedShapeType type, u32 max_convex_parts
+  ) -> JPH::ShapeSettings::ShapeResult;
+  static auto content_hash(
+    std::span<const glm::vec3> positions, std::span<const u32> indices, CookedShapeType type, u32 max_convex_parts
+  ) -> u64;
+  static auto cache_path(const std::filesystem::path& cache_directory, u64 hash) -> std::filesystem::path;
+
+private:
+  std::mutex mutex = {};
+  ankerl::unordered_dense::map<u64, JPH::Ref<JPH::Shape>> shapes = {};
+
+  static auto save(const JPH::Shape& shape, const std::filesystem::path& path, u64 hash) -> bool;
+  static auto load(const std::filesystem::path& path, u64 hash) -> JPH::Ref<JPH::Shape>;
+};
+} // namespace ox
@@ -20,6 +20,7 @@ class Renderer;
 class DebugRenderer {
 public:
   constexpr static auto MODULE_NAME = "DebugRenderer";
+  constexpr static auto SKIP_HEADLESS = true;
   using module_dependencies = std::tuple<Renderer>;
 
   struct Vertex {
@@ -62,26 +62,26 @@ struct Frustum {
     return false;
   }
 
+  // Gribb/Hartmann extraction, same plane convention as `math::calc_frustum_planes`.
   static Frustum from_matrix(const glm::mat4& view_projection) {
-    Frustum frustum = {};
-
-    frustum.near_face = Plane(view_projection[2]);
-
-    // Far plane:
-    frustum.far_face = Plane(view_projection[3] - view_projection[2]);
-
-    // Left plane:
-    frustum.left_face = Plane(view_projection[3] + view_projection[0]);
-
-    // Right plane:
-    frustum.right_face = Plane(view_projection[3] - view_projection[0]);
-
-    // Top plane:
-    frustum.top_face = Plane(view_projection[3] - view_projection[1]);
-
-    // Bottom plane:
-    frustum.bottom_face = Plane(view_projection[3] + view_projection[1]);
+    const auto row = [&view_projection](int i) {
+      return glm::vec4(view_projection[0][i], view_projection[1][i], view_projection[2][i], view_projection[3][i]);
+    };
+    const auto make_plane = [](const glm::vec4& coefficients) {
+      const auto length = glm::length(glm::vec3(coefficients));
+      Plane plane = {};
+      plane.normal = glm::vec3(coefficients) / length;
+      plane.distance = -coefficients.w / length;
+      return plane;
+    };
 
+    Frustum frustum = {};
+    frustum.left_face = make_plane(row(3) + row(0));
+    frustum.right_face = make_plane(row(3) - row(0));
+    frustum.bottom_face = make_plane(row(3) + row(1));
+    frustum.top_face = make_plane(row(3) - row(1));
+    frustum.near_face = make_plane(row(3) + row(2));
+    frustum.far_face = make_plane(row(3) - row(2));
     frustum.init();
 
     return frustum;
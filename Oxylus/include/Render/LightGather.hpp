@@ -0,0 +1,47 @@
+#pragma once
+
+#include <ankerl/unordered_dense.h>
+#include <flecs.h>
+#include <vector>
+
+#include "Memory/SlotMap.hpp"
+#include "Scene/Components.hpp"
+#include "Scene/SceneGPU.hpp"
+
+namespace ox {
+// The light half of `RendererInstance::update`. Keeps the scene's light slots in sync with its light
+// entities and picks up the sun, atmosphere and sky, without touching the device.
+struct LightGather {
+  // Filled from the directional light.
+  GPU::DirectionalLight directional_light = {};
+  bool directional_light_cast_shadows = true;
+  bool sun_direction_changed = false;
+  f32 first_clipmap_width = 1.0f;
+  f32 clipmap_selection_bias = 2.0f;
+  // Only the scattering parameters, the LUT sizes are the renderer's.
+  GPU::Atmosphere atmosphere = {};
+  GPU::SkyData sky_data = {};
+  // Frames the lights were walked, frames with nothing to do don't count.
+  u32 gather_count = 0;
+
+  auto init(this LightGather&, flecs::world& world) -> void;
+  // Rewrites the slots of changed tables and of parented lights that moved, and queues them in
+  // `dirty_lights`. Returns the scene flags the lights contribute, also on frames that are skipped.
+  auto gather(
+    this LightGather&,
+    SlotMap<GPU::Light, GPU::LightID>& lights,
+    ankerl::unordered_dense::map<flecs::entity, GPU::LightID>& entity_lights,
+    std::vector<GPU::LightID>& dirty_lights
+  ) -> GPU::SceneFlags;
+
+private:
+  // Tracks changes so the gather can be skipped on frames where nothing it reads was written.
+  flecs::query<const TransformComponent, const LightComponent, const AtmosphereComponent*, const SkyComponent*>
+    query = {};
+  bool gathered = false;
+  // Lights with a parent are gathered every frame, their tables don't change when an ancestor moves.
+  bool has_parented_lights = false;
+  GPU::SceneFlags scene_flags = {};
+  glm::vec3 previous_sun_direction = {};
+};
+} // namespace ox
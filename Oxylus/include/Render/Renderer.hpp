@@ -17,6 +17,7 @@ class RenderContext;
 class Renderer {
 public:
   constexpr static auto MODULE_NAME = "Renderer";
+  constexpr static auto SKIP_HEADLESS = true;
 
   vuk::Unique<vuk::Buffer> quad_vertex_buffer = vuk::Unique<vuk::Buffer>();
   vuk::Unique<vuk::Buffer> quad_index_buffer = vuk::Unique<vuk::Buffer>();
@@ -3,8 +3,11 @@
 #include <ankerl/unordered_dense.h>
 
 #include "Asset/Texture.hpp"
+#include "Render/LightGather.hpp"
+#include "Render/SpriteGather.hpp"
 #include "Render/Renderer.hpp"
 #include "Render/RendererCVar.hpp"
+#include "Scene/Components.hpp"
 #include "Scene/SceneGPU.hpp"
 #include "Scene/Terrain.hpp"
 
@@ -322,6 +325,10 @@ struct PBRContext {
   vuk::Value<vuk::ImageAttachment> ambient_occlusion_attachment = {};
   vuk::Value<vuk::ImageAttachment> contact_shadows_attachment = {};
   vuk::Value<vuk::ImageAttachment> resolved_shadows_attachment = {};
+
+  // Filled by `cluster_lights`, GPU::LIGHT_CLUSTER_COUNT counts and MAX_LIGHTS_PER_CLUSTER indices per cluster.
+  vuk::Value<vuk::Buffer> cluster_light_counts_buffer = {};
+  vuk::Value<vuk::Buffer> cluster_light_indices_buffer = {};
 };
 
 struct DebugContext {
@@ -341,6 +348,34 @@ struct DebugContext {
   vuk::Value<vuk::ImageAttachment> vsm_page_table_attachment = {};
 };
 
+struct ParticleContext {
+  vuk::PersistentDescriptorSet* bindless_set = nullptr;
+
+  vuk::Value<vuk::ImageAttachment> final_attachment = {};
+  vuk::Value<vuk::ImageAttachment> depth_attachment = {};
+};
+
+// Persistent buffers of a `ParticleSystemComponent::gpu_simulation` emitter. Live particle indices
+// ping-pong between the two halves of `alive_list_buffer`, `parity` selects the current one.
+struct GPUParticleEmitter {
+  u32 capacity = 0;
+  u32 parity = 0;
+  bool needs_reset = true;
+  bool seen = false;
+
+  vuk::Unique<vuk::Buffer> particles_buffer{};
+  vuk::Unique<vuk::Buffer> alive_list_buffer{};
+  vuk::Unique<vuk::Buffer> dead_list_buffer{};
+  vuk::Unique<vuk::Buffer> counters_buffer{};
+  vuk::Unique<vuk::Buffer> instances_buffer{};
+};
+
+struct GPUParticleDraw {
+  u64 entity = 0;
+  u32 material_index = 0;
+  GPU::ParticleEmitterParams params = {};
+};
+
 struct PostProcessContext {
   f32 delta_time = 0.0f;
   vuk::Extent3D extent = {};
@@ -408,6 +443,7 @@ public:
   auto resolve_shadowmap(this RendererInstance&, ShadowResolveContext& context) -> void;
   auto draw_atmosphere(this RendererInstance&, AtmosphereContext& context) -> void;
   auto generate_ambient_occlusion(this RendererInstance&, AmbientOcclusionContext& context) -> void;
+  auto cluster_lights(this RendererInstance&, PBRContext& context) -> void;
   auto apply_pbr(this RendererInstance&, PBRContext& context, vuk::Value<vuk::ImageAttachment>&& dst_attachment)
     -> vuk::Value<vuk::ImageAttachment>;
   auto apply_eye_adaptation(this RendererInstance&, PostProcessContext& context) -> void;
@@ -421,6 +457,8 @@ public:
     vuk::Value<vuk::ImageAttachment>&& dst_attachment
   ) -> vuk::Value<vuk::ImageAttachment>;
 
+  auto draw_particles(this RendererInstance& self, ParticleContext& context) -> void;
+
   auto update_vbgtao_info(this RendererInstance&, const RendererCVar& cvar) -> void;
 
 private:
@@ -435,9 +473,31 @@ private:
   auto execute_stages_before(this const RendererInstance& self, RenderStage stage, RenderStageContext& ctx) -> void;
   auto execute_stages_after(this const RendererInstance& self, RenderStage stage, RenderStageContext& ctx) -> void;
 
+  auto simulate_gpu_particles(this RendererInstance& self, GPUParticleEmitter& emitter, const GPUParticleDraw& draw)
+    -> std::pair<vuk::Value<vuk::Buffer>, vuk::Value<vuk::Buffer>>;
+
+
   Scene& scene;
   Renderer& renderer;
-  GPU::RenderQueue2D render_queue_2d = {};
+
+  // Built once per scene. Lights and sprites skip their gathers on frames where nothing they read
+  // was written, see `light_gather` and `sprite_gather`.
+  flecs::query<const TransformComponent, const CameraComponent> camera_query = {};
+  flecs::query<const ParticleSystemComponent> particle_system_query = {};
+  flecs::query<const AutoExposureComponent> auto_exposure_query = {};
+  flecs::query<const TransformComponent, const VignetteComponent> vignette_query = {};
+  flecs::query<const TransformComponent, const ChromaticAberrationComponent> chromatic_aberration_query = {};
+  flecs::query<const TransformComponent, const FilmGrainComponent> film_grain_query = {};
+  flecs::query<const TonemappingComponent> tonemapping_query = {};
+
+  LightGather light_gather = {};
+  SpriteGather sprite_gather = {};
+  bool sprites_sorted = false;
+
+  std::vector<GPU::ParticleInstance> particle_instances = {};
+  std::vector<GPU::ParticleBatch> particle_batches = {};
+  std::vector<GPUParticleDraw> gpu_particle_draws = {};
+  ankerl::unordered_dense::map<u64, GPUParticleEmitter> gpu_particle_emitters = {};
   bool saved_camera = false;
 
   glm::uvec2 viewport_size_ = {};
@@ -455,14 +515,6 @@ private:
 
   GPU::TonemapType tonemap_type = GPU::TonemapType::AgX;
 
-  bool directional_light_cast_shadows = true;
-  bool sun_direction_changed = false;
-  glm::vec3 previous_sun_direction = {};
-  GPU::DirectionalLight directional_light = {};
-  f32 first_clipmap_width = 1.0f;
-  f32 clipmap_selection_bias = 2.0f;
-  GPU::Atmosphere atmosphere = {};
-  GPU::SkyData sky_data = {};
   GPU::EyeAdaptationSettings eye_adaptation = {};
   GPU::VBGTAOSettings vbgtao_info = {};
   GPU::PostProcessSettings post_proces_settings = {};
@@ -0,0 +1,37 @@
+#pragma once
+
+#include <ankerl/unordered_dense.h>
+#include <flecs.h>
+#include <functional>
+
+#include "Core/Option.hpp"
+#include "Scene/Components.hpp"
+#include "Scene/SceneGPU.hpp"
+
+namespace ox {
+// The sprite half of `RendererInstance::update`. Fills the 2D render queue from the sprite entities
+// and keeps it as it is on frames nothing it reads changed, without touching the device.
+struct SpriteGather {
+  GPU::RenderQueue2D render_queue_2d = {};
+  // Frames the sprites were walked, frames with nothing to do don't count.
+  u32 gather_count = 0;
+
+  auto init(this SpriteGather&, flecs::world& world) -> void;
+  // Rebuilds `render_queue_2d` when a sprite was written or removed, the camera's z moved or a
+  // material was still loading last time. `material_index` is nullopt for a material still loading.
+  // True when the queue was rebuilt and has to be sorted again.
+  auto gather(
+    this SpriteGather&,
+    f32 camera_z,
+    const ankerl::unordered_dense::map<flecs::entity, GPU::TransformID>& entity_transforms,
+    const std::function<option<u32>(const UUID&)>& material_index
+  ) -> bool;
+
+private:
+  flecs::query<const TransformComponent, const SpriteComponent> query = {};
+  // Forces a rebuild, also set while a sprite's material is still loading.
+  bool dirty = true;
+  // Sort distance only depends on the camera's z, any other camera movement keeps the queue valid.
+  f32 camera_z = 0.0f;
+};
+} // namespace ox
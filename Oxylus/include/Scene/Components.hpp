@@ -4,6 +4,7 @@
 
 #include "Audio/AudioEngine.hpp"
 #include "Core/UUID.hpp"
+#include "Scene/ParticlePool.hpp"
 #include "Scene/SceneGPU.hpp"
 #include "Utils/OxMath.hpp"
 
@@ -186,8 +187,14 @@ struct ParticleSystemComponent {
   f32 rotation_by_speed_min_speed = 0.f;
   f32 rotation_by_speed_max_speed = 1.f;
 
-  std::vector<u64> particles = {};
-  u32 pool_index = 0;
+  // Simulate on the GPU instead of `pool`, particle data then never leaves the GPU.
+  bool gpu_simulation = false;
+
+  ParticlePool pool = {};
+  // Emission request handed to the renderer each frame when `gpu_simulation` is set.
+  u32 gpu_emit_count = 0;
+  f32 gpu_delta_time = 0.0f;
+  glm::vec3 emitter_position = {};
   float system_time = 0.0f;
   float burst_time = 0.0f;
   float spawn_time = 0.0f;
@@ -196,6 +203,8 @@ struct ParticleSystemComponent {
   bool playing = false;
 };
 
+// Particles live in `ParticleSystemComponent::pool` now, this is only kept so that scenes saved
+// with per-entity particles still deserialize.
 struct ParticleComponent {
   glm::vec4 color = {};
   f32 life_remaining = 0.f;
@@ -393,7 +402,14 @@ struct CylinderColliderComponent {
   f32 restitution = 0.0f;
 };
 
+// Collides with the entity's `MeshComponent`. Jolt only simulates moving bodies with convex shapes, so
+// `Auto` uses the triangles for static bodies and a hull for everything else.
 struct MeshColliderComponent {
+  enum ShapeType : u32 { Auto = 0, Triangles, ConvexHull, ConvexParts };
+
+  ShapeType shape_type = ShapeType::Auto;
+  // Upper bound on hulls `ConvexParts` splits the mesh into.
+  u32 max_convex_parts = 16;
   glm::vec3 offset = {0.f, 0.f, 0.f};
   f32 friction = 0.5f;
   f32 restitution = 0.0f;
@@ -474,6 +490,23 @@ struct Hidden {};
 
 struct Networked {};
 
+// Sent to every client regardless of where its viewer is.
+struct AlwaysRelevant {};
+
+// How a replicated entity competes for a client's update budget. It is resent at most every
+// `update_interval` ticks, ahead of others by `priority` times the ticks since it was last sent.
+struct NetRelevancy {
+  f32 priority = 1.0f;
+  u32 update_interval = 1;
+};
+
+// Newest input of the owning client the server has applied to this entity, set by the server's
+// game code. It travels in the same snapshot as the state it produced, which is what lets a
+// `ClientPrediction` tell which of its inputs that state already includes.
+struct NetInputAck {
+  u32 sequence = 0;
+};
+
 struct CoreComponentsModule {
   CoreComponentsModule(flecs::world& world);
 };
@@ -0,0 +1,123 @@
+#pragma once
+
+#include <vector>
+
+#include "Core/Types.hpp"
+#include "Physics/RayCast.hpp"
+#include "Render/BoundingVolume.hpp"
+#include "Render/Frustum.hpp"
+#include "Utils/Log.hpp"
+
+namespace ox {
+// Incrementally updated AABB tree, after Box2D's b2DynamicTree. Leaves keep a fattened copy of their
+// bounds so small movements don't touch the tree, and inserts/removals rebalance with AVL style
+// rotations, so queries stay O(log n) plus the number of hits.
+class DynamicBVH {
+public:
+  constexpr static u32 NULL_NODE = ~0_u32;
+  constexpr static f32 AABB_MARGIN = 0.1f;
+  // Balanced trees are ~1.44 log2(n) deep, this covers far more than 1M proxies.
+  constexpr static u32 MAX_STACK_SIZE = 256;
+
+  auto create_proxy(this DynamicBVH& self, const AABB& aabb, u64 user_data) -> u32;
+  auto destroy_proxy(this DynamicBVH& self, u32 proxy) -> void;
+  // Returns true when `aabb` left the fat bounds and the proxy got reinserted.
+  auto move_proxy(this DynamicBVH& self, u32 proxy, const AABB& aabb) -> bool;
+  auto clear(this DynamicBVH& self) -> void;
+
+  auto get_user_data(this const DynamicBVH& self, u32 proxy) -> u64 { return self.nodes[proxy].user_data; }
+  auto get_fat_aabb(this const DynamicBVH& self, u32 proxy) -> const AABB& { return self.nodes[proxy].aabb; }
+  auto get_proxy_count(this const DynamicBVH& self) -> u32 { return self.proxy_count; }
+  auto get_height(this const DynamicBVH& self) -> i32 {
+    return self.root == NULL_NODE ? 0 : self.nodes[self.root].height;
+  }
+
+  // All query callbacks receive the proxy's user data and return false to stop the query early.
+  template <typename F>
+  auto query(this const DynamicBVH& self, const AABB& aabb, F&& callback) -> void {
+    self.traverse([&aabb](const AABB& node) { return node.intersects_fast(aabb); }, callback);
+  }
+
+  template <typename F>
+  auto query(this const DynamicBVH& self, const Sphere& sphere, F&& callback) -> void {
+    self.traverse([&sphere](const AABB& node) { return sphere.intersects(node); }, callback);
+  }
+
+  template <typename F>
+  auto query(this const DynamicBVH& self, const Frustum& frustum, F&& callback) -> void {
+    self.traverse([&frustum](const AABB& node) { return node.is_on_frustum(frustum); }, callback);
+  }
+
+  // `callback(u64 user_data, f32 distance)`, distance is where the ray enters the proxy's fat bounds.
+  // Hits are reported in traversal order, not sorted.
+  template <typename F>
+  auto ray_cast(this const DynamicBVH& self, const RayCast& ray, F&& callback) -> void {
+    const auto origin = ray.get_origin();
+    const auto inv_direction = ray.get_direction_inverse();
+    f32 distance = 0.0f;
+    self.traverse(
+      [&](const AABB& node) { return ray_intersects(node, origin, inv_direction, ray.t_min, ray.t_max, distance); },
+      [&](u64 user_data) { return callback(user_data, distance); }
+    );
+  }
+
+  // Slab test, `distance` receives the entry point clamped to `t_min`.
+  static auto ray_intersects(
+    const AABB& aabb, const glm::vec3& origin, const glm::vec3& inv_direction, f32 t_min, f32 t_max, f32& distance
+  ) -> bool;
+
+  // Checks parent links, heights and bounds of the whole tree. Debugging/tests only.
+  auto validate(this const DynamicBVH& self) -> bool;
+
+private:
+  struct Node {
+    AABB aabb = {};
+    u64 user_data = 0;
+    // Next free node while the node is on the free list.
+    u32 parent = NULL_NODE;
+    u32 child1 = NULL_NODE;
+    u32 child2 = NULL_NODE;
+    // -1 free, 0 leaf
+    i32 height = -1;
+
+    auto is_leaf() const -> bool { return child1 == NULL_NODE; }
+  };
+
+  std::vector<Node> nodes = {};
+  u32 root = NULL_NODE;
+  u32 free_list = NULL_NODE;
+  u32 proxy_count = 0;
+
+  template <typename Overlap, typename F>
+  auto traverse(this const DynamicBVH& self, Overlap&& overlaps, F&& callback) -> void {
+    if (self.root == NULL_NODE)
+      return;
+
+    u32 stack[MAX_STACK_SIZE];
+    u32 stack_size = 0;
+    stack[stack_size++] = self.root;
+
+    while (stack_size > 0) {
+      const auto& node = self.nodes[stack[--stack_size]];
+      if (!overlaps(node.aabb))
+        continue;
+
+      if (node.is_leaf()) {
+        if (!callback(node.user_data))
+          return;
+      } else {
+        OX_CHECK_LT(stack_size + 2, MAX_STACK_SIZE);
+        stack[stack_size++] = node.child1;
+        stack[stack_size++] = node.child2;
+      }
+    }
+  }
+
+  auto allocate_node(this DynamicBVH& self) -> u32;
+  auto free_node(this DynamicBVH& self, u32 node) -> void;
+  auto insert_leaf(this DynamicBVH& self, u32 leaf) -> void;
+  auto remove_leaf(this DynamicBVH& self, u32 leaf) -> void;
+  auto balance(this DynamicBVH& self, u32 node) -> u32;
+  auto refit_ancestors(this DynamicBVH& self, u32 node) -> void;
+};
+} // namespace ox
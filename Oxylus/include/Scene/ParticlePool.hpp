@@ -0,0 +1,58 @@
+#pragma once
+
+#include <glm/gtc/quaternion.hpp>
+#include <glm/vec3.hpp>
+#include <vector>
+
+#include "Core/Types.hpp"
+
+namespace ox {
+class JobManager;
+struct ParticleSystemComponent;
+
+// Particle state of a single emitter, stored as parallel arrays so the simulation kernel streams
+// through plain float columns. Live particles are always packed into [0, alive_count); a particle
+// that dies is swapped with the last live one.
+struct ParticlePool {
+  // Below this many live particles the whole pool is simulated inline, the job overhead would
+  // dominate otherwise.
+  constexpr static u32 PARALLEL_THRESHOLD = 16384;
+  constexpr static u32 MIN_CHUNK_SIZE = 4096;
+
+  std::vector<f32> position_x = {};
+  std::vector<f32> position_y = {};
+  std::vector<f32> position_z = {};
+  std::vector<f32> velocity_x = {};
+  std::vector<f32> velocity_y = {};
+  std::vector<f32> velocity_z = {};
+  std::vector<f32> life_remaining = {};
+  std::vector<f32> size_x = {};
+  std::vector<f32> size_y = {};
+  std::vector<u32> color = {}; // packUnorm4x8
+  std::vector<glm::quat> rotation = {};
+
+  u32 capacity = 0;
+  u32 alive_count = 0;
+
+  auto resize(this ParticlePool& self, u32 new_capacity) -> void;
+  auto clear(this ParticlePool& self) -> void;
+
+  // Returns the number of particles that actually got emitted, which can be lower than `count`
+  // when the pool is full.
+  auto emit(this ParticlePool& self, const ParticleSystemComponent& component, const glm::vec3& origin, u32 count)
+    -> u32;
+
+  // Advances particles in [begin, end). Does not touch `alive_count`, so disjoint ranges can be
+  // simulated concurrently. Dead particles are removed by `compact`.
+  auto simulate(this ParticlePool& self, const ParticleSystemComponent& component, f32 delta_time, u32 begin, u32 end)
+    -> void;
+  auto compact(this ParticlePool& self) -> void;
+
+  // simulate + compact, split across the job manager for large pools when one is given.
+  auto update(this ParticlePool& self, const ParticleSystemComponent& component, f32 delta_time, JobManager* job_man)
+    -> void;
+
+private:
+  auto move_particle(this ParticlePool& self, u32 dst, u32 src) -> void;
+};
+} // namespace ox
@@ -10,14 +10,19 @@
 // clang-format on
 
 #include <simdjson.h>
+#include <span>
 
 #include "Asset/Model.hpp"
 #include "Core/UUID.hpp"
+#include "Physics/PhysicsCVar.hpp"
 #include "Physics/PhysicsInterfaces.hpp"
+#include "Physics/PhysicsQueries.hpp"
+#include "Physics/RigidBodySync.hpp"
 #include "Render/DebugRenderer.hpp"
 #include "Render/RendererCVar.hpp"
 #include "Render/RendererInstance.hpp"
 #include "Scene/Components.hpp"
+#include "Scene/DynamicBVH.hpp"
 #include "Scene/SceneGPU.hpp"
 #include "Scene/Terrain.hpp"
 #include "Scripting/LuaSystem.hpp"
@@ -67,6 +72,8 @@ public:
   ComponentDB component_db = {};
 
   f32 physics_interval = 1.f / 60.f; // used only on initialization
+  // Keeps contacts recorded for `get_contacts` even without a script listening for them.
+  bool collect_contacts = false;
 
   std::vector<GPU::TransformID> dirty_transforms = {};
   std::vector<MeshInstanceID> dirty_mesh_instances = {};
@@ -77,11 +84,20 @@ public:
   bool input_focused = true;
 
   RendererCVar renderer_cvar = {};
+  // Read when physics starts, the system is recreated then if the capacity it needs changed.
+  PhysicsCVar physics_cvar = {};
 
   SlotMap<MeshInstance, MeshInstanceID> mesh_instances = {};
   ankerl::unordered_dense::map<flecs::entity, MeshInstanceID> entity_to_mesh_instance_map = {};
 
+  // Point and spot lights, slots stay put while the entity lives so only changed lights get uploaded.
   SlotMap<GPU::Light, GPU::LightID> lights = {};
+  ankerl::unordered_dense::map<flecs::entity, GPU::LightID> entity_lights_map = {};
+  std::vector<GPU::LightID> dirty_lights = {};
+
+  // World bounds of meshes, sprites and point/spot lights, refit as their transforms propagate.
+  DynamicBVH spatial_index = {};
+  ankerl::unordered_dense::map<flecs::entity, u32> entity_spatial_proxies = {};
 
   std::unique_ptr<Terrain> terrain = nullptr;
   flecs::entity terrain_entity = {};
@@ -134,6 +150,13 @@ public:
 
   auto set_dirty(this Scene& self, flecs::entity entity) -> void;
 
+  // Spatial queries against `spatial_index`, they test the (slightly fattened) indexed bounds.
+  auto query_aabb(this const Scene& self, const AABB& aabb) -> std::vector<flecs::entity>;
+  auto query_sphere(this const Scene& self, const Sphere& sphere) -> std::vector<flecs::entity>;
+  auto query_frustum(this const Scene& self, const Frustum& frustum) -> std::vector<flecs::entity>;
+  // Sorted front to back by where the ray enters each entity's bounds.
+  auto query_ray(this const Scene& self, const RayCast& ray) -> std::vector<flecs::entity>;
+
   auto safe_entity_name(this const Scene& self, std::string prefix, flecs::entity parent = {}) -> std::string;
 
   auto get_lua_system(this const Scene& self, const UUID& lua_script) -> LuaSystem*;
@@ -145,19 +168,13 @@ public:
   auto get_physics_system(this const Scene& self) -> JPH::PhysicsSystem*;
   auto cast_ray(this const Scene& self, const RayCast& ray_cast)
     -> JPH::AllHitCollisionCollector<JPH::RayCastBodyCollector>;
-  auto on_contact_added(
-    const JPH::Body& body1,
-    const JPH::Body& body2,
-    const JPH::ContactManifold& manifold,
-    const JPH::ContactSettings& settings
-  ) -> void;
-  auto on_contact_persisted(
-    const JPH::Body& body1,
-    const JPH::Body& body2,
-    const JPH::ContactManifold& manifold,
-    const JPH::ContactSettings& settings
-  ) -> void;
-  auto on_contact_removed(const JPH::SubShapeIDPair& sub_shape_pair) -> void;
+  // Runs the whole batch over the app's job manager.
+  auto run_physics_queries(this const Scene& self, const PhysicsQueryBatch& batch, PhysicsQueryResults& results)
+    -> void;
+  // Contacts of the last physics step, one per pair of bodies.
+  auto get_contacts(this const Scene& self) -> std::span<const ContactEvent>;
+  // Hands the contacts recorded during the step to the scripts that listen for them.
+  auto dispatch_contacts(this Scene& self) -> void;
 
   auto on_body_activated(const JPH::BodyID& body_id, JPH::uint64 body_user_data) -> void;
   auto on_body_deactivated(const JPH::BodyID& body_id, JPH::uint64 body_user_data) -> void;
@@ -165,12 +182,20 @@ public:
   auto create_rigidbody(
     this Scene& self, flecs::entity entity, const TransformComponent& transform, RigidBodyComponent& component
   ) -> void;
+  // Creates the body without adding it to the world, for adding many at once. Null when the entity
+  // has no collider or the system is full, or when its mesh collider is still loading, in which case
+  // the body gets created once the mesh is in.
+  auto build_rigidbody(
+    this Scene& self, flecs::entity entity, const TransformComponent& transform, RigidBodyComponent& component
+  ) -> JPH::Body*;
   auto create_character_controller(
     flecs::entity entity, const TransformComponent& transform, CharacterControllerComponent& component
   ) const -> void;
 
   auto create_terrain_collision(this Scene& self) -> void;
   auto destroy_terrain_collision(this Scene& self) -> void;
+  // Patches the heights brush strokes changed into the existing collider instead of rebuilding it.
+  auto update_terrain_collision_region(this Scene& self) -> void;
   auto sync_terrain_edits(this Scene& self) -> void;
   auto set_terrain_edits_ref(this Scene& self, const UUID& uuid) -> void;
   auto clear_terrain_edits(this Scene& self) -> void;
@@ -219,14 +244,24 @@ private:
   };
 
   std::vector<PendingModelSpawn> pending_model_spawns = {};
+  // Rigidbodies with a mesh collider whose mesh was not loaded yet when the body was built.
+  std::vector<flecs::entity> pending_mesh_colliders = {};
 
   bool running = false;
   bool deserializing_entity = false;
 
+  // Built once in `init` instead of on every physics start/stop and (de)serialization.
+  flecs::query<const TransformComponent, RigidBodyComponent> rigidbody_query = {};
+  flecs::query<const TransformComponent, CharacterControllerComponent> character_query = {};
+  flecs::query<> transform_query = {};
+  flecs::query<const MeshComponent> mesh_query = {};
+
   std::vector<std::function<void(Scene* scene)>> deferred_functions_ = {};
 
   // Lua. Owned per scene, not borrowed from the asset: a shared instance means two scenes share one environment.
   ankerl::unordered_dense::map<UUID, std::unique_ptr<LuaSystem>> lua_systems = {};
+  // Gathered every update, kept to reuse its allocation.
+  std::vector<LuaParallelScript*> parallel_lua_scripts = {};
 
   // Renderer
   std::unique_ptr<RendererInstance> renderer_instance = nullptr;
@@ -236,14 +271,25 @@ private:
   // Physics
   std::shared_mutex physics_mutex = {};
   std::unique_ptr<JPH::PhysicsSystem> physics_system = nullptr;
+  PhysicsCapacity physics_capacity = {};
+  RigidBodySync rigidbody_sync = {};
   std::unique_ptr<PhysicsDebugRenderer> physics_debug_renderer = nullptr;
   std::unique_ptr<Physics3DContactListener> contact_listener_3d = nullptr;
   std::unique_ptr<Physics3DBodyActivationListener> body_activation_listener_3d = nullptr;
+  std::vector<ContactEvent> contacts = {};
   JPH::BodyID terrain_body_id = {};
+  // The `JPH::HeightFieldShape` of `terrain_body_id`, kept to set heights on.
+  JPH::Ref<JPH::Shape> terrain_shape = nullptr;
 
   auto add_transform(this Scene& self, flecs::entity entity) -> GPU::TransformID;
   auto remove_transform(this Scene& self, flecs::entity entity) -> void;
 
+  auto update_spatial_proxy(this Scene& self, flecs::entity entity, const AABB& aabb) -> void;
+  // Marks transforms written in place as modified, so observers, change detection and replication
+  // see them like any other set.
+  auto refresh_transforms(this Scene& self, std::span<const flecs::entity> entities) -> void;
+  auto remove_spatial_proxy(this Scene& self, flecs::entity entity) -> void;
+
   struct MeshSpawnInfo {
     usize mesh_index = 0;
     flecs::entity parent = {};
@@ -258,6 +304,7 @@ private:
     -> MeshSpawnInfo;
   auto spawn_model_mesh_entity(this Scene& self, const UUID& model_uuid, const MeshSpawnInfo& info) -> void;
   auto update_pending_model_spawns(this Scene& self) -> void;
+  auto update_pending_mesh_colliders(this Scene& self) -> void;
 
   auto bake_terrain(this Scene& self) -> void;
 
@@ -228,7 +228,13 @@ struct CullCamera {
   u32 mesh_instance_count = {};
 };
 
-constexpr static u32 MAX_LIGHTS = 256;
+// Froxel grid for clustered light culling: screen tiles by exponential depth slices between the
+// camera clip planes. Must match defines.slang.
+constexpr static u32 LIGHT_CLUSTER_X = 16;
+constexpr static u32 LIGHT_CLUSTER_Y = 9;
+constexpr static u32 LIGHT_CLUSTER_Z = 24;
+constexpr static u32 LIGHT_CLUSTER_COUNT = LIGHT_CLUSTER_X * LIGHT_CLUSTER_Y * LIGHT_CLUSTER_Z;
+constexpr static u32 MAX_LIGHTS_PER_CLUSTER = 64;
 
 struct DirectionalLight {
   alignas(4) glm::vec3 color = {0.02, 0.02, 0.02};
@@ -505,6 +511,89 @@ struct SpriteGPUData {
   }
 };
 
+// One billboard per particle, streamed per instance. Mirrors `VertexInput` in 2d_particle.slang.
+struct ParticleInstance {
+  alignas(4) glm::vec3 position = {};
+  alignas(4) glm::vec2 size = {};
+  alignas(4) u32 color = 0; // packUnorm4x8
+  alignas(4) glm::vec4 rotation = {0.f, 0.f, 0.f, 1.f}; // xyzw
+};
+static_assert(sizeof(ParticleInstance) == 40);
+
+struct ParticleBatch {
+  u32 material_index = 0;
+  u32 offset = 0;
+  u32 count = 0;
+};
+
+struct ParticleState {
+  alignas(4) glm::vec3 position = {};
+  alignas(4) f32 life = 0.f;
+  alignas(4) glm::vec3 velocity = {};
+  alignas(4) u32 pad = 0;
+};
+
+struct ParticleCounters {
+  alignas(4) u32 vertex_count = 6;
+  alignas(4) u32 instance_count = 0;
+  alignas(4) u32 first_vertex = 0;
+  alignas(4) u32 first_instance = 0;
+  alignas(4) u32 alive_count[2] = {};
+  alignas(4) u32 dead_count = 0;
+  alignas(4) u32 emit_count = 0;
+  alignas(4) u32 emit_base = 0;
+  alignas(4) u32 pad[3] = {};
+};
+
+enum class ParticleEmitterFlags : u32 {
+  None = 0,
+  RotationOverLifetime = 1 << 0,
+  RotationBySpeed = 1 << 1,
+};
+consteval void enable_bitmask(ParticleEmitterFlags);
+
+// Curves are baked into `base + slope * factor`, see ParticlePool for the CPU equivalent.
+struct ParticleEmitterParams {
+  alignas(4) glm::vec3 origin = {};
+  alignas(4) f32 delta_time = 0.f;
+  alignas(4) glm::vec3 position_start = {};
+  alignas(4) u32 emit_count = 0;
+  alignas(4) glm::vec3 position_end = {};
+  alignas(4) u32 capacity = 0;
+  alignas(4) glm::vec3 start_velocity = {};
+  alignas(4) f32 start_lifetime = 0.f;
+  alignas(4) glm::vec4 start_color = {};
+  alignas(4) glm::vec4 start_rotation = {0.f, 0.f, 0.f, 1.f}; // xyzw
+  alignas(4) glm::vec2 start_size = {};
+  alignas(4) f32 gravity = 0.f;
+  alignas(4) u32 seed = 0;
+  alignas(4) glm::vec3 velocity_base = {};
+  alignas(4) u32 parity = 0;
+  alignas(4) glm::vec3 velocity_slope = {};
+  alignas(4) ParticleEmitterFlags flags = ParticleEmitterFlags::None;
+  alignas(4) glm::vec3 force_base = {};
+  alignas(4) f32 color_speed_min = 0.f;
+  alignas(4) glm::vec3 force_slope = {};
+  alignas(4) f32 color_speed_inv_range = 0.f;
+  alignas(4) glm::vec4 color_time_base = {};
+  alignas(4) glm::vec4 color_time_slope = {};
+  alignas(4) glm::vec4 color_speed_base = {};
+  alignas(4) glm::vec4 color_speed_slope = {};
+  alignas(4) glm::vec2 size_time_base = {};
+  alignas(4) glm::vec2 size_time_slope = {};
+  alignas(4) glm::vec2 size_speed_base = {};
+  alignas(4) glm::vec2 size_speed_slope = {};
+  alignas(4) f32 size_speed_min = 0.f;
+  alignas(4) f32 size_speed_inv_range = 0.f;
+  alignas(4) f32 rotation_speed_min = 0.f;
+  alignas(4) f32 rotation_speed_inv_range = 0.f;
+  alignas(4) glm::vec4 rotation_time_start = {};
+  alignas(4) glm::vec4 rotation_time_end = {};
+  alignas(4) glm::vec4 rotation_speed_start = {};
+  alignas(4) glm::vec4 rotation_speed_end = {};
+};
+static_assert(sizeof(ParticleEmitterParams) == 352);
+
 struct RenderQueue2D {
   std::vector<DrawBatch2D> batches = {};
   std::vector<SpriteGPUData> sprite_data = {};
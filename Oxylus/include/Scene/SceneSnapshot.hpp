@@ -1,7 +1,8 @@
 #pragma once
 
-#include <ankerl/unordered_dense.h>
+#include <array>
 #include <flecs.h>
+#include <span>
 #include <vector>
 
 #include "Core/Option.hpp"
@@ -11,38 +12,85 @@ namespace ox {
 struct ComponentState {
   flecs::id_t id = 0;
   u64 hash = 0; // u64_max indicates that this one is a tag
-  // TODO: we should probably replace this vector with something pre-allocated
-  std::vector<u8> buffer = {};
+  // Bytes in `SceneState::data`, tags have none.
+  u32 offset = 0;
+  u32 size = 0;
 };
 
 struct EntityState {
   flecs::entity_t entity_id = 0;
-  ankerl::unordered_dense::map<flecs::id_t, ComponentState> components = {};
-  ankerl::unordered_dense::set<flecs::id_t> removed_components = {};
+  // Range in `SceneState::components`, sorted by component id.
+  u32 first_component = 0;
+  u32 component_count = 0;
 };
 
+struct RemovedComponent {
+  flecs::entity_t entity_id = 0;
+  flecs::id_t id = 0;
+
+  auto operator<=>(const RemovedComponent&) const = default;
+};
+
+// Flat snapshot of the networked part of a world. Entities are sorted by id and each one owns a
+// range of `components`, whose bytes all live in `data`. Clearing or copying over a state keeps the
+// capacity of its vectors, so states that are reused don't allocate once they've grown.
 struct SceneState {
-  ankerl::unordered_dense::map<flecs::entity_t, EntityState> entities = {};
-  ankerl::unordered_dense::set<flecs::entity_t> removed_entities = {};
+  std::vector<EntityState> entities = {};
+  std::vector<ComponentState> components = {};
+  std::vector<u8> data = {};
+  // Both sorted.
+  std::vector<flecs::entity_t> removed_entities = {};
+  std::vector<RemovedComponent> removed_components = {};
 
   auto clear() -> void {
     entities.clear();
+    components.clear();
+    data.clear();
     removed_entities.clear();
+    removed_components.clear();
   }
+
+  auto find(this const SceneState&, flecs::entity_t entity_id) -> const EntityState*;
+  auto contains(this const SceneState& self, flecs::entity_t entity_id) -> bool { return self.find(entity_id); }
+  auto components_of(this const SceneState&, const EntityState& entity) -> std::span<const ComponentState>;
+  auto find_component(this const SceneState&, const EntityState& entity, flecs::id_t id) -> const ComponentState*;
+  auto bytes_of(this const SceneState&, const ComponentState& component) -> std::span<const u8>;
+  auto was_removed(this const SceneState&, flecs::entity_t entity_id) -> bool;
+  auto was_removed(this const SceneState&, flecs::entity_t entity_id, flecs::id_t id) -> bool;
+
+  // Entities have to be pushed in increasing id order, components of an entity in increasing id
+  // order after it.
+  auto push_entity(this SceneState&, flecs::entity_t entity_id) -> void;
+  auto push_component(this SceneState&, flecs::id_t id, u64 hash, std::span<const u8> bytes) -> void;
+  // Copies `entity` and its components over from `from`.
+  auto push_entity(this SceneState&, const SceneState& from, const EntityState& entity) -> void;
+
+  // Whether every range is in bounds and everything is sorted, for states that came off the wire.
+  auto is_valid(this const SceneState&) -> bool;
 };
 
+// Ring of the last `MAX_SEQUENCES` snapshots. Sequences wrap at 256, a slot only answers `find` for
+// the sequence it currently holds, so a baseline that has been overwritten is never mistaken for a
+// newer one.
 struct SceneSnapshotBuilder {
   constexpr static auto MAX_SEQUENCES = 32_u8;
   std::array<SceneState, MAX_SEQUENCES> states = {};
-  std::array<bool, MAX_SEQUENCES> acks = {};
+  std::array<u8, MAX_SEQUENCES> sequences = {};
+  // Only slot 0 starts out valid, it holds the still empty state of sequence 0.
+  std::array<bool, MAX_SEQUENCES> valid = {true, false};
   u8 current_sequence = 0;
 
-  auto current() -> SceneState& { return states[current_sequence]; }
-  auto ack(u8 seq) -> void { acks[seq % MAX_SEQUENCES] = true; }
-  auto set_current(this SceneSnapshotBuilder&, SceneState& new_state) -> void;
+  auto current() -> SceneState& { return states[current_sequence % MAX_SEQUENCES]; }
+  auto find(this SceneSnapshotBuilder&, u8 sequence) -> SceneState*;
+  // Keeps a snapshot around as a baseline for later deltas, copying into the slot reuses its memory.
+  auto store(this SceneSnapshotBuilder&, u8 sequence, const SceneState& state) -> void;
+  // Empty slot for `sequence` to be filled in place, it only answers `find` once passed to `store`.
+  auto claim(this SceneSnapshotBuilder&, u8 sequence) -> SceneState&;
   auto advance(this SceneSnapshotBuilder&) -> void;
-  auto find_last_acked(this SceneSnapshotBuilder& self) -> option<u8>;
-  auto delta(this SceneSnapshotBuilder& self) -> SceneState;
+  // Whole component delta from `baseline` to the current state, everything when there is no baseline.
+  auto delta(this SceneSnapshotBuilder& self, const SceneState* baseline) -> SceneState;
+  // Reads every networked component of `world` into `state`. Use `SnapshotCapture` to capture every
+  // tick, this builds its queries from scratch on each call.
   static auto take_snapshot(flecs::world& world, SceneState& state) -> void;
 };
 } // namespace ox
@@ -0,0 +1,62 @@
+#pragma once
+
+#include <ankerl/unordered_dense.h>
+#include <flecs.h>
+#include <vector>
+
+#include "Core/Types.hpp"
+#include "Scene/SceneSnapshot.hpp"
+
+namespace ox {
+// Captures the networked components of a world table by table, copying each column straight into
+// the flat arrays of a `SceneState`. Tables none of whose networked columns were written since the
+// last capture are copied over from the previous state in one go instead of being read and hashed
+// again, so writes have to be flagged the usual flecs way (`set`, `modified`, systems with write
+// access) to be picked up.
+struct SnapshotCapture {
+  struct NetworkedComponent {
+    flecs::id_t id = 0;
+    // 0 for tags.
+    u32 size = 0;
+    flecs::query<> query = {};
+  };
+
+  // Where a table landed in the last capture.
+  struct TableCapture {
+    u32 first_component = 0;
+    u32 component_count = 0;
+    u32 data_offset = 0;
+    u32 data_size = 0;
+    std::vector<flecs::entity_t> entities = {};
+    bool changed = false;
+    bool seen = false;
+  };
+
+  // Captures into the current slot of `snapshots`, reusing the last capture if it is still in there.
+  auto capture(this SnapshotCapture&, flecs::world& world, SceneSnapshotBuilder& snapshots) -> void;
+  // `previous` has to be what this capture wrote last, or nullptr to read everything.
+  auto capture(this SnapshotCapture&, flecs::world& world, const SceneState* previous, SceneState& out) -> void;
+
+private:
+  struct Column {
+    flecs::id_t id = 0;
+    u32 size = 0;
+    // Within an entity's bytes.
+    u32 offset = 0;
+    const u8* data = nullptr;
+  };
+
+  auto refresh_components(this SnapshotCapture&, flecs::world& world) -> void;
+
+  const flecs::world_t* world_handle = nullptr;
+  flecs::query<> networked_query = {};
+  std::vector<NetworkedComponent> components = {};
+  ankerl::unordered_dense::map<ecs_table_t*, TableCapture> tables = {};
+  // Tables in the order they were first matched this capture.
+  std::vector<ecs_table_t*> table_order = {};
+  std::vector<flecs::id_t> networked_ids = {};
+  std::vector<Column> columns = {};
+  bool has_last_sequence = false;
+  u8 last_sequence = 0;
+};
+} // namespace ox
@@ -0,0 +1,64 @@
+#pragma once
+
+#include <ankerl/unordered_dense.h>
+#include <flecs.h>
+#include <span>
+#include <vector>
+
+#include "Core/Types.hpp"
+#include "Scene/SceneSnapshot.hpp"
+
+namespace ox {
+struct SnapshotQuantization {
+  bool enabled = true;
+  // Step size of quantized f32 fields. Values within +-2^24 steps travel as a step count, values
+  // beyond that (+-16384 at the default) as the f32 itself with its lowest mantissa bit dropped.
+  f32 float_precision = 1.0f / 1024.0f;
+  // Step size of quaternion components, rotations are sent with w >= 0.
+  f32 quat_precision = 1.0f / 32767.0f;
+};
+
+// How a networked component is split into 32 bit words on the wire, built from its flecs reflection
+// data. Anything that isn't an f32 or a `glm::quat` travels as raw 4 byte chunks.
+struct SnapshotComponentLayout {
+  enum class FieldKind : u8 {
+    Raw = 0,
+    F32,
+    Quat,
+  };
+
+  struct Field {
+    FieldKind kind = FieldKind::Raw;
+    u32 offset = 0;
+    u32 size = 0;
+  };
+
+  flecs::id_t id = 0;
+  u32 size = 0;
+  u32 word_count = 0;
+  std::vector<Field> fields = {};
+};
+
+// Encodes a `SceneState` as a delta against a baseline the receiver already has. Components are
+// turned into words, XORed with the baseline's words, and the result is written as runs of zero
+// words followed by varint literals, so an untouched field costs nothing and a small move costs a
+// byte or two. Both ends have to use the same quantization settings.
+struct SnapshotCodec {
+  constexpr static u32 MAX_COMPONENT_SIZE = 64 * 1024;
+
+  SnapshotQuantization quantization = {};
+  ankerl::unordered_dense::map<flecs::id_t, SnapshotComponentLayout> layouts = {};
+
+  // Builds layouts for every component tagged `Networked`.
+  static auto from_world(flecs::world& world, const SnapshotQuantization& quantization = {}) -> SnapshotCodec;
+  auto add_component(this SnapshotCodec&, flecs::world& world, flecs::entity component) -> void;
+
+  // Appends the delta from `baseline` to `current` to `out`, nullptr baseline sends everything.
+  auto encode(this const SnapshotCodec&, const SceneState* baseline, const SceneState& current, std::vector<u8>& out)
+    -> bool;
+  // Rebuilds the full state into `out`. Entities and components this delta removed are also listed
+  // in the `removed_*` lists of `out`.
+  auto decode(this const SnapshotCodec&, const SceneState* baseline, std::span<const u8> payload, SceneState& out)
+    -> bool;
+};
+} // namespace ox
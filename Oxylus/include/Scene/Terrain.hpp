@@ -4,6 +4,7 @@
 #include <vector>
 
 #include "Asset/TerrainEdits.hpp"
+#include "Core/Option.hpp"
 #include "Asset/Texture.hpp"
 #include "Scene/SceneGPU.hpp"
 
@@ -19,6 +20,35 @@ constexpr u32 TERRAIN_COLLISION_MAX_SAMPLES = 4096;
 // Rounds a requested collider resolution to a sample count Jolt accepts.
 auto terrain_collision_sample_count(u32 requested) -> u32;
 
+// A rectangle of texels or samples, `min` inclusive and `max` exclusive.
+struct TerrainRect {
+  glm::uvec2 min = {};
+  glm::uvec2 max = {};
+
+  auto is_empty(this const TerrainRect& self) -> bool { return self.max.x <= self.min.x || self.max.y <= self.min.y; }
+  auto size(this const TerrainRect& self) -> glm::uvec2 {
+    return self.is_empty() ? glm::uvec2(0) : self.max - self.min;
+  }
+
+  auto merged(this const TerrainRect& self, const TerrainRect& other) -> TerrainRect {
+    if (self.is_empty()) {
+      return other;
+    }
+    if (other.is_empty()) {
+      return self;
+    }
+    return {.min = glm::min(self.min, other.min), .max = glm::max(self.max, other.max)};
+  }
+};
+
+// The collision samples that read any of `texels` of a `map_size` heightmap, grown out to whole Jolt
+// blocks so `HeightFieldShape::SetHeights` takes them as they are.
+auto terrain_collision_samples_for_texels(const TerrainRect& texels, glm::uvec2 map_size, u32 sample_count)
+  -> TerrainRect;
+// The heightmap texels the bilinear resample of `samples` reads.
+auto terrain_collision_texels_for_samples(const TerrainRect& samples, glm::uvec2 map_size, u32 sample_count)
+  -> TerrainRect;
+
 struct TerrainMaps {
   vuk::Value<vuk::ImageAttachment> heightmap = {};
   vuk::Value<vuk::ImageAttachment> ridgemap = {};
@@ -95,7 +125,11 @@ struct Terrain {
   // World-space heights in row major order, `collision_sample_count` per side.
   std::vector<f32> collision_heights = {};
   u32 collision_sample_count = 0;
+  // The whole collider has to be rebuilt.
   bool collision_dirty = true;
+  // Heightmap texels brush strokes changed since the collider last caught up, patched in place
+  // when `collision_dirty` is not set.
+  TerrainRect collision_dirty_texels = {};
 
   auto create(this Terrain& self) -> std::expected<void, std::string>;
   auto destroy(this Terrain& self) -> void;
@@ -105,6 +139,18 @@ struct Terrain {
   auto clone_edits_from(this Terrain& self, const Terrain& src, RenderContext& render_context) -> void;
 
   auto download_collision_heights(this Terrain& self, RenderContext& render_context) -> void;
+  // Reads back only the texels under `collision_dirty_texels` and resamples the collision heights
+  // they feed. Returns the samples that changed, empty when there was nothing to do.
+  auto download_collision_region(this Terrain& self, RenderContext& render_context) -> TerrainRect;
+
+  // Called for every frame a brush stroke paints. Finds where the stroke lands on the collision
+  // heights and grows `collision_dirty_texels` by its footprint, or asks for a full rebuild when
+  // there are no heights to find it on or it misses them.
+  auto mark_brush_collision_dirty(this Terrain& self) -> void;
+  // First point along the ray below the collision heights.
+  auto raycast_collision_heights(this const Terrain& self, const glm::vec3& origin, const glm::vec3& direction)
+    -> option<glm::vec3>;
+  auto collision_height_at(this const Terrain& self, glm::vec2 world_xz) -> f32;
 
   auto download_edits(this const Terrain& self, RenderContext& render_context) -> TerrainEdits;
 
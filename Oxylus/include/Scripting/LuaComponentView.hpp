@@ -0,0 +1,200 @@
+#pragma once
+
+#include <ankerl/unordered_dense.h>
+#include <array>
+#include <flecs.h>
+#include <memory>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "Core/Option.hpp"
+#include "Core/Types.hpp"
+
+namespace sol {
+class state;
+}
+
+namespace ox {
+enum class LuaFieldKind : u8 {
+  Bool = 0,
+  Char,
+  U8,
+  U16,
+  U32,
+  U64,
+  I8,
+  I16,
+  I32,
+  I64,
+  F32,
+  F64,
+  Entity,
+  CString,
+  String,
+  UUID,
+  Vec2,
+  IVec2,
+  Vec3,
+  Vec4,
+  Quat,
+  // Any other struct, read as a view of its own.
+  Struct,
+};
+
+class LuaCommandBuffer;
+struct LuaColumnView;
+struct LuaComponentLayout;
+struct LuaComponentView;
+
+struct LuaComponentField {
+  std::string name = {};
+  LuaFieldKind kind = LuaFieldKind::F32;
+  u32 offset = 0;
+  const LuaComponentLayout* nested = nullptr;
+};
+
+// Where the fields of a component type live, taken from its flecs meta ops.
+struct LuaComponentLayout {
+  std::vector<LuaComponentField> fields = {};
+
+  auto find(this const LuaComponentLayout& self, std::string_view name) -> const LuaComponentField*;
+};
+
+// Layouts are built the first time a script touches a type and kept until its world is gone, since
+// component ids, and the meta behind them, are only meaningful within one world.
+class LuaComponentLayouts : public std::enable_shared_from_this<LuaComponentLayouts> {
+public:
+  // Set for the VMs of `LuaWorkerPool`: views and columns handed out stage their writes here instead
+  // of writing the storage.
+  LuaCommandBuffer* commands = nullptr;
+
+  auto get(this LuaComponentLayouts& self, ecs_world_t* world, flecs::entity_t type) -> const LuaComponentLayout*;
+  // Starts caching for `world`, which hooks its teardown. Worker VMs have this done ahead of time, as
+  // they must not touch the world themselves.
+  auto track(this LuaComponentLayouts& self, const ecs_world_t* world) -> void;
+  auto forget(this LuaComponentLayouts& self, const ecs_world_t* world) -> void;
+
+  auto view(this LuaComponentLayouts& self, flecs::entity entity, flecs::entity_t component, bool is_mutable)
+    -> LuaComponentView;
+  // One field of `component` over the iterator's current table, unless the query has no such term or
+  // the field is a nested struct.
+  auto column(this LuaComponentLayouts& self, ecs_iter_t* it, flecs::entity_t component, std::string_view field)
+    -> option<LuaColumnView>;
+  // Called whenever an iterator lent to a script moves on or its callback returns. Every column
+  // handed out until then refuses further access.
+  auto expire_columns(this LuaComponentLayouts& self) -> void { self.column_generation += 1; }
+  auto get_column_generation(this const LuaComponentLayouts& self) -> u64 { return self.column_generation; }
+
+private:
+  using WorldLayouts = ankerl::unordered_dense::map<flecs::entity_t, std::unique_ptr<LuaComponentLayout>>;
+  ankerl::unordered_dense::map<const ecs_world_t*, WorldLayouts> worlds = {};
+  u64 column_generation = 0;
+
+  auto world_layouts(this LuaComponentLayouts& self, const ecs_world_t* world) -> WorldLayouts&;
+  auto collect_fields(
+    this LuaComponentLayouts& self,
+    ecs_world_t* world,
+    const flecs::meta::op_t* ops,
+    i32 op_count,
+    LuaComponentLayout& layout
+  ) -> void;
+};
+
+// A script's handle on one component of one entity. Fields are read from and written to the entity's
+// storage on every access, nothing is copied into Lua, and writes to a mutable view mark the component
+// modified so observers and change detection see them. With a command buffer, writes are staged
+// there instead and reads keep seeing the storage as it was.
+struct LuaComponentView {
+  // Can be a stage, so writes from systems are deferred like any other.
+  ecs_world_t* world = nullptr;
+  flecs::entity_t entity = 0;
+  flecs::entity_t component = 0;
+  // Nested struct views share the component, this is where their struct starts in it.
+  u32 offset = 0;
+  const LuaComponentLayout* layout = nullptr;
+  bool is_mutable = false;
+  LuaCommandBuffer* commands = nullptr;
+
+  auto resolve(this const LuaComponentView& self) -> u8*;
+};
+
+// One field of one component across every entity of the table a query iterator is on, so a script
+// pays for crossing into C++ per table instead of per entity. Writes go straight into the column, the
+// same as a C++ system writing through `ecs_field`, so they count for the query's change detection
+// but raise no per-entity `modified`. Staged writes are applied like a view's. Only valid until the
+// iterator moves on to the next table: a script holding on to one past that reads nil and its writes
+// are dropped.
+struct LuaColumnView {
+  ecs_world_t* world = nullptr;
+  // The field of the first entity, the others follow `stride` bytes apart.
+  u8* data = nullptr;
+  // 0 for terms matched on another entity, like a parent or a singleton: every row sees the same one.
+  u32 stride = 0;
+  u32 count = 0;
+  LuaFieldKind kind = LuaFieldKind::F32;
+  bool is_mutable = false;
+
+  // What staged writes need to find the element again once the table is gone.
+  LuaCommandBuffer* commands = nullptr;
+  const flecs::entity_t* entities = nullptr;
+  flecs::entity_t component = 0;
+  u32 offset = 0;
+
+  // Checked on every access, as the column is an ordinary copyable value on the Lua side.
+  const LuaComponentLayouts* layouts = nullptr;
+  u64 generation = 0;
+
+  auto at(this const LuaColumnView& self, u32 index) -> u8* { return self.data + index * self.stride; }
+  auto is_live(this const LuaColumnView& self) -> bool {
+    return self.layouts != nullptr && self.layouts->get_column_generation() == self.generation;
+  }
+};
+
+// Field writes made by scripts running off the main thread while the world is read only, applied on
+// the main thread afterwards in the order they were made.
+class LuaCommandBuffer {
+public:
+  constexpr static u32 MAX_VALUE_SIZE = 16;
+
+  auto record(
+    this LuaCommandBuffer& self,
+    flecs::entity_t entity,
+    flecs::entity_t component,
+    u32 offset,
+    std::span<const u8> value
+  ) -> void;
+  // Writes to entities that are gone or lost the component are dropped. Each component written to
+  // raises `modified` once, after all writes are in.
+  auto apply(this LuaCommandBuffer& self, ecs_world_t* world) -> void;
+  auto clear(this LuaCommandBuffer& self) -> void { self.writes.clear(); }
+  auto size(this const LuaCommandBuffer& self) -> usize { return self.writes.size(); }
+
+private:
+  struct FieldWrite {
+    flecs::entity_t entity = 0;
+    flecs::entity_t component = 0;
+    u32 offset = 0;
+    u32 size = 0;
+    std::array<u8, MAX_VALUE_SIZE> value = {};
+  };
+
+  using Modified = std::pair<flecs::entity_t, flecs::entity_t>;
+  struct ModifiedHash {
+    using is_avalanching = void;
+    auto operator()(const Modified& key) const noexcept -> u64 {
+      return ankerl::unordered_dense::detail::wyhash::hash(&key, sizeof(Modified));
+    }
+  };
+
+  std::vector<FieldWrite> writes = {};
+  // Entity and component pairs written to, in the order of their first write.
+  std::vector<Modified> modified = {};
+  ankerl::unordered_dense::set<Modified, ModifiedHash> seen = {};
+};
+
+// Registers the `LuaComponentView` and `LuaColumnView` usertypes. Component views come from
+// `entity:get/get_mut/ensure` and `it:field`, column views from `it:column`.
+auto bind_component_views(sol::state* state) -> void;
+} // namespace ox
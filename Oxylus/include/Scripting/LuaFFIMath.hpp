@@ -0,0 +1,80 @@
+#pragma once
+
+// With the `luajit` option vec3, quat and mat4 reach scripts as FFI structs laid out like their glm
+// counterparts instead of sol usertypes, so script math is compiled into traces rather than boxed
+// into a userdata per result. The customization points below let every binding keep taking and
+// returning the glm types by value. Force-included by the build so sol sees them before anything
+// else instantiates its stack functions.
+//
+// Being values, they are always copied into Lua. A usertype member bound by pointer would hand
+// scripts a reference on Lua 5.4 but a copy here, so members of these types are bound as
+// properties, read and written whole on both backends.
+#ifdef OX_LUAJIT
+  #include <glm/ext/matrix_float4x4.hpp>
+  #include <glm/ext/quaternion_float.hpp>
+  #include <glm/ext/vector_float3.hpp>
+  #include <lua.hpp>
+  #include <type_traits>
+
+namespace sol {
+class state;
+enum class type : int;
+template <typename... Args>
+struct types;
+} // namespace sol
+
+namespace ox::ffi_math {
+enum class Kind : int { Vec3 = 0, Quat, Mat4 };
+
+template <typename T>
+constexpr auto kind_of() -> Kind {
+  if constexpr (std::is_same_v<T, glm::vec3>) {
+    return Kind::Vec3;
+  } else if constexpr (std::is_same_v<T, glm::quat>) {
+    return Kind::Quat;
+  } else {
+    return Kind::Mat4;
+  }
+}
+
+template <typename T>
+concept FFIMathType = std::is_same_v<T, glm::vec3> || std::is_same_v<T, glm::quat> || std::is_same_v<T, glm::mat4>;
+
+// Whether the value at `index` is a cdata of `kind`.
+auto is(lua_State* L, int index, Kind kind) -> bool;
+auto read(lua_State* L, int index, void* value, size_t size) -> void;
+auto push(lua_State* L, Kind kind, const void* value, size_t size) -> int;
+
+// Defines the structs and their metatypes and sets the `vec3`, `quat` and `mat4` globals.
+auto bind(sol::state* state) -> void;
+} // namespace ox::ffi_math
+
+template <ox::ffi_math::FFIMathType T, typename Handler, typename Record>
+auto sol_lua_check(sol::types<T>, lua_State* L, int index, Handler&& handler, Record& tracking) -> bool {
+  tracking.use(1);
+  if (ox::ffi_math::is(L, index, ox::ffi_math::kind_of<T>())) {
+    return true;
+  }
+  handler(
+    L,
+    index,
+    static_cast<sol::type>(LUA_TUSERDATA),
+    static_cast<sol::type>(lua_type(L, index)),
+    "expected a vec3, quat or mat4 cdata"
+  );
+  return false;
+}
+
+template <ox::ffi_math::FFIMathType T, typename Record>
+auto sol_lua_get(sol::types<T>, lua_State* L, int index, Record& tracking) -> T {
+  tracking.use(1);
+  auto value = T{};
+  ox::ffi_math::read(L, index, &value, sizeof(T));
+  return value;
+}
+
+template <ox::ffi_math::FFIMathType T>
+auto sol_lua_push(sol::types<T>, lua_State* L, const T& value) -> int {
+  return ox::ffi_math::push(L, ox::ffi_math::kind_of<T>(), &value, sizeof(T));
+}
+#endif
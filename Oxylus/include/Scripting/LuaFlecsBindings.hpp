@@ -1,10 +1,21 @@
 #pragma once
 
+#include <memory>
+
 #include "Scripting/LuaBinding.hpp"
+#include "Scripting/LuaComponentView.hpp"
 
 namespace ox {
 class FlecsBinding : public LuaBinding {
 public:
   auto bind(sol::state* state) -> void override;
+
+  auto get_layouts(this const FlecsBinding& self) -> const std::shared_ptr<LuaComponentLayouts>& {
+    return self.layouts;
+  }
+
+private:
+  // Shared with the closures handed to Lua, which can outlive the binding.
+  std::shared_ptr<LuaComponentLayouts> layouts = std::make_shared<LuaComponentLayouts>();
 };
 } // namespace ox
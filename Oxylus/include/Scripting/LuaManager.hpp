@@ -5,6 +5,7 @@
 #include <sol/state.hpp>
 
 #include "Scripting/LuaBinding.hpp"
+#include "Scripting/LuaWorkerPool.hpp"
 
 namespace ox {
 class LuaManager {
@@ -15,6 +16,8 @@ public:
   auto deinit(this LuaManager& self) -> std::expected<void, std::string>;
 
   auto get_state(this const LuaManager& self) -> sol::state* { return self.state.get(); }
+  // A VM per job manager worker for scripts that declare `parallel`.
+  auto get_workers(this LuaManager& self) -> LuaWorkerPool& { return self.workers; }
 
   template <typename T>
   void bind(this LuaManager& self, const std::string& name, sol::state* state) {
@@ -33,8 +36,9 @@ public:
 private:
   ankerl::unordered_dense::map<std::string, std::unique_ptr<LuaBinding>> bindings = {};
   std::unique_ptr<sol::state> state = nullptr;
+  LuaWorkerPool workers = {};
 
-  auto bind_log(this const LuaManager& self) -> void;
-  auto bind_vector(this const LuaManager& self) -> void;
+  static auto bind_log(sol::state* state) -> void;
+  static auto bind_vector(sol::state* state) -> void;
 };
 } // namespace ox
@@ -9,17 +9,16 @@
 #include "Core/Option.hpp"
 #include "Core/Types.hpp"
 #include "Scripting/LuaScript.hpp"
+#include "Scripting/LuaWorkerPool.hpp"
 
 namespace JPH {
-class ContactSettings;
-class ContactManifold;
 class Body;
 class BodyID;
-class SubShapeIDPair;
 } // namespace JPH
 
 namespace ox {
 class Scene;
+struct ContactEvent;
 
 // One scene's live instance of a LuaScript: its own environment and its own resolved callbacks. Never share one
 // between scenes, that is what makes two scenes fight over the script's state.
@@ -45,29 +44,35 @@ public:
   auto on_scene_fixed_update(this const LuaSystem& self, Scene* scene, f32 delta_time) -> void;
   auto on_scene_render(this const LuaSystem& self, Scene* scene, vuk::Extent3D extent) -> void;
 
+  // Contacts arrive in one batch after each physics step, on the thread that runs the scene. Bodies
+  // are null once they are gone.
   auto on_contact_added(
     this const LuaSystem& self,
     Scene* scene,
-    const JPH::Body& body1,
-    const JPH::Body& body2,
-    const JPH::ContactManifold& manifold,
-    const JPH::ContactSettings& settings
+    const JPH::Body* body1,
+    const JPH::Body* body2,
+    const ContactEvent& contact
   ) -> void;
   auto on_contact_persisted(
     this const LuaSystem& self,
     Scene* scene,
-    const JPH::Body& body1,
-    const JPH::Body& body2,
-    const JPH::ContactManifold& manifold,
-    const JPH::ContactSettings& settings
+    const JPH::Body* body1,
+    const JPH::Body* body2,
+    const ContactEvent& contact
   ) -> void;
-  auto on_contact_removed(this const LuaSystem& self, Scene* scene, const JPH::SubShapeIDPair& sub_shape_pair) -> void;
+  auto on_contact_removed(this const LuaSystem& self, Scene* scene, const ContactEvent& contact) -> void;
+  auto has_contact_callbacks(this const LuaSystem& self) -> bool;
+  // Scripts that called `subscribe_contacts(entity)` only get contacts involving one of those entities,
+  // the rest get all of them.
+  auto wants_contact(this const LuaSystem& self, const ContactEvent& contact) -> bool;
   auto on_body_activated(this const LuaSystem& self, Scene* scene, const JPH::BodyID& body_id, u64 body_user_data)
     -> void;
   auto on_body_deactivated(this const LuaSystem& self, Scene* scene, const JPH::BodyID& body_id, u64 body_user_data)
     -> void;
 
   auto get_path() const -> const std::filesystem::path& { return file_path; }
+  // The script's copies in the worker VMs, if it declared `parallel`.
+  auto get_parallel(this const LuaSystem& self) -> LuaParallelScript* { return self.parallel.get(); }
 
 private:
   std::filesystem::path file_path = {};
@@ -91,6 +96,10 @@ private:
   std::unique_ptr<sol::protected_function> on_body_activated_func = nullptr;
   std::unique_ptr<sol::protected_function> on_body_deactivated_func = nullptr;
 
+  ankerl::unordered_dense::set<u64> contact_entities = {};
+
+  std::unique_ptr<LuaParallelScript> parallel = nullptr;
+
   void init_script(
     this LuaSystem& self, const std::filesystem::path& path, const ox::option<std::string> script = nullopt
   );
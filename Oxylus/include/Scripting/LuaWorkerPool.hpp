@@ -0,0 +1,102 @@
+#pragma once
+
+#include <filesystem>
+#include <flecs.h>
+#include <functional>
+#include <memory>
+#include <sol/environment.hpp>
+#include <sol/protected_function.hpp>
+#include <sol/state.hpp>
+#include <span>
+#include <vector>
+
+#include "Core/Option.hpp"
+#include "Core/Types.hpp"
+#include "Scripting/LuaBinding.hpp"
+#include "Scripting/LuaComponentView.hpp"
+
+namespace ox {
+class JobManager;
+
+// A Lua VM of its own for one slot of the pool, never used by two threads at once.
+struct LuaWorker {
+  std::unique_ptr<sol::state> state = nullptr;
+  std::vector<std::unique_ptr<LuaBinding>> bindings = {};
+  // Those of the VM's FlecsBinding, set up by whoever binds it.
+  std::shared_ptr<LuaComponentLayouts> layouts = nullptr;
+  // Component writes of this slot's scripts, applied once every slot is done.
+  LuaCommandBuffer commands = {};
+};
+
+enum class LuaParallelMode : u8 {
+  // `parallel = "pure"`: `on_parallel_update(world, dt)` runs once a frame on one of the VMs, `world`
+  // being that slot's stage.
+  Pure = 0,
+  // `parallel = "partitioned"`: `on_parallel_update(it, dt)` runs on every VM for its share of the
+  // entities matching `parallel_query`, once per table slice.
+  Partitioned,
+};
+
+// A script loaded into every VM of the pool, each copy with an environment of its own. Globals a copy
+// sets stay in its VM, so scripts can't rely on them carrying over between slots.
+struct LuaParallelScript {
+  LuaParallelMode mode = LuaParallelMode::Pure;
+  std::vector<flecs::entity_t> terms = {};
+  std::vector<sol::environment> environments = {};
+  std::vector<sol::protected_function> functions = {};
+
+  // Built for the world the script first runs against.
+  ecs_world_t* world = nullptr;
+  ecs_query_t* query = nullptr;
+
+  LuaParallelScript() = default;
+  ~LuaParallelScript();
+  LuaParallelScript(const LuaParallelScript&) = delete;
+  auto operator=(const LuaParallelScript&) -> LuaParallelScript& = delete;
+};
+
+// Runs scripts that declared `parallel` over the job manager, one VM per slot with the bindings
+// registered into each once up front.
+//
+// The world is read only while they run. Reads see it as the frame left it. Component writes go
+// into per-slot command buffers. Anything structural goes into per-slot flecs stages. Both are
+// merged on the calling thread in slot order, so the outcome only depends on the slot count and
+// not on which worker got to what first.
+class LuaWorkerPool {
+public:
+  using SetupFn = std::function<void(LuaWorker& worker)>;
+
+  auto init(this LuaWorkerPool& self, u32 slot_count, const SetupFn& setup) -> void;
+  auto reset(this LuaWorkerPool& self) -> void { self.workers.clear(); }
+  auto size(this const LuaWorkerPool& self) -> usize { return self.workers.size(); }
+  auto get_worker(this const LuaWorkerPool& self, usize index) -> LuaWorker& { return *self.workers[index]; }
+
+  // Component handles, tables with a `component_id`, are registered as globals of the main VM. The
+  // ones scripts look up by name are copied over to every slot.
+  auto mirror_components(this LuaWorkerPool& self, sol::state& main) -> void;
+
+  // Null unless the script declares a `parallel` mode and defines `on_parallel_update`.
+  auto load(this LuaWorkerPool& self, const std::filesystem::path& path, const option<std::string>& source)
+    -> std::unique_ptr<LuaParallelScript>;
+
+  // `job_manager` can be null to run every slot on the calling thread.
+  auto run(
+    this LuaWorkerPool& self,
+    flecs::world& world,
+    std::span<LuaParallelScript* const> scripts,
+    JobManager* job_manager,
+    f32 delta_time
+  ) -> void;
+
+private:
+  std::vector<std::unique_ptr<LuaWorker>> workers = {};
+
+  auto run_slot(
+    this LuaWorkerPool& self,
+    ecs_world_t* world,
+    u32 slot,
+    std::span<LuaParallelScript* const> scripts,
+    f32 delta_time
+  ) -> void;
+};
+} // namespace ox
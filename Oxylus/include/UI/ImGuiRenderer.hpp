@@ -15,6 +15,7 @@ class Input;
 class ImGuiRenderer {
 public:
   constexpr static auto MODULE_NAME = "ImGuiRenderer";
+  constexpr static auto SKIP_HEADLESS = true;
   using module_dependencies = std::tuple<Input, Renderer>;
 
   Texture font_texture = {};
@@ -20,6 +20,7 @@ class RmlView;
 class RmlUI {
 public:
   constexpr static auto MODULE_NAME = "RmlUI";
+  constexpr static auto SKIP_HEADLESS = true;
   using module_dependencies = std::tuple<Input, Renderer>;
 
   auto init(this RmlUI& self) -> std::expected<void, std::string>;
@@ -25,6 +25,8 @@ public:
   auto get_max_frame_time(this const Timestep& self) -> f64 { return self.max_frame_time; }
   auto set_max_frame_time(this Timestep& self, f64 value) -> void { self.max_frame_time = value; }
   auto reset_max_frame_time(this Timestep& self) -> void { self.max_frame_time = -1.0; }
+  // How long before the frame is due to stop sleeping and busy wait for it instead.
+  auto set_spin_threshold(this Timestep& self, f64 value) -> void { self.spin_threshold = value; }
 
   explicit operator float() const { return (float)timestep; }
 
@@ -33,6 +35,7 @@ private:
   f64 last_time = 0;
   f64 elapsed = 0;
   f64 max_frame_time = -1.0;
+  f64 spin_threshold = 1.0;
 
   Timer* timer = nullptr;
 };
@@ -9,6 +9,7 @@
 #include "Memory/Hasher.hpp"
 #include "Memory/Stack.hpp"
 #include "OS/File.hpp"
+#include "Render/Renderer.hpp"
 #include "Scripting/LuaScript.hpp"
 #include "Utils/Log.hpp"
 
@@ -813,6 +814,13 @@ auto AssetManager::load_asset_impl(
 
   asset.reset();
 
+  // Nothing to upload textures to without a renderer, a headless server goes without them. Models still
+  // load there, keeping only the geometry colliders are cooked from.
+  if (asset_type == AssetType::Texture && !App::has_mod<Renderer>()) {
+    OX_LOG_TRACE("Skipping {} without a renderer.", asset_path);
+    return false;
+  }
+
   auto asset_id = [&]() -> u64 {
     switch (asset_type) {
       case AssetType::Model: {
@@ -3,6 +3,7 @@
 #include <fastgltf/types.hpp>
 #include <glm/gtc/type_ptr.hpp>
 #include <glm/gtx/matrix_decompose.hpp>
+#include <limits>
 #include <meshoptimizer.h>
 #include <queue>
 #include <vuk/Types.hpp>
@@ -11,6 +12,7 @@
 #include "Asset/AssetManager.hpp"
 #include "Core/App.hpp"
 #include "Memory/Stack.hpp"
+#include "Render/Renderer.hpp"
 #include "Render/UploadBatch.hpp"
 
 template <>
@@ -457,6 +459,7 @@ auto register_gltf_materials(
 
 struct MeshBuildData {
   GPU::Mesh gpu_mesh = {};
+  Model::CollisionMesh collision_mesh = {};
   std::array<GPU::MeshLOD, GPU::Mesh::MAX_LODS> lods = {};
   std::vector<u8> blob = {};
   u64 lod_metadata_offset = 0;
@@ -764,12 +767,52 @@ auto build_gltf_mesh(const fastgltf::Asset& gltf_asset, const fastgltf::Primitiv
     return nullopt;
   }
 
+  build.collision_mesh = {.positions = std::move(positions), .indices = std::move(indices)};
   build.lod_metadata_offset = ox::align_up(build.blob.size(), 8);
   build.blob.resize(build.lod_metadata_offset + gpu_mesh.lod_count * sizeof(GPU::MeshLOD));
 
   return build;
 }
 
+// What a headless server keeps of a primitive: its triangles as stored, for cooking colliders, and its
+// bounds. None of the meshlet and LOD building the GPU path goes through.
+auto build_gltf_collision_mesh(const fastgltf::Asset& gltf_asset, const fastgltf::Primitive& gltf_primitive)
+  -> option<MeshBuildData> {
+  ZoneScoped;
+
+  const auto attrib = gltf_primitive.findAttribute("POSITION");
+  if (!gltf_primitive.indicesAccessor.has_value() || attrib == gltf_primitive.attributes.end()) {
+    return nullopt;
+  }
+
+  auto build = MeshBuildData{};
+  auto& collision_mesh = build.collision_mesh;
+
+  auto& index_accessor = gltf_asset.accessors[gltf_primitive.indicesAccessor.value()];
+  collision_mesh.indices.resize(index_accessor.count);
+  fastgltf::iterateAccessorWithIndex<u32>(gltf_asset, index_accessor, [&](u32 index, usize i) {
+    collision_mesh.indices[i] = index;
+  });
+
+  auto& position_accessor = gltf_asset.accessors[attrib->accessorIndex];
+  collision_mesh.positions.resize(position_accessor.count);
+  auto bb_min = glm::vec3(std::numeric_limits<f32>::max());
+  auto bb_max = glm::vec3(std::numeric_limits<f32>::lowest());
+  fastgltf::iterateAccessorWithIndex<glm::vec3>(gltf_asset, position_accessor, [&](glm::vec3 pos, usize i) {
+    collision_mesh.positions[i] = pos;
+    bb_min = glm::min(bb_min, pos);
+    bb_max = glm::max(bb_max, pos);
+  });
+  if (collision_mesh.positions.empty()) {
+    return nullopt;
+  }
+
+  build.gpu_mesh.bounds.aabb_center = (bb_max + bb_min) * 0.5f;
+  build.gpu_mesh.bounds.aabb_extent = bb_max - bb_min;
+
+  return build;
+}
+
 auto upload_gltf_mesh(RenderContext& render_context, MeshBuildData& build, UploadBatch* batch)
   -> vuk::Unique<vuk::Buffer> {
   ZoneScoped;
@@ -872,7 +915,8 @@ auto AssetManager::load_model(this AssetManager& self, const std::filesystem::pa
     job_man.submit(std::move(job));
   };
 
-  auto& render_context = App::get_rendercontext();
+  // Null on a headless server, which only keeps what colliders need and never touches the GPU.
+  auto* render_context = App::has_mod<Renderer>() ? &App::get_rendercontext() : nullptr;
 
   OX_ASSERT(gltf_asset.textures.size() == textures.size());
   auto texture_barrier = Barrier::create();
@@ -880,7 +924,7 @@ auto AssetManager::load_model(this AssetManager& self, const std::filesystem::pa
   for (const auto& [gltf_texture, texture_uuid, texture_index] :
        std::views::zip(gltf_asset.textures, textures, std::views::iota(0_sz))) {
     auto image_index = get_effective_image_index(gltf_texture);
-    if (!image_index.has_value()) {
+    if (!image_index.has_value() || render_context == nullptr) {
       continue;
     }
 
@@ -913,7 +957,9 @@ auto AssetManager::load_model(this AssetManager& self, const std::filesystem::pa
   texture_barrier->wait(job_man);
   // One fence wait and one vkUpdateDescriptorSets for every texture in the model. Has to happen
   // before the materials below reach the GPU, since they index the slots written here.
-  texture_batch->flush(render_context);
+  if (render_context != nullptr) {
+    texture_batch->flush(*render_context);
+  }
 
   auto materials_result = register_gltf_materials(self, *meta_json->doc, path);
   if (!materials_result.has_value()) {
@@ -1022,6 +1068,7 @@ auto AssetManager::load_model(this AssetManager& self, const std::filesystem::pa
 
       model.material_indices.push_back(mesh_material_index);
       model.gpu_meshes.emplace_back();
+      model.collision_meshes.emplace_back();
       model.lod0_meshlet_counts.push_back(0_u32);
       model.gpu_mesh_buffers.emplace_back();
       pending_meshes.push_back({gltf_mesh_index, gltf_primitive_index});
@@ -1042,21 +1089,24 @@ auto AssetManager::load_model(this AssetManager& self, const std::filesystem::pa
   for (const auto& [pending_mesh, mesh_index] : std::views::zip(pending_meshes, std::views::iota(0_sz))) {
     dispatch(
       mesh_barrier,
-      [&asset_man = self, model_id, gltf_asset_ref, &render_context, pending_mesh, mesh_index, mesh_batch]() {
+      [&asset_man = self, model_id, gltf_asset_ref, render_context, pending_mesh, mesh_index, mesh_batch]() {
         ZoneScopedN("GLTF Mesh Build");
 
         const auto& gltf_primitive = gltf_asset_ref->meshes[pending_mesh.gltf_mesh_index]
                                        .primitives[pending_mesh.gltf_primitive_index];
-        auto build = build_gltf_mesh(*gltf_asset_ref, gltf_primitive);
+        auto build = render_context != nullptr ? build_gltf_mesh(*gltf_asset_ref, gltf_primitive)
+                                               : build_gltf_collision_mesh(*gltf_asset_ref, gltf_primitive);
         auto mesh_buffer = vuk::Unique<vuk::Buffer>();
-        if (build) {
-          mesh_buffer = upload_gltf_mesh(render_context, *build, mesh_batch.get());
+        if (build && render_context != nullptr) {
+          mesh_buffer = upload_gltf_mesh(*render_context, *build, mesh_batch.get());
         }
 
         auto loaded_model = asset_man.get_model(model_id);
         if (!loaded_model) {
           // Still notify, or every waiter on this id blocks forever.
-          mesh_batch->flush(render_context);
+          if (render_context != nullptr) {
+            mesh_batch->flush(*render_context);
+          }
           asset_man.notify_model_loaded();
           return;
         }
@@ -1064,6 +1114,7 @@ auto AssetManager::load_model(this AssetManager& self, const std::filesystem::pa
         if (build) {
           loaded_model->gpu_mesh_buffers[mesh_index] = std::move(mesh_buffer);
           loaded_model->gpu_meshes[mesh_index] = build->gpu_mesh;
+          loaded_model->collision_meshes[mesh_index] = std::move(build->collision_mesh);
           loaded_model->lod0_meshlet_counts[mesh_index] = build->lods[0].meshlet_count;
 
           loaded_model->mesh_ready[mesh_index].test_and_set(std::memory_order_release);
@@ -1077,7 +1128,9 @@ auto AssetManager::load_model(this AssetManager& self, const std::filesystem::pa
         if (was_last) {
           // Nothing waits on `mesh_barrier` when async, so the last mesh in has to settle the batch
           // before the model is announced as loaded.
-          mesh_batch->flush(render_context);
+          if (render_context != nullptr) {
+            mesh_batch->flush(*render_context);
+          }
           asset_man.notify_model_loaded();
         }
       }
@@ -1100,14 +1153,46 @@ auto AssetManager::load_model(this AssetManager& self, const ModelLoadInfo& info
     return ModelID::Invalid;
   }
 
-  auto& render_context = App::get_rendercontext();
-
   auto model = Model{.materials = info.materials};
 
   for (const auto& material_uuid : model.materials) {
     self.load_asset(material_uuid, {}, false);
   }
 
+  auto collision_mesh = Model::CollisionMesh{.indices = info.indices};
+  collision_mesh.positions.reserve(info.vertices.size());
+  for (const auto& vertex : info.vertices) {
+    collision_mesh.positions.push_back(vertex.position);
+  }
+  model.collision_meshes.push_back(std::move(collision_mesh));
+
+  auto& root_group = model.mesh_groups.emplace_back();
+  root_group.name = "Root";
+  root_group.mesh_indices.push_back(0);
+  model.material_indices.push_back(info.materials.empty() ? option<u32>(nullopt) : option<u32>(0));
+  model.mesh_ready = std::vector<std::atomic_flag>(1);
+
+  // A headless server keeps the geometry for colliders and its bounds, and stops there.
+  if (!App::has_mod<Renderer>()) {
+    auto bb_min = glm::vec3(std::numeric_limits<f32>::max());
+    auto bb_max = glm::vec3(std::numeric_limits<f32>::lowest());
+    for (const auto& position : model.collision_meshes[0].positions) {
+      bb_min = glm::min(bb_min, position);
+      bb_max = glm::max(bb_max, position);
+    }
+    auto& gpu_mesh = model.gpu_meshes.emplace_back();
+    gpu_mesh.bounds.aabb_center = (bb_max + bb_min) * 0.5f;
+    gpu_mesh.bounds.aabb_extent = bb_max - bb_min;
+    model.gpu_mesh_buffers.emplace_back();
+    model.lod0_meshlet_counts.push_back(0);
+    model.mesh_ready[0].test_and_set(std::memory_order_release);
+
+    auto write_lock = std::unique_lock(self.models_mutex);
+    return self.model_map.create_slot(std::move(model));
+  }
+
+  auto& render_context = App::get_rendercontext();
+
   auto quantized_positions = std::vector<glm::u16vec4>(vertex_count);
   auto quantized_normals = std::vector<u32>(vertex_count);
   auto quantized_texcoords = std::vector<glm::u16vec2>(vertex_count);
@@ -1331,16 +1416,9 @@ auto AssetManager::load_model(this AssetManager& self, const ModelLoadInfo& info
   );
   render_context.wait_on(render_context.upload_staging(std::move(cpu_metadata_buffer), std::move(metadata_subrange)));
 
-  auto& root_group = model.mesh_groups.emplace_back();
-  root_group.name = "Root";
-  root_group.mesh_indices.push_back(0);
-
   model.gpu_meshes.push_back(gpu_mesh);
   model.gpu_mesh_buffers.push_back(std::move(gpu_mesh_buffer));
   model.lod0_meshlet_counts.push_back(lod0.meshlet_count);
-  model.material_indices.push_back(info.materials.empty() ? option<u32>(nullopt) : option<u32>(0));
-
-  model.mesh_ready = std::vector<std::atomic_flag>(1);
   model.mesh_ready[0].test_and_set(std::memory_order_release);
 
   auto write_lock = std::unique_lock(self.models_mutex);
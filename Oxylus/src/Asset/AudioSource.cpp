@@ -11,6 +11,11 @@ AudioSource::~AudioSource() { unload(); }
 auto AudioSource::load(const std::filesystem::path& path) -> bool {
   ZoneScoped;
 
+  // Headless apps run without an audio engine, the source just stays silent.
+  if (!App::has_mod<AudioEngine>()) {
+    return false;
+  }
+
   _sound = new ma_sound;
   auto* engine = App::mod<AudioEngine>().get_engine();
   auto path_str = path.string();
@@ -27,8 +32,13 @@ auto AudioSource::load(const std::filesystem::path& path) -> bool {
 auto AudioSource::unload() -> void {
   ZoneScoped;
 
+  if (!_sound) {
+    return;
+  }
+
   ma_sound_uninit(_sound);
   delete _sound;
+  _sound = nullptr;
 }
 
 auto AudioSource::get_source() -> ma_sound* { return _sound; }
@@ -416,6 +416,14 @@ auto Texture::create(const TextureLoadInfo& info, OX_CALLSTACK) -> Texture {
 auto Texture::destroy(this Texture& self) -> void {
   ZoneScoped;
 
+  // Nothing was ever created, which also holds for textures living outside of an app.
+  if (
+    self.image_id == ImageID::Invalid && self.image_view_id == ImageViewID::Invalid &&
+    self.sampler_id == SamplerID::Invalid
+  ) {
+    return;
+  }
+
   auto& render_context = App::get_rendercontext();
 
   if (self.image_id != ImageID::Invalid)
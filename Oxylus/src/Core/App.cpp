@@ -1,5 +1,8 @@
 #include "Core/App.hpp"
 
+#include <cmath>
+#include <csignal>
+#include <cstdlib>
 #include <vuk/vsl/Core.hpp>
 
 #include "Core/EventSystem.hpp"
@@ -13,6 +16,15 @@
 #include "Utils/Profiler.hpp"
 
 namespace ox {
+namespace {
+volatile std::sig_atomic_t stop_requested = 0;
+
+auto on_stop_signal(int) -> void { stop_requested = 1; }
+
+// A server's tick has no frame to present on time, it can wake up a little late for much less busy waiting.
+constexpr f64 HEADLESS_SPIN_MS = 0.2;
+} // namespace
+
 App* App::instance_ = nullptr;
 
 App::App(int argc, char** argv) {
@@ -28,6 +40,9 @@ App::App(int argc, char** argv) {
   Log::init(argc, argv);
 
   instance_->command_line_args = AppCommandLineArgs{argc, argv};
+
+  // Read here rather than in init, modules get added in between and the headless ones get left out.
+  headless = command_line_args.contains("--headless");
 }
 
 App::~App() {
@@ -50,7 +65,25 @@ auto App::init(this App& self) -> void {
 
   self.vfs.mount_dir(VFS::APP_DIR, std::filesystem::absolute(self.assets_path));
 
-  if (self.window_info.has_value()) {
+  if (auto index = self.command_line_args.get_index("--tick-rate")) {
+    auto value = self.command_line_args.get(*index + 1);
+    const auto* arg = value ? value->arg_str.c_str() : "";
+    char* end = nullptr;
+    const auto tick_rate = std::strtod(arg, &end);
+    if (end == arg || *end != '\0' || !std::isfinite(tick_rate) || tick_rate <= 0.0) {
+      OX_LOG_ERROR("--tick-rate wants a positive number of ticks per second, not '{}'.", arg);
+    } else {
+      self.tick_rate = tick_rate;
+    }
+  }
+
+  if (self.headless) {
+    OX_LOG_INFO("Running headless at {} ticks per second.", self.tick_rate);
+    // Nothing else would ever end the loop, a dedicated server gets stopped with a signal.
+    std::signal(SIGINT, on_stop_signal);
+    std::signal(SIGTERM, on_stop_signal);
+    self.timestep.set_spin_threshold(HEADLESS_SPIN_MS);
+  } else if (self.window_info.has_value()) {
     self.window = Window::create(*self.window_info);
   }
 
@@ -79,15 +112,26 @@ auto App::init(this App& self) -> void {
 }
 
 auto App::step(this App& self) -> void {
-  const i32 frame_limit = self.frame_limit > 0 ? self.frame_limit : self.render_context->context_cvar.cvar_frame_limit.get();
-  if (frame_limit > 0) {
-    self.timestep.set_max_frame_time(1000.0 / static_cast<f64>(frame_limit));
+  // Headless there is no vsync to hold the loop back, it sleeps out the rest of each tick instead.
+  auto frame_limit = static_cast<f64>(self.frame_limit);
+  if (frame_limit <= 0.0 && self.render_context) {
+    frame_limit = static_cast<f64>(self.render_context->context_cvar.cvar_frame_limit.get());
+  } else if (frame_limit <= 0.0 && self.headless) {
+    frame_limit = self.tick_rate;
+  }
+
+  if (frame_limit > 0.0) {
+    self.timestep.set_max_frame_time(1000.0 / frame_limit);
   } else {
     self.timestep.reset_max_frame_time();
   }
 
   self.timestep.on_update();
 
+  if (stop_requested) {
+    self.is_running = false;
+  }
+
   self.run_deferred_tasks();
 
   if (self.window.has_value())
@@ -183,6 +227,16 @@ auto App::with_assets_directory(this App& self, const std::filesystem::path& dir
   return self;
 }
 
+auto App::with_headless(this App& self, bool headless) -> App& {
+  self.headless = headless;
+  return self;
+}
+
+auto App::with_tick_rate(this App& self, f64 ticks_per_second) -> App& {
+  self.tick_rate = ticks_per_second;
+  return self;
+}
+
 auto App::with_workers(this App& self, const u32 count) -> App& {
   self.job_manager.set_thread_count(count);
   return self;
@@ -207,6 +261,10 @@ auto App::get_command_line_args(this const App& self) -> const AppCommandLineArg
   return self.command_line_args; //
 }
 
+auto App::is_headless() -> bool {
+  return instance_->headless; //
+}
+
 auto App::get_window() -> const Window& {
   OX_ASSERT(instance_->window.has_value());
   return instance_->window.value();
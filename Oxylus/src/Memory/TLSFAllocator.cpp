@@ -0,0 +1,217 @@
+#include "Memory/TLSFAllocator.hpp"
+
+#include <algorithm>
+#include <bit>
+
+#include "Utils/Log.hpp"
+
+namespace ox {
+namespace {
+constexpr auto FL_INDEX_SHIFT = static_cast<u32>(std::bit_width(TLSFAllocator::SMALL_BLOCK_SIZE) - 1);
+
+struct Mapping {
+  u32 first = 0;
+  u32 second = 0;
+};
+
+// Free lists are split in powers of two, then each power of two in `SL_INDEX_COUNT` linear steps.
+// Blocks below `SMALL_BLOCK_SIZE` all go into the first level.
+auto mapping_of(u32 size) -> Mapping {
+  if (size < TLSFAllocator::SMALL_BLOCK_SIZE) {
+    return {.first = 0, .second = size / (TLSFAllocator::SMALL_BLOCK_SIZE / TLSFAllocator::SL_INDEX_COUNT)};
+  }
+
+  const auto last_bit = static_cast<u32>(std::bit_width(size) - 1);
+  const auto second_shift = last_bit - TLSFAllocator::SL_INDEX_COUNT_LOG2;
+  return {
+    .first = last_bit - (FL_INDEX_SHIFT - 1),
+    .second = (size >> second_shift) ^ (1_u32 << TLSFAllocator::SL_INDEX_COUNT_LOG2),
+  };
+}
+
+// Rounded up to the next list, so any block found there is big enough.
+auto search_mapping_of(u32 size) -> Mapping {
+  if (size >= TLSFAllocator::SMALL_BLOCK_SIZE) {
+    const auto last_bit = static_cast<u32>(std::bit_width(size) - 1);
+    size += (1_u32 << (last_bit - TLSFAllocator::SL_INDEX_COUNT_LOG2)) - 1;
+  }
+
+  return mapping_of(size);
+}
+} // namespace
+
+auto TLSFAllocator::init(this TLSFAllocator& self, u32 capacity) -> void {
+  ZoneScoped;
+
+  OX_CHECK_LT(capacity, 1_u32 << FL_INDEX_MAX);
+
+  self.first_level_bitmap = 0;
+  std::ranges::fill(self.second_level_bitmap, 0_u32);
+  for (auto& lists : self.free_lists) {
+    std::ranges::fill(lists, NodeID::Invalid);
+  }
+  self.nodes.clear();
+  self.unused_nodes.clear();
+  self.capacity = capacity & ~(ALIGNMENT - 1);
+  self.free_size = self.capacity;
+
+  if (self.capacity > 0) {
+    const auto node_id = self.new_node();
+    self.nodes[static_cast<u32>(node_id)].size = self.capacity;
+    self.insert_free(node_id);
+  }
+}
+
+auto TLSFAllocator::allocate(this TLSFAllocator& self, u32 size) -> option<Allocation> {
+  ZoneScoped;
+
+  if (size == 0 || size > self.free_size) {
+    return nullopt;
+  }
+
+  size = (size + ALIGNMENT - 1) & ~(ALIGNMENT - 1);
+  const auto node_id = self.find_free(size);
+  if (node_id == NodeID::Invalid) {
+    return nullopt;
+  }
+
+  self.remove_free(node_id);
+
+  // Whatever is left over goes back as its own free block.
+  const auto remainder = self.nodes[static_cast<u32>(node_id)].size - size;
+  if (remainder >= ALIGNMENT) {
+    const auto split_id = self.new_node();
+    auto& node = self.nodes[static_cast<u32>(node_id)];
+    auto& split = self.nodes[static_cast<u32>(split_id)];
+    split.offset = node.offset + size;
+    split.size = remainder;
+    split.prev_phys = node_id;
+    split.next_phys = node.next_phys;
+    if (node.next_phys != NodeID::Invalid) {
+      self.nodes[static_cast<u32>(node.next_phys)].prev_phys = split_id;
+    }
+    node.next_phys = split_id;
+    node.size = size;
+    self.insert_free(split_id);
+  }
+
+  auto& node = self.nodes[static_cast<u32>(node_id)];
+  node.used = true;
+  self.free_size -= node.size;
+
+  return Allocation{.offset = node.offset, .node = node_id};
+}
+
+auto TLSFAllocator::free(this TLSFAllocator& self, NodeID node_id) -> void {
+  ZoneScoped;
+
+  OX_ASSERT(node_id != NodeID::Invalid);
+  auto* node = &self.nodes[static_cast<u32>(node_id)];
+  OX_ASSERT(node->used, "Double free of TLSF node {}.", static_cast<u32>(node_id));
+  node->used = false;
+  self.free_size += node->size;
+
+  // Swallowed neighbours return their node to the pool.
+  const auto merge = [&self](NodeID into_id, NodeID from_id) {
+    auto& into = self.nodes[static_cast<u32>(into_id)];
+    const auto& from = self.nodes[static_cast<u32>(from_id)];
+    into.size = into.size + from.size;
+    into.next_phys = from.next_phys;
+    if (from.next_phys != NodeID::Invalid) {
+      self.nodes[static_cast<u32>(from.next_phys)].prev_phys = into_id;
+    }
+    self.nodes[static_cast<u32>(from_id)] = {};
+    self.unused_nodes.push_back(from_id);
+  };
+
+  const auto prev_id = node->prev_phys;
+  if (prev_id != NodeID::Invalid && !self.nodes[static_cast<u32>(prev_id)].used) {
+    self.remove_free(prev_id);
+    merge(prev_id, node_id);
+    node_id = prev_id;
+    node = &self.nodes[static_cast<u32>(node_id)];
+  }
+
+  const auto next_id = node->next_phys;
+  if (next_id != NodeID::Invalid && !self.nodes[static_cast<u32>(next_id)].used) {
+    self.remove_free(next_id);
+    merge(node_id, next_id);
+  }
+
+  self.insert_free(node_id);
+}
+
+auto TLSFAllocator::insert_free(this TLSFAllocator& self, NodeID node_id) -> void {
+  auto& node = self.nodes[static_cast<u32>(node_id)];
+  const auto [first, second] = mapping_of(node.size);
+  auto& head = self.free_lists[first][second];
+
+  node.prev_free = NodeID::Invalid;
+  node.next_free = head;
+  if (head != NodeID::Invalid) {
+    self.nodes[static_cast<u32>(head)].prev_free = node_id;
+  }
+  head = node_id;
+
+  self.first_level_bitmap |= 1_u32 << first;
+  self.second_level_bitmap[first] |= 1_u32 << second;
+}
+
+auto TLSFAllocator::remove_free(this TLSFAllocator& self, NodeID node_id) -> void {
+  auto& node = self.nodes[static_cast<u32>(node_id)];
+  const auto [first, second] = mapping_of(node.size);
+
+  if (node.prev_free != NodeID::Invalid) {
+    self.nodes[static_cast<u32>(node.prev_free)].next_free = node.next_free;
+  }
+  if (node.next_free != NodeID::Invalid) {
+    self.nodes[static_cast<u32>(node.next_free)].prev_free = node.prev_free;
+  }
+
+  auto& head = self.free_lists[first][second];
+  if (head == node_id) {
+    head = node.next_free;
+    if (head == NodeID::Invalid) {
+      self.second_level_bitmap[first] &= ~(1_u32 << second);
+      if (self.second_level_bitmap[first] == 0) {
+        self.first_level_bitmap &= ~(1_u32 << first);
+      }
+    }
+  }
+
+  node.prev_free = NodeID::Invalid;
+  node.next_free = NodeID::Invalid;
+}
+
+auto TLSFAllocator::find_free(this TLSFAllocator& self, u32 size) -> NodeID {
+  auto [first, second] = search_mapping_of(size);
+  if (first >= FL_INDEX_MAX) {
+    return NodeID::Invalid;
+  }
+
+  auto second_map = self.second_level_bitmap[first] & (~0_u32 << second);
+  if (second_map == 0) {
+    const auto first_map = first + 1 < 32 ? self.first_level_bitmap & (~0_u32 << (first + 1)) : 0_u32;
+    if (first_map == 0) {
+      return NodeID::Invalid;
+    }
+
+    first = static_cast<u32>(std::countr_zero(first_map));
+    second_map = self.second_level_bitmap[first];
+  }
+
+  second = static_cast<u32>(std::countr_zero(second_map));
+  return self.free_lists[first][second];
+}
+
+auto TLSFAllocator::new_node(this TLSFAllocator& self) -> NodeID {
+  if (!self.unused_nodes.empty()) {
+    const auto node_id = self.unused_nodes.back();
+    self.unused_nodes.pop_back();
+    return node_id;
+  }
+
+  self.nodes.emplace_back();
+  return static_cast<NodeID>(self.nodes.size() - 1);
+}
+} // namespace ox
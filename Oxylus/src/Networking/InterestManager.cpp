@@ -0,0 +1,156 @@
+#include "Networking/InterestManager.hpp"
+
+#include <algorithm>
+#include <limits>
+
+#include "Scene/Components.hpp"
+#include "Scene/Scene.hpp"
+
+namespace ox {
+auto InterestManager::update(this InterestManager& self, flecs::world& world, const SceneState& state) -> void {
+  ZoneScoped;
+
+  self.tick += 1;
+  self.cells.clear();
+  self.entities.clear();
+  self.always_relevant.clear();
+
+  for (const auto& entity_state : state.entities) {
+    const auto entity_id = entity_state.entity_id;
+    const auto entity = flecs::entity(world, entity_id);
+    auto info = EntityInfo{};
+    if (const auto* relevancy = entity.try_get<NetRelevancy>()) {
+      info.priority = relevancy->priority;
+      info.update_interval = glm::max(relevancy->update_interval, 1_u32);
+    }
+
+    // Children are binned by where they are in the world, not by their offset to the parent.
+    if (entity.has<TransformComponent>() && !entity.has<AlwaysRelevant>()) {
+      info.spatial = true;
+      info.cell = self.cell_of(Scene::get_world_position(entity));
+      self.cells[cell_key(info.cell)].push_back(entity_id);
+    } else {
+      self.always_relevant.push_back(entity_id);
+    }
+
+    self.entities.emplace(entity_id, info);
+  }
+}
+
+auto InterestManager::filter(
+  this InterestManager& self,
+  ClientInterest& client,
+  const SceneState& state,
+  const SceneState* previous,
+  SceneState& out
+) -> void {
+  ZoneScoped;
+
+  out.clear();
+  client.entered.clear();
+  client.left.clear();
+  self.candidates.clear();
+  self.scored.clear();
+
+  self.candidates.insert(self.always_relevant.begin(), self.always_relevant.end());
+  auto viewer_it = self.entities.find(client.viewer);
+  if (viewer_it != self.entities.end()) {
+    self.candidates.emplace(client.viewer);
+
+    if (viewer_it->second.spatial) {
+      const auto center = viewer_it->second.cell;
+      const auto reach = static_cast<i32>(client.radius_cells) + 1;
+      for (auto x = -reach; x <= reach; x++) {
+        for (auto y = -reach; y <= reach; y++) {
+          for (auto z = -reach; z <= reach; z++) {
+            auto cell_it = self.cells.find(cell_key(center + glm::ivec3(x, y, z)));
+            if (cell_it == self.cells.end()) {
+              continue;
+            }
+
+            // The outer ring only keeps what is already relevant.
+            const auto outer = glm::max(glm::abs(x), glm::max(glm::abs(y), glm::abs(z))) == reach;
+            for (const auto entity_id : cell_it->second) {
+              if (!outer || client.relevant.contains(entity_id)) {
+                self.candidates.emplace(entity_id);
+              }
+            }
+          }
+        }
+      }
+    }
+  }
+
+  for (auto it = client.relevant.begin(); it != client.relevant.end();) {
+    if (self.candidates.contains(it->first)) {
+      ++it;
+      continue;
+    }
+
+    client.left.push_back(it->first);
+    it = client.relevant.erase(it);
+  }
+
+  // Entering entities go first, the rest by priority times ticks since they were last sent.
+  for (const auto entity_id : self.candidates) {
+    const auto& info = self.entities.find(entity_id)->second;
+    auto relevant_it = client.relevant.find(entity_id);
+    if (relevant_it == client.relevant.end()) {
+      self.scored.emplace_back(std::numeric_limits<f32>::max(), entity_id);
+      continue;
+    }
+
+    const auto staleness = self.tick - relevant_it->second.last_update_tick;
+    if (staleness >= info.update_interval) {
+      self.scored.emplace_back(info.priority * static_cast<f32>(staleness), entity_id);
+    }
+  }
+
+  auto update_count = self.scored.size();
+  if (client.max_updates > 0 && update_count > client.max_updates) {
+    update_count = client.max_updates;
+    std::ranges::nth_element(self.scored, self.scored.begin() + update_count, std::greater{});
+  }
+
+  self.picked.clear();
+  for (auto i = 0_sz; i < update_count; i++) {
+    const auto entity_id = self.scored[i].second;
+    auto [relevant_it, inserted] = client.relevant.try_emplace(entity_id);
+    relevant_it->second.last_update_tick = self.tick;
+    if (inserted) {
+      client.entered.push_back(entity_id);
+    }
+
+    self.picked.emplace_back(entity_id, true);
+  }
+
+  // Entities over budget or waiting on their interval repeat what the client was sent last, so the
+  // delta against its baseline stays the same as the last one instead of snapping them back.
+  for (const auto& [entity_id, entry] : client.relevant) {
+    if (entry.last_update_tick != self.tick) {
+      self.picked.emplace_back(entity_id, false);
+    }
+  }
+
+  std::ranges::sort(self.picked);
+  for (const auto& [entity_id, updated] : self.picked) {
+    const auto* last_sent = (updated || !previous) ? nullptr : previous->find(entity_id);
+    if (last_sent) {
+      out.push_entity(*previous, *last_sent);
+    } else {
+      out.push_entity(state, *state.find(entity_id));
+    }
+  }
+}
+
+auto InterestManager::cell_of(this const InterestManager& self, const glm::vec3& position) -> glm::ivec3 {
+  return glm::ivec3(glm::floor(position / self.cell_size));
+}
+
+auto InterestManager::cell_key(const glm::ivec3& cell) -> u64 {
+  // 21 bits per axis, +-1M cells.
+  constexpr auto MASK = (1_u64 << 21) - 1;
+  return ((static_cast<u64>(cell.x) & MASK) << 42) | ((static_cast<u64>(cell.y) & MASK) << 21) |
+         (static_cast<u64>(cell.z) & MASK);
+}
+} // namespace ox
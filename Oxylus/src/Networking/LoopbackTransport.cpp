@@ -0,0 +1,338 @@
+#include "Networking/LoopbackTransport.hpp"
+
+#include <algorithm>
+
+#include "Core/Base.hpp"
+#include "Utils/Log.hpp"
+
+#ifndef ENET_FEATURE_ADDRESS_MAPPING
+  #define ENET_FEATURE_ADDRESS_MAPPING
+#endif
+
+#include <enet.h>
+
+namespace ox {
+// Both directions of one connection, index 0 is the end that connected.
+struct LoopbackConnection {
+  std::array<ENetPeer, 2> peers = {};
+  std::array<LoopbackTransport*, 2> ends = {};
+  std::array<NetPeerCounters, 2> counters = {};
+  // When each direction is done sending what it already has, with a bandwidth cap.
+  std::array<f64, 2> link_free_at = {};
+  // When the last reliable packet of each direction arrives, the next one can't overtake it.
+  std::array<f64, 2> last_reliable_at = {};
+  bool open = true;
+
+  auto side(this const LoopbackConnection& self, const ENetPeer* peer) -> u32 {
+    return peer == &self.peers[0] ? 0 : 1;
+  }
+};
+
+namespace {
+// ENet gives up on a peer after this many resends, the loopback just stops adding delay.
+constexpr u32 MAX_RESENDS = 8;
+
+auto later_first(const LoopbackDelivery& lhs, const LoopbackDelivery& rhs) -> bool {
+  return lhs.at != rhs.at ? lhs.at > rhs.at : lhs.order > rhs.order;
+}
+} // namespace
+
+LoopbackNetwork::LoopbackNetwork(u64 seed) : random(seed) {}
+
+LoopbackNetwork::~LoopbackNetwork() { OX_ASSERT(listeners.empty()); }
+
+auto LoopbackNetwork::advance(this LoopbackNetwork& self, f64 ms) -> void { self.now_ms += ms; }
+
+auto LoopbackNetwork::listen(this LoopbackNetwork& self, u16 port, LoopbackTransport* transport) -> bool {
+  ZoneScoped;
+
+  return self.listeners.emplace(port, transport).second;
+}
+
+auto LoopbackNetwork::listener(this LoopbackNetwork& self, u16 port) -> LoopbackTransport* {
+  ZoneScoped;
+
+  auto it = self.listeners.find(port);
+  return it != self.listeners.end() ? it->second : nullptr;
+}
+
+auto LoopbackNetwork::open(this LoopbackNetwork& self, LoopbackTransport* from, LoopbackTransport* to)
+  -> LoopbackConnection& {
+  ZoneScoped;
+
+  auto& connection = *self.connections.emplace_back(std::make_unique<LoopbackConnection>());
+  connection.ends = {from, to};
+  self.peer_connections.emplace(&connection.peers[0], &connection);
+  self.peer_connections.emplace(&connection.peers[1], &connection);
+
+  return connection;
+}
+
+auto LoopbackNetwork::find(this LoopbackNetwork& self, const ENetPeer* peer) -> LoopbackConnection* {
+  ZoneScoped;
+
+  auto it = self.peer_connections.find(peer);
+  return it != self.peer_connections.end() ? it->second : nullptr;
+}
+
+auto LoopbackNetwork::transmit(
+  this LoopbackNetwork& self, LoopbackConnection& connection, u32 from, ENetPacket* packet, bool reliable
+) -> void {
+  ZoneScoped;
+
+  const auto to = 1 - from;
+  const auto size = packet->dataLength;
+  auto& counters = connection.counters[from];
+  counters.sent_bytes += size;
+  counters.sent_packets += 1;
+
+  // With a cap the packet only leaves once everything queued before it did.
+  auto departure = self.now_ms;
+  if (self.conditions.bandwidth != 0) {
+    departure = std::max(self.now_ms, connection.link_free_at[from]);
+    departure += static_cast<f64>(size) * 1000.0 / static_cast<f64>(self.conditions.bandwidth);
+    connection.link_free_at[from] = departure;
+  }
+
+  auto arrival = departure + self.trip_time();
+  auto copies = 1_u32;
+  if (reliable) {
+    for (u32 resend = 0; resend < MAX_RESENDS && self.chance(self.conditions.loss); resend++) {
+      arrival += 2.0 * self.trip_time();
+      counters.packets_lost += 1;
+    }
+    arrival = std::max(arrival, connection.last_reliable_at[from]);
+    connection.last_reliable_at[from] = arrival;
+  } else if (self.chance(self.conditions.loss)) {
+    counters.packets_lost += 1;
+    return;
+  } else if (self.chance(self.conditions.duplication)) {
+    copies = 2;
+  }
+
+  for (u32 copy = 0; copy < copies; copy++) {
+    // Every receiver owns what it pops, so each one gets its own copy, like off the wire.
+    auto* received = enet_packet_create(packet->data, size, reliable ? ENET_PACKET_FLAG_RELIABLE : 0);
+    if (!received) {
+      return;
+    }
+
+    connection.ends[to]->deliver({
+      .at = copy == 0 ? arrival : departure + self.trip_time(),
+      .event = {.kind = NetEventKind::Receive, .peer = &connection.peers[to], .packet = received},
+      .connection = &connection,
+    });
+  }
+}
+
+auto LoopbackNetwork::drop(this LoopbackNetwork& self, LoopbackTransport* transport) -> void {
+  ZoneScoped;
+
+  for (auto& connection : self.connections) {
+    if (!connection->open || (connection->ends[0] != transport && connection->ends[1] != transport)) {
+      continue;
+    }
+
+    connection->open = false;
+    const auto other = connection->ends[0] == transport ? 1_u32 : 0_u32;
+    connection->ends[other]->deliver({
+      .at = self.now_ms + self.trip_time(),
+      .event = {.kind = NetEventKind::Disconnect, .peer = &connection->peers[other]},
+      .connection = connection.get(),
+    });
+  }
+}
+
+auto LoopbackNetwork::chance(this LoopbackNetwork& self, f64 probability) -> bool {
+  return probability > 0.0 && std::uniform_real_distribution<f64>(0.0, 1.0)(self.random) < probability;
+}
+
+auto LoopbackNetwork::trip_time(this LoopbackNetwork& self) -> f64 {
+  auto jitter = 0.0;
+  if (self.conditions.jitter_ms > 0.0) {
+    jitter = std::uniform_real_distribution<f64>(0.0, self.conditions.jitter_ms)(self.random);
+  }
+
+  return self.conditions.latency_ms + jitter;
+}
+
+LoopbackTransport::LoopbackTransport(LoopbackNetwork& network_, u16 port_) : network(&network_), port(port_) {
+  if (port != 0 && !network->listen(port, this)) {
+    OX_LOG_ERROR("Loopback port {} is already taken!", port);
+    port = 0;
+  }
+}
+
+LoopbackTransport::~LoopbackTransport() {
+  network->drop(this);
+  if (port != 0) {
+    network->listeners.erase(port);
+  }
+
+  clear_inbox();
+}
+
+auto LoopbackTransport::deliver(LoopbackDelivery&& delivery) -> void {
+  ZoneScoped;
+
+  delivery.order = delivery_counter++;
+  inbox.push_back(std::move(delivery));
+  std::ranges::push_heap(inbox, later_first);
+}
+
+auto LoopbackTransport::poll() -> option<NetIOEvent> {
+  ZoneScoped;
+
+  while (!inbox.empty() && inbox.front().at <= network->now_ms) {
+    std::ranges::pop_heap(inbox, later_first);
+    auto delivery = std::move(inbox.back());
+    inbox.pop_back();
+
+    auto* connection = delivery.connection;
+    auto& event = delivery.event;
+    // Whatever was still on its way when the connection closed is gone, apart from the news of it.
+    if (connection && !connection->open && event.kind != NetEventKind::Disconnect) {
+      if (event.packet) {
+        enet_packet_destroy(event.packet);
+      }
+      continue;
+    }
+
+    if (event.kind == NetEventKind::Receive) {
+      connection->counters[connection->side(event.peer)].received_bytes += event.packet->dataLength;
+    }
+
+    return event;
+  }
+
+  return nullopt;
+}
+
+auto LoopbackTransport::connect(std::string_view, u16 remote_port) -> bool {
+  ZoneScoped;
+
+  auto* remote = network->listener(remote_port);
+  if (!remote) {
+    // Nobody answers, the attempt fails once it would have timed out.
+    deliver({.at = network->now_ms + 2.0 * network->trip_time(), .event = {.kind = NetEventKind::Disconnect}});
+    return true;
+  }
+
+  auto& connection = network->open(this, remote);
+  const auto accepted_at = network->now_ms + network->trip_time();
+  remote->deliver({
+    .at = accepted_at,
+    .event = {.kind = NetEventKind::Connect, .peer = &connection.peers[1]},
+    .connection = &connection,
+  });
+  deliver({
+    .at = accepted_at + network->trip_time(),
+    .event = {.kind = NetEventKind::Connect, .peer = &connection.peers[0]},
+    .connection = &connection,
+  });
+
+  return true;
+}
+
+auto LoopbackTransport::disconnect(ENetPeer* peer, bool immediate, u32 data) -> void {
+  ZoneScoped;
+
+  auto* connection = network->find(peer);
+  if (!connection || !connection->open) {
+    return;
+  }
+
+  connection->open = false;
+  const auto side = connection->side(peer);
+  const auto other = 1 - side;
+  const auto notified_at = network->now_ms + network->trip_time();
+  connection->ends[other]->deliver({
+    .at = notified_at,
+    .event = {.kind = NetEventKind::Disconnect, .peer = &connection->peers[other], .data = data},
+    .connection = connection,
+  });
+
+  // Like ENet, only a graceful disconnect is reported back, once the other end acknowledged it.
+  if (!immediate) {
+    deliver({
+      .at = notified_at + network->trip_time(),
+      .event = {.kind = NetEventKind::Disconnect, .peer = peer, .data = data},
+      .connection = connection,
+    });
+  }
+}
+
+auto LoopbackTransport::reset() -> void {
+  ZoneScoped;
+
+  // ENet leaves the other end to time out, here it hears about it right away.
+  network->drop(this);
+  clear_inbox();
+}
+
+auto LoopbackTransport::send(ENetPeer* peer, ENetPacket* packet, bool reliable) -> void {
+  ZoneScoped;
+
+  auto* connection = peer ? network->find(peer) : nullptr;
+  if (connection && connection->open) {
+    network->transmit(*connection, connection->side(peer), packet, reliable);
+  }
+
+  if (packet->referenceCount == 0) {
+    enet_packet_destroy(packet);
+  }
+}
+
+auto LoopbackTransport::broadcast(ENetPacket* packet, bool reliable) -> void {
+  ZoneScoped;
+
+  for (auto& connection : network->connections) {
+    if (!connection->open) {
+      continue;
+    }
+
+    for (u32 side = 0; side < 2; side++) {
+      if (connection->ends[side] == this) {
+        network->transmit(*connection, side, packet, reliable);
+      }
+    }
+  }
+
+  if (packet->referenceCount == 0) {
+    enet_packet_destroy(packet);
+  }
+}
+
+auto LoopbackTransport::release(ENetPacket* packet) -> void {
+  ZoneScoped;
+
+  release_packet(packet);
+}
+
+auto LoopbackTransport::peer_counters(ENetPeer* peer) -> option<NetPeerCounters> {
+  ZoneScoped;
+
+  auto* connection = network->find(peer);
+  if (!connection) {
+    return nullopt;
+  }
+
+  auto counters = connection->counters[connection->side(peer)];
+  const auto& conditions = network->conditions;
+  counters.rtt = static_cast<u32>(2.0 * conditions.latency_ms + conditions.jitter_ms);
+  counters.rtt_variance = static_cast<u32>(conditions.jitter_ms);
+
+  return counters;
+}
+
+auto LoopbackTransport::clear_inbox() -> void {
+  ZoneScoped;
+
+  for (auto& delivery : inbox) {
+    if (delivery.event.packet) {
+      enet_packet_destroy(delivery.event.packet);
+    }
+  }
+  inbox.clear();
+}
+} // namespace ox
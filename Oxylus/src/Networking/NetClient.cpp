@@ -2,6 +2,7 @@
 
 #include "Core/App.hpp"
 #include "Core/Base.hpp"
+#include "Networking/SnapshotInterpolator.hpp"
 #include "Utils/Log.hpp"
 
 #ifndef ENET_FEATURE_ADDRESS_MAPPING
@@ -25,29 +26,31 @@ auto NetClient::update_stats(this NetClient& self) -> void {
     return;
   }
 
-  auto current_sent_bytes = self.remote_peer->totalDataSent;
-  auto current_received_bytes = self.remote_peer->totalDataReceived;
-  auto current_sent_packets = self.remote_peer->packetsSent;
-
-  self.stats.ping = self.remote_peer->pingInterval;
-  self.stats.sent_bytes = static_cast<u32>(current_sent_bytes - self.stats.last_sent_bytes);
-  self.stats.received_bytes = static_cast<u32>(current_received_bytes - self.stats.last_received_bytes);
-  self.stats.sent_packets = current_sent_packets - self.stats.last_sent_packets;
-  self.stats.packets_lost = self.remote_peer->packetsLost;
-  self.stats.rtt = self.remote_peer->lastRoundTripTime;
-  self.stats.last_sent_bytes = static_cast<u32>(current_sent_bytes);
-  self.stats.last_received_bytes = static_cast<u32>(current_received_bytes);
-  self.stats.last_sent_packets = current_sent_packets;
+  if (auto counters = self.transport->peer_counters(self.remote_peer)) {
+    self.update_stats(counters.value());
+  }
+}
+
+auto NetClient::update_stats(this NetClient& self, const NetPeerCounters& counters) -> void {
+  ZoneScoped;
+
+  self.stats.ping = counters.ping_interval;
+  self.stats.sent_bytes = static_cast<u32>(counters.sent_bytes - self.stats.last_sent_bytes);
+  self.stats.received_bytes = static_cast<u32>(counters.received_bytes - self.stats.last_received_bytes);
+  self.stats.sent_packets = counters.sent_packets - self.stats.last_sent_packets;
+  self.stats.packets_lost = counters.packets_lost;
+  self.stats.rtt = counters.rtt;
+  self.stats.rtt_variance = counters.rtt_variance;
+  self.stats.last_sent_bytes = static_cast<u32>(counters.sent_bytes);
+  self.stats.last_received_bytes = static_cast<u32>(counters.received_bytes);
+  self.stats.last_sent_packets = counters.sent_packets;
 }
 
 auto NetClient::connect(this NetClient& self, std::string_view host_name, u16 port, f64 timeout) -> bool {
   ZoneScoped;
 
-  auto address = ENetAddress{};
-  enet_address_set_host(&address, host_name.data());
-  address.port = port;
-  self.remote_peer = enet_host_connect(self.local_host, &address, NET_CHANNEL_COUNT, 0);
-  if (!self.remote_peer) {
+  // `remote_peer` is filled in once the connect event comes back.
+  if (!self.transport->connect(host_name, port)) {
     return false;
   }
 
@@ -63,14 +66,11 @@ auto NetClient::connect(this NetClient& self, std::string_view host_name, u16 po
 auto NetClient::disconnect(this NetClient& self, bool immediate, u32 data) -> void {
   ZoneScoped;
 
-  if (!self.remote_peer) {
-    return;
-  }
-
-  if (immediate) {
-    enet_peer_disconnect_now(self.remote_peer, data);
-  } else {
-    enet_peer_disconnect_later(self.remote_peer, data);
+  if (self.remote_peer) {
+    self.transport->disconnect(self.remote_peer, immediate, data);
+  } else if (self.status == NetClientStatus::Connecting) {
+    // Still waiting for the connect event, drop the attempt.
+    self.transport->reset();
   }
 
   self.remote_peer = nullptr;
@@ -79,45 +79,10 @@ auto NetClient::disconnect(this NetClient& self, bool immediate, u32 data) -> vo
 auto NetClient::tick(this NetClient& self, const Timestep& ts) -> bool {
   ZoneScoped;
 
-  auto event = ENetEvent{};
-  while (enet_host_service(self.local_host, &event, 0) > 0) {
-    switch (event.type) {
-      case ENET_EVENT_TYPE_CONNECT: {
-        ZoneScopedN("ENET_EVENT_TYPE_CONNECT");
-        OX_LOG_INFO("NetClient connected.");
-        self.status = NetClientStatus::Connected;
-
-        if (auto handshake_packet = NetPacket::handshake({.version = 1})) {
-          self.send_reliable(handshake_packet.value());
-        }
-      } break;
-      case ENET_EVENT_TYPE_DISCONNECT_TIMEOUT:
-      case ENET_EVENT_TYPE_DISCONNECT        : {
-        ZoneScopedN("ENET_EVENT_TYPE_DISCONNECT");
-        OX_LOG_INFO("NetClient disconnected.");
-
-        self.status = NetClientStatus::Disconnected;
-        self.remote_peer = nullptr;
-        event.peer->data = nullptr;
-
-        auto& es = App::get_event_system();
-        std::ignore = es.emit<ServerDisconnectEvent>({.client = &self, .reason = NetClientStatus::Disconnected});
-      } break;
-      case ENET_EVENT_TYPE_RECEIVE: {
-        ZoneScopedN("ENET_EVENT_TYPE_RECEIVE");
-        OX_DEFER(&) { enet_packet_destroy(event.packet); };
-
-        auto packet = NetPacket::from_packet(event.packet);
-        if (!packet.has_value()) {
-          OX_LOG_ERROR("Received a packet with bad data.");
-          break;
-        }
+  self.flush_rpcs();
 
-        self.handle_packet(packet.value());
-      } break;
-      case ENET_EVENT_TYPE_NONE: {
-      } break;
-    }
+  while (auto event = self.transport->poll()) {
+    self.handle_event(event.value());
   }
 
   self.update_stats();
@@ -128,10 +93,8 @@ auto NetClient::tick(this NetClient& self, const Timestep& ts) -> bool {
     if (self.timeout_elapsed >= self.timeout_max) {
       OX_LOG_ERROR("Connection attempt timed out after {:.1f}ms", self.timeout_elapsed);
 
-      if (self.remote_peer) {
-        enet_peer_reset(self.remote_peer);
-        self.remote_peer = nullptr;
-      }
+      self.transport->reset();
+      self.remote_peer = nullptr;
 
       self.status = NetClientStatus::TimedOut;
       self.timeout_elapsed = 0.0;
@@ -152,6 +115,62 @@ auto NetClient::tick(this NetClient& self, const Timestep& ts) -> bool {
   return false;
 }
 
+auto NetClient::handle_event(this NetClient& self, NetIOEvent& event) -> void {
+  ZoneScoped;
+
+  switch (event.kind) {
+    case NetEventKind::Connect: {
+      ZoneScopedN("NetEventKind::Connect");
+      // A connection that was given up on meanwhile is dropped.
+      if (self.status != NetClientStatus::Connecting) {
+        self.transport->disconnect(event.peer, true, 0);
+        break;
+      }
+
+      OX_LOG_INFO("NetClient connected.");
+      self.status = NetClientStatus::Connected;
+      self.remote_peer = event.peer;
+
+      auto handshake = NetHandshakePacket{.version = 1, .procs = self.proc_hashes};
+      if (self.compressor) {
+        handshake.compression = self.compressor->supported();
+        handshake.dictionary_id = self.compressor->dictionary_id();
+      }
+      if (auto handshake_packet = NetPacket::handshake(handshake)) {
+        self.send_reliable(handshake_packet.value());
+      }
+    } break;
+    case NetEventKind::Disconnect: {
+      ZoneScopedN("NetEventKind::Disconnect");
+      OX_LOG_INFO("NetClient disconnected.");
+
+      self.status = NetClientStatus::Disconnected;
+      self.remote_peer = nullptr;
+      if (event.peer) {
+        event.peer->data = nullptr;
+      }
+
+      auto& es = App::get_event_system();
+      std::ignore = es.emit<ServerDisconnectEvent>({.client = &self, .reason = NetClientStatus::Disconnected});
+    } break;
+    case NetEventKind::Receive: {
+      ZoneScopedN("NetEventKind::Receive");
+      OX_DEFER(&) { enet_packet_destroy(event.packet); };
+
+      auto packet = NetPacket::from_packet(event.packet);
+      if (!packet.has_value()) {
+        OX_LOG_ERROR("Received a packet with bad data.");
+        break;
+      }
+
+      self.handle_packet(packet.value());
+    } break;
+    case NetEventKind::Stats: {
+      self.update_stats(event.counters);
+    } break;
+  }
+}
+
 auto NetClient::handle_packet(this NetClient& self, NetPacket& packet) -> void {
   ZoneScoped;
 
@@ -163,6 +182,14 @@ auto NetClient::handle_packet(this NetClient& self, NetPacket& packet) -> void {
       }
 
       self.net_id = handshake->net_id;
+      self.remote_proc_ids.clear();
+      for (u32 i = 0; i < handshake->procs.size(); i++) {
+        self.remote_proc_ids.emplace(handshake->procs[i], i);
+      }
+      // The server only lists the codec it picked, this lands on the same one.
+      if (self.compressor) {
+        self.compression = self.compressor->negotiate(handshake->compression, handshake->dictionary_id);
+      }
       self.status = NetClientStatus::Connected;
 
       auto& es = App::get_event_system();
@@ -174,13 +201,54 @@ auto NetClient::handle_packet(this NetClient& self, NetPacket& packet) -> void {
         return;
       }
 
-      // TODO: Copying the whole scene snapshot...
+      if (self.interpolator) {
+        self.interpolator->push(snapshot->sequence, snapshot->state);
+      }
+
       auto& es = App::get_event_system();
       std::ignore = es.emit<ClientSceneSnapshotEvent>(
-        ClientSceneSnapshotEvent(&self, snapshot->sequence, snapshot->state)
+        ClientSceneSnapshotEvent(&self, snapshot->sequence, &snapshot->state)
       );
 
-      self.on_scene_snapshot(snapshot->sequence, std::move(snapshot->state));
+      self.on_scene_snapshot(snapshot->sequence, snapshot->state);
+    } break;
+    case NetPacketType::SceneDelta: {
+      auto delta = packet.get_scene_delta();
+      if (!delta.has_value() || !self.snapshot_codec) {
+        return;
+      }
+
+      const SceneState* baseline = nullptr;
+      if (delta->has_baseline) {
+        baseline = self.snapshots.find(delta->baseline_sequence);
+        // Stays unacked, the server keeps encoding against our last ack or falls back to a full state.
+        if (!baseline) {
+          return;
+        }
+      }
+
+      // Decoded straight into the ring slot it is kept in, unless that slot still holds the baseline.
+      const auto* slot = &self.snapshots.states[delta->sequence % SceneSnapshotBuilder::MAX_SEQUENCES];
+      auto& state = slot == baseline ? self.decode_scratch : self.snapshots.claim(delta->sequence);
+      if (!self.snapshot_codec->decode(baseline, delta->payload, state)) {
+        OX_LOG_ERROR("Received a malformed scene delta.");
+        return;
+      }
+
+      self.snapshots.store(delta->sequence, state);
+      if (auto ack_packet = NetPacket::client_ack({.acked = delta->sequence})) {
+        self.send_unreliable(ack_packet.value());
+      }
+
+      const auto* stored = self.snapshots.find(delta->sequence);
+      if (self.interpolator) {
+        self.interpolator->push(delta->sequence, *stored);
+      }
+
+      auto& es = App::get_event_system();
+      std::ignore = es.emit<ClientSceneSnapshotEvent>(ClientSceneSnapshotEvent(&self, delta->sequence, stored));
+
+      self.on_scene_snapshot(delta->sequence, *stored);
     } break;
     case NetPacketType::ClientAck: {
       // Not our job
@@ -191,63 +259,85 @@ auto NetClient::handle_packet(this NetClient& self, NetPacket& packet) -> void {
         return;
       }
 
-      auto procs_it = self.rpcs.find(rpc->proc_hash);
-      if (procs_it == self.rpcs.end()) {
-        OX_LOG_ERROR("Server is trying to call an invalid proc!");
+      auto call = NetRPCCall{};
+      while (rpc->next(self.proc_hashes, call)) {
+        auto procs_it = self.rpcs.find(call.proc_hash);
+        if (procs_it == self.rpcs.end()) {
+          OX_LOG_ERROR("Server is trying to call an invalid proc!");
+          continue;
+        }
+
+        procs_it->second(NetClientID::Invalid, std::span(call.parameters));
+      }
+
+      if (rpc->call_count != 0) {
+        OX_LOG_ERROR("Server sent a malformed RPC batch!");
+      }
+    } break;
+    case NetPacketType::Compressed: {
+      if (!self.compressor) {
+        OX_LOG_ERROR("Server sent a compressed packet, but there's nothing to decompress it with!");
+        return;
+      }
+
+      auto decompressed = self.compressor->decompress(packet, self.compression);
+      if (!decompressed.has_value()) {
+        OX_LOG_ERROR("Server sent a malformed compressed packet!");
         return;
       }
 
-      procs_it->second(NetClientID::Invalid, std::span(rpc->parameters));
+      OX_DEFER(&) { enet_packet_destroy(decompressed->inner); };
+      self.handle_packet(decompressed.value());
     } break;
     case NetPacketType::Unknown: {
     } break;
   }
 }
 
+auto NetClient::ack_snapshot(this NetClient& self, u8 sequence) -> void {
+  ZoneScoped;
+
+  // Acks are unreliable and can arrive out of order, the baseline only ever moves forward.
+  if (self.has_baseline && static_cast<i8>(sequence - self.baseline_sequence) <= 0) {
+    return;
+  }
+
+  self.has_baseline = true;
+  self.baseline_sequence = sequence;
+}
+
 auto NetClient::add_builtin_procs(this NetClient& self) -> void { ZoneScoped; }
 
 auto NetClient::register_proc(this NetClient& self, std::string_view identifier, NetRPCPacket::Callback&& cb) -> void {
   ZoneScoped;
 
   auto hash = ankerl::unordered_dense::detail::wyhash::hash(identifier.data(), identifier.size());
-  self.rpcs.emplace(hash, std::move(cb));
+  if (self.rpcs.emplace(hash, std::move(cb)).second) {
+    self.proc_hashes.push_back(hash);
+  }
 }
 
 auto NetClient::send_reliable(this NetClient& self, NetPacket& packet) -> void {
   ZoneScoped;
 
   // Sends can outlive the peer, the connection may have dropped since the packet was built.
-  if (!self.remote_peer) {
-    if (packet.can_destroy()) {
-      packet.destroy();
-    }
-    return;
-  }
-
-  packet.inner->flags = ENET_PACKET_FLAG_RELIABLE;
-  if (enet_peer_send(self.remote_peer, NET_CHANNEL_RELIABLE, packet) < 0) {
-    if (packet.can_destroy()) {
-      packet.destroy();
-    }
-  }
+  self.transport->send(self.remote_peer, packet, true);
 }
 
 auto NetClient::send_unreliable(this NetClient& self, NetPacket& packet) -> void {
   ZoneScoped;
 
-  if (!self.remote_peer) {
-    if (packet.can_destroy()) {
-      packet.destroy();
-    }
-    return;
-  }
+  self.transport->send(self.remote_peer, packet, false);
+}
 
-  packet.inner->flags = 0;
-  if (enet_peer_send(self.remote_peer, NET_CHANNEL_UNRELIABLE, packet) < 0) {
-    if (packet.can_destroy()) {
-      packet.destroy();
-    }
+auto NetClient::compress(this NetClient& self, NetPacket& packet) -> bool {
+  ZoneScoped;
+
+  if (!self.compressor || self.compression == NetCompression::None) {
+    return false;
   }
+
+  return self.compressor->compress(packet, self.compression);
 }
 
 auto NetClient::call_server(
@@ -259,17 +349,51 @@ auto NetClient::call_server(
     return false;
   }
 
-  auto packet = NetPacket::rpc(proc, params);
-  if (!packet.has_value()) {
-    return false;
-  }
+  self.rpc_params_scratch.clear();
+  encode_rpc_parameters(params, self.rpc_params_scratch);
+  const auto hash = ankerl::unordered_dense::detail::wyhash::hash(proc.data(), proc.size());
+  self.queue_rpc(hash, self.rpc_params_scratch, reliable);
+
+  return true;
+}
 
-  if (reliable) {
-    self.send_reliable(packet.value());
-  } else {
-    self.send_unreliable(packet.value());
+auto NetClient::queue_rpc(this NetClient& self, u64 proc_hash, std::span<const u8> encoded_params, bool reliable)
+  -> void {
+  ZoneScoped;
+
+  const auto channel = reliable ? NET_CHANNEL_RELIABLE : NET_CHANNEL_UNRELIABLE;
+  auto& batch = self.rpc_batches[channel];
+  // Worst case header of one call is its id or hash.
+  const auto call_size = MAX_VARINT_SIZE + sizeof(u64) + encoded_params.size();
+  if (!batch.empty() && batch.bytes.size() + call_size > RPCBatch::MAX_SIZE) {
+    self.flush_rpcs();
   }
 
-  return true;
+  const auto proc_id_it = self.remote_proc_ids.find(proc_hash);
+  const auto has_proc_id = proc_id_it != self.remote_proc_ids.end();
+  batch.push(has_proc_id ? option<u32>(proc_id_it->second) : option<u32>(nullopt), proc_hash, encoded_params);
+}
+
+auto NetClient::flush_rpcs(this NetClient& self) -> void {
+  ZoneScoped;
+
+  for (u32 channel = 0; channel < NET_CHANNEL_COUNT; channel++) {
+    auto& batch = self.rpc_batches[channel];
+    if (batch.empty()) {
+      continue;
+    }
+
+    if (self.remote_peer) {
+      if (auto packet = NetPacket::rpc_batch(batch)) {
+        if (channel == NET_CHANNEL_RELIABLE) {
+          self.send_reliable(packet.value());
+        } else {
+          self.send_unreliable(packet.value());
+        }
+      }
+    }
+
+    batch.clear();
+  }
 }
 } // namespace ox
@@ -0,0 +1,257 @@
+#include "Networking/NetCompression.hpp"
+
+#include <array>
+#include <chrono>
+#include <cstring>
+#include <lz4.h>
+#include <numeric>
+#include <zdict.h>
+#include <zstd.h>
+
+#include "Core/Base.hpp"
+#include "Memory/Buffer.hpp"
+#include "Utils/Log.hpp"
+
+#ifndef ENET_FEATURE_ADDRESS_MAPPING
+  #define ENET_FEATURE_ADDRESS_MAPPING
+#endif
+
+#include <enet.h>
+
+namespace ox {
+namespace {
+auto elapsed_ms(std::chrono::steady_clock::time_point start) -> f64 {
+  return std::chrono::duration<f64, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+} // namespace
+
+NetCompressor::NetCompressor() :
+    zstd_compress_context(ZSTD_createCCtx()),
+    zstd_decompress_context(ZSTD_createDCtx()) {}
+
+NetCompressor::~NetCompressor() {
+  free_dictionaries();
+  ZSTD_freeCCtx(zstd_compress_context);
+  ZSTD_freeDCtx(zstd_decompress_context);
+}
+
+auto NetCompressor::set_dictionary(this NetCompressor& self, std::vector<u8> dictionary) -> bool {
+  ZoneScoped;
+
+  self.free_dictionaries();
+  self.dictionary = std::move(dictionary);
+  self.dictionary_id_ = 0;
+  if (self.dictionary.empty()) {
+    return true;
+  }
+
+  self.zstd_compress_dictionary = ZSTD_createCDict(self.dictionary.data(), self.dictionary.size(), self.zstd_level);
+  self.zstd_decompress_dictionary = ZSTD_createDDict(self.dictionary.data(), self.dictionary.size());
+  if (!self.zstd_compress_dictionary || !self.zstd_decompress_dictionary) {
+    OX_LOG_ERROR("Failed to load a zstd dictionary of {} bytes.", self.dictionary.size());
+    self.free_dictionaries();
+    self.dictionary.clear();
+    return false;
+  }
+
+  self.dictionary_id_ = ZSTD_getDictID_fromDict(self.dictionary.data(), self.dictionary.size());
+  return true;
+}
+
+auto NetCompressor::dictionary_id(this const NetCompressor& self) -> u32 { return self.dictionary_id_; }
+
+auto NetCompressor::supported(this const NetCompressor& self) -> u8 {
+  auto mask = 0_u8;
+  if (self.enable_lz4) {
+    mask |= net_compression_bit(NetCompression::LZ4);
+  }
+  if (self.enable_zstd) {
+    mask |= net_compression_bit(NetCompression::Zstd);
+  }
+
+  return mask;
+}
+
+auto NetCompressor::negotiate(this const NetCompressor& self, u8 remote_supported, u32 remote_dictionary_id)
+  -> NetCompression {
+  const auto common = self.supported() & remote_supported;
+  if ((common & net_compression_bit(NetCompression::Zstd)) && remote_dictionary_id == self.dictionary_id_) {
+    return NetCompression::Zstd;
+  }
+  if (common & net_compression_bit(NetCompression::LZ4)) {
+    return NetCompression::LZ4;
+  }
+
+  return NetCompression::None;
+}
+
+auto NetCompressor::compress(this NetCompressor& self, NetPacket& packet, NetCompression codec) -> bool {
+  ZoneScoped;
+
+  const auto raw_size = packet.inner->dataLength;
+  if (codec == NetCompression::None || packet.type == NetPacketType::Compressed) {
+    return false;
+  }
+  if (raw_size < self.threshold || raw_size > MAX_DECOMPRESSED_SIZE) {
+    self.stats.skipped_packets += 1;
+    return false;
+  }
+
+  const auto start = std::chrono::steady_clock::now();
+  const auto* raw = packet.inner->data;
+  auto compressed_size = 0_sz;
+  if (codec == NetCompression::LZ4) {
+    self.scratch.resize(static_cast<usize>(LZ4_compressBound(static_cast<i32>(raw_size))));
+    const auto written = LZ4_compress_default(
+      reinterpret_cast<const char*>(raw),
+      reinterpret_cast<char*>(self.scratch.data()),
+      static_cast<i32>(raw_size),
+      static_cast<i32>(self.scratch.size())
+    );
+    compressed_size = written > 0 ? static_cast<usize>(written) : 0;
+  } else {
+    self.scratch.resize(ZSTD_compressBound(raw_size));
+    auto* destination = self.scratch.data();
+    const auto capacity = self.scratch.size();
+    auto* context = self.zstd_compress_context;
+    const auto written = self.zstd_compress_dictionary
+                           ? ZSTD_compress_usingCDict(
+                               context, destination, capacity, raw, raw_size, self.zstd_compress_dictionary
+                             )
+                           : ZSTD_compressCCtx(context, destination, capacity, raw, raw_size, self.zstd_level);
+    compressed_size = ZSTD_isError(written) ? 0 : written;
+  }
+
+  // Type, codec and the size it decompresses to.
+  auto header = std::array<u8, 2 + MAX_VARINT_SIZE>{};
+  auto header_writer = BufferWriter(header);
+  header_writer.write(NetPacketType::Compressed);
+  header_writer.write(codec);
+  header_writer.write_varint(raw_size);
+
+  const auto packet_size = header_writer.size() + compressed_size;
+  if (compressed_size == 0 || packet_size >= raw_size || raw_size > compressed_size * MAX_COMPRESSION_RATIO) {
+    self.stats.skipped_packets += 1;
+    self.stats.compress_ms += elapsed_ms(start);
+    return false;
+  }
+
+  auto* compressed = enet_packet_create(nullptr, packet_size, packet.inner->flags);
+  if (!compressed) {
+    return false;
+  }
+
+  std::memcpy(compressed->data, header.data(), header_writer.size());
+  std::memcpy(compressed->data + header_writer.size(), self.scratch.data(), compressed_size);
+  enet_packet_destroy(packet.inner);
+  packet = NetPacket{.type = NetPacketType::Compressed, .inner = compressed};
+
+  self.stats.compressed_packets += 1;
+  self.stats.raw_bytes += raw_size;
+  self.stats.compressed_bytes += packet_size;
+  self.stats.compress_ms += elapsed_ms(start);
+
+  return true;
+}
+
+auto NetCompressor::decompress(this NetCompressor& self, NetPacket& packet, NetCompression expected_codec)
+  -> option<NetPacket> {
+  ZoneScoped;
+
+  if (packet.type != NetPacketType::Compressed) {
+    return nullopt;
+  }
+
+  const auto start = std::chrono::steady_clock::now();
+  auto reader = BufferReader(packet.inner->data, packet.inner->dataLength);
+  auto codec = option<NetCompression>{};
+  auto raw_size = option<u64>{};
+  if (!reader.skip(sizeof(NetPacketType)) || !(codec = reader.read<NetCompression>()) ||
+      !(raw_size = reader.read_varint()) || *raw_size == 0 || *raw_size > MAX_DECOMPRESSED_SIZE) {
+    return nullopt;
+  }
+
+  // Checked before anything gets allocated for the output.
+  const auto* source = reader.data() + reader.offset;
+  const auto source_size = reader.remaining();
+  if (*codec != expected_codec || *codec == NetCompression::None || *raw_size > source_size * MAX_COMPRESSION_RATIO) {
+    return nullopt;
+  }
+
+  auto* raw = enet_packet_create(nullptr, *raw_size, packet.inner->flags);
+  if (!raw) {
+    return nullopt;
+  }
+
+  auto decompressed_size = 0_sz;
+  switch (*codec) {
+    case NetCompression::LZ4: {
+      const auto read = LZ4_decompress_safe(
+        reinterpret_cast<const char*>(source),
+        reinterpret_cast<char*>(raw->data),
+        static_cast<i32>(source_size),
+        static_cast<i32>(*raw_size)
+      );
+      decompressed_size = read > 0 ? static_cast<usize>(read) : 0;
+    } break;
+    case NetCompression::Zstd: {
+      auto* context = self.zstd_decompress_context;
+      const auto read = self.zstd_decompress_dictionary
+                          ? ZSTD_decompress_usingDDict(
+                              context, raw->data, *raw_size, source, source_size, self.zstd_decompress_dictionary
+                            )
+                          : ZSTD_decompressDCtx(context, raw->data, *raw_size, source, source_size);
+      decompressed_size = ZSTD_isError(read) ? 0 : read;
+    } break;
+    case NetCompression::None: break;
+  }
+
+  auto result = option<NetPacket>{};
+  if (decompressed_size == *raw_size) {
+    result = NetPacket::from_packet(raw);
+  }
+  // Nested compression would let a tiny packet expand without bound.
+  if (!result.has_value() || result->type == NetPacketType::Compressed) {
+    enet_packet_destroy(raw);
+    return nullopt;
+  }
+
+  self.stats.decompressed_packets += 1;
+  self.stats.decompress_ms += elapsed_ms(start);
+
+  return result;
+}
+
+auto NetCompressor::train_dictionary(std::span<const std::vector<u8>> samples, usize capacity) -> std::vector<u8> {
+  ZoneScoped;
+
+  auto sizes = std::vector<usize>{};
+  auto concatenated = std::vector<u8>{};
+  concatenated.reserve(std::accumulate(samples.begin(), samples.end(), 0_sz, [](usize sum, const auto& sample) {
+    return sum + sample.size();
+  }));
+  for (const auto& sample : samples) {
+    sizes.push_back(sample.size());
+    concatenated.insert(concatenated.end(), sample.begin(), sample.end());
+  }
+
+  auto dictionary = std::vector<u8>(capacity);
+  const auto size = ZDICT_trainFromBuffer(
+    dictionary.data(), dictionary.size(), concatenated.data(), sizes.data(), static_cast<u32>(sizes.size())
+  );
+  if (ZDICT_isError(size)) {
+    OX_LOG_ERROR("Failed to train a zstd dictionary: {}", ZDICT_getErrorName(size));
+    return {};
+  }
+
+  dictionary.resize(size);
+  return dictionary;
+}
+
+auto NetCompressor::free_dictionaries(this NetCompressor& self) -> void {
+  ZSTD_freeCDict(self.zstd_compress_dictionary);
+  ZSTD_freeDDict(self.zstd_decompress_dictionary);
+  self.zstd_compress_dictionary = nullptr;
+  self.zstd_decompress_dictionary = nullptr;
+}
+} // namespace ox
@@ -0,0 +1,227 @@
+#include "Networking/NetIOThread.hpp"
+
+#include <chrono>
+
+#include "Core/Base.hpp"
+#include "OS/OS.hpp"
+#include "Utils/Log.hpp"
+
+#ifndef ENET_FEATURE_ADDRESS_MAPPING
+  #define ENET_FEATURE_ADDRESS_MAPPING
+#endif
+
+#include <enet.h>
+
+namespace ox {
+auto read_peer_counters(const ENetPeer* peer) -> NetPeerCounters {
+  return {
+    .sent_bytes = peer->totalDataSent,
+    .received_bytes = peer->totalDataReceived,
+    .sent_packets = peer->packetsSent,
+    .packets_lost = peer->packetsLost,
+    .ping_interval = peer->pingInterval,
+    .rtt = peer->roundTripTime,
+    .rtt_variance = peer->roundTripTimeVariance,
+  };
+}
+
+auto to_net_io_event(const ENetEvent& event) -> NetIOEvent {
+  auto io_event = NetIOEvent{.peer = event.peer, .packet = event.packet, .data = event.data};
+  switch (event.type) {
+    case ENET_EVENT_TYPE_CONNECT           : io_event.kind = NetEventKind::Connect; break;
+    case ENET_EVENT_TYPE_DISCONNECT_TIMEOUT:
+    case ENET_EVENT_TYPE_DISCONNECT        : io_event.kind = NetEventKind::Disconnect; break;
+    case ENET_EVENT_TYPE_RECEIVE           : io_event.kind = NetEventKind::Receive; break;
+    case ENET_EVENT_TYPE_NONE              : break;
+  }
+
+  return io_event;
+}
+
+auto send_peer_packet(ENetPeer* peer, ENetPacket* packet, bool reliable) -> void {
+  ZoneScoped;
+
+  const auto channel = reliable ? NET_CHANNEL_RELIABLE : NET_CHANNEL_UNRELIABLE;
+  packet->flags = reliable ? ENET_PACKET_FLAG_RELIABLE : 0;
+  const auto sent = peer && enet_peer_send(peer, static_cast<u8>(channel), packet) >= 0;
+  if (!sent && packet->referenceCount == 0) {
+    enet_packet_destroy(packet);
+  }
+}
+
+auto broadcast_host_packet(ENetHost* host, ENetPacket* packet, bool reliable) -> void {
+  ZoneScoped;
+
+  const auto channel = reliable ? NET_CHANNEL_RELIABLE : NET_CHANNEL_UNRELIABLE;
+  packet->flags = reliable ? ENET_PACKET_FLAG_RELIABLE : 0;
+  // enet_host_broadcast owns the packet from here on, including destroying it when there are no peers.
+  enet_host_broadcast(host, static_cast<u8>(channel), packet);
+}
+
+auto release_packet(ENetPacket* packet) -> void {
+  ZoneScoped;
+
+  if (packet->referenceCount > 0) {
+    packet->referenceCount -= 1;
+  }
+  if (packet->referenceCount == 0) {
+    enet_packet_destroy(packet);
+  }
+}
+
+auto reset_host_peers(ENetHost* host) -> void {
+  ZoneScoped;
+
+  for (auto i = 0_sz; i < host->peerCount; i++) {
+    auto* peer = &host->peers[i];
+    if (peer->state != ENET_PEER_STATE_DISCONNECTED) {
+      enet_peer_reset(peer);
+    }
+  }
+}
+
+NetIOThread::~NetIOThread() { stop(); }
+
+auto NetIOThread::start(this NetIOThread& self) -> void {
+  ZoneScoped;
+
+  OX_ASSERT(!self.is_running());
+  self.thread = std::jthread([&self](std::stop_token stop_token) { self.run(stop_token); });
+}
+
+auto NetIOThread::stop(this NetIOThread& self) -> void {
+  ZoneScoped;
+
+  if (!self.is_running()) {
+    return;
+  }
+
+  self.thread.request_stop();
+  self.thread.join();
+
+  while (auto event = self.events.try_pop()) {
+    if (event->packet) {
+      enet_packet_destroy(event->packet);
+    }
+  }
+  for (auto& event : self.overflow) {
+    if (event.packet) {
+      enet_packet_destroy(event.packet);
+    }
+  }
+  self.overflow.clear();
+}
+
+auto NetIOThread::push(this NetIOThread& self, NetIOCommand&& command) -> void {
+  ZoneScoped;
+
+  while (!self.commands.try_push(std::move(command))) {
+    std::this_thread::yield();
+  }
+}
+
+auto NetIOThread::send(this NetIOThread& self, ENetPeer* peer, ENetPacket* packet, bool reliable) -> void {
+  self.push({.kind = NetIOCommandKind::Send, .reliable = reliable, .peer = peer, .packet = packet});
+}
+
+auto NetIOThread::broadcast(this NetIOThread& self, ENetPacket* packet, bool reliable) -> void {
+  self.push({.kind = NetIOCommandKind::Broadcast, .reliable = reliable, .packet = packet});
+}
+
+auto NetIOThread::release(this NetIOThread& self, ENetPacket* packet) -> void {
+  self.push({.kind = NetIOCommandKind::Release, .packet = packet});
+}
+
+auto NetIOThread::run(this NetIOThread& self, std::stop_token stop_token) -> void {
+  os::set_thread_name("Net I/O");
+
+  auto last_stats = std::chrono::steady_clock::now();
+  auto event = ENetEvent{};
+  while (!stop_token.stop_requested()) {
+    ZoneScopedN("NetIOThread::run");
+
+    self.flush_overflow();
+
+    auto has_commands = false;
+    while (auto command = self.commands.try_pop()) {
+      self.execute(command.value());
+      has_commands = true;
+    }
+
+    // Out right away rather than on the next service call.
+    if (has_commands) {
+      enet_host_flush(self.host);
+    }
+
+    auto timeout = SERVICE_TIMEOUT_MS;
+    while (enet_host_service(self.host, &event, timeout) > 0) {
+      timeout = 0;
+      self.publish(to_net_io_event(event));
+    }
+
+    const auto now = std::chrono::steady_clock::now();
+    // Stats only go out while the game thread keeps up, they are stale by the time it catches up.
+    if (std::chrono::duration<f64, std::milli>(now - last_stats).count() >= STATS_INTERVAL_MS &&
+        self.overflow.empty()) {
+      last_stats = now;
+      for (auto i = 0_sz; i < self.host->peerCount; i++) {
+        auto* peer = &self.host->peers[i];
+        if (peer->state == ENET_PEER_STATE_CONNECTED) {
+          self.publish({.kind = NetEventKind::Stats, .peer = peer, .counters = read_peer_counters(peer)});
+        }
+      }
+    }
+  }
+
+  // Disconnects and the last sends still have to reach ENet before the host goes away.
+  while (auto command = self.commands.try_pop()) {
+    self.execute(command.value());
+  }
+  enet_host_flush(self.host);
+}
+
+auto NetIOThread::execute(this NetIOThread& self, NetIOCommand& command) -> void {
+  ZoneScoped;
+
+  switch (command.kind) {
+    case NetIOCommandKind::Send     : send_peer_packet(command.peer, command.packet, command.reliable); break;
+    case NetIOCommandKind::Broadcast: broadcast_host_packet(self.host, command.packet, command.reliable); break;
+    case NetIOCommandKind::Release  : release_packet(command.packet); break;
+    case NetIOCommandKind::Connect: {
+      auto address = ENetAddress{};
+      enet_address_set_host(&address, command.host_name.c_str());
+      address.port = command.port;
+      // The peer is handed over with the connect event, a failed attempt shows up as a disconnect.
+      if (!enet_host_connect(self.host, &address, NET_CHANNEL_COUNT, 0)) {
+        self.publish({.kind = NetEventKind::Disconnect});
+      }
+    } break;
+    case NetIOCommandKind::DisconnectNow: {
+      enet_peer_disconnect_now(command.peer, command.data);
+    } break;
+    case NetIOCommandKind::DisconnectLater: {
+      enet_peer_disconnect_later(command.peer, command.data);
+    } break;
+    case NetIOCommandKind::Reset: {
+      reset_host_peers(self.host);
+    } break;
+  }
+}
+
+auto NetIOThread::publish(this NetIOThread& self, NetIOEvent&& event) -> void {
+  ZoneScoped;
+
+  // Behind whatever is already waiting, so the game thread still sees events in order.
+  if (!self.overflow.empty() || !self.events.try_push(std::move(event))) {
+    self.overflow.push_back(std::move(event));
+  }
+}
+
+auto NetIOThread::flush_overflow(this NetIOThread& self) -> void {
+  ZoneScoped;
+
+  while (!self.overflow.empty() && self.events.try_push(std::move(self.overflow.front()))) {
+    self.overflow.pop_front();
+  }
+}
+} // namespace ox
@@ -1,7 +1,13 @@
 #include "Networking/NetPacket.hpp"
 
+#include <algorithm>
+#include <ankerl/unordered_dense.h>
+#include <array>
 #include <enet.h>
+#include <glm/common.hpp>
+#include <utility>
 
+#include "Memory/Buffer.hpp"
 #include "Utils/Log.hpp"
 
 namespace ox {
@@ -9,26 +15,46 @@ constexpr auto MAX_PACKET_ALLOC_SIZE = 16_sz * 1024 * 1024;
 using SizeOption = zpp::bits::options::size_varint;
 using AllocLimitOption = zpp::bits::alloc_limit<MAX_PACKET_ALLOC_SIZE>;
 
+constexpr auto MIN_PACKET_CAPACITY = 64_sz;
+
+// Packets are serialized straight into the buffer of the ENet packet that gets sent. One that turns
+// out too small is thrown away and redone at twice the size, the hints remember how big each type
+// tends to get so that rarely happens twice.
 template <typename... T>
 auto serialize_packet(NetPacketType type, const T&... payload) -> option<NetPacket> {
   ZoneScoped;
 
-  auto [data, ser] = zpp::bits::data_out(SizeOption{});
-  if (zpp::bits::failure(ser(type, payload...))) {
-    OX_LOG_ERROR("Failed to serialize packet.");
-    return nullopt;
-  }
-
-  auto* packet = enet_packet_create(data.data(), data.size(), 0);
-  if (!packet) {
-    return nullopt;
+  thread_local auto size_hints = std::array<usize, 256>{};
+  auto& size_hint = size_hints[std::to_underlying(type)];
+  for (auto capacity = glm::max(size_hint, MIN_PACKET_CAPACITY); capacity <= MAX_PACKET_ALLOC_SIZE; capacity *= 2) {
+    auto* packet = enet_packet_create(nullptr, capacity, 0);
+    if (!packet) {
+      return nullopt;
+    }
+
+    auto bytes = std::span(packet->data, packet->dataLength);
+    auto ser = zpp::bits::out(bytes, SizeOption{});
+    const auto result = ser(type, payload...);
+    if (zpp::bits::success(result)) {
+      // Only ever shrinks, the rest of the buffer goes back with the packet.
+      packet->dataLength = ser.position();
+      size_hint = ser.position() + ser.position() / 4;
+      return NetPacket{.type = type, .inner = packet};
+    }
+
+    enet_packet_destroy(packet);
+    if (result.code != std::errc::result_out_of_range) {
+      break;
+    }
   }
 
-  return NetPacket{.type = type, .inner = packet};
+  OX_LOG_ERROR("Failed to serialize packet.");
+  return nullopt;
 }
 
+// `position` is where the reader stopped, anything after it is left to the caller.
 template <typename... T>
-auto deserialize_packet(NetPacket& self, NetPacketType type, T&... payload) -> bool {
+auto deserialize_packet_at(NetPacket& self, NetPacketType type, usize& position, T&... payload) -> bool {
   ZoneScoped;
 
   if (self.type != type) {
@@ -40,7 +66,18 @@ auto deserialize_packet(NetPacket& self, NetPacketType type, T&... payload) -> b
 
   // The type is part of the payload, it has already been peeked at by `from_packet`.
   auto packet_type = NetPacketType::Unknown;
-  return !zpp::bits::failure(deser(packet_type, payload...));
+  if (zpp::bits::failure(deser(packet_type, payload...))) {
+    return false;
+  }
+
+  position = deser.position();
+  return true;
+}
+
+template <typename... T>
+auto deserialize_packet(NetPacket& self, NetPacketType type, T&... payload) -> bool {
+  auto position = 0_sz;
+  return deserialize_packet_at(self, type, position, payload...);
 }
 
 auto RPCParameter::as_f32(this const RPCParameter& self) -> option<const f32> {
@@ -62,7 +99,7 @@ auto RPCParameter::as_int64(this const RPCParameter& self) -> option<const i64>
 }
 
 auto RPCParameter::as_str(this const RPCParameter& self) -> std::string_view {
-  const auto* v = std::get_if<std::string>(&self.value);
+  const auto* v = std::get_if<std::string_view>(&self.value);
   if (!v) {
     return {};
   }
@@ -80,6 +117,179 @@ auto RPCParameter::as_uuid(this const RPCParameter& self) -> option<UUID> {
   return UUID::from_bytes(bytes);
 }
 
+auto encode_rpc_parameters(std::span<const RPCParameter> params, std::vector<u8>& out) -> void {
+  ZoneScoped;
+
+  auto max_size = MAX_VARINT_SIZE;
+  for (const auto& param : params) {
+    max_size += 1 + MAX_VARINT_SIZE + 16;
+    if (const auto* str = std::get_if<std::string_view>(&param.value)) {
+      max_size += str->size();
+    } else if (const auto* bytes = std::get_if<std::span<const u8>>(&param.value)) {
+      max_size += bytes->size();
+    }
+  }
+
+  const auto start = out.size();
+  out.resize(start + max_size);
+  auto writer = BufferWriter(std::span(out).subspan(start));
+
+  // Integers go out as varints, most values scripts pass around are small.
+  auto ok = writer.write_varint(params.size());
+  for (const auto& param : params) {
+    ok &= writer.write(static_cast<u8>(param.value.index()));
+    std::visit(
+      [&](const auto& value) {
+        using T = std::decay_t<decltype(value)>;
+        if constexpr (std::is_same_v<T, std::monostate>) {
+        } else if constexpr (std::is_same_v<T, u16>) {
+          ok &= writer.write_varint(value);
+        } else if constexpr (std::is_same_v<T, i32> || std::is_same_v<T, i64>) {
+          ok &= writer.write_varint(zigzag_encode(value));
+        } else if constexpr (std::is_same_v<T, std::string_view> || std::is_same_v<T, std::span<const u8>>) {
+          ok &= writer.write_varint(value.size());
+          ok &= writer.write_bytes(value.data(), value.size()) || value.empty();
+        } else {
+          ok &= writer.write(value);
+        }
+      },
+      param.value
+    );
+  }
+
+  OX_ASSERT(ok);
+  out.resize(start + writer.size());
+}
+
+auto RPCBatch::push(this RPCBatch& self, option<u32> proc_id, u64 proc_hash, std::span<const u8> encoded_params)
+  -> void {
+  ZoneScoped;
+
+  const auto start = self.bytes.size();
+  self.bytes.resize(start + MAX_VARINT_SIZE + sizeof(u64) + encoded_params.size());
+  auto writer = BufferWriter(std::span(self.bytes).subspan(start));
+
+  // 0 is reserved for calls by hash, ids are shifted up by one.
+  auto ok = true;
+  if (proc_id.has_value()) {
+    ok &= writer.write_varint(static_cast<u64>(*proc_id) + 1);
+  } else {
+    ok &= writer.write_varint(0);
+    ok &= writer.write(proc_hash);
+  }
+  ok &= writer.write_span(encoded_params);
+
+  OX_ASSERT(ok);
+  self.bytes.resize(start + writer.size());
+  self.call_count += 1;
+}
+
+auto RPCBatch::clear(this RPCBatch& self) -> void {
+  self.call_count = 0;
+  self.bytes.clear();
+}
+
+auto NetRPCPacket::next(this NetRPCPacket& self, std::span<const u64> proc_hashes, NetRPCCall& call) -> bool {
+  ZoneScoped;
+
+  if (self.call_count == 0) {
+    return false;
+  }
+
+  auto reader = BufferReader(self.calls);
+  const auto proc = reader.read_varint();
+  if (!proc.has_value()) {
+    return false;
+  }
+
+  call.proc_hash = 0;
+  if (*proc == 0) {
+    const auto proc_hash = reader.read<u64>();
+    if (!proc_hash.has_value()) {
+      return false;
+    }
+    call.proc_hash = *proc_hash;
+  } else if (*proc - 1 < proc_hashes.size()) {
+    call.proc_hash = proc_hashes[*proc - 1];
+  }
+
+  // Each parameter takes at least its tag byte.
+  const auto param_count = reader.read_varint();
+  if (!param_count.has_value() || *param_count > reader.remaining()) {
+    return false;
+  }
+
+  call.parameters.clear();
+  for (auto i = 0_u64; i < *param_count; i++) {
+    const auto tag = reader.read<u8>();
+    if (!tag.has_value()) {
+      return false;
+    }
+
+    // Tags are `RPCParameter::Value` alternative indices, see `encode_rpc_parameters`.
+    auto& param = call.parameters.emplace_back();
+    auto ok = true;
+    switch (*tag) {
+      case 0: break;
+      case 1: {
+        const auto value = reader.read<u8>();
+        ok = value.has_value();
+        param.value = value.value_or(0);
+      } break;
+      case 2: {
+        const auto value = reader.read_varint();
+        ok = value.has_value() && *value <= std::numeric_limits<u16>::max();
+        param.value = static_cast<u16>(value.value_or(0));
+      } break;
+      case 3: {
+        const auto value = reader.read_varint();
+        ok = value.has_value() && *value <= std::numeric_limits<u32>::max();
+        param.value = zigzag_decode(static_cast<u32>(value.value_or(0)));
+      } break;
+      case 4: {
+        const auto value = reader.read_varint();
+        ok = value.has_value();
+        param.value = zigzag_decode(value.value_or(0));
+      } break;
+      case 5: {
+        const auto value = reader.read<f32>();
+        ok = value.has_value();
+        param.value = value.value_or(0.0f);
+      } break;
+      case 6: {
+        const auto value = reader.read<f64>();
+        ok = value.has_value();
+        param.value = value.value_or(0.0);
+      } break;
+      case 7:
+      case 9: {
+        const auto size = reader.read_varint();
+        const auto bytes = size.has_value() ? reader.read_span(*size) : nullopt;
+        ok = bytes.has_value();
+        if (ok && *tag == 7) {
+          param.value = std::string_view(reinterpret_cast<const c8*>(bytes->data()), bytes->size());
+        } else if (ok) {
+          param.value = *bytes;
+        }
+      } break;
+      case 8: {
+        const auto value = reader.read<std::array<u8, 16>>();
+        ok = value.has_value();
+        param.value = value.value_or(std::array<u8, 16>{});
+      } break;
+      default: ok = false; break;
+    }
+
+    if (!ok) {
+      return false;
+    }
+  }
+
+  self.calls = self.calls.subspan(reader.offset);
+  self.call_count -= 1;
+  return true;
+}
+
 auto NetPacket::handshake(const NetHandshakePacket& info) -> option<NetPacket> {
   ZoneScoped;
 
@@ -98,11 +308,63 @@ auto NetPacket::client_ack(const NetClientAckPacket& info) -> option<NetPacket>
   return serialize_packet(NetPacketType::ClientAck, info);
 }
 
+auto NetPacket::scene_delta(const NetSceneDeltaPacket& info) -> option<NetPacket> {
+  ZoneScoped;
+
+  // The payload isn't size prefixed, it is the rest of the packet. That is what lets the receiver
+  // look at it in place.
+  constexpr auto MAX_HEADER_SIZE = 16_sz;
+  auto* packet = enet_packet_create(nullptr, MAX_HEADER_SIZE + info.payload.size(), 0);
+  if (!packet) {
+    return nullopt;
+  }
+
+  auto bytes = std::span(packet->data, packet->dataLength);
+  auto ser = zpp::bits::out(bytes, SizeOption{});
+  if (zpp::bits::failure(ser(NetPacketType::SceneDelta, info.sequence, info.has_baseline, info.baseline_sequence))) {
+    OX_LOG_ERROR("Failed to serialize packet.");
+    enet_packet_destroy(packet);
+    return nullopt;
+  }
+
+  std::ranges::copy(info.payload, bytes.subspan(ser.position()).begin());
+  packet->dataLength = ser.position() + info.payload.size();
+
+  return NetPacket{.type = NetPacketType::SceneDelta, .inner = packet};
+}
+
 auto NetPacket::rpc(std::string_view proc, std::span<const RPCParameter> params) -> option<NetPacket> {
   ZoneScoped;
 
+  auto encoded_params = std::vector<u8>{};
+  encode_rpc_parameters(params, encoded_params);
+
+  auto batch = RPCBatch{};
   const auto proc_hash = ankerl::unordered_dense::detail::wyhash::hash(proc.data(), proc.size());
-  return serialize_packet(NetPacketType::RPC, proc_hash, params);
+  batch.push(nullopt, proc_hash, encoded_params);
+
+  return rpc_batch(batch);
+}
+
+auto NetPacket::rpc_batch(const RPCBatch& batch) -> option<NetPacket> {
+  ZoneScoped;
+
+  auto* packet = enet_packet_create(nullptr, 1 + MAX_VARINT_SIZE + batch.bytes.size(), 0);
+  if (!packet) {
+    return nullopt;
+  }
+
+  auto writer = BufferWriter(packet->data, packet->dataLength);
+  auto ok = writer.write(NetPacketType::RPC);
+  ok &= writer.write_varint(batch.call_count);
+  ok &= writer.write_span(batch.bytes);
+  if (!ok) {
+    enet_packet_destroy(packet);
+    return nullopt;
+  }
+
+  packet->dataLength = writer.size();
+  return NetPacket{.type = NetPacketType::RPC, .inner = packet};
 }
 
 auto NetPacket::from_packet(ENetPacket* packet) -> option<NetPacket> {
@@ -156,7 +418,7 @@ auto NetPacket::get_scene_snapshot(this NetPacket& self) -> option<NetSceneSnaps
   ZoneScoped;
 
   auto info = NetSceneSnapshotPacket{};
-  if (!deserialize_packet(self, NetPacketType::SceneSnapshot, info.sequence, info.state)) {
+  if (!deserialize_packet(self, NetPacketType::SceneSnapshot, info.sequence, info.state) || !info.state.is_valid()) {
     return nullopt;
   }
 
@@ -174,14 +436,42 @@ auto NetPacket::get_client_ack(this NetPacket& self) -> option<NetClientAckPacke
   return info;
 }
 
-auto NetPacket::get_rpc(this NetPacket& self) -> option<NetRPCPacket> {
+auto NetPacket::get_scene_delta(this NetPacket& self) -> option<NetSceneDeltaPacket> {
   ZoneScoped;
 
-  auto info = NetRPCPacket{};
-  if (!deserialize_packet(self, NetPacketType::RPC, info.proc_hash, info.parameters)) {
+  auto info = NetSceneDeltaPacket{};
+  auto position = 0_sz;
+  if (!deserialize_packet_at(
+        self, NetPacketType::SceneDelta, position, info.sequence, info.has_baseline, info.baseline_sequence
+      )) {
     return nullopt;
   }
 
+  info.payload = std::span(self.inner->data, self.inner->dataLength).subspan(position);
   return info;
 }
+
+auto NetPacket::get_rpc(this NetPacket& self) -> option<NetRPCPacket> {
+  ZoneScoped;
+
+  if (self.type != NetPacketType::RPC) {
+    return nullopt;
+  }
+
+  auto reader = BufferReader(self.inner->data, self.inner->dataLength);
+  auto call_count = option<u64>{};
+  if (!reader.skip(sizeof(NetPacketType)) || !(call_count = reader.read_varint())) {
+    return nullopt;
+  }
+
+  // Every call takes at least two bytes, anything claiming more calls than that is garbage.
+  if (*call_count > reader.remaining() / 2) {
+    return nullopt;
+  }
+
+  return NetRPCPacket{
+    .call_count = static_cast<u32>(*call_count),
+    .calls = reader.buffer.subspan(reader.offset),
+  };
+}
 } // namespace ox
@@ -17,47 +17,10 @@ auto NetServer::set_tick_rate(this NetServer& self, f64 tick_rate) -> void {
 auto NetServer::tick(this NetServer& self, const Timestep& ts) -> bool {
   ZoneScoped;
 
-  auto event = ENetEvent{};
-  while (enet_host_service(self.local_host, &event, 0) > 0) {
-    switch (event.type) {
-      case ENET_EVENT_TYPE_CONNECT: {
-        ZoneScopedN("ENET_EVENT_TYPE_CONNECT");
-        OX_LOG_INFO("New client(peer: {}) connected.", static_cast<void*>(event.peer));
-      } break;
-      case ENET_EVENT_TYPE_DISCONNECT_TIMEOUT:
-      case ENET_EVENT_TYPE_DISCONNECT        : {
-        ZoneScopedN("ENET_EVENT_TYPE_DISCONNECT");
-        auto* remote_peer = event.peer;
-
-        auto client_id = NetClientID::Invalid;
-        if (remote_peer->data) {
-          client_id = static_cast<NetClientID>(reinterpret_cast<uptr>(remote_peer->data));
-        }
-
-        auto& es = App::get_event_system();
-        std::ignore = es.emit<ClientDisconnectEvent>({.server = &self, .client_id = client_id});
-
-        self.on_client_disconnect(client_id);
-        self.remote_clients.destroy_slot(client_id);
-
-        event.peer->data = nullptr;
-        OX_LOG_INFO("Client(peer: {}) disconnected.", static_cast<void*>(event.peer));
-      } break;
-      case ENET_EVENT_TYPE_RECEIVE: {
-        ZoneScopedN("ENET_EVENT_TYPE_RECEIVE");
-        OX_DEFER(&) { enet_packet_destroy(event.packet); };
-        auto packet = NetPacket::from_packet(event.packet);
-        auto* remote_peer = event.peer;
-        if (!packet.has_value()) {
-          OX_LOG_ERROR("Received a packet with bad data.");
-          break;
-        }
+  self.flush_rpcs();
 
-        self.handle_packet(remote_peer, packet.value());
-      } break;
-      case ENET_EVENT_TYPE_NONE: {
-      } break;
-    }
+  while (auto event = self.transport->poll()) {
+    self.handle_event(event.value());
   }
 
   self.remote_clients.for_each_active([](usize, NetClient& client) { client.update_stats(); });
@@ -71,6 +34,58 @@ auto NetServer::tick(this NetServer& self, const Timestep& ts) -> bool {
   return false;
 }
 
+auto NetServer::handle_event(this NetServer& self, NetIOEvent& event) -> void {
+  ZoneScoped;
+
+  switch (event.kind) {
+    case NetEventKind::Connect: {
+      ZoneScopedN("NetEventKind::Connect");
+      OX_LOG_INFO("New client(peer: {}) connected.", static_cast<void*>(event.peer));
+    } break;
+    case NetEventKind::Disconnect: {
+      ZoneScopedN("NetEventKind::Disconnect");
+      auto* remote_peer = event.peer;
+
+      auto client_id = NetClientID::Invalid;
+      if (remote_peer->data) {
+        client_id = static_cast<NetClientID>(reinterpret_cast<uptr>(remote_peer->data));
+      }
+
+      auto& es = App::get_event_system();
+      std::ignore = es.emit<ClientDisconnectEvent>({.server = &self, .client_id = client_id});
+
+      self.on_client_disconnect(client_id);
+      self.remote_clients.destroy_slot(client_id);
+
+      event.peer->data = nullptr;
+      OX_LOG_INFO("Client(peer: {}) disconnected.", static_cast<void*>(event.peer));
+    } break;
+    case NetEventKind::Receive: {
+      ZoneScopedN("NetEventKind::Receive");
+      OX_DEFER(&) { enet_packet_destroy(event.packet); };
+      auto packet = NetPacket::from_packet(event.packet);
+      auto* remote_peer = event.peer;
+      if (!packet.has_value()) {
+        OX_LOG_ERROR("Received a packet with bad data.");
+        break;
+      }
+
+      self.handle_packet(remote_peer, packet.value());
+    } break;
+    case NetEventKind::Stats: {
+      // `data` is only ever written on this thread, the I/O thread leaves it alone.
+      if (!event.peer->data) {
+        break;
+      }
+
+      const auto client_id = static_cast<NetClientID>(reinterpret_cast<uptr>(event.peer->data));
+      if (auto* client = self.remote_clients.slot(client_id)) {
+        client->update_stats(event.counters);
+      }
+    } break;
+  }
+}
+
 auto NetServer::handle_packet(this NetServer& self, ENetPeer* remote_peer, NetPacket& packet) -> void {
   ZoneScoped;
 
@@ -90,10 +105,26 @@ auto NetServer::handle_packet(this NetServer& self, ENetPeer* remote_peer, NetPa
 
       // At this point client is accepted
       auto unique_net_id = self.net_id_counter++;
-      client_id = self.remote_clients.create_slot(NetClient(remote_peer, unique_net_id));
+      auto remote_client = NetClient(self.transport, remote_peer, unique_net_id);
+      for (u32 i = 0; i < handshake->procs.size(); i++) {
+        remote_client.remote_proc_ids.emplace(handshake->procs[i], i);
+      }
+      if (self.compressor) {
+        remote_client.compressor = self.compressor;
+        remote_client.compression = self.compressor->negotiate(handshake->compression, handshake->dictionary_id);
+      }
+      const auto compression = remote_client.compression;
+      client_id = self.remote_clients.create_slot(std::move(remote_client));
       remote_peer->data = reinterpret_cast<void*>(static_cast<uptr>(client_id));
 
-      if (auto accept_handshake_packet = NetPacket::handshake({.version = 1, .net_id = unique_net_id})) {
+      auto accept_handshake = NetHandshakePacket{
+        .version = 1,
+        .net_id = unique_net_id,
+        .procs = self.proc_hashes,
+        .compression = net_compression_bit(compression),
+        .dictionary_id = self.compressor ? self.compressor->dictionary_id() : 0,
+      };
+      if (auto accept_handshake_packet = NetPacket::handshake(accept_handshake)) {
         auto client = self.remote_clients.slot(client_id);
         client->send_reliable(accept_handshake_packet.value());
       }
@@ -122,21 +153,51 @@ auto NetServer::handle_packet(this NetServer& self, ENetPeer* remote_peer, NetPa
       auto& es = App::get_event_system();
       std::ignore = es.emit<ClientAckEvent>(ClientAckEvent(&self, client_id, client_ack.value()));
 
+      if (auto* client = self.remote_clients.slot(client_id)) {
+        client->ack_snapshot(client_ack->acked);
+      }
+
       self.on_client_ack(client_id, client_ack.value());
     } break;
+    case NetPacketType::SceneDelta: {
+      // This is not our job
+    } break;
     case NetPacketType::RPC: {
       auto rpc = packet.get_rpc();
       if (!rpc.has_value()) {
         return;
       }
 
-      auto procs_it = self.rpcs.find(rpc->proc_hash);
-      if (procs_it == self.rpcs.end()) {
-        OX_LOG_ERROR("Client is trying to call an invalid proc!");
+      auto call = NetRPCCall{};
+      while (rpc->next(self.proc_hashes, call)) {
+        auto procs_it = self.rpcs.find(call.proc_hash);
+        if (procs_it == self.rpcs.end()) {
+          OX_LOG_ERROR("Client is trying to call an invalid proc!");
+          continue;
+        }
+
+        procs_it->second(client_id, std::span(call.parameters));
+      }
+
+      if (rpc->call_count != 0) {
+        OX_LOG_ERROR("Client sent a malformed RPC batch!");
+      }
+    } break;
+    case NetPacketType::Compressed: {
+      if (!self.compressor) {
+        OX_LOG_ERROR("Client sent a compressed packet, but there's nothing to decompress it with!");
         return;
       }
 
-      procs_it->second(client_id, std::span(rpc->parameters));
+      const auto* client = self.remote_clients.slot(client_id);
+      auto decompressed = self.compressor->decompress(packet, client ? client->compression : NetCompression::None);
+      if (!decompressed.has_value()) {
+        OX_LOG_ERROR("Client sent a malformed compressed packet!");
+        return;
+      }
+
+      OX_DEFER(&) { enet_packet_destroy(decompressed->inner); };
+      self.handle_packet(remote_peer, decompressed.value());
     } break;
     case NetPacketType::Unknown: {
       OX_LOG_ERROR("Peer {} sent an unkown packet.");
@@ -148,7 +209,9 @@ auto NetServer::register_proc(this NetServer& self, std::string_view identifier,
   ZoneScoped;
 
   auto hash = ankerl::unordered_dense::detail::wyhash::hash(identifier.data(), identifier.size());
-  self.rpcs.emplace(hash, std::move(cb));
+  if (self.rpcs.emplace(hash, std::move(cb)).second) {
+    self.proc_hashes.push_back(hash);
+  }
 }
 
 auto NetServer::client(this NetServer& self, NetClientID client_id) -> NetClient* {
@@ -187,9 +250,110 @@ auto NetServer::send_to_client(this NetServer& self, NetClientID client_id, NetP
 auto NetServer::broadcast(this NetServer& self, NetPacket& packet, bool reliable) -> void {
   ZoneScoped;
 
-  packet.inner->flags = reliable ? ENET_PACKET_FLAG_RELIABLE : 0;
-  // enet_host_broadcast owns the packet from here on, including destroying it when there are no peers.
-  enet_host_broadcast(self.local_host, reliable ? NET_CHANNEL_RELIABLE : NET_CHANNEL_UNRELIABLE, packet);
+  self.transport->broadcast(packet, reliable);
+}
+
+auto NetServer::send_snapshots(this NetServer& self, SceneSnapshotBuilder& snapshots, const SnapshotCodec& codec)
+  -> void {
+  ZoneScoped;
+
+  // Clients acking the same baseline with the same codec share one packet, the extra ref keeps it
+  // alive until every client had its go at it. Compressing here, before anything was sent, keeps
+  // the I/O thread's hands off the packet meanwhile.
+  constexpr auto NO_BASELINE = 0x100_u32;
+  constexpr auto CODEC_SHIFT = 9_u32;
+  auto packets = ankerl::unordered_dense::map<u32, NetPacket>{};
+  const auto sequence = snapshots.current_sequence;
+  const auto& current = snapshots.current();
+
+  self.remote_clients.for_each_active([&](usize, NetClient& client) {
+    const auto* baseline = client.has_baseline ? snapshots.find(client.baseline_sequence) : nullptr;
+    const auto baseline_key = baseline ? static_cast<u32>(client.baseline_sequence) : NO_BASELINE;
+    const auto key = baseline_key | (static_cast<u32>(client.compression) << CODEC_SHIFT);
+
+    auto packet_it = packets.find(key);
+    if (packet_it == packets.end()) {
+      auto delta = NetSceneDeltaPacket{
+        .sequence = sequence,
+        .has_baseline = baseline != nullptr,
+        .baseline_sequence = client.baseline_sequence,
+      };
+      self.delta_payload.clear();
+      if (!codec.encode(baseline, current, self.delta_payload)) {
+        OX_LOG_ERROR("Failed to encode scene delta.");
+        return;
+      }
+      delta.payload = self.delta_payload;
+
+      auto packet = NetPacket::scene_delta(delta);
+      if (!packet.has_value()) {
+        return;
+      }
+
+      client.compress(packet.value());
+      packet->inner->referenceCount += 1;
+      packet_it = packets.emplace(key, packet.value()).first;
+    }
+
+    client.send_unreliable(packet_it->second);
+  });
+
+  for (auto& [_, packet] : packets) {
+    self.transport->release(packet);
+  }
+}
+
+auto NetServer::send_snapshots(
+  this NetServer& self, SceneSnapshotBuilder& snapshots, const SnapshotCodec& codec, InterestManager& interest
+) -> void {
+  ZoneScoped;
+
+  // Every client sees its own subset, so each keeps the history of what it was sent as its baselines
+  // and nothing can be shared.
+  const auto sequence = snapshots.current_sequence;
+  const auto& current = snapshots.current();
+  auto relevancy_changed = std::vector<NetClientID>{};
+
+  self.remote_clients.for_each_active_id([&](NetClientID client_id, NetClient& client) {
+    auto& relevant = self.relevant_state;
+    const auto* previous = client.snapshots.find(static_cast<u8>(sequence - 1));
+    interest.filter(client.interest, current, previous, relevant);
+    if (!client.interest.entered.empty() || !client.interest.left.empty()) {
+      relevancy_changed.push_back(client_id);
+    }
+
+    const auto* baseline = client.has_baseline ? client.snapshots.find(client.baseline_sequence) : nullptr;
+    auto delta = NetSceneDeltaPacket{
+      .sequence = sequence,
+      .has_baseline = baseline != nullptr,
+      .baseline_sequence = client.baseline_sequence,
+    };
+    self.delta_payload.clear();
+    if (!codec.encode(baseline, relevant, self.delta_payload)) {
+      OX_LOG_ERROR("Failed to encode scene delta.");
+      return;
+    }
+    delta.payload = self.delta_payload;
+    client.snapshots.store(sequence, relevant);
+
+    if (auto packet = NetPacket::scene_delta(delta)) {
+      client.compress(packet.value());
+      client.send_unreliable(packet.value());
+    }
+  });
+
+  // Outside of the slot map's lock, handlers are free to look clients up.
+  auto& es = App::get_event_system();
+  for (const auto client_id : relevancy_changed) {
+    auto* client = self.remote_clients.slot(client_id);
+    const auto& entered = client->interest.entered;
+    const auto& left = client->interest.left;
+    std::ignore = es.emit<ClientRelevancyEvent>(
+      {.server = &self, .client_id = client_id, .entered = entered, .left = left}
+    );
+
+    self.on_client_relevancy(client_id, entered, left);
+  }
 }
 
 auto NetServer::call_client(
@@ -201,15 +365,15 @@ auto NetServer::call_client(
 ) -> bool {
   ZoneScoped;
 
-  auto packet = NetPacket::rpc(proc, params);
-  if (!packet.has_value()) {
+  auto* client = self.remote_clients.slot(client_id);
+  if (!client) {
     return false;
   }
 
-  if (!self.send_to_client(client_id, packet.value(), reliable)) {
-    packet->destroy();
-    return false;
-  }
+  self.rpc_params_scratch.clear();
+  encode_rpc_parameters(params, self.rpc_params_scratch);
+  const auto hash = ankerl::unordered_dense::detail::wyhash::hash(proc.data(), proc.size());
+  client->queue_rpc(hash, self.rpc_params_scratch, reliable);
 
   return true;
 }
@@ -219,14 +383,21 @@ auto NetServer::broadcast_call(
 ) -> bool {
   ZoneScoped;
 
-  auto packet = NetPacket::rpc(proc, params);
-  if (!packet.has_value()) {
-    return false;
-  }
-
-  self.broadcast(packet.value(), reliable);
+  // Encoded once, each client's batch only differs in the proc's id.
+  self.rpc_params_scratch.clear();
+  encode_rpc_parameters(params, self.rpc_params_scratch);
+  const auto hash = ankerl::unordered_dense::detail::wyhash::hash(proc.data(), proc.size());
+  self.remote_clients.for_each_active([&](usize, NetClient& client) {
+    client.queue_rpc(hash, self.rpc_params_scratch, reliable);
+  });
 
   return true;
 }
 
+auto NetServer::flush_rpcs(this NetServer& self) -> void {
+  ZoneScoped;
+
+  self.remote_clients.for_each_active([](usize, NetClient& client) { client.flush_rpcs(); });
+}
+
 } // namespace ox
@@ -0,0 +1,126 @@
+#include "Networking/NetTransport.hpp"
+
+#include "Core/Base.hpp"
+
+#ifndef ENET_FEATURE_ADDRESS_MAPPING
+  #define ENET_FEATURE_ADDRESS_MAPPING
+#endif
+
+#include <enet.h>
+
+namespace ox {
+EnetTransport::EnetTransport(ENetHost* host_, bool threaded) : host(host_) {
+  if (threaded) {
+    io_thread = std::make_unique<NetIOThread>(host);
+    io_thread->start();
+  }
+}
+
+EnetTransport::~EnetTransport() {
+  // Stopping the thread runs whatever was still queued, it has to happen while the host is alive.
+  io_thread.reset();
+  enet_host_destroy(host);
+}
+
+auto EnetTransport::poll() -> option<NetIOEvent> {
+  ZoneScoped;
+
+  if (io_thread) {
+    return io_thread->events.try_pop();
+  }
+
+  auto event = ENetEvent{};
+  if (enet_host_service(host, &event, 0) > 0) {
+    return to_net_io_event(event);
+  }
+
+  return nullopt;
+}
+
+auto EnetTransport::connect(std::string_view host_name, u16 port) -> bool {
+  ZoneScoped;
+
+  if (io_thread) {
+    io_thread->push({.kind = NetIOCommandKind::Connect, .port = port, .host_name = std::string(host_name)});
+    return true;
+  }
+
+  auto address = ENetAddress{};
+  enet_address_set_host(&address, std::string(host_name).c_str());
+  address.port = port;
+
+  return enet_host_connect(host, &address, NET_CHANNEL_COUNT, 0) != nullptr;
+}
+
+auto EnetTransport::disconnect(ENetPeer* peer, bool immediate, u32 data) -> void {
+  ZoneScoped;
+
+  if (io_thread) {
+    const auto kind = immediate ? NetIOCommandKind::DisconnectNow : NetIOCommandKind::DisconnectLater;
+    io_thread->push({.kind = kind, .data = data, .peer = peer});
+    return;
+  }
+
+  if (immediate) {
+    enet_peer_disconnect_now(peer, data);
+  } else {
+    enet_peer_disconnect_later(peer, data);
+  }
+}
+
+auto EnetTransport::reset() -> void {
+  ZoneScoped;
+
+  if (io_thread) {
+    io_thread->push({.kind = NetIOCommandKind::Reset});
+    return;
+  }
+
+  reset_host_peers(host);
+}
+
+auto EnetTransport::send(ENetPeer* peer, ENetPacket* packet, bool reliable) -> void {
+  ZoneScoped;
+
+  if (io_thread) {
+    io_thread->send(peer, packet, reliable);
+    return;
+  }
+
+  send_peer_packet(peer, packet, reliable);
+}
+
+auto EnetTransport::broadcast(ENetPacket* packet, bool reliable) -> void {
+  ZoneScoped;
+
+  if (io_thread) {
+    io_thread->broadcast(packet, reliable);
+    return;
+  }
+
+  broadcast_host_packet(host, packet, reliable);
+}
+
+auto EnetTransport::release(ENetPacket* packet) -> void {
+  ZoneScoped;
+
+  // With an I/O thread the count is only touched over there, after the sends queued before.
+  if (io_thread) {
+    io_thread->release(packet);
+    return;
+  }
+
+  release_packet(packet);
+}
+
+auto EnetTransport::peer_counters(ENetPeer* peer) -> option<NetPeerCounters> {
+  ZoneScoped;
+
+  // The peer belongs to the I/O thread, it publishes the counters itself.
+  if (io_thread) {
+    return nullopt;
+  }
+
+  return read_peer_counters(peer);
+}
+} // namespace ox
@@ -1,15 +1,38 @@
 #include "Networking/NetworkManager.hpp"
 
+#include <cstdlib>
+#include <cstring>
 #include <enet.h>
 
 #include "Utils/Log.hpp"
 
 namespace ox {
-auto NetworkManager::init(this NetworkManager&) -> std::expected<void, std::string> {
+namespace {
+// ENet's callbacks don't carry a user pointer.
+NetworkManager* enet_pool_owner = nullptr;
+
+// In front of every allocation, so freeing only needs the pointer.
+struct alignas(TLSFAllocator::ALIGNMENT) PoolAllocationHeader {
+  TLSFAllocator::NodeID node = TLSFAllocator::NodeID::Invalid;
+};
+
+auto enet_pool_malloc(usize size) -> void* { return enet_pool_owner->pool_allocate(size); }
+auto enet_pool_free(void* memory) -> void { enet_pool_owner->pool_free(memory); }
+auto enet_pool_no_memory() -> void { OX_LOG_FATAL("ENet ran out of memory!"); }
+} // namespace
+
+auto NetworkManager::init(this NetworkManager& self) -> std::expected<void, std::string> {
   ZoneScoped;
 
-  // TODO: There is also `_with_callbacks` version to controll allocations ourselves
-  if (enet_initialize() != 0) {
+  self.allocator_memory = std::make_unique_for_overwrite<u8[]>(PACKET_POOL_SIZE);
+  self.allocator.init(PACKET_POOL_SIZE);
+  enet_pool_owner = &self;
+
+  auto callbacks = ENetCallbacks{};
+  callbacks.malloc = enet_pool_malloc;
+  callbacks.free = enet_pool_free;
+  callbacks.no_memory = enet_pool_no_memory;
+  if (enet_initialize_with_callbacks(ENET_VERSION, &callbacks) != 0) {
     return std::unexpected("An error occurred while initializing ENet");
   }
 
@@ -23,15 +46,66 @@ auto NetworkManager::deinit(this NetworkManager& self) -> std::expected<void, st
   OX_ASSERT(self.clients.empty());
 
   enet_deinitialize();
+  enet_pool_owner = nullptr;
 
   return {};
 }
 
 auto NetworkManager::update(this NetworkManager&, const Timestep&) -> void { ZoneScoped; }
 
-auto NetworkManager::create_server_handle(this NetworkManager& self, u16 port, u32 max_clients) -> ENetHost* {
+auto NetworkManager::pool_allocate(this NetworkManager& self, usize size) -> void* {
+  ZoneScoped;
+
+  const auto total_size = size + sizeof(PoolAllocationHeader);
+  auto allocation = option<TLSFAllocator::Allocation>{};
+  if (total_size <= PACKET_POOL_SIZE) {
+    auto lock = std::unique_lock(self.allocator_mutex);
+    allocation = self.allocator.allocate(static_cast<u32>(total_size));
+  }
+
+  void* memory = nullptr;
+  auto header = PoolAllocationHeader{};
+  if (allocation.has_value()) {
+    memory = self.allocator_memory.get() + allocation->offset;
+    header.node = allocation->node;
+  } else {
+    memory = std::malloc(total_size);
+    if (!memory) {
+      return nullptr;
+    }
+  }
+
+  std::memcpy(memory, &header, sizeof(PoolAllocationHeader));
+  return static_cast<u8*>(memory) + sizeof(PoolAllocationHeader);
+}
+
+auto NetworkManager::pool_free(this NetworkManager& self, void* memory) -> void {
+  ZoneScoped;
+
+  if (!memory) {
+    return;
+  }
+
+  auto* header_memory = static_cast<u8*>(memory) - sizeof(PoolAllocationHeader);
+  auto header = PoolAllocationHeader{};
+  std::memcpy(&header, header_memory, sizeof(PoolAllocationHeader));
+  if (header.node == TLSFAllocator::NodeID::Invalid) {
+    std::free(header_memory);
+    return;
+  }
+
+  auto lock = std::unique_lock(self.allocator_mutex);
+  self.allocator.free(header.node);
+}
+
+auto NetworkManager::create_server_transport(this NetworkManager& self, u16 port, u32 max_clients) -> NetTransport* {
   ZoneScoped;
 
+  if (self.loopback) {
+    OX_LOG_INFO("NetServer listening for loopback port {}.", port);
+    return self.transports.emplace_back(std::make_unique<LoopbackTransport>(*self.loopback, port)).get();
+  }
+
   auto address = ENetAddress{
     .host = ENET_HOST_ANY,
     .port = port,
@@ -43,33 +117,42 @@ auto NetworkManager::create_server_handle(this NetworkManager& self, u16 port, u
     return nullptr;
   }
 
-  // TODO: Compression
   local_host->checksum = enet_crc32;
 
   OX_LOG_INFO("NetServer listening for port {}.", port);
 
-  return local_host;
+  return self.transports.emplace_back(std::make_unique<EnetTransport>(local_host, self.threaded_io)).get();
 }
 
-auto NetworkManager::create_client_handle(this NetworkManager& self) -> ENetHost* {
+auto NetworkManager::create_client_transport(this NetworkManager& self) -> NetTransport* {
   ZoneScoped;
 
+  if (self.loopback) {
+    return self.transports.emplace_back(std::make_unique<LoopbackTransport>(*self.loopback)).get();
+  }
+
   auto* local_host = enet_host_create(nullptr, 1, NET_CHANNEL_COUNT, 0, 0);
   if (!local_host) {
     OX_LOG_ERROR("Failed to create new NetClient!");
     return nullptr;
   }
 
-  // TODO: Compression
   local_host->checksum = enet_crc32;
 
-  return local_host;
+  return self.transports.emplace_back(std::make_unique<EnetTransport>(local_host, self.threaded_io)).get();
+}
+
+auto NetworkManager::destroy_transport(this NetworkManager& self, NetTransport* transport) -> void {
+  ZoneScoped;
+
+  // Threaded ENet transports run whatever was still queued before their host goes away.
+  std::erase_if(self.transports, [&](std::unique_ptr<NetTransport>& v) { return v.get() == transport; });
 }
 
 auto NetworkManager::destroy_server(this NetworkManager& self, NetServer* server) -> void {
   ZoneScoped;
 
-  enet_host_destroy(server->local_host);
+  self.destroy_transport(server->transport);
   std::erase_if(self.servers, [&](std::unique_ptr<NetServer>& v) { return v.get() == server; });
 
   server = nullptr;
@@ -79,7 +162,7 @@ auto NetworkManager::destroy_client(this NetworkManager& self, NetClient* client
   ZoneScoped;
 
   client->disconnect(true);
-  enet_host_destroy(client->local_host);
+  self.destroy_transport(client->transport);
   std::erase_if(self.clients, [&](std::unique_ptr<NetClient>& v) { return v.get() == client; });
 
   client = nullptr;
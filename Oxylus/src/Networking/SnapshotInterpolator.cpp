@@ -0,0 +1,181 @@
+#include "Networking/SnapshotInterpolator.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <glm/gtc/quaternion.hpp>
+
+#include "Core/Base.hpp"
+
+namespace ox {
+namespace {
+// How much faster or slower than real time the playback clock runs while it catches up.
+constexpr f64 MAX_TIME_SCALE = 0.1;
+} // namespace
+
+SnapshotInterpolator::SnapshotInterpolator(flecs::id_t transform_id_, f64 snapshot_interval_) :
+    transform_id(transform_id_),
+    snapshot_interval(snapshot_interval_),
+    delay_ms(2.0 * snapshot_interval_) {}
+
+auto SnapshotInterpolator::push(this SnapshotInterpolator& self, u8 sequence, const SceneState& state) -> void {
+  ZoneScoped;
+
+  // Sequences wrap at 256, they are unwrapped relative to the newest one seen so far.
+  auto tick = 0_i64;
+  if (self.frames.empty()) {
+    self.newest_tick = 0;
+    self.newest_sequence = sequence;
+    self.since_newest = 0.0;
+  } else {
+    tick = self.newest_tick + static_cast<i8>(sequence - self.newest_sequence);
+    if (tick > self.newest_tick) {
+      self.newest_tick = tick;
+      self.newest_sequence = sequence;
+      self.since_newest = 0.0;
+    }
+  }
+
+  auto* frame = self.claim_frame(static_cast<f64>(tick) * self.snapshot_interval);
+  if (!frame) {
+    return;
+  }
+
+  for (const auto& entity : state.entities) {
+    if (entity.entity_id == self.predicted_entity) {
+      continue;
+    }
+
+    const auto* component = state.find_component(entity, self.transform_id);
+    if (!component || component->size != sizeof(TransformComponent)) {
+      continue;
+    }
+
+    auto& transform = frame->transforms.emplace_back();
+    std::memcpy(&transform, state.bytes_of(*component).data(), sizeof(TransformComponent));
+    frame->entities.push_back(entity.entity_id);
+  }
+}
+
+auto SnapshotInterpolator::update(this SnapshotInterpolator& self, f64 delta_ms) -> std::span<const Sample> {
+  ZoneScoped;
+
+  self.samples.clear();
+  if (self.frames.empty()) {
+    return self.samples;
+  }
+
+  self.since_newest += delta_ms;
+  const auto target = static_cast<f64>(self.newest_tick) * self.snapshot_interval + self.since_newest - self.delay_ms;
+  const auto error = target - (self.playback_time + delta_ms);
+  // Too far off to catch up on unnoticed, after a stall or on the first update.
+  if (!self.playing || std::abs(error) > std::max(self.delay_ms, 2.0 * self.snapshot_interval)) {
+    self.playback_time = target;
+    self.playing = true;
+  } else {
+    const auto scale = 1.0 + std::clamp(error / std::max(self.delay_ms, 1.0), -MAX_TIME_SCALE, MAX_TIME_SCALE);
+    self.playback_time += delta_ms * scale;
+  }
+
+  // Only the last frame at or before the playback position is still needed.
+  while (self.frames.size() >= 2 && self.frames[1].time <= self.playback_time) {
+    self.spare_frames.push_back(std::move(self.frames.front()));
+    self.frames.erase(self.frames.begin());
+  }
+
+  const auto& from = self.frames.front();
+  if (self.frames.size() == 1 || self.playback_time <= from.time) {
+    // Ran dry or hasn't reached the first snapshot yet, holds still rather than guess.
+    self.sample(from, from, 0.0f);
+  } else {
+    const auto& to = self.frames[1];
+    const auto t = (self.playback_time - from.time) / (to.time - from.time);
+    self.sample(from, to, static_cast<f32>(t));
+  }
+
+  return self.samples;
+}
+
+auto SnapshotInterpolator::find(this const SnapshotInterpolator& self, flecs::entity_t entity_id)
+  -> const TransformComponent* {
+  ZoneScoped;
+
+  auto it = std::ranges::lower_bound(self.samples, entity_id, {}, &Sample::entity_id);
+  if (it == self.samples.end() || it->entity_id != entity_id) {
+    return nullptr;
+  }
+
+  return &it->transform;
+}
+
+auto SnapshotInterpolator::reset(this SnapshotInterpolator& self) -> void {
+  ZoneScoped;
+
+  for (auto& frame : self.frames) {
+    self.spare_frames.push_back(std::move(frame));
+  }
+  self.frames.clear();
+  self.samples.clear();
+  self.playback_time = 0.0;
+  self.since_newest = 0.0;
+  self.playing = false;
+}
+
+auto SnapshotInterpolator::claim_frame(this SnapshotInterpolator& self, f64 time) -> Frame* {
+  ZoneScoped;
+
+  // Older than anything kept, playback is already past it.
+  if (self.playing && time < self.frames.front().time) {
+    return nullptr;
+  }
+
+  auto it = std::ranges::lower_bound(self.frames, time, {}, &Frame::time);
+  if (it != self.frames.end() && it->time == time) {
+    return nullptr;
+  }
+
+  auto index = std::distance(self.frames.begin(), it);
+  if (self.frames.size() >= MAX_FRAMES) {
+    if (index == 0) {
+      return nullptr;
+    }
+
+    self.spare_frames.push_back(std::move(self.frames.front()));
+    self.frames.erase(self.frames.begin());
+    index -= 1;
+  }
+
+  auto frame = Frame{};
+  if (!self.spare_frames.empty()) {
+    frame = std::move(self.spare_frames.back());
+    self.spare_frames.pop_back();
+    frame.entities.clear();
+    frame.transforms.clear();
+  }
+  frame.time = time;
+
+  return &*self.frames.insert(self.frames.begin() + index, std::move(frame));
+}
+
+auto SnapshotInterpolator::sample(this SnapshotInterpolator& self, const Frame& from, const Frame& to, f32 t) -> void {
+  ZoneScoped;
+
+  // Both sides are sorted, entities only `to` has just appeared and show up where they are.
+  auto from_index = 0_sz;
+  for (usize i = 0; i < to.entities.size(); i++) {
+    const auto entity_id = to.entities[i];
+    while (from_index < from.entities.size() && from.entities[from_index] < entity_id) {
+      from_index += 1;
+    }
+
+    auto transform = to.transforms[i];
+    if (from_index < from.entities.size() && from.entities[from_index] == entity_id) {
+      const auto& previous = from.transforms[from_index];
+      transform.position = glm::mix(previous.position, transform.position, t);
+      transform.rotation = glm::slerp(previous.rotation, transform.rotation, t);
+      transform.scale = glm::mix(previous.scale, transform.scale, t);
+    }
+
+    self.samples.push_back({.entity_id = entity_id, .transform = transform});
+  }
+}
+} // namespace ox
@@ -0,0 +1,162 @@
+#include "Physics/ContactBuffer.hpp"
+
+#include <Jolt/Physics/Body/Body.h>
+#include <Jolt/Physics/Collision/ContactListener.h>
+#include <algorithm>
+
+#include "Core/Base.hpp"
+#include "Core/JobManager.hpp"
+#include "Utils/OxMath.hpp"
+
+namespace ox {
+namespace {
+auto pair_key(const ContactEvent& event) -> u64 {
+  return (static_cast<u64>(event.body1.GetIndexAndSequenceNumber()) << 32) | event.body2.GetIndexAndSequenceNumber();
+}
+} // namespace
+
+auto ContactBuffer::init(this ContactBuffer& self, u32 worker_count) -> void {
+  ZoneScoped;
+
+  self.clear();
+  self.threads.resize(worker_count + 1);
+}
+
+auto ContactBuffer::record(
+  this ContactBuffer& self,
+  ContactEventKind kind,
+  const JPH::Body& body1,
+  const JPH::Body& body2,
+  const JPH::ContactManifold& manifold,
+  const JPH::ContactSettings& settings
+) -> void {
+  if (!self.enabled) {
+    return;
+  }
+
+  auto event = ContactEvent{
+    .kind = kind,
+    .body1 = body1.GetID(),
+    .body2 = body2.GetID(),
+    .entity1 = body1.GetUserData(),
+    .entity2 = body2.GetUserData(),
+    .sub_shape1 = manifold.mSubShapeID1,
+    .sub_shape2 = manifold.mSubShapeID2,
+    .normal = math::from_jolt(manifold.mWorldSpaceNormal),
+    .penetration_depth = manifold.mPenetrationDepth,
+    .friction = settings.mCombinedFriction,
+    .restitution = settings.mCombinedRestitution,
+  };
+  if (!manifold.mRelativeContactPointsOn1.empty()) {
+    event.point = math::from_jolt(JPH::Vec3(manifold.GetWorldSpaceContactPointOn1(0)));
+  }
+
+  // Jolt already orders them, this is only in case it ever doesn't.
+  if (event.body2 < event.body1) {
+    std::swap(event.body1, event.body2);
+    std::swap(event.entity1, event.entity2);
+    std::swap(event.sub_shape1, event.sub_shape2);
+    event.normal = -event.normal;
+    event.point += event.normal * event.penetration_depth;
+  }
+
+  self.push(event);
+}
+
+auto ContactBuffer::record_removed(this ContactBuffer& self, const JPH::BodyID& body1, const JPH::BodyID& body2)
+  -> void {
+  if (!self.enabled) {
+    return;
+  }
+
+  self.push({
+    .kind = ContactEventKind::Removed,
+    .body1 = body2 < body1 ? body2 : body1,
+    .body2 = body2 < body1 ? body1 : body2,
+  });
+}
+
+auto ContactBuffer::merge(this ContactBuffer& self, std::vector<ContactEvent>& out) -> usize {
+  ZoneScoped;
+
+  out.clear();
+  for (auto& thread : self.threads) {
+    out.insert(out.end(), thread.events.begin(), thread.events.end());
+    thread.events.clear();
+  }
+  out.insert(out.end(), self.shared.events.begin(), self.shared.events.end());
+  self.shared.events.clear();
+
+  const auto recorded = out.size();
+  std::ranges::sort(out, {}, pair_key);
+
+  auto write = 0_sz;
+  for (auto begin = 0_sz; begin < out.size();) {
+    const auto key = pair_key(out[begin]);
+    auto end = begin + 1;
+    while (end < out.size() && pair_key(out[end]) == key) {
+      end += 1;
+    }
+
+    auto has_added = false;
+    auto has_persisted = false;
+    auto has_removed = false;
+    auto deepest = begin;
+    auto touching = 0_u32;
+    for (auto i = begin; i < end; i++) {
+      const auto& event = out[i];
+      has_added |= event.kind == ContactEventKind::Added;
+      has_persisted |= event.kind == ContactEventKind::Persisted;
+      has_removed |= event.kind == ContactEventKind::Removed;
+      if (event.kind != ContactEventKind::Removed) {
+        const auto& current = out[deepest];
+        if (current.kind == ContactEventKind::Removed || event.penetration_depth > current.penetration_depth) {
+          deepest = i;
+        }
+        touching += 1;
+      }
+    }
+
+    auto merged = out[deepest];
+    if (has_persisted || (has_added && has_removed)) {
+      merged.kind = ContactEventKind::Persisted;
+    } else if (has_added) {
+      merged.kind = ContactEventKind::Added;
+    }
+    merged.contact_count = touching ? touching : static_cast<u32>(end - begin);
+    out[write++] = merged;
+
+    begin = end;
+  }
+  out.resize(write);
+
+  return recorded;
+}
+
+auto ContactBuffer::clear(this ContactBuffer& self) -> void {
+  ZoneScoped;
+
+  for (auto& thread : self.threads) {
+    thread.events.clear();
+  }
+  self.shared.events.clear();
+}
+
+auto ContactBuffer::push(this ContactBuffer& self, const ContactEvent& event) -> void {
+  if (!self.threads.empty()) {
+    // Workers that came up after `init` go through the lock.
+    const auto worker_count = static_cast<u32>(self.threads.size() - 1);
+    if (this_thread_worker.id < worker_count) {
+      self.threads[this_thread_worker.id].events.push_back(event);
+      return;
+    }
+    if (JobManager::is_main_thread()) {
+      self.threads[worker_count].events.push_back(event);
+      return;
+    }
+  }
+
+  auto lock = std::unique_lock(self.shared_mutex);
+  self.shared.events.push_back(event);
+}
+} // namespace ox
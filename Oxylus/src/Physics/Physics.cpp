@@ -2,6 +2,7 @@
 
 #include <Jolt/Core/Factory.h>
 #include <Jolt/Core/JobSystemWithBarrier.h>
+#include <Jolt/Core/TempAllocator.h>
 #include <Jolt/Physics/Body/BodyManager.h>
 #include <Jolt/Physics/Collision/CastResult.h>
 #include <Jolt/Physics/Collision/RayCast.h>
@@ -80,7 +81,7 @@ auto Physics::init(this Physics& self) -> std::expected<void, std::string> {
   JPH::Factory::sInstance = new JPH::Factory();
   JPH::RegisterTypes();
 
-  self.temp_allocator = std::make_unique<JPH::TempAllocatorImpl>(10 * 1024 * 1024);
+  self.reserve_temp_allocator(PhysicsCapacity{}.temp_allocator_size);
 
   self.job_system = std::make_unique<JoltJobSystem>();
   self.job_system->Init(JPH::cMaxPhysicsBarriers);
@@ -91,6 +92,8 @@ auto Physics::init(this Physics& self) -> std::expected<void, std::string> {
 auto Physics::deinit(this Physics& self) -> std::expected<void, std::string> {
   ZoneScoped;
 
+  self.shape_cache.clear();
+
   JPH::UnregisterTypes();
   delete JPH::Factory::sInstance;
   JPH::Factory::sInstance = nullptr;
@@ -98,15 +101,16 @@ auto Physics::deinit(this Physics& self) -> std::expected<void, std::string> {
   return {};
 }
 
-auto Physics::new_system(this const Physics& self) -> std::unique_ptr<JPH::PhysicsSystem> {
+auto Physics::new_system(this const Physics& self, const PhysicsCapacity& capacity)
+  -> std::unique_ptr<JPH::PhysicsSystem> {
   ZoneScoped;
 
   auto sys = std::make_unique<JPH::PhysicsSystem>();
   sys->Init(
-    MAX_BODIES,
-    0,
-    MAX_BODY_PAIRS,
-    MAX_CONTACT_CONSTRAINS,
+    capacity.max_bodies,
+    capacity.body_mutexes,
+    capacity.max_body_pairs,
+    capacity.max_contact_constraints,
     self.layer_interface,
     self.object_vs_broad_phase_layer_filter_interface,
     self.object_layer_pair_filter_interface
@@ -115,6 +119,18 @@ auto Physics::new_system(this const Physics& self) -> std::unique_ptr<JPH::Physi
   return sys;
 }
 
+auto Physics::reserve_temp_allocator(this Physics& self, usize size) -> void {
+  ZoneScoped;
+
+  if (self.temp_allocator && size <= self.temp_allocator_size) {
+    return;
+  }
+
+  // A step that still needs more than this goes to malloc instead of asserting.
+  self.temp_allocator = std::make_unique<JPH::TempAllocatorImplWithMallocFallback>(static_cast<JPH::uint>(size));
+  self.temp_allocator_size = size;
+}
+
 auto Physics::new_debug_renderer(this const Physics& self) -> std::unique_ptr<PhysicsDebugRenderer> {
   ZoneScoped;
 
@@ -0,0 +1,94 @@
+#include "Physics/PhysicsCVar.hpp"
+
+#include <algorithm>
+
+namespace ox {
+namespace {
+auto cvar_u32(const AutoCVar_Int& cvar) -> u32 { return static_cast<u32>(std::max(cvar.get(), 0)); }
+} // namespace
+
+PhysicsCVar::PhysicsCVar() { init(); }
+
+auto PhysicsCVar::init(this PhysicsCVar& self) -> void {
+  ZoneScoped;
+
+  const auto defaults = PhysicsCapacity{};
+  self.cvar_auto_capacity
+    .init(self.system, "ph.auto_capacity", "grow the capacities below to fit the scene when physics starts", 1);
+  self.cvar_max_bodies
+    .init(self.system, "ph.max_bodies", "bodies the scene can hold", static_cast<i32>(defaults.max_bodies));
+  self.cvar_max_body_pairs.init(
+    self.system, "ph.max_body_pairs", "body pairs the broadphase can report", static_cast<i32>(defaults.max_body_pairs)
+  );
+  self.cvar_max_contact_constraints.init(
+    self.system,
+    "ph.max_contact_constraints",
+    "contact constraints solved per step",
+    static_cast<i32>(defaults.max_contact_constraints)
+  );
+  self.cvar_body_mutexes.init(self.system, "ph.body_mutexes", "body mutexes, 0: one per hardware thread", 0);
+  self.cvar_temp_allocator_mb.init(
+    self.system,
+    "ph.temp_allocator_mb",
+    "megabytes reserved for a physics step",
+    static_cast<i32>(defaults.temp_allocator_size / (1024 * 1024))
+  );
+}
+
+auto PhysicsCVar::to_json(this const PhysicsCVar& self, JsonWriter& writer) -> void {
+  ZoneScoped;
+
+  writer["physics"].begin_obj();
+  writer["auto_capacity"] = self.cvar_auto_capacity.as_bool();
+  writer["max_bodies"] = self.cvar_max_bodies.get();
+  writer["max_body_pairs"] = self.cvar_max_body_pairs.get();
+  writer["max_contact_constraints"] = self.cvar_max_contact_constraints.get();
+  writer["body_mutexes"] = self.cvar_body_mutexes.get();
+  writer["temp_allocator_mb"] = self.cvar_temp_allocator_mb.get();
+  writer.end_obj();
+}
+
+auto PhysicsCVar::from_json(this const PhysicsCVar& self, simdjson::ondemand::value& json) -> void {
+  ZoneScoped;
+
+  auto read_int = [&json](const AutoCVar_Int& cvar, std::string_view key) {
+    auto value = json[key];
+    if (!value.error()) {
+      cvar.set(static_cast<i32>(value.get_int64()));
+    }
+  };
+
+  auto auto_capacity = json["auto_capacity"];
+  if (!auto_capacity.error()) {
+    self.cvar_auto_capacity.set(auto_capacity.get_bool());
+  }
+  read_int(self.cvar_max_bodies, "max_bodies");
+  read_int(self.cvar_max_body_pairs, "max_body_pairs");
+  read_int(self.cvar_max_contact_constraints, "max_contact_constraints");
+  read_int(self.cvar_body_mutexes, "body_mutexes");
+  read_int(self.cvar_temp_allocator_mb, "temp_allocator_mb");
+}
+
+auto PhysicsCVar::capacity(this const PhysicsCVar& self, u32 body_count, u32 moving_count) -> PhysicsCapacity {
+  auto capacity = PhysicsCapacity{
+    .max_bodies = cvar_u32(self.cvar_max_bodies),
+    .max_body_pairs = cvar_u32(self.cvar_max_body_pairs),
+    .max_contact_constraints = cvar_u32(self.cvar_max_contact_constraints),
+    .body_mutexes = cvar_u32(self.cvar_body_mutexes),
+    .temp_allocator_size = static_cast<usize>(cvar_u32(self.cvar_temp_allocator_mb)) * 1024 * 1024,
+  };
+  if (!self.cvar_auto_capacity.as_bool()) {
+    return capacity;
+  }
+
+  // Room for a quarter more to be spawned while running. Only moving bodies make pairs and contacts,
+  // a resting pile touches about four neighbours per body and the broadphase reports roughly twice as
+  // many pairs as end up touching.
+  capacity.max_bodies = std::max(capacity.max_bodies, body_count + body_count / 4);
+  capacity.max_body_pairs = std::max(capacity.max_body_pairs, moving_count * 8);
+  capacity.max_contact_constraints = std::max(capacity.max_contact_constraints, moving_count * 4);
+  capacity.temp_allocator_size = std::max(capacity.temp_allocator_size, static_cast<usize>(moving_count) * 2048);
+
+  return capacity;
+}
+} // namespace ox
@@ -3,7 +3,6 @@
 #include <Jolt/Physics/Body/Body.h>
 
 #include "Physics/PhysicsMaterial.hpp"
-#include "Scene/Scene.hpp"
 #include "Utils/Log.hpp"
 
 bool ObjectLayerPairFilterImpl::ShouldCollide(JPH::ObjectLayer inObject1, JPH::ObjectLayer inObject2) const {
@@ -118,7 +117,7 @@ void Physics3DContactListener::OnContactAdded(
 
   OverrideContactSettings(inBody1, inBody2, inManifold, ioSettings);
 
-  _scene->on_contact_added(inBody1, inBody2, inManifold, ioSettings);
+  contacts.record(ContactEventKind::Added, inBody1, inBody2, inManifold, ioSettings);
 }
 
 void Physics3DContactListener::OnContactPersisted(
@@ -131,13 +130,13 @@ void Physics3DContactListener::OnContactPersisted(
 
   OverrideContactSettings(inBody1, inBody2, inManifold, ioSettings);
 
-  _scene->on_contact_persisted(inBody1, inBody2, inManifold, ioSettings);
+  contacts.record(ContactEventKind::Persisted, inBody1, inBody2, inManifold, ioSettings);
 }
 
 void Physics3DContactListener::OnContactRemoved(const JPH::SubShapeIDPair& inSubShapePair) {
   ZoneScoped;
 
-  _scene->on_contact_removed(inSubShapePair);
+  contacts.record_removed(inSubShapePair.GetBody1ID(), inSubShapePair.GetBody2ID());
 }
 
 } // namespace ox
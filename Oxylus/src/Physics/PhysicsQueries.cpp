@@ -0,0 +1,283 @@
+#include "Physics/PhysicsQueries.hpp"
+
+#include <Jolt/Physics/Body/BodyFilter.h>
+#include <Jolt/Physics/Body/BodyLock.h>
+#include <Jolt/Physics/Collision/CastResult.h>
+#include <Jolt/Physics/Collision/CollideShape.h>
+#include <Jolt/Physics/Collision/NarrowPhaseQuery.h>
+#include <Jolt/Physics/Collision/RayCast.h>
+#include <Jolt/Physics/Collision/Shape/SphereShape.h>
+#include <Jolt/Physics/Collision/ShapeCast.h>
+#include <Jolt/Physics/PhysicsSystem.h>
+#include <algorithm>
+
+#include "Core/Base.hpp"
+#include "Core/JobManager.hpp"
+#include "Utils/OxMath.hpp"
+
+namespace ox {
+namespace {
+auto hit_body(const JPH::RayCastResult& result) -> JPH::BodyID { return result.mBodyID; }
+auto hit_body(const JPH::ShapeCastResult& result) -> JPH::BodyID { return result.mBodyID2; }
+auto hit_body(const JPH::CollideShapeResult& result) -> JPH::BodyID { return result.mBodyID2; }
+
+// Keeps the closest hit per body, up to as many bodies as it has slots, in storage that outlives
+// it. Once the slots are full it tells Jolt to skip anything farther than the farthest one kept.
+template <typename Base>
+class ClosestBodiesCollector final : public Base {
+public:
+  using Result = typename Base::ResultType;
+
+  explicit ClosestBodiesCollector(std::span<Result> slots_) : slots(slots_) {}
+
+  void Reset() override {
+    Base::Reset();
+    count = 0;
+  }
+
+  void AddHit(const Result& result) override {
+    const auto fraction = result.GetEarlyOutFraction();
+    const auto kept = std::span(slots.data(), count);
+    const auto same = std::ranges::find(kept, hit_body(result), [](const Result& r) { return hit_body(r); });
+    if (same != kept.end()) {
+      if (fraction < same->GetEarlyOutFraction()) {
+        *same = result;
+      }
+    } else if (count < slots.size()) {
+      slots[count++] = result;
+    } else {
+      auto farthest = std::ranges::max_element(kept, {}, [](const Result& r) { return r.GetEarlyOutFraction(); });
+      if (fraction >= farthest->GetEarlyOutFraction()) {
+        return;
+      }
+      *farthest = result;
+    }
+
+    if (count == slots.size()) {
+      const auto farthest = std::ranges::max(std::span(slots.data(), count), {}, [](const Result& r) {
+        return r.GetEarlyOutFraction();
+      });
+      this->UpdateEarlyOutFraction(farthest.GetEarlyOutFraction());
+    }
+  }
+
+  auto sorted(this ClosestBodiesCollector& self) -> std::span<const Result> {
+    auto kept = std::span(self.slots.data(), self.count);
+    std::ranges::sort(kept, {}, [](const Result& r) { return r.GetEarlyOutFraction(); });
+    return kept;
+  }
+
+private:
+  std::span<Result> slots = {};
+  usize count = 0;
+};
+
+// Grown to the largest `max_hits` any batch used on this thread, then reused.
+struct QueryScratch {
+  std::vector<JPH::RayCastResult> rays = {};
+  std::vector<JPH::ShapeCastResult> casts = {};
+  std::vector<JPH::CollideShapeResult> overlaps = {};
+};
+
+thread_local QueryScratch query_scratch = {};
+
+auto body_details(const JPH::PhysicsSystem& system, PhysicsQueryHit& hit, const JPH::SubShapeID* sub_shape) -> void {
+  const auto lock = JPH::BodyLockRead(system.GetBodyLockInterface(), hit.body);
+  if (!lock.Succeeded()) {
+    return;
+  }
+
+  const auto& body = lock.GetBody();
+  hit.entity = body.GetUserData();
+  if (sub_shape != nullptr) {
+    hit.normal = math::from_jolt(body.GetWorldSpaceSurfaceNormal(*sub_shape, math::to_jolt(hit.point)));
+  }
+}
+
+auto surface_normal(const JPH::Vec3& penetration_axis) -> glm::vec3 {
+  return math::from_jolt(-penetration_axis.NormalizedOr(JPH::Vec3::sAxisY()));
+}
+} // namespace
+
+auto PhysicsQueryBatch::add_ray(
+  this PhysicsQueryBatch& self, const glm::vec3& origin, const glm::vec3& direction, JPH::BodyID ignore
+) -> u32 {
+  self.queries.push_back({
+    .kind = PhysicsQueryKind::Ray,
+    .origin = origin,
+    .direction = direction,
+    .ignore_body = ignore,
+  });
+  return static_cast<u32>(self.queries.size() - 1);
+}
+
+auto PhysicsQueryBatch::add_sphere_cast(
+  this PhysicsQueryBatch& self, const glm::vec3& origin, const glm::vec3& direction, f32 radius, JPH::BodyID ignore
+) -> u32 {
+  self.queries.push_back({
+    .kind = PhysicsQueryKind::SphereCast,
+    .origin = origin,
+    .direction = direction,
+    .radius = radius,
+    .ignore_body = ignore,
+  });
+  return static_cast<u32>(self.queries.size() - 1);
+}
+
+auto PhysicsQueryBatch::add_sphere_overlap(
+  this PhysicsQueryBatch& self, const glm::vec3& center, f32 radius, JPH::BodyID ignore
+) -> u32 {
+  self.queries.push_back({
+    .kind = PhysicsQueryKind::SphereOverlap,
+    .origin = center,
+    .radius = radius,
+    .ignore_body = ignore,
+  });
+  return static_cast<u32>(self.queries.size() - 1);
+}
+
+auto PhysicsQueryBatch::prepare_results(this const PhysicsQueryBatch& self, PhysicsQueryResults& results) -> void {
+  results.max_hits = std::max(self.max_hits, 1_u32);
+  results.hit_counts.assign(self.queries.size(), 0);
+  results.hits.resize(self.queries.size() * results.max_hits);
+}
+
+auto PhysicsQueryBatch::run(
+  this const PhysicsQueryBatch& self,
+  const JPH::PhysicsSystem& system,
+  JobManager* job_manager,
+  PhysicsQueryResults& results
+) -> void {
+  ZoneScoped;
+
+  self.prepare_results(results);
+
+  const auto query_count = static_cast<u32>(self.queries.size());
+  const auto thread_count = job_manager ? job_manager->get_thread_count() : 1_u32;
+  if (thread_count <= 1 || query_count < PARALLEL_THRESHOLD) {
+    self.run_range(system, 0, query_count, results);
+    return;
+  }
+
+  // A few chunks per worker, so a chunk of rays that all go the distance does not hold the rest up.
+  const auto chunk_size = std::max(MIN_CHUNK_SIZE, query_count / (thread_count * 4));
+  auto barrier = Barrier::create();
+  for (u32 begin = 0; begin < query_count; begin += chunk_size) {
+    const auto end = std::min(begin + chunk_size, query_count);
+    auto job = Job::create([&self, &system, &results, begin, end]() {
+      self.run_range(system, begin, end, results);
+    });
+    job->signal(barrier);
+    job_manager->submit(std::move(job));
+  }
+  barrier->wait(*job_manager);
+}
+
+auto PhysicsQueryBatch::run_range(
+  this const PhysicsQueryBatch& self,
+  const JPH::PhysicsSystem& system,
+  usize begin,
+  usize end,
+  PhysicsQueryResults& results
+) -> void {
+  ZoneScoped;
+
+  const auto max_hits = results.max_hits;
+  auto& scratch = query_scratch;
+  scratch.rays.resize(std::max<usize>(scratch.rays.size(), max_hits));
+  scratch.casts.resize(std::max<usize>(scratch.casts.size(), max_hits));
+  scratch.overlaps.resize(std::max<usize>(scratch.overlaps.size(), max_hits));
+
+  auto ray_collector = ClosestBodiesCollector<JPH::CastRayCollector>(std::span(scratch.rays.data(), max_hits));
+  auto cast_collector = ClosestBodiesCollector<JPH::CastShapeCollector>(std::span(scratch.casts.data(), max_hits));
+  auto overlap_collector = ClosestBodiesCollector<JPH::CollideShapeCollector>(
+    std::span(scratch.overlaps.data(), max_hits)
+  );
+
+  const auto& narrow_phase = system.GetNarrowPhaseQuery();
+  const auto ray_settings = JPH::RayCastSettings{};
+  const auto cast_settings = JPH::ShapeCastSettings{};
+  const auto collide_settings = JPH::CollideShapeSettings{};
+
+  for (auto i = begin; i < end; i++) {
+    const auto& query = self.queries[i];
+    auto* hits = results.hits.data() + i * max_hits;
+    auto& hit_count = results.hit_counts[i];
+    const auto body_filter = JPH::IgnoreSingleBodyFilter(query.ignore_body);
+
+    switch (query.kind) {
+      case PhysicsQueryKind::Ray: {
+        ray_collector.Reset();
+        const auto ray = JPH::RRayCast(JPH::RVec3(math::to_jolt(query.origin)), math::to_jolt(query.direction));
+        narrow_phase.CastRay(ray, ray_settings, ray_collector, {}, {}, body_filter);
+        for (const auto& result : ray_collector.sorted()) {
+          auto& hit = hits[hit_count++];
+          hit = {
+            .body = result.mBodyID,
+            .point = query.origin + query.direction * result.mFraction,
+            .fraction = result.mFraction,
+          };
+          body_details(system, hit, &result.mSubShapeID2);
+        }
+        break;
+      }
+      case PhysicsQueryKind::SphereCast: {
+        // Jolt has no use for a sphere without a radius.
+        if (query.radius <= 0.0f) {
+          break;
+        }
+        cast_collector.Reset();
+        auto sphere = JPH::SphereShape(query.radius);
+        sphere.SetEmbedded();
+        const auto cast = JPH::RShapeCast::sFromWorldTransform(
+          &sphere,
+          JPH::Vec3::sOne(),
+          JPH::RMat44::sTranslation(JPH::RVec3(math::to_jolt(query.origin))),
+          math::to_jolt(query.direction)
+        );
+        narrow_phase.CastShape(cast, cast_settings, JPH::RVec3::sZero(), cast_collector, {}, {}, body_filter);
+        for (const auto& result : cast_collector.sorted()) {
+          auto& hit = hits[hit_count++];
+          hit = {
+            .body = result.mBodyID2,
+            .point = math::from_jolt(JPH::Vec3(result.mContactPointOn2)),
+            .normal = surface_normal(result.mPenetrationAxis),
+            .fraction = result.mFraction,
+          };
+          body_details(system, hit, nullptr);
+        }
+        break;
+      }
+      case PhysicsQueryKind::SphereOverlap: {
+        if (query.radius <= 0.0f) {
+          break;
+        }
+        overlap_collector.Reset();
+        auto sphere = JPH::SphereShape(query.radius);
+        sphere.SetEmbedded();
+        narrow_phase.CollideShape(
+          &sphere,
+          JPH::Vec3::sOne(),
+          JPH::RMat44::sTranslation(JPH::RVec3(math::to_jolt(query.origin))),
+          collide_settings,
+          JPH::RVec3::sZero(),
+          overlap_collector,
+          {},
+          {},
+          body_filter
+        );
+        for (const auto& result : overlap_collector.sorted()) {
+          auto& hit = hits[hit_count++];
+          hit = {
+            .body = result.mBodyID2,
+            .point = math::from_jolt(JPH::Vec3(result.mContactPointOn2)),
+            .normal = surface_normal(result.mPenetrationAxis),
+          };
+          body_details(system, hit, nullptr);
+        }
+        break;
+      }
+    }
+  }
+}
+} // namespace ox
@@ -0,0 +1,108 @@
+#include "Physics/RigidBodySync.hpp"
+
+#include <Jolt/Physics/Body/Body.h>
+#include <Jolt/Physics/PhysicsSystem.h>
+#include <algorithm>
+
+#include "Core/Option.hpp"
+#include "Scene/Components.hpp"
+
+namespace ox {
+namespace {
+struct SyncedBody {
+  const JPH::Body* body = nullptr;
+  flecs::entity entity = {};
+  RigidBodyComponent* rigidbody = nullptr;
+};
+
+auto find_body(flecs::world& world, const JPH::PhysicsSystem& system, const JPH::BodyID& id) -> option<SyncedBody> {
+  const auto* body = system.GetBodyLockInterfaceNoLock().TryGetBody(id);
+  if (body == nullptr) {
+    return nullopt;
+  }
+
+  auto entity = world.entity(static_cast<flecs::entity_t>(body->GetUserData()));
+  if (!entity.is_alive()) {
+    return nullopt;
+  }
+
+  // Characters and terrain have bodies too, but no rigidbody owning them.
+  auto* rigidbody = entity.try_get_mut<RigidBodyComponent>();
+  if (rigidbody == nullptr || rigidbody->runtime_body != body || !entity.has<TransformComponent>()) {
+    return nullopt;
+  }
+
+  return SyncedBody{.body = body, .entity = entity, .rigidbody = rigidbody};
+}
+} // namespace
+
+auto RigidBodySync::step(this RigidBodySync& self, flecs::world& world, const JPH::PhysicsSystem& system) -> void {
+  ZoneScoped;
+
+  self.moving.clear();
+  std::swap(self.awake_bodies, self.last_awake_bodies);
+  system.GetActiveBodies(JPH::EBodyType::RigidBody, self.awake_bodies);
+  // `BodyID` only has `<`, not the full set `std::ranges::less` wants.
+  std::sort(self.awake_bodies.begin(), self.awake_bodies.end());
+
+  for (const auto& id : self.awake_bodies) {
+    const auto synced = find_body(world, system, id);
+    if (!synced.has_value()) {
+      continue;
+    }
+
+    auto& rb = *synced->rigidbody;
+    rb.previous_translation = rb.translation;
+    rb.previous_rotation = rb.rotation;
+    rb.translation = math::from_jolt(JPH::Vec3(synced->body->GetPosition()));
+    rb.rotation = math::from_jolt(synced->body->GetRotation());
+    self.moving.push_back(synced->entity);
+  }
+
+  // Sleeping bodies barely moved during their last step, they snap to where they came to rest instead
+  // of being interpolated there.
+  for (const auto& id : self.last_awake_bodies) {
+    if (std::binary_search(self.awake_bodies.begin(), self.awake_bodies.end(), id)) {
+      continue;
+    }
+    const auto synced = find_body(world, system, id);
+    if (!synced.has_value()) {
+      continue;
+    }
+
+    auto& rb = *synced->rigidbody;
+    rb.previous_translation = rb.translation = math::from_jolt(JPH::Vec3(synced->body->GetPosition()));
+    rb.previous_rotation = rb.rotation = math::from_jolt(synced->body->GetRotation());
+    auto& tc = synced->entity.get_mut<TransformComponent>();
+    tc.position = rb.translation;
+    tc.rotation = rb.rotation;
+    self.written.push_back(synced->entity);
+  }
+}
+
+auto RigidBodySync::interpolate(this RigidBodySync& self, flecs::world&, f32 alpha) -> void {
+  ZoneScoped;
+
+  for (auto entity : self.moving) {
+    if (!entity.is_alive()) {
+      continue;
+    }
+    const auto* rb = entity.try_get<RigidBodyComponent>();
+    auto* tc = entity.try_get_mut<TransformComponent>();
+    if (rb == nullptr || tc == nullptr || rb->runtime_body == nullptr) {
+      continue;
+    }
+
+    tc->position = glm::mix(rb->previous_translation, rb->translation, alpha);
+    tc->rotation = glm::slerp(rb->previous_rotation, rb->rotation, alpha);
+    self.written.push_back(entity);
+  }
+}
+
+auto RigidBodySync::clear(this RigidBodySync& self) -> void {
+  self.written.clear();
+  self.moving.clear();
+  self.awake_bodies.clear();
+  self.last_awake_bodies.clear();
+}
+} // namespace ox
@@ -0,0 +1,403 @@
+#include "Physics/ShapeCache.hpp"
+
+#include <Jolt/Core/StreamWrapper.h>
+#include <Jolt/Physics/Collision/Shape/ConvexHullShape.h>
+#include <Jolt/Physics/Collision/Shape/MeshShape.h>
+#include <Jolt/Physics/Collision/Shape/StaticCompoundShape.h>
+#include <algorithm>
+#include <glm/geometric.hpp>
+#include <numeric>
+#include <sstream>
+#include <tuple>
+
+#include "Core/Base.hpp"
+#include "OS/File.hpp"
+#include "Utils/Log.hpp"
+#include "Utils/OxMath.hpp"
+
+namespace ox {
+namespace {
+// Bump whenever cooking changes, old cache files then simply stop matching.
+constexpr u32 COOK_VERSION = 1;
+constexpr u32 CACHE_MAGIC = 0x4c43584f; // OXCL
+// A split has to shrink the hulls by at least this much to be worth another part.
+constexpr f32 MIN_SPLIT_GAIN = 0.1f;
+
+struct ConvexPart {
+  std::vector<u32> triangles = {};
+  JPH::Ref<JPH::Shape> hull = nullptr;
+  f32 volume = 0.0f;
+  bool settled = false;
+};
+
+auto triangle_count(std::span<const u32> indices) -> u32 { return static_cast<u32>(indices.size() / 3); }
+
+auto is_valid_triangle(std::span<const glm::vec3> positions, std::span<const u32> indices, u32 triangle) -> bool {
+  const auto* corners = &indices[triangle * 3];
+  return corners[0] < positions.size() && corners[1] < positions.size() && corners[2] < positions.size();
+}
+
+auto triangle_center(std::span<const glm::vec3> positions, std::span<const u32> indices, u32 triangle) -> glm::vec3 {
+  const auto* corners = &indices[triangle * 3];
+  return (positions[corners[0]] + positions[corners[1]] + positions[corners[2]]) / 3.0f;
+}
+
+auto build_hull(std::span<const glm::vec3> positions, std::span<const u32> indices, ConvexPart& part) -> void {
+  auto points = JPH::Array<JPH::Vec3>{};
+  points.reserve(part.triangles.size() * 3);
+  for (auto triangle : part.triangles) {
+    for (u32 corner = 0; corner < 3; corner++) {
+      points.push_back(math::to_jolt(positions[indices[triangle * 3 + corner]]));
+    }
+  }
+
+  // Flat or tiny parts have no hull, they are dropped.
+  const auto result = JPH::ConvexHullShapeSettings(points).Create();
+  part.hull = result.IsValid() ? result.Get() : nullptr;
+  part.volume = part.hull ? part.hull->GetVolume() : 0.0f;
+}
+
+// Triangles grouped by the pieces of the mesh they are connected in. Vertices split along UV seams
+// share positions but not indices, so they are welded first.
+auto find_islands(std::span<const glm::vec3> positions, std::span<const u32> indices) -> std::vector<ConvexPart> {
+  auto order = std::vector<u32>(positions.size());
+  std::iota(order.begin(), order.end(), 0_u32);
+  auto position_key = [&](u32 vertex) {
+    const auto& p = positions[vertex];
+    return std::tuple(p.x, p.y, p.z);
+  };
+  std::ranges::sort(order, {}, position_key);
+
+  auto parent = std::vector<u32>(positions.size());
+  for (auto i = 0_sz; i < order.size(); i++) {
+    const auto same = i > 0 && positions[order[i]] == positions[order[i - 1]];
+    parent[order[i]] = same ? parent[order[i - 1]] : order[i];
+  }
+
+  auto find = [&parent](u32 vertex) {
+    while (parent[vertex] != vertex) {
+      parent[vertex] = parent[parent[vertex]];
+      vertex = parent[vertex];
+    }
+    return vertex;
+  };
+
+  for (u32 triangle = 0; triangle < triangle_count(indices); triangle++) {
+    if (!is_valid_triangle(positions, indices, triangle)) {
+      continue;
+    }
+    const auto root = find(indices[triangle * 3]);
+    parent[find(indices[triangle * 3 + 1])] = root;
+    parent[find(indices[triangle * 3 + 2])] = root;
+  }
+
+  auto island_of_root = ankerl::unordered_dense::map<u32, usize>{};
+  auto islands = std::vector<ConvexPart>{};
+  for (u32 triangle = 0; triangle < triangle_count(indices); triangle++) {
+    if (!is_valid_triangle(positions, indices, triangle)) {
+      continue;
+    }
+    const auto [it, inserted] = island_of_root.try_emplace(find(indices[triangle * 3]), islands.size());
+    if (inserted) {
+      islands.emplace_back();
+    }
+    islands[it->second].triangles.push_back(triangle);
+  }
+
+  return islands;
+}
+
+auto part_center(std::span<const glm::vec3> positions, std::span<const u32> indices, const ConvexPart& part)
+  -> glm::vec3 {
+  auto min = glm::vec3(std::numeric_limits<f32>::max());
+  auto max = glm::vec3(std::numeric_limits<f32>::lowest());
+  for (auto triangle : part.triangles) {
+    const auto center = triangle_center(positions, indices, triangle);
+    min = glm::min(min, center);
+    max = glm::max(max, center);
+  }
+
+  return (min + max) * 0.5f;
+}
+
+// Not a full convex decomposition: the mesh is cut into its connected pieces, and the piece whose
+// hull wastes the most volume is halved along its longest axis for as long as that makes the hulls
+// noticeably tighter.
+auto cook_convex_parts(std::span<const glm::vec3> positions, std::span<const u32> indices, u32 max_parts)
+  -> JPH::ShapeSettings::ShapeResult {
+  auto parts = find_islands(positions, indices);
+
+  // Too many pieces, the small ones join whichever kept piece is closest.
+  if (parts.size() > max_parts) {
+    std::ranges::sort(parts, std::greater{}, [](const ConvexPart& part) { return part.triangles.size(); });
+    auto centers = std::vector<glm::vec3>{};
+    for (u32 i = 0; i < max_parts; i++) {
+      centers.push_back(part_center(positions, indices, parts[i]));
+    }
+    for (auto i = static_cast<usize>(max_parts); i < parts.size(); i++) {
+      const auto center = part_center(positions, indices, parts[i]);
+      auto closest = 0_sz;
+      for (auto j = 1_sz; j < centers.size(); j++) {
+        if (glm::distance(center, centers[j]) < glm::distance(center, centers[closest])) {
+          closest = j;
+        }
+      }
+      auto& target = parts[closest].triangles;
+      target.insert(target.end(), parts[i].triangles.begin(), parts[i].triangles.end());
+    }
+    parts.resize(max_parts);
+  }
+
+  for (auto& part : parts) {
+    build_hull(positions, indices, part);
+  }
+
+  while (parts.size() < max_parts) {
+    auto widest = std::ranges::max_element(parts, {}, [](const ConvexPart& part) {
+      return part.settled ? -1.0f : part.volume;
+    });
+    if (widest == parts.end() || widest->settled) {
+      break;
+    }
+
+    auto& part = *widest;
+    auto min = glm::vec3(std::numeric_limits<f32>::max());
+    auto max = glm::vec3(std::numeric_limits<f32>::lowest());
+    for (auto triangle : part.triangles) {
+      const auto center = triangle_center(positions, indices, triangle);
+      min = glm::min(min, center);
+      max = glm::max(max, center);
+    }
+    const auto extent = max - min;
+    const auto axis = extent.x >= extent.y && extent.x >= extent.z ? 0 : (extent.y >= extent.z ? 1 : 2);
+
+    auto triangles = part.triangles;
+    const auto middle = triangles.begin() + static_cast<std::ptrdiff_t>(triangles.size() / 2);
+    std::ranges::nth_element(triangles, middle, {}, [&](u32 triangle) {
+      return triangle_center(positions, indices, triangle)[axis];
+    });
+
+    auto first = ConvexPart{.triangles = {triangles.begin(), middle}};
+    auto second = ConvexPart{.triangles = {middle, triangles.end()}};
+    if (first.triangles.empty() || second.triangles.empty()) {
+      part.settled = true;
+      continue;
+    }
+
+    build_hull(positions, indices, first);
+    build_hull(positions, indices, second);
+    if (!first.hull || !second.hull || first.volume + second.volume > part.volume * (1.0f - MIN_SPLIT_GAIN)) {
+      part.settled = true;
+      continue;
+    }
+
+    part = std::move(first);
+    parts.push_back(std::move(second));
+  }
+
+  std::erase_if(parts, [](const ConvexPart& part) { return part.hull == nullptr; });
+  if (parts.empty()) {
+    auto result = JPH::ShapeSettings::ShapeResult{};
+    result.SetError("Mesh has no volume to build convex parts from");
+    return result;
+  }
+  if (parts.size() == 1) {
+    auto result = JPH::ShapeSettings::ShapeResult{};
+    result.Set(parts.front().hull);
+    return result;
+  }
+
+  auto compound = JPH::StaticCompoundShapeSettings{};
+  for (const auto& part : parts) {
+    compound.AddShape(JPH::Vec3::sZero(), JPH::Quat::sIdentity(), part.hull);
+  }
+
+  return compound.Create();
+}
+} // namespace
+
+auto ShapeCache::get_or_cook(
+  this ShapeCache& self,
+  std::span<const glm::vec3> positions,
+  std::span<const u32> indices,
+  CookedShapeType type,
+  u32 max_convex_parts,
+  const std::filesystem::path& cache_directory
+) -> JPH::ShapeSettings::ShapeResult {
+  ZoneScoped;
+
+  auto result = JPH::ShapeSettings::ShapeResult{};
+  const auto hash = content_hash(positions, indices, type, max_convex_parts);
+  {
+    auto lock = std::unique_lock(self.mutex);
+    if (auto it = self.shapes.find(hash); it != self.shapes.end()) {
+      self.stats.shared += 1;
+      result.Set(it->second);
+      return result;
+    }
+  }
+
+  // Loaded or cooked outside the lock, a big mesh takes a while.
+  const auto path = cache_directory.empty() ? std::filesystem::path{} : cache_path(cache_directory, hash);
+  auto shape = path.empty() ? nullptr : load(path, hash);
+  const auto from_disk = shape != nullptr;
+  if (!from_disk) {
+    result = cook(positions, indices, type, max_convex_parts);
+    if (!result.IsValid()) {
+      return result;
+    }
+    shape = result.Get();
+    if (!path.empty() && !save(*shape, path, hash)) {
+      OX_LOG_WARN("Failed to write cooked collision shape to {}.", path);
+    }
+  }
+
+  auto lock = std::unique_lock(self.mutex);
+  (from_disk ? self.stats.loaded : self.stats.cooked) += 1;
+  // Whoever got here first wins, so every body still ends up with the same shape.
+  const auto [it, inserted] = self.shapes.try_emplace(hash, shape);
+  result.Set(it->second);
+
+  return result;
+}
+
+auto ShapeCache::clear(this ShapeCache& self) -> void {
+  ZoneScoped;
+
+  auto lock = std::unique_lock(self.mutex);
+  self.shapes.clear();
+}
+
+auto ShapeCache::cook(
+  std::span<const glm::vec3> positions, std::span<const u32> indices, CookedShapeType type, u32 max_convex_parts
+) -> JPH::ShapeSettings::ShapeResult {
+  ZoneScoped;
+
+  switch (type) {
+    case CookedShapeType::Triangles: {
+      auto vertices = JPH::VertexList{};
+      vertices.reserve(positions.size());
+      for (const auto& position : positions) {
+        vertices.push_back({position.x, position.y, position.z});
+      }
+
+      auto triangles = JPH::IndexedTriangleList{};
+      triangles.reserve(triangle_count(indices));
+      for (u32 triangle = 0; triangle < triangle_count(indices); triangle++) {
+        if (is_valid_triangle(positions, indices, triangle)) {
+          triangles.push_back({indices[triangle * 3], indices[triangle * 3 + 1], indices[triangle * 3 + 2], 0});
+        }
+      }
+
+      return JPH::MeshShapeSettings(std::move(vertices), std::move(triangles)).Create();
+    }
+    case CookedShapeType::ConvexHull: {
+      auto part = ConvexPart{};
+      for (u32 triangle = 0; triangle < triangle_count(indices); triangle++) {
+        if (is_valid_triangle(positions, indices, triangle)) {
+          part.triangles.push_back(triangle);
+        }
+      }
+      build_hull(positions, indices, part);
+
+      auto result = JPH::ShapeSettings::ShapeResult{};
+      if (part.hull) {
+        result.Set(part.hull);
+      } else {
+        result.SetError("Mesh has no volume to build a convex hull from");
+      }
+      return result;
+    }
+    case CookedShapeType::ConvexParts: {
+      return cook_convex_parts(positions, indices, std::clamp(max_convex_parts, 1_u32, MAX_CONVEX_PARTS));
+    }
+  }
+
+  return {};
+}
+
+auto ShapeCache::content_hash(
+  std::span<const glm::vec3> positions, std::span<const u32> indices, CookedShapeType type, u32 max_convex_parts
+) -> u64 {
+  ZoneScoped;
+
+  // Parts only matter for the shape type that uses them.
+  const auto parts = type == CookedShapeType::ConvexParts ? max_convex_parts : 0_u32;
+  const u64 key[] = {
+    ankerl::unordered_dense::detail::wyhash::hash(positions.data(), positions.size_bytes()),
+    ankerl::unordered_dense::detail::wyhash::hash(indices.data(), indices.size_bytes()),
+    (static_cast<u64>(type) << 32) | parts,
+    (static_cast<u64>(COOK_VERSION) << 32) | JPH_VERSION_ID,
+  };
+
+  return ankerl::unordered_dense::detail::wyhash::hash(key, sizeof(key));
+}
+
+auto ShapeCache::cache_path(const std::filesystem::path& cache_directory, u64 hash) -> std::filesystem::path {
+  return cache_directory / fmt::format("{:016x}.oxcollider", hash);
+}
+
+auto ShapeCache::save(const JPH::Shape& shape, const std::filesystem::path& path, u64 hash) -> bool {
+  ZoneScoped;
+
+  auto stream = std::stringstream{};
+  auto out = JPH::StreamOutWrapper(stream);
+  out.Write(CACHE_MAGIC);
+  out.Write(hash);
+  auto shapes = JPH::Shape::ShapeToIDMap{};
+  auto materials = JPH::Shape::MaterialToIDMap{};
+  shape.SaveWithChildren(out, shapes, materials);
+  if (out.IsFailed()) {
+    return false;
+  }
+
+  // Written aside and moved over, so a crash never leaves half a file that matches the name.
+  auto error = std::error_code{};
+  std::filesystem::create_directories(path.parent_path(), error);
+  auto temporary_path = path;
+  temporary_path += ".tmp";
+  {
+    auto file = File(temporary_path, FileAccess::Write);
+    if (!file) {
+      return false;
+    }
+    const auto bytes = stream.str();
+    if (file.write(bytes) != bytes.size()) {
+      return false;
+    }
+  }
+  std::filesystem::rename(temporary_path, path, error);
+
+  return !error;
+}
+
+auto ShapeCache::load(const std::filesystem::path& path, u64 hash) -> JPH::Ref<JPH::Shape> {
+  ZoneScoped;
+
+  auto error = std::error_code{};
+  if (!std::filesystem::exists(path, error)) {
+    return nullptr;
+  }
+
+  const auto bytes = File::to_bytes(path);
+  auto stream = std::stringstream(std::string(bytes.begin(), bytes.end()));
+  auto in = JPH::StreamInWrapper(stream);
+  auto magic = 0_u32;
+  auto stored_hash = 0_u64;
+  in.Read(magic);
+  in.Read(stored_hash);
+  if (in.IsFailed() || magic != CACHE_MAGIC || stored_hash != hash) {
+    return nullptr;
+  }
+
+  auto shapes = JPH::Shape::IDToShapeMap{};
+  auto materials = JPH::Shape::IDToMaterialMap{};
+  auto result = JPH::Shape::sRestoreWithChildren(in, shapes, materials);
+  if (!result.IsValid()) {
+    OX_LOG_WARN("Ignoring corrupt collision shape cache {}: {}", path, result.GetError().c_str());
+    return nullptr;
+  }
+
+  return result.Get();
+}
+} // namespace ox
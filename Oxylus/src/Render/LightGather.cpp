@@ -0,0 +1,165 @@
+#include "Render/LightGather.hpp"
+
+#include "Scene/Scene.hpp"
+
+namespace ox {
+auto LightGather::init(this LightGather& self, flecs::world& world) -> void {
+  ZoneScoped;
+
+  self.query = world
+                 .query_builder<
+                   const TransformComponent,
+                   const LightComponent,
+                   const AtmosphereComponent*,
+                   const SkyComponent*>()
+                 .cached()
+                 .detect_changes()
+                 .build();
+}
+
+auto LightGather::gather(
+  this LightGather& self,
+  SlotMap<GPU::Light, GPU::LightID>& lights,
+  ankerl::unordered_dense::map<flecs::entity, GPU::LightID>& entity_lights,
+  std::vector<GPU::LightID>& dirty_lights
+) -> GPU::SceneFlags {
+  ZoneScoped;
+
+  // A light under another entity moves with it without its own table being written, so those keep
+  // the gather running every frame.
+  self.sun_direction_changed = false;
+  if (self.gathered && !self.has_parented_lights && !self.query.changed()) {
+    return self.scene_flags;
+  }
+
+  const auto full_gather = !self.gathered;
+  self.gathered = true;
+  self.gather_count += 1;
+  self.scene_flags = {};
+  self.has_parented_lights = false;
+
+  auto seen_lights = ankerl::unordered_dense::set<flecs::entity>{};
+  seen_lights.reserve(entity_lights.size());
+
+  // Every table is walked for the scene flags and to see which lights are still alive, but light
+  // data is only rebuilt for tables that were written since the last gather and for lights with a
+  // parent, whose world transform can change through any of their ancestors.
+  self.query.run([&](flecs::iter& it) {
+    while (it.next()) {
+      const auto table_changed = full_gather || it.changed();
+      const auto light_components = it.field<const LightComponent>(1);
+      const auto has_atmosphere = it.is_set(2);
+      const auto has_sky = it.is_set(3);
+
+      for (auto i : it) {
+        const auto e = it.entity(i);
+        if (!e.enabled()) {
+          continue;
+        }
+
+        const auto& lc = light_components[i];
+        if (has_atmosphere) {
+          self.scene_flags |= GPU::SceneFlags::HasAtmosphere;
+        }
+        if (has_sky) {
+          self.scene_flags |= GPU::SceneFlags::HasSky;
+        }
+        if (lc.type == LightComponent::LightType::Directional) {
+          self.scene_flags |= GPU::SceneFlags::HasDirectionalLight;
+        } else {
+          seen_lights.insert(e);
+        }
+
+        const auto has_parent = e.parent() != flecs::entity::null();
+        self.has_parented_lights |= has_parent;
+        if (!table_changed && !has_parent) {
+          continue;
+        }
+
+        const glm::mat4 world_transform = Scene::get_world_transform(e);
+        const glm::vec3 world_position = world_transform[3];
+        const glm::vec3 world_forward = glm::normalize(
+          glm::mat3(world_transform) * glm::vec3(0.0f, 0.0f, -1.0f)
+        );
+
+        if (lc.type == LightComponent::LightType::Directional) {
+          self.directional_light.color = lc.color;
+          self.directional_light.intensity = lc.intensity;
+          self.sun_direction_changed = world_forward != self.previous_sun_direction;
+          self.previous_sun_direction = world_forward;
+          self.directional_light.direction = world_forward;
+          self.first_clipmap_width = lc.first_clipmap_width;
+          self.clipmap_selection_bias = lc.clipmap_selection_bias;
+
+          self.directional_light_cast_shadows = lc.cast_shadows;
+        } else {
+          const auto is_spot = lc.type == LightComponent::LightType::Spot;
+          auto gpu_light = GPU::Light{
+            .position = world_position,
+            .intensity = lc.intensity,
+            .color = lc.color,
+            .range = lc.radius,
+            .direction = is_spot ? world_forward : glm::vec3(0.0f),
+            .inner_cone_angle = lc.inner_cone_angle,
+            .outer_cone_angle = lc.outer_cone_angle,
+            .kind = is_spot ? GPU::LightKind::Spot : GPU::LightKind::Point,
+          };
+
+          if (const auto light_it = entity_lights.find(e); light_it != entity_lights.end()) {
+            // Parented lights are read every frame, only the ones that moved are uploaded again.
+            auto* slot = lights.slot(light_it->second);
+            if (table_changed || slot->position != gpu_light.position || slot->direction != gpu_light.direction) {
+              *slot = gpu_light;
+              dirty_lights.push_back(light_it->second);
+            }
+          } else {
+            const auto light_id = lights.create_slot(std::move(gpu_light));
+            entity_lights.emplace(e, light_id);
+            dirty_lights.push_back(light_id);
+          }
+        }
+
+        if (has_atmosphere) {
+          const auto& atmos_info = it.field<const AtmosphereComponent>(2)[i];
+          self.atmosphere.rayleigh_scatter = atmos_info.rayleigh_scattering * 1e-3f;
+          self.atmosphere.rayleigh_density = atmos_info.rayleigh_density;
+          self.atmosphere.mie_scatter = atmos_info.mie_scattering * 1e-3f;
+          self.atmosphere.mie_density = atmos_info.mie_density;
+          self.atmosphere.mie_extinction = atmos_info.mie_extinction * 1e-3f;
+          self.atmosphere.mie_asymmetry = atmos_info.mie_asymmetry;
+          self.atmosphere.ozone_absorption = atmos_info.ozone_absorption * 1e-3f;
+          self.atmosphere.ozone_height = atmos_info.ozone_height;
+          self.atmosphere.ozone_thickness = atmos_info.ozone_thickness;
+          self.atmosphere.aerial_perspective_start_km = atmos_info.aerial_perspective_start_km;
+          self.atmosphere.aerial_perspective_exposure = atmos_info.aerial_perspective_exposure;
+        }
+
+        if (has_sky) {
+          const auto& sky_info = it.field<const SkyComponent>(3)[i];
+          self.sky_data.solid_color = sky_info.solid_color;
+          self.sky_data.ambient_color = sky_info.ambient_color;
+          self.sky_data.has_texture = static_cast<bool>(sky_info.texture);
+        }
+      }
+    }
+  });
+
+  // Lights that were destroyed, disabled or turned directional. Their slots are zeroed so the cull
+  // pass skips them until the slot gets reused.
+  auto stale_lights = std::vector<flecs::entity>{};
+  for (const auto& [e, light_id] : entity_lights) {
+    if (!seen_lights.contains(e)) {
+      stale_lights.push_back(e);
+    }
+  }
+  for (const auto e : stale_lights) {
+    const auto light_id = entity_lights[e];
+    *lights.slot(light_id) = GPU::Light{.intensity = 0.0f, .range = 0.0f};
+    dirty_lights.push_back(light_id);
+    lights.destroy_slot(light_id);
+    entity_lights.erase(e);
+  }
+
+  return self.scene_flags;
+}
+} // namespace ox
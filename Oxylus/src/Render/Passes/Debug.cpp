@@ -15,11 +15,11 @@ auto RendererInstance::apply_debug_view(this RendererInstance& self, DebugContex
     .page_table_size = RMVSMContext::DIRECTIONAL_PAGE_TABLE_SIZE,
     .physcial_page_table_size = RMVSMContext::DIRECTIONAL_IMAGE_SIZE,
     .clipmap_count = RMVSMContext::MAX_DIRECTIONAL_CLIPMAP_COUNT,
-    .first_clipmap_width = self.first_clipmap_width,
-    .clipmap_selection_bias = self.clipmap_selection_bias,
+    .first_clipmap_width = self.light_gather.first_clipmap_width,
+    .clipmap_selection_bias = self.light_gather.clipmap_selection_bias,
     .virtual_extent = RMVSMContext::DIRECTIONAL_IMAGE_SIZE,
     .z_length = 1.0f,
-    .directional_light_dir = self.directional_light.direction,
+    .directional_light_dir = self.light_gather.directional_light.direction,
   };
 
   auto debug_attachment = vuk::declare_ia(
@@ -10,8 +10,8 @@ auto RendererInstance::draw_atmosphere(this RendererInstance& self, AtmosphereCo
   ZoneScoped;
   auto sky_view_pass = vuk::make_pass(
     "sky view",
-    [sun_dir = self.directional_light.direction,
-     sun_intensity = self.directional_light.intensity,
+    [sun_dir = self.light_gather.directional_light.direction,
+     sun_intensity = self.light_gather.directional_light.intensity,
      camera_pos = self.camera_data.position](
       vuk::CommandBuffer& cmd_list, //
       VUK_IA(vuk::eComputeSampled) sky_transmittance_lut,
@@ -51,8 +51,8 @@ auto RendererInstance::draw_atmosphere(this RendererInstance& self, AtmosphereCo
 
   auto sky_cubemap_pass = vuk::make_pass(
     "sky cubemap",
-    [sun_dir = self.directional_light.direction,
-     sun_intensity = self.directional_light.intensity,
+    [sun_dir = self.light_gather.directional_light.direction,
+     sun_intensity = self.light_gather.directional_light.intensity,
      sun_ambient_strength = 0.15f,
      frame_index = static_cast<u32>(self.renderer.render_context->num_frames),
      atmosphere_address = self.prepared_frame.atmosphere_buffer->device_address](
@@ -95,7 +95,8 @@ auto RendererInstance::draw_atmosphere(this RendererInstance& self, AtmosphereCo
 
   auto sky_aerial_perspective_pass = vuk::make_pass(
     "sky aerial perspective",
-    [sun_dir = self.directional_light.direction, sun_intensity = self.directional_light.intensity](
+    [sun_dir = self.light_gather.directional_light.direction,
+     sun_intensity = self.light_gather.directional_light.intensity](
       vuk::CommandBuffer& cmd_list, //
       VUK_IA(vuk::eComputeSampled) sky_transmittance_lut,
       VUK_IA(vuk::eComputeSampled) sky_multiscatter_lut,
@@ -310,6 +311,56 @@ auto RendererInstance::generate_ambient_occlusion(this RendererInstance& self, A
   );
 }
 
+auto RendererInstance::cluster_lights(this RendererInstance& self, PBRContext& context) -> void {
+  ZoneScoped;
+
+  auto& render_context = *self.renderer.render_context;
+  context.cluster_light_counts_buffer = render_context.alloc_transient_buffer(
+    vuk::MemoryUsage::eGPUonly,
+    GPU::LIGHT_CLUSTER_COUNT * sizeof(u32)
+  );
+  context.cluster_light_indices_buffer = render_context.alloc_transient_buffer(
+    vuk::MemoryUsage::eGPUonly,
+    GPU::LIGHT_CLUSTER_COUNT * GPU::MAX_LIGHTS_PER_CLUSTER * sizeof(u32)
+  );
+
+  // Destroyed slots stay in the buffer zeroed out, so the whole slot range is culled.
+  auto cull_pass = vuk::make_pass(
+    "light cluster cull",
+    [light_count = static_cast<u32>(self.scene.lights.slots_unsafe().size())](
+      vuk::CommandBuffer& cmd_list,
+      VUK_BA(vuk::eComputeUniformRead) camera,
+      VUK_BA(vuk::eComputeRead) lights,
+      VUK_BA(vuk::eComputeWrite) cluster_light_counts,
+      VUK_BA(vuk::eComputeWrite) cluster_light_indices
+    ) {
+      cmd_list //
+        .bind_compute_pipeline("light_cluster_cull")
+        .bind_buffer(0, 0, camera)
+        .bind_buffer(0, 1, lights)
+        .bind_buffer(0, 2, cluster_light_counts)
+        .bind_buffer(0, 3, cluster_light_indices)
+        .push_constants(vuk::ShaderStageFlagBits::eCompute, 0, light_count)
+        .dispatch_invocations(GPU::LIGHT_CLUSTER_COUNT);
+
+      return std::make_tuple(camera, lights, cluster_light_counts, cluster_light_indices);
+    }
+  );
+
+  std::tie(
+    self.prepared_frame.camera_buffer,
+    self.prepared_frame.lights_buffer,
+    context.cluster_light_counts_buffer,
+    context.cluster_light_indices_buffer
+  ) =
+    cull_pass(
+      std::move(self.prepared_frame.camera_buffer),
+      std::move(self.prepared_frame.lights_buffer),
+      std::move(context.cluster_light_counts_buffer),
+      std::move(context.cluster_light_indices_buffer)
+    );
+}
+
 auto RendererInstance::apply_pbr(
   this RendererInstance& self, PBRContext& context, vuk::Value<vuk::ImageAttachment>&& dst_attachment
 ) -> vuk::Value<vuk::ImageAttachment> {
@@ -320,8 +371,8 @@ auto RendererInstance::apply_pbr(
     auto pbr_apply_pass = vuk::make_pass(
       "pbr apply",
       [scene_flags = self.gpu_scene_flags,
-       sun_dir = self.directional_light.direction,
-       sun_intensity = self.directional_light.intensity,
+       sun_dir = self.light_gather.directional_light.direction,
+       sun_intensity = self.light_gather.directional_light.intensity,
        light_count = static_cast<u32>(self.scene.lights.size()),
        atmosphere_address = self.prepared_frame.atmosphere_buffer->device_address](
         vuk::CommandBuffer& cmd_list,
@@ -339,7 +390,9 @@ auto RendererInstance::apply_pbr(
         VUK_IA(vuk::eFragmentSampled) resolved_shadows,
         VUK_IA(vuk::eFragmentSampled) contact_shadows,
         VUK_BA(vuk::eFragmentUniformRead) camera,
-        VUK_BA(vuk::eFragmentRead) lights
+        VUK_BA(vuk::eFragmentRead) lights,
+        VUK_BA(vuk::eFragmentRead) cluster_light_counts,
+        VUK_BA(vuk::eFragmentRead) cluster_light_indices
       ) {
         cmd_list //
           .bind_graphics_pipeline("pbr_apply")
@@ -372,7 +425,9 @@ auto RendererInstance::apply_pbr(
               glm::vec3(0.03f),
               light_count,
               atmosphere_address,
-              lights->device_address
+              lights->device_address,
+              cluster_light_counts->device_address,
+              cluster_light_indices->device_address
             )
           )
           .specialize_constants(0, std::to_underlying(scene_flags))
@@ -393,7 +448,9 @@ auto RendererInstance::apply_pbr(
           resolved_shadows,
           contact_shadows,
           camera,
-          lights
+          lights,
+          cluster_light_counts,
+          cluster_light_indices
         );
       }
     );
@@ -413,7 +470,9 @@ auto RendererInstance::apply_pbr(
       context.resolved_shadows_attachment,
       context.contact_shadows_attachment,
       self.prepared_frame.camera_buffer,
-      self.prepared_frame.lights_buffer
+      self.prepared_frame.lights_buffer,
+      context.cluster_light_counts_buffer,
+      context.cluster_light_indices_buffer
     ) =
       pbr_apply_pass(
         std::move(dst_attachment),
@@ -430,16 +489,18 @@ auto RendererInstance::apply_pbr(
         std::move(context.resolved_shadows_attachment),
         std::move(context.contact_shadows_attachment),
         std::move(self.prepared_frame.camera_buffer),
-        std::move(self.prepared_frame.lights_buffer)
+        std::move(self.prepared_frame.lights_buffer),
+        std::move(context.cluster_light_counts_buffer),
+        std::move(context.cluster_light_indices_buffer)
       );
   } else {
     auto pbr_apply_pass = vuk::make_pass(
       "pbr apply",
       [scene_flags = self.gpu_scene_flags,
-       sun_dir = self.directional_light.direction,
-       sun_intensity = self.directional_light.intensity,
+       sun_dir = self.light_gather.directional_light.direction,
+       sun_intensity = self.light_gather.directional_light.intensity,
        light_count = static_cast<u32>(self.scene.lights.size()),
-       sky_address = self.renderer.render_context->scratch_buffer(self.sky_data)->device_address](
+       sky_address = self.renderer.render_context->scratch_buffer(self.light_gather.sky_data)->device_address](
         vuk::CommandBuffer& cmd_list,
         VUK_IA(vuk::eColorWrite) dst,
         VUK_IA(vuk::eFragmentSampled) depth,
@@ -451,7 +512,9 @@ auto RendererInstance::apply_pbr(
         VUK_IA(vuk::eFragmentSampled) resolved_shadows,
         VUK_IA(vuk::eFragmentSampled) contact_shadows,
         VUK_BA(vuk::eFragmentUniformRead) camera,
-        VUK_BA(vuk::eFragmentRead) lights
+        VUK_BA(vuk::eFragmentRead) lights,
+        VUK_BA(vuk::eFragmentRead) cluster_light_counts,
+        VUK_BA(vuk::eFragmentRead) cluster_light_indices
       ) {
         cmd_list //
           .bind_graphics_pipeline("pbr_apply_no_atmos")
@@ -480,7 +543,9 @@ auto RendererInstance::apply_pbr(
               glm::vec3(0.03f),
               light_count,
               lights->device_address,
-              sky_address
+              sky_address,
+              cluster_light_counts->device_address,
+              cluster_light_indices->device_address
             )
           )
           .specialize_constants(0, std::to_underlying(scene_flags))
@@ -497,7 +562,9 @@ auto RendererInstance::apply_pbr(
           resolved_shadows,
           contact_shadows,
           camera,
-          lights
+          lights,
+          cluster_light_counts,
+          cluster_light_indices
         );
       }
     );
@@ -513,7 +580,9 @@ auto RendererInstance::apply_pbr(
       context.resolved_shadows_attachment,
       context.contact_shadows_attachment,
       self.prepared_frame.camera_buffer,
-      self.prepared_frame.lights_buffer
+      self.prepared_frame.lights_buffer,
+      context.cluster_light_counts_buffer,
+      context.cluster_light_indices_buffer
     ) =
       pbr_apply_pass(
         std::move(dst_attachment),
@@ -526,7 +595,9 @@ auto RendererInstance::apply_pbr(
         std::move(context.resolved_shadows_attachment),
         std::move(context.contact_shadows_attachment),
         std::move(self.prepared_frame.camera_buffer),
-        std::move(self.prepared_frame.lights_buffer)
+        std::move(self.prepared_frame.lights_buffer),
+        std::move(context.cluster_light_counts_buffer),
+        std::move(context.cluster_light_indices_buffer)
       );
   }
 
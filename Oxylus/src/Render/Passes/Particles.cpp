@@ -0,0 +1,278 @@
+#include <vuk/runtime/CommandBuffer.hpp>
+
+#include "Render/RendererInstance.hpp"
+#include "Render/Utils/VukCommon.hpp"
+
+namespace ox {
+static auto particle_instance_pack() -> vuk::Packed {
+  return vuk::Packed{
+    vuk::Format::eR32G32B32Sfloat,    // 12 position
+    vuk::Format::eR32G32Sfloat,       // 8 size
+    vuk::Format::eR32Uint,            // 4 color
+    vuk::Format::eR32G32B32A32Sfloat, // 16 rotation
+  };
+}
+
+static auto bind_particle_pipeline(vuk::CommandBuffer& cmd_list, vuk::PersistentDescriptorSet& descriptor_set)
+  -> vuk::CommandBuffer& {
+  return cmd_list.bind_graphics_pipeline("2d_particle")
+    .set_depth_stencil(
+      vuk::PipelineDepthStencilStateCreateInfo{
+        .depthTestEnable = true,
+        .depthWriteEnable = false,
+        .depthCompareOp = vuk::CompareOp::eGreaterOrEqual,
+      }
+    )
+    .set_dynamic_state(vuk::DynamicStateFlagBits::eScissor | vuk::DynamicStateFlagBits::eViewport)
+    .set_viewport(0, vuk::Rect2D::framebuffer())
+    .set_scissor(0, vuk::Rect2D::framebuffer())
+    .broadcast_color_blend(vuk::BlendPreset::eAlphaBlend)
+    .set_rasterization({.cullMode = vuk::CullModeFlagBits::eNone})
+    .bind_persistent(1, descriptor_set);
+}
+
+auto RendererInstance::simulate_gpu_particles(
+  this RendererInstance& self, GPUParticleEmitter& emitter, const GPUParticleDraw& draw
+) -> std::pair<vuk::Value<vuk::Buffer>, vuk::Value<vuk::Buffer>> {
+  ZoneScoped;
+
+  auto& render_context = *self.renderer.render_context;
+  const auto capacity = draw.params.capacity;
+
+  if (emitter.capacity != capacity) {
+    const auto resize = [&render_context](vuk::Unique<vuk::Buffer>& buffer, usize size) {
+      buffer = render_context.resize_buffer(std::move(buffer), vuk::MemoryUsage::eGPUonly, size);
+    };
+    resize(emitter.particles_buffer, capacity * sizeof(GPU::ParticleState));
+    resize(emitter.alive_list_buffer, 2 * capacity * sizeof(u32));
+    resize(emitter.dead_list_buffer, capacity * sizeof(u32));
+    resize(emitter.counters_buffer, sizeof(GPU::ParticleCounters));
+    resize(emitter.instances_buffer, capacity * sizeof(GPU::ParticleInstance));
+    emitter.capacity = capacity;
+    emitter.parity = 0;
+    emitter.needs_reset = true;
+  }
+
+  auto params = draw.params;
+  params.parity = emitter.parity;
+  auto params_buffer = render_context.scratch_buffer(params);
+
+  const auto last_access = emitter.needs_reset ? vuk::eNone : vuk::eMemoryRead;
+  auto particles = vuk::acquire_buf("particles", *emitter.particles_buffer, last_access);
+  auto alive_list = vuk::acquire_buf("particle alive list", *emitter.alive_list_buffer, last_access);
+  auto dead_list = vuk::acquire_buf("particle dead list", *emitter.dead_list_buffer, last_access);
+  auto counters = vuk::acquire_buf("particle counters", *emitter.counters_buffer, last_access);
+  auto instances = vuk::acquire_buf("particle instances", *emitter.instances_buffer, vuk::eNone);
+
+  if (emitter.needs_reset) {
+    auto reset_pass = vuk::make_pass(
+      "particle reset",
+      [capacity](
+        vuk::CommandBuffer& cmd_list,
+        VUK_BA(vuk::eComputeRead) emitter_params,
+        VUK_BA(vuk::eComputeWrite) dead,
+        VUK_BA(vuk::eComputeWrite) counter
+      ) {
+        cmd_list //
+          .bind_compute_pipeline("particle_reset")
+          .bind_buffer(0, 0, emitter_params)
+          .bind_buffer(0, 1, dead)
+          .bind_buffer(0, 2, counter)
+          .dispatch_invocations(capacity);
+
+        return std::make_tuple(emitter_params, dead, counter);
+      }
+    );
+
+    std::tie(params_buffer, dead_list, counters) = reset_pass(
+      std::move(params_buffer),
+      std::move(dead_list),
+      std::move(counters)
+    );
+    emitter.needs_reset = false;
+  }
+
+  auto begin_pass = vuk::make_pass(
+    "particle begin",
+    [](vuk::CommandBuffer& cmd_list, VUK_BA(vuk::eComputeRead) emitter_params, VUK_BA(vuk::eComputeRW) counter) {
+      cmd_list //
+        .bind_compute_pipeline("particle_begin")
+        .bind_buffer(0, 0, emitter_params)
+        .bind_buffer(0, 1, counter)
+        .dispatch(1);
+
+      return std::make_tuple(emitter_params, counter);
+    }
+  );
+
+  std::tie(params_buffer, counters) = begin_pass(std::move(params_buffer), std::move(counters));
+
+  if (params.emit_count > 0) {
+    auto emit_pass = vuk::make_pass(
+      "particle emit",
+      [emit_count = params.emit_count](
+        vuk::CommandBuffer& cmd_list,
+        VUK_BA(vuk::eComputeRead) emitter_params,
+        VUK_BA(vuk::eComputeWrite) particle_states,
+        VUK_BA(vuk::eComputeRW) alive,
+        VUK_BA(vuk::eComputeRead) dead,
+        VUK_BA(vuk::eComputeRW) counter
+      ) {
+        cmd_list //
+          .bind_compute_pipeline("particle_emit")
+          .bind_buffer(0, 0, emitter_params)
+          .bind_buffer(0, 1, particle_states)
+          .bind_buffer(0, 2, alive)
+          .bind_buffer(0, 3, dead)
+          .bind_buffer(0, 4, counter)
+          .dispatch_invocations(emit_count);
+
+        return std::make_tuple(emitter_params, particle_states, alive, dead, counter);
+      }
+    );
+
+    std::tie(params_buffer, particles, alive_list, dead_list, counters) = emit_pass(
+      std::move(params_buffer),
+      std::move(particles),
+      std::move(alive_list),
+      std::move(dead_list),
+      std::move(counters)
+    );
+  }
+
+  // Survivors are compacted into the other half of the alive list and written straight into the
+  // instance buffer, `counters` doubles as the indirect draw.
+  auto simulate_pass = vuk::make_pass(
+    "particle simulate",
+    [capacity](
+      vuk::CommandBuffer& cmd_list,
+      VUK_BA(vuk::eComputeRead) emitter_params,
+      VUK_BA(vuk::eComputeRW) particle_states,
+      VUK_BA(vuk::eComputeRW) alive,
+      VUK_BA(vuk::eComputeRW) dead,
+      VUK_BA(vuk::eComputeRW) counter,
+      VUK_BA(vuk::eComputeWrite) instance
+    ) {
+      cmd_list //
+        .bind_compute_pipeline("particle_simulate")
+        .bind_buffer(0, 0, emitter_params)
+        .bind_buffer(0, 1, particle_states)
+        .bind_buffer(0, 2, alive)
+        .bind_buffer(0, 3, dead)
+        .bind_buffer(0, 4, counter)
+        .bind_buffer(0, 5, instance)
+        .dispatch_invocations(capacity);
+
+      return std::make_tuple(counter, instance);
+    }
+  );
+
+  std::tie(counters, instances) = simulate_pass(
+    std::move(params_buffer),
+    std::move(particles),
+    std::move(alive_list),
+    std::move(dead_list),
+    std::move(counters),
+    std::move(instances)
+  );
+
+  emitter.parity ^= 1;
+
+  return {std::move(counters), std::move(instances)};
+}
+
+auto RendererInstance::draw_particles(this RendererInstance& self, ParticleContext& context) -> void {
+  ZoneScoped;
+
+  if (!self.particle_batches.empty()) {
+    auto particle_instance_buffer = self.renderer.render_context->scratch_buffer_span(
+      std::span(self.particle_instances)
+    );
+
+    auto particle_pass = vuk::make_pass(
+      "2d_particle_pass",
+      [batches = self.particle_batches, &descriptor_set = *context.bindless_set](
+        vuk::CommandBuffer& cmd_list,
+        VUK_IA(vuk::eColorWrite) target,
+        VUK_IA(vuk::eDepthStencilRead) depth,
+        VUK_BA(vuk::eAttributeRead) instance_buffer,
+        VUK_BA(vuk::eVertexRead) materials,
+        VUK_BA(vuk::eVertexRead) camera
+      ) {
+        bind_particle_pipeline(cmd_list, descriptor_set)
+          .bind_vertex_buffer(0, instance_buffer, 0, particle_instance_pack(), vuk::VertexInputRate::eInstance);
+
+        for (const auto& batch : batches) {
+          cmd_list
+            .push_constants(
+              vuk::ShaderStageFlagBits::eVertex | vuk::ShaderStageFlagBits::eFragment,
+              0,
+              PushConstants(materials->device_address, camera->device_address, batch.material_index)
+            )
+            .draw(6, batch.count, 0, batch.offset);
+        }
+
+        return std::make_tuple(target, depth, camera, materials);
+      }
+    );
+
+    std::tie(
+      context.final_attachment,
+      context.depth_attachment,
+      self.prepared_frame.camera_buffer,
+      self.prepared_frame.materials_buffer
+    ) =
+      particle_pass(
+        std::move(context.final_attachment),
+        std::move(context.depth_attachment),
+        std::move(particle_instance_buffer),
+        std::move(self.prepared_frame.materials_buffer),
+        std::move(self.prepared_frame.camera_buffer)
+      );
+  }
+
+  for (const auto& draw : self.gpu_particle_draws) {
+    auto& emitter = self.gpu_particle_emitters[draw.entity];
+    auto [draw_cmd, instances] = self.simulate_gpu_particles(emitter, draw);
+
+    auto gpu_particle_pass = vuk::make_pass(
+      "2d_particle_gpu_pass",
+      [material_index = draw.material_index, &descriptor_set = *context.bindless_set](
+        vuk::CommandBuffer& cmd_list,
+        VUK_IA(vuk::eColorWrite) target,
+        VUK_IA(vuk::eDepthStencilRead) depth,
+        VUK_BA(vuk::eIndirectRead) draw_cmd_buffer,
+        VUK_BA(vuk::eAttributeRead) instance_buffer,
+        VUK_BA(vuk::eVertexRead) materials,
+        VUK_BA(vuk::eVertexRead) camera
+      ) {
+        bind_particle_pipeline(cmd_list, descriptor_set)
+          .bind_vertex_buffer(0, instance_buffer, 0, particle_instance_pack(), vuk::VertexInputRate::eInstance)
+          .push_constants(
+            vuk::ShaderStageFlagBits::eVertex | vuk::ShaderStageFlagBits::eFragment,
+            0,
+            PushConstants(materials->device_address, camera->device_address, material_index)
+          )
+          .draw_indirect(1, draw_cmd_buffer);
+
+        return std::make_tuple(target, depth, camera, materials);
+      }
+    );
+
+    std::tie(
+      context.final_attachment,
+      context.depth_attachment,
+      self.prepared_frame.camera_buffer,
+      self.prepared_frame.materials_buffer
+    ) =
+      gpu_particle_pass(
+        std::move(context.final_attachment),
+        std::move(context.depth_attachment),
+        std::move(draw_cmd),
+        std::move(instances),
+        std::move(self.prepared_frame.materials_buffer),
+        std::move(self.prepared_frame.camera_buffer)
+      );
+  }
+}
+} // namespace ox
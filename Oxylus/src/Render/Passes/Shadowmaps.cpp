@@ -74,11 +74,11 @@ auto RendererInstance::draw_virtual_shadowmap(this RendererInstance& self, RMVSM
     .physcial_page_table_size = RMVSMContext::DIRECTIONAL_IMAGE_SIZE,
     .clipmap_count = RMVSMContext::MAX_DIRECTIONAL_CLIPMAP_COUNT,
     .depth_extent = glm::ivec2(context.depth_extent.width, context.depth_extent.height),
-    .first_clipmap_width = self.first_clipmap_width,
-    .clipmap_selection_bias = self.clipmap_selection_bias,
+    .first_clipmap_width = self.light_gather.first_clipmap_width,
+    .clipmap_selection_bias = self.light_gather.clipmap_selection_bias,
     .virtual_extent = RMVSMContext::DIRECTIONAL_IMAGE_SIZE,
     .z_length = context.max_shadow_dist * 2.0f,
-    .directional_light_dir = self.directional_light.direction,
+    .directional_light_dir = self.light_gather.directional_light.direction,
   };
 
   GPU::VirtualClipmap directional_clipmaps[RMVSMContext::MAX_DIRECTIONAL_CLIPMAP_COUNT] = {};
@@ -91,7 +91,7 @@ auto RendererInstance::draw_virtual_shadowmap(this RendererInstance& self, RMVSM
   calculate_virtual_shadow_matrices(
     vsm_ctx,
     self.camera_data.position,
-    self.directional_light.direction,
+    self.light_gather.directional_light.direction,
     context.max_shadow_dist,
     directional_clipmaps
   );
@@ -431,7 +431,7 @@ auto RendererInstance::draw_virtual_shadowmap(this RendererInstance& self, RMVSM
   );
 
   auto clipmap_camera = GPU::CullCamera{
-    .position = -self.directional_light.direction,
+    .position = -self.light_gather.directional_light.direction,
     .acceptable_lod_error = self.camera_data.acceptable_lod_error,
     .resolution = self.camera_data.resolution,
     .near_clip = self.camera_data.near_clip,
@@ -761,11 +761,11 @@ auto RendererInstance::resolve_shadowmap(this RendererInstance& self, ShadowReso
     .page_table_size = RMVSMContext::DIRECTIONAL_PAGE_TABLE_SIZE,
     .physcial_page_table_size = RMVSMContext::DIRECTIONAL_IMAGE_SIZE,
     .clipmap_count = RMVSMContext::MAX_DIRECTIONAL_CLIPMAP_COUNT,
-    .first_clipmap_width = self.first_clipmap_width,
-    .clipmap_selection_bias = self.clipmap_selection_bias,
+    .first_clipmap_width = self.light_gather.first_clipmap_width,
+    .clipmap_selection_bias = self.light_gather.clipmap_selection_bias,
     .virtual_extent = RMVSMContext::DIRECTIONAL_IMAGE_SIZE,
     .z_length = context.max_shadow_dist * 2.0f,
-    .directional_light_dir = self.directional_light.direction,
+    .directional_light_dir = self.light_gather.directional_light.direction,
   };
 
   auto resolve_pass = vuk::make_pass(
@@ -11,13 +11,15 @@
 #include "Render/Utils/VukCommon.hpp"
 #include "Scene/SceneGPU.hpp"
 #include "Utils/Log.hpp"
+#include "Utils/Random.hpp"
 
 namespace ox {
-template <typename T>
-auto update_projected_transform_buffer(
+// Keeps a persistent GPU buffer in sync with a slot map, copying only the slots named in `dirty_ids`.
+template <typename T, typename Source, typename ID>
+auto update_projected_buffer(
   auto& render_context,
-  std::span<GPU::Transforms> gpu_transforms,
-  std::span<GPU::TransformID> dirty_transform_ids,
+  std::span<Source> source,
+  std::span<ID> dirty_ids,
   vuk::Unique<vuk::Buffer>& buffer,
   vuk::Value<vuk::Buffer>& prepared_buffer,
   auto projection,
@@ -28,12 +30,12 @@ auto update_projected_transform_buffer(
 
   constexpr auto full_rebuild_dirty_threshold = 0.4;
 
-  const auto element_count = gpu_transforms.size();
+  const auto element_count = source.size();
   constexpr auto element_size = sizeof(T);
-  const auto rebuild_needed = !buffer || buffer->size < gpu_transforms.size_bytes();
+  const auto rebuild_needed = !buffer || buffer->size < source.size_bytes();
 
-  buffer = render_context.resize_buffer(std::move(buffer), vuk::MemoryUsage::eGPUonly, gpu_transforms.size_bytes());
-  if (dirty_transform_ids.empty()) {
+  buffer = render_context.resize_buffer(std::move(buffer), vuk::MemoryUsage::eGPUonly, source.size_bytes());
+  if (dirty_ids.empty()) {
     if (buffer) {
       prepared_buffer = vuk::acquire_buf(buffer_name, *buffer, vuk::Access::eMemoryRead);
     }
@@ -41,8 +43,8 @@ auto update_projected_transform_buffer(
     return;
   }
 
-  auto unique_indices = stack.alloc<u32>(dirty_transform_ids.size());
-  for (const auto& [unique_index, dirty_id] : std::views::zip(unique_indices, dirty_transform_ids)) {
+  auto unique_indices = stack.alloc<u32>(dirty_ids.size());
+  for (const auto& [unique_index, dirty_id] : std::views::zip(unique_indices, dirty_ids)) {
     unique_index = SlotMap_decode_id(dirty_id).index;
   }
   std::sort(unique_indices.begin(), unique_indices.end());
@@ -54,7 +56,7 @@ auto update_projected_transform_buffer(
 
     auto staging = staging_stack.alloc<T>(element_count);
     for (auto i = 0_sz; i < element_count; ++i) {
-      staging[i] = projection(gpu_transforms[i]);
+      staging[i] = projection(source[i]);
     }
     prepared_buffer = render_context.upload_staging(staging, *buffer);
 
@@ -67,7 +69,7 @@ auto update_projected_transform_buffer(
   auto upload_buffer = render_context.alloc_transient_buffer(vuk::MemoryUsage::eCPUtoGPU, dirty_size_bytes);
   auto* dst_ptr = reinterpret_cast<T*>(upload_buffer->mapped_ptr);
   for (usize i = 0; i < dirty_count; ++i) {
-    dst_ptr[i] = projection(gpu_transforms[unique_indices[i]]);
+    dst_ptr[i] = projection(source[unique_indices[i]]);
   }
 
   struct CopyRange {
@@ -108,18 +110,97 @@ auto update_projected_transform_buffer(
   prepared_buffer = update_pass(std::move(upload_buffer), std::move(buffer_handle));
 }
 
+// Bakes the component curves the same way ParticlePool::simulate does: factor 1 -> start, 0 -> end.
+static auto make_particle_emitter_params(const ParticleSystemComponent& c) -> GPU::ParticleEmitterParams {
+  const auto inv_range = [](f32 min, f32 max) { return max != min ? 1.f / (max - min) : 0.f; };
+  const auto quat_xyzw = [](const glm::quat& q) { return glm::vec4(q.x, q.y, q.z, q.w); };
+
+  auto params = GPU::ParticleEmitterParams{
+    .origin = c.emitter_position,
+    .delta_time = c.gpu_delta_time,
+    .position_start = c.position_start,
+    .emit_count = c.gpu_emit_count,
+    .position_end = c.position_end,
+    .capacity = c.max_particles,
+    .start_velocity = c.start_velocity,
+    .start_lifetime = c.start_lifetime,
+    .start_color = c.start_color,
+    .start_rotation = quat_xyzw(c.start_rotation),
+    .start_size = glm::vec2(c.start_size),
+    .gravity = c.gravity_modifier * -9.8f,
+    .seed = Random::get_uint(),
+    .velocity_base = glm::vec3(1.f),
+    .force_base = glm::vec3(0.f),
+    .color_speed_min = c.color_by_speed_min_speed,
+    .color_speed_inv_range = inv_range(c.color_by_speed_min_speed, c.color_by_speed_max_speed),
+    .color_time_base = glm::vec4(1.f),
+    .color_speed_base = glm::vec4(1.f),
+    .size_time_base = glm::vec2(1.f),
+    .size_speed_base = glm::vec2(1.f),
+    .size_speed_min = c.size_by_speed_min_speed,
+    .size_speed_inv_range = inv_range(c.size_by_speed_min_speed, c.size_by_speed_max_speed),
+    .rotation_speed_min = c.rotation_by_speed_min_speed,
+    .rotation_speed_inv_range = inv_range(c.rotation_by_speed_min_speed, c.rotation_by_speed_max_speed),
+    .rotation_time_start = quat_xyzw(c.rotation_over_lifetime_start),
+    .rotation_time_end = quat_xyzw(c.rotation_over_lifetime_end),
+    .rotation_speed_start = quat_xyzw(c.rotation_by_speed_start),
+    .rotation_speed_end = quat_xyzw(c.rotation_by_speed_end),
+  };
+
+  if (c.velocity_over_lifetime_enabled) {
+    params.velocity_base = c.velocity_over_lifetime_end;
+    params.velocity_slope = c.velocity_over_lifetime_start - c.velocity_over_lifetime_end;
+  }
+  if (c.force_over_lifetime_enabled) {
+    params.force_base = c.force_over_lifetime_end;
+    params.force_slope = c.force_over_lifetime_start - c.force_over_lifetime_end;
+  }
+  if (c.color_over_lifetime_enabled) {
+    params.color_time_base = c.color_over_lifetime_end;
+    params.color_time_slope = c.color_over_lifetime_start - c.color_over_lifetime_end;
+  }
+  if (c.color_by_speed_enabled) {
+    params.color_speed_base = c.color_by_speed_end;
+    params.color_speed_slope = c.color_by_speed_start - c.color_by_speed_end;
+  }
+  if (c.size_over_lifetime_enabled) {
+    params.size_time_base = glm::vec2(c.size_over_lifetime_end);
+    params.size_time_slope = glm::vec2(c.size_over_lifetime_start - c.size_over_lifetime_end);
+  }
+  if (c.size_by_speed_enabled) {
+    params.size_speed_base = glm::vec2(c.size_by_speed_end);
+    params.size_speed_slope = glm::vec2(c.size_by_speed_start - c.size_by_speed_end);
+  }
+  if (c.rotation_over_lifetime_enabled)
+    params.flags |= GPU::ParticleEmitterFlags::RotationOverLifetime;
+  if (c.rotation_by_speed_enabled)
+    params.flags |= GPU::ParticleEmitterFlags::RotationBySpeed;
+
+  return params;
+}
+
 RendererInstance::RendererInstance(Scene& owner_scene, Renderer& parent_renderer)
     : scene(owner_scene),
       renderer(parent_renderer) {
 
   auto& render_context = App::get_rendercontext();
   auto& allocator = render_context.superframe_allocator;
-  render_queue_2d.init();
 
-  lights_buffer = render_context.allocate_buffer_super(
-    vuk::MemoryUsage::eGPUonly,
-    GPU::MAX_LIGHTS * sizeof(GPU::Light)
-  );
+  auto& world = scene.world;
+  camera_query = world.query_builder<const TransformComponent, const CameraComponent>().cached().build();
+  light_gather.init(world);
+  sprite_gather.init(world);
+  particle_system_query = world.query_builder<const ParticleSystemComponent>().cached().build();
+  auto_exposure_query = world.query_builder<const AutoExposureComponent>().cached().build();
+  vignette_query = world.query_builder<const TransformComponent, const VignetteComponent>().cached().build();
+  chromatic_aberration_query = world
+                                 .query_builder<const TransformComponent, const ChromaticAberrationComponent>()
+                                 .cached()
+                                 .build();
+  film_grain_query = world.query_builder<const TransformComponent, const FilmGrainComponent>().cached().build();
+  tonemapping_query = world.query_builder<const TonemappingComponent>().cached().build();
+
+  lights_buffer = render_context.allocate_buffer_super(vuk::MemoryUsage::eGPUonly, sizeof(GPU::Light));
   transforms_world_buffer = render_context.allocate_buffer_super(
     vuk::MemoryUsage::eGPUonly,
     sizeof(GPU::TransformWorld)
@@ -147,6 +228,11 @@ RendererInstance::RendererInstance(Scene& owner_scene, Renderer& parent_renderer
   });
   OX_ASSERT(sky_multiscatter_lut);
 
+  light_gather.atmosphere.sky_view_lut_size = sky_view_lut_extent;
+  light_gather.atmosphere.aerial_perspective_lut_size = sky_aerial_perspective_lut_extent;
+  light_gather.atmosphere.transmittance_lut_size = sky_transmittance_lut.get_extent();
+  light_gather.atmosphere.multiscattering_lut_size = sky_multiscatter_lut.get_extent();
+
   constexpr auto HILBERT_NOISE_LUT_WIDTH = 64_u32;
   auto hilbert_index = [](u32 pos_x, u32 pos_y) -> u16 {
     auto index = 0_u32;
@@ -517,10 +603,13 @@ auto RendererInstance::render(
   self.camera_data.resolution = {dst_extent.width, dst_extent.height};
   self.prepared_frame.camera_buffer = self.renderer.render_context->scratch_buffer(self.camera_data);
 
-  self.render_queue_2d.update();
-  self.render_queue_2d.sort();
+  self.sprite_gather.render_queue_2d.update();
+  if (!self.sprites_sorted) {
+    self.sprite_gather.render_queue_2d.sort();
+    self.sprites_sorted = true;
+  }
   auto vertex_buffer_2d = self.renderer.render_context->scratch_buffer_span(
-    std::span(self.render_queue_2d.sprite_data)
+    std::span(self.sprite_gather.render_queue_2d.sprite_data)
   );
 
   const auto scene_has_atmosphere = self.gpu_scene_flags & GPU::SceneFlags::HasAtmosphere;
@@ -824,6 +913,7 @@ auto RendererInstance::render(
         terrain_brush_context.maps.splat_edit = terrain->splat_edit.acquire("terrain splat edit", vuk::eComputeRW);
 
         self.scene.terrain->edits_dirty = true;
+        self.scene.terrain->mark_brush_collision_dirty();
       }
 
       if (terrain->brush.active) {
@@ -961,10 +1051,10 @@ auto RendererInstance::render(
     emissive_attachment = std::move(main_geometry_context.emissive_attachment);
     metallic_roughness_occlusion_attachment = std::move(main_geometry_context.metallic_roughness_occlusion_attachment);
 
-    if (self.directional_light_cast_shadows && has_meshes) {
+    if (self.light_gather.directional_light_cast_shadows && has_meshes) {
       auto rmvsm_context = RMVSMContext{
         .bindless_set = &bindless_set,
-        .sun_moved = self.sun_direction_changed,
+        .sun_moved = self.light_gather.sun_direction_changed,
         .depth_extent = dst_extent,
         .depth_attachment = std::move(depth_attachment),
       };
@@ -989,7 +1079,7 @@ auto RendererInstance::render(
 
     auto contact_shadows_pass = vuk::make_pass(
       "contact_shadows",
-      [sun_dir = self.directional_light.direction, &cvar](
+      [sun_dir = self.light_gather.directional_light.direction, &cvar](
         vuk::CommandBuffer& cmd_list,
         VUK_IA(vuk::eComputeRW) result,
         VUK_IA(vuk::eComputeSampled) src_depth,
@@ -1069,6 +1159,7 @@ auto RendererInstance::render(
     .contact_shadows_attachment = std::move(contact_shadows_attachment),
     .resolved_shadows_attachment = std::move(resolved_shadows_attachment),
   };
+  self.cluster_lights(pbr_context);
   final_attachment = self.apply_pbr(pbr_context, std::move(final_attachment));
   depth_attachment = std::move(pbr_context.depth_attachment);
   albedo_attachment = std::move(pbr_context.albedo_attachment);
@@ -1078,12 +1169,12 @@ auto RendererInstance::render(
   vbgtao_occlusion_attachment = std::move(pbr_context.ambient_occlusion_attachment);
 
   // --- 2D Pass ---
-  if (!self.render_queue_2d.sprite_data.empty()) {
+  if (!self.sprite_gather.render_queue_2d.sprite_data.empty()) {
     // WARN: rq2d is copied each frame (it needs to be copied)
 
     auto forward_2d_vis_pass = vuk::make_pass(
       "2d_forward_vis_pass",
-      [rq2d = self.render_queue_2d, &descriptor_set = bindless_set](
+      [rq2d = self.sprite_gather.render_queue_2d, &descriptor_set = bindless_set](
         vuk::CommandBuffer& cmd_list,
         VUK_IA(vuk::eColorWrite) target,
         VUK_IA(vuk::eDepthStencilRW) depth,
@@ -1148,7 +1239,7 @@ auto RendererInstance::render(
 
     auto forward_2d_pass = vuk::make_pass(
       "2d_forward_pass",
-      [rq2d = self.render_queue_2d, &descriptor_set = bindless_set](
+      [rq2d = self.sprite_gather.render_queue_2d, &descriptor_set = bindless_set](
         vuk::CommandBuffer& cmd_list,
         VUK_IA(vuk::eColorWrite) target,
         VUK_IA(vuk::eDepthStencilRW) depth,
@@ -1222,6 +1313,18 @@ auto RendererInstance::render(
     final_attachment = ctx.get_image_resource("final_attachment");
   }
 
+  // --- Particle Pass ---
+  if (!self.particle_batches.empty() || !self.gpu_particle_draws.empty()) {
+    auto particle_context = ParticleContext{
+      .bindless_set = &bindless_set,
+      .final_attachment = std::move(final_attachment),
+      .depth_attachment = std::move(depth_attachment),
+    };
+    self.draw_particles(particle_context);
+    final_attachment = std::move(particle_context.final_attachment);
+    depth_attachment = std::move(particle_context.depth_attachment);
+  }
+
   // --- FXAA Pass ---
   if (self.gpu_scene_flags & GPU::SceneFlags::HasFXAA) {
     auto fxaa_attachment = vuk::declare_ia(
@@ -1346,28 +1449,25 @@ auto RendererInstance::update(this RendererInstance& self, RendererInstanceUpdat
   CameraComponent frozen_camera = {};
   const auto freeze_culling = static_cast<bool>(cvar.cvar_freeze_culling_frustum.get());
 
-  self.scene.world
-    .query_builder<const TransformComponent, const CameraComponent>() //
-    .build()
-    .each([&](flecs::entity e, const TransformComponent& tc, const CameraComponent& c) {
-      if (freeze_culling && !self.saved_camera) {
-        self.saved_camera = true;
-        frozen_camera = current_camera;
-      } else if (!freeze_culling && self.saved_camera) {
-        self.saved_camera = false;
-      }
+  self.camera_query.each([&](flecs::entity e, const TransformComponent& tc, const CameraComponent& c) {
+    if (freeze_culling && !self.saved_camera) {
+      self.saved_camera = true;
+      frozen_camera = current_camera;
+    } else if (!freeze_culling && self.saved_camera) {
+      self.saved_camera = false;
+    }
 
-      if (
-        static_cast<bool>(cvar.cvar_freeze_culling_frustum.get()) &&
-        static_cast<bool>(cvar.cvar_draw_camera_frustum.get())
-      ) {
-        const auto proj = frozen_camera.get_projection_matrix() * frozen_camera.get_view_matrix();
-        auto& debug_renderer = App::mod<ox::DebugRenderer>();
-        debug_renderer.draw_frustum(proj, glm::vec4(0, 1, 0, 1), frozen_camera.near_clip, frozen_camera.far_clip);
-      }
+    if (
+      static_cast<bool>(cvar.cvar_freeze_culling_frustum.get()) &&
+      static_cast<bool>(cvar.cvar_draw_camera_frustum.get())
+    ) {
+      const auto proj = frozen_camera.get_projection_matrix() * frozen_camera.get_view_matrix();
+      auto& debug_renderer = App::mod<ox::DebugRenderer>();
+      debug_renderer.draw_frustum(proj, glm::vec4(0, 1, 0, 1), frozen_camera.near_clip, frozen_camera.far_clip);
+    }
 
-      current_camera = c;
-    });
+    current_camera = c;
+  });
 
   CameraComponent cam = freeze_culling ? frozen_camera : current_camera;
 
@@ -1398,186 +1498,112 @@ auto RendererInstance::update(this RendererInstance& self, RendererInstanceUpdat
 
   math::calc_frustum_planes(self.camera_data.projection_view, self.camera_data.frustum_planes);
 
-  self.scene.lights.reset();
+  auto& scene = self.scene;
+  self.gpu_scene_flags |= self.light_gather.gather(scene.lights, scene.entity_lights_map, scene.dirty_lights);
 
-  self.scene.world
-    .query_builder<const TransformComponent, const LightComponent>() //
-    .build()
-    .each([&self](flecs::entity e, const TransformComponent& tc, const LightComponent& lc) {
-      if (!e.enabled()) {
-        return;
-      }
+  self.post_proces_settings.exposure = cvar.cvar_exposure.get();
 
-      const glm::mat4 world_transform = self.scene.get_world_transform(e);
-      const glm::vec3 world_position = world_transform[3];
-      const glm::vec3 world_forward = glm::normalize(glm::mat3(world_transform) * glm::vec3(0.0f, 0.0f, -1.0f));
-
-      if (lc.type == LightComponent::LightType::Directional) {
-        self.gpu_scene_flags |= GPU::SceneFlags::HasDirectionalLight;
-        self.directional_light.color = lc.color;
-        self.directional_light.intensity = lc.intensity;
-        self.sun_direction_changed = world_forward != self.previous_sun_direction;
-        self.previous_sun_direction = world_forward;
-        self.directional_light.direction = world_forward;
-        self.first_clipmap_width = lc.first_clipmap_width;
-        self.clipmap_selection_bias = lc.clipmap_selection_bias;
-
-        self.directional_light_cast_shadows = lc.cast_shadows;
-      } else {
-        const auto kind = lc.type == LightComponent::LightType::Spot ? GPU::LightKind::Spot : GPU::LightKind::Point;
-        const auto direction = lc.type == LightComponent::LightType::Spot ? world_forward : glm::vec3(0.0f);
-        self.scene.lights.create_slot(
-          GPU::Light{
-            .position = world_position,
-            .intensity = lc.intensity,
-            .color = lc.color,
-            .range = lc.radius,
-            .direction = direction,
-            .inner_cone_angle = lc.inner_cone_angle,
-            .outer_cone_angle = lc.outer_cone_angle,
-            .kind = kind,
-          }
-        );
-      }
-      if (const auto* atmos_info = e.try_get<AtmosphereComponent>()) {
-        self.gpu_scene_flags |= GPU::SceneFlags::HasAtmosphere;
-
-        self.atmosphere.rayleigh_scatter = atmos_info->rayleigh_scattering * 1e-3f;
-        self.atmosphere.rayleigh_density = atmos_info->rayleigh_density;
-        self.atmosphere.mie_scatter = atmos_info->mie_scattering * 1e-3f;
-        self.atmosphere.mie_density = atmos_info->mie_density;
-        self.atmosphere.mie_extinction = atmos_info->mie_extinction * 1e-3f;
-        self.atmosphere.mie_asymmetry = atmos_info->mie_asymmetry;
-        self.atmosphere.ozone_absorption = atmos_info->ozone_absorption * 1e-3f;
-        self.atmosphere.ozone_height = atmos_info->ozone_height;
-        self.atmosphere.ozone_thickness = atmos_info->ozone_thickness;
-        self.atmosphere.aerial_perspective_start_km = atmos_info->aerial_perspective_start_km;
-        self.atmosphere.aerial_perspective_exposure = atmos_info->aerial_perspective_exposure;
-        self.atmosphere.sky_view_lut_size = self.sky_view_lut_extent;
-        self.atmosphere.aerial_perspective_lut_size = self.sky_aerial_perspective_lut_extent;
-        self.atmosphere.transmittance_lut_size = self.sky_transmittance_lut.get_extent();
-        self.atmosphere.multiscattering_lut_size = self.sky_multiscatter_lut.get_extent();
-      }
+  const auto material_index = [&asset_man](const UUID& uuid) -> option<u32> {
+    auto material = asset_man.get_asset(uuid);
+    if (!material) {
+      return nullopt;
+    }
 
-      if (const auto* sky_info = e.try_get<SkyComponent>()) {
-        self.gpu_scene_flags |= GPU::SceneFlags::HasSky;
+    return SlotMap_decode_id(material->material_id).index;
+  };
+  if (self.sprite_gather.gather(cam.position.z, scene.entity_transforms_map, material_index)) {
+    self.sprites_sorted = false;
+  }
 
-        self.sky_data.solid_color = sky_info->solid_color;
-        self.sky_data.ambient_color = sky_info->ambient_color;
-        self.sky_data.has_texture = static_cast<bool>(sky_info->texture);
-      }
-    });
+  self.particle_instances.clear();
+  self.particle_batches.clear();
+  self.gpu_particle_draws.clear();
+  for (auto& [_, emitter] : self.gpu_particle_emitters) {
+    emitter.seen = false;
+  }
+  self.particle_system_query.each([&asset_man, &self](flecs::entity e, const ParticleSystemComponent& comp) {
+    if (comp.gpu_simulation) {
+      if (comp.max_particles == 0)
+        return;
 
-  self.post_proces_settings.exposure = cvar.cvar_exposure.get();
+      // Before the material check, an emitter whose material is still loading keeps its buffers
+      // and particles.
+      auto& emitter = self.gpu_particle_emitters[e.id()];
+      emitter.seen = true;
 
-  self.render_queue_2d.init();
-
-  self.scene.world
-    .query_builder<const TransformComponent, const SpriteComponent>() //
-    .build()
-    .each([&asset_man,
-           &s = self.scene,
-           &cam,
-           &rq2d = self.render_queue_2d](flecs::entity e, const TransformComponent& tc, const SpriteComponent& comp) {
-      const auto distance = glm::distance(glm::vec3(0.f, 0.f, cam.position.z), glm::vec3(0.f, 0.f, tc.position.z));
-      if (auto material = asset_man.get_asset(comp.material)) {
-        u16 flags = 0;
-        if (comp.sort_y)
-          flags |= GPU::RENDER_FLAGS_2D_SORT_Y;
-        if (comp.flip_x)
-          flags |= GPU::RENDER_FLAGS_2D_FLIP_X;
-
-        if (auto transform_id = s.get_entity_transform_id(e)) {
-          rq2d.add(
-            flags,
-            tc.position.y,
-            SlotMap_decode_id(*transform_id).index,
-            SlotMap_decode_id(material->material_id).index,
-            distance
-          );
-        } else {
-          OX_LOG_WARN("No registered transform for sprite entity: {}", e.name().c_str());
-        }
-      }
-    });
-
-  self.scene.world
-    .query_builder<const TransformComponent, const ParticleComponent>() //
-    .build()
-    .each([&asset_man,
-           &s = self.scene,
-           &cam,
-           &rq2d = self.render_queue_2d](flecs::entity e, const TransformComponent& tc, const ParticleComponent& comp) {
-      if (comp.life_remaining <= 0.0f)
+      auto material = asset_man.get_asset(comp.material);
+      if (!material)
         return;
 
-      const auto distance = glm::distance(glm::vec3(0.f, 0.f, cam.position.z), glm::vec3(0.f, 0.f, tc.position.z));
-
-      auto particle_system_component = e.parent().try_get<ParticleSystemComponent>();
-      if (particle_system_component) {
-        if (auto material = asset_man.get_asset(particle_system_component->material)) {
-          if (auto transform_id = s.get_entity_transform_id(e)) {
-            rq2d.add(
-              GPU::RENDER_FLAGS_2D_SORT_Y,
-              tc.position.y,
-              SlotMap_decode_id(*transform_id).index,
-              SlotMap_decode_id(material->material_id).index,
-              distance
-            );
-          } else {
-            OX_LOG_WARN("No registered transform for sprite entity: {}", e.name().c_str());
-          }
-        }
-      }
-    });
-
-  self.scene.world
-    .query_builder<const AutoExposureComponent>() //
-    .build()
-    .each([&self](flecs::entity e, const AutoExposureComponent& c) {
-      self.gpu_scene_flags |= GPU::SceneFlags::HasEyeAdaptation;
-      self.eye_adaptation.max_exposure = c.max_exposure;
-      self.eye_adaptation.min_exposure = c.min_exposure;
-      self.eye_adaptation.adaptation_speed = c.adaptation_speed;
-      self.eye_adaptation.ev100_bias = c.ev100_bias;
-    });
-
-  self.scene.world
-    .query_builder<const TransformComponent, const VignetteComponent>() //
-    .build()
-    .each([&](flecs::entity e, const TransformComponent& tc, const VignetteComponent& c) {
-      self.post_proces_settings.vignette_amount = c.amount;
-
-      self.gpu_scene_flags |= GPU::SceneFlags::HasVignette;
-    });
-
-  self.scene.world
-    .query_builder<const TransformComponent, const ChromaticAberrationComponent>() //
-    .build()
-    .each([&](flecs::entity e, const TransformComponent& tc, const ChromaticAberrationComponent& c) {
+      self.gpu_particle_draws.push_back(
+        {.entity = e.id(),
+         .material_index = SlotMap_decode_id(material->material_id).index,
+         .params = make_particle_emitter_params(comp)}
+      );
+      return;
+    }
+
+    auto material = asset_man.get_asset(comp.material);
+    if (!material)
+      return;
+
+    const auto& pool = comp.pool;
+    if (pool.alive_count == 0)
+      return;
+
+    const auto offset = static_cast<u32>(self.particle_instances.size());
+    self.particle_instances.resize(offset + pool.alive_count);
+    auto* instances = self.particle_instances.data() + offset;
+    for (u32 i = 0; i < pool.alive_count; i++) {
+      const auto& rotation = pool.rotation[i];
+      instances[i] = {
+        .position = {pool.position_x[i], pool.position_y[i], pool.position_z[i]},
+        .size = {pool.size_x[i], pool.size_y[i]},
+        .color = pool.color[i],
+        .rotation = {rotation.x, rotation.y, rotation.z, rotation.w},
+      };
+    }
+
+    self.particle_batches.push_back(
+      {.material_index = SlotMap_decode_id(material->material_id).index, .offset = offset, .count = pool.alive_count}
+    );
+  });
+  std::erase_if(self.gpu_particle_emitters, [](const auto& it) { return !it.second.seen; });
+
+  self.auto_exposure_query.each([&self](flecs::entity e, const AutoExposureComponent& c) {
+    self.gpu_scene_flags |= GPU::SceneFlags::HasEyeAdaptation;
+    self.eye_adaptation.max_exposure = c.max_exposure;
+    self.eye_adaptation.min_exposure = c.min_exposure;
+    self.eye_adaptation.adaptation_speed = c.adaptation_speed;
+    self.eye_adaptation.ev100_bias = c.ev100_bias;
+  });
+
+  self.vignette_query.each([&](flecs::entity e, const TransformComponent& tc, const VignetteComponent& c) {
+    self.post_proces_settings.vignette_amount = c.amount;
+
+    self.gpu_scene_flags |= GPU::SceneFlags::HasVignette;
+  });
+
+  self.chromatic_aberration_query.each(
+    [&](flecs::entity e, const TransformComponent& tc, const ChromaticAberrationComponent& c) {
       self.post_proces_settings.chromatic_aberration_amount = c.amount;
 
       self.gpu_scene_flags |= GPU::SceneFlags::HasChromaticAberration;
-    });
-
-  self.scene.world
-    .query_builder<const TransformComponent, const FilmGrainComponent>() //
-    .build()
-    .each([&](flecs::entity e, const TransformComponent& tc, const FilmGrainComponent& c) {
-      self.post_proces_settings.film_grain_amount = c.amount;
-      self.post_proces_settings.film_grain_scale = c.scale;
-      self.post_proces_settings.film_grain_seed = render_context.num_frames % 16;
-
-      self.gpu_scene_flags |= GPU::SceneFlags::HasFilmGrain;
-    });
-
-  self.scene.world
-    .query_builder<const TonemappingComponent>() //
-    .build()
-    .each([&](flecs::entity e, const TonemappingComponent& tc) {
-      self.tonemap_type = tc.tonemap_type;
-      //
-    });
+    }
+  );
+
+  self.film_grain_query.each([&](flecs::entity e, const TransformComponent& tc, const FilmGrainComponent& c) {
+    self.post_proces_settings.film_grain_amount = c.amount;
+    self.post_proces_settings.film_grain_scale = c.scale;
+    self.post_proces_settings.film_grain_seed = render_context.num_frames % 16;
+
+    self.gpu_scene_flags |= GPU::SceneFlags::HasFilmGrain;
+  });
+
+  self.tonemapping_query.each([&](flecs::entity e, const TonemappingComponent& tc) {
+    self.tonemap_type = tc.tonemap_type;
+    //
+  });
 
   auto zero_fill_pass = vuk::make_pass(
     "zero fill",
@@ -1587,7 +1613,7 @@ auto RendererInstance::update(this RendererInstance& self, RendererInstanceUpdat
     }
   );
 
-  update_projected_transform_buffer<GPU::TransformWorld>(
+  update_projected_buffer<GPU::TransformWorld>(
     render_context,
     info.gpu_transforms,
     info.dirty_transform_ids,
@@ -1597,7 +1623,7 @@ auto RendererInstance::update(this RendererInstance& self, RendererInstanceUpdat
     "transforms_world",
     "update transform world"
   );
-  update_projected_transform_buffer<GPU::TransformPrevious>(
+  update_projected_buffer<GPU::TransformPrevious>(
     render_context,
     info.gpu_transforms,
     info.dirty_transform_ids,
@@ -1610,21 +1636,18 @@ auto RendererInstance::update(this RendererInstance& self, RendererInstanceUpdat
   // Materials are global and already synced by the renderer; this instance only reads them.
   self.prepared_frame.materials_buffer = self.renderer.get_materials_buffer();
 
-  {
-    const auto lights_span = self.scene.lights.slots_unsafe();
-    const auto count = std::min<std::size_t>(lights_span.size(), GPU::MAX_LIGHTS);
-    const auto size_bytes = count * sizeof(GPU::Light);
-    if (count > 0) {
-      auto src_buffer = render_context.alloc_transient_buffer(vuk::MemoryUsage::eCPUtoGPU, size_bytes);
-      std::memcpy(src_buffer->mapped_ptr, lights_span.data(), size_bytes);
-      auto dst_buffer = vuk::acquire_buf("lights", self.lights_buffer->subrange(0, size_bytes), vuk::eMemoryRead);
-      self.prepared_frame.lights_buffer = vuk::copy(std::move(src_buffer), std::move(dst_buffer));
-    } else {
-      self.prepared_frame.lights_buffer = vuk::acquire_buf("lights", *self.lights_buffer, vuk::eMemoryRead);
-    }
-  }
+  update_projected_buffer<GPU::Light>(
+    render_context,
+    self.scene.lights.slots_unsafe(),
+    std::span(self.scene.dirty_lights),
+    self.lights_buffer,
+    self.prepared_frame.lights_buffer,
+    [](const GPU::Light& light) { return light; },
+    "lights",
+    "update lights"
+  );
 
-  self.prepared_frame.atmosphere_buffer = self.renderer.render_context->scratch_buffer(self.atmosphere);
+  self.prepared_frame.atmosphere_buffer = self.renderer.render_context->scratch_buffer(self.light_gather.atmosphere);
 
   if (!info.gpu_meshes.empty()) {
     self.meshes_buffer = render_context.resize_buffer(
@@ -0,0 +1,64 @@
+#include "Render/SpriteGather.hpp"
+
+#include "Utils/Log.hpp"
+
+namespace ox {
+auto SpriteGather::init(this SpriteGather& self, flecs::world& world) -> void {
+  ZoneScoped;
+
+  self.render_queue_2d.init();
+  self.query = world
+                 .query_builder<const TransformComponent, const SpriteComponent>() //
+                 .cached()
+                 .detect_changes()
+                 .build();
+}
+
+auto SpriteGather::gather(
+  this SpriteGather& self,
+  f32 camera_z,
+  const ankerl::unordered_dense::map<flecs::entity, GPU::TransformID>& entity_transforms,
+  const std::function<option<u32>(const UUID&)>& material_index
+) -> bool {
+  ZoneScoped;
+
+  if (!self.dirty && !self.query.changed() && camera_z == self.camera_z) {
+    return false;
+  }
+
+  self.dirty = false;
+  self.camera_z = camera_z;
+  self.gather_count += 1;
+  self.render_queue_2d.init();
+
+  self.query.each([&](flecs::entity e, const TransformComponent& tc, const SpriteComponent& comp) {
+    const auto distance = glm::distance(glm::vec3(0.f, 0.f, camera_z), glm::vec3(0.f, 0.f, tc.position.z));
+    const auto material = material_index(comp.material);
+    if (!material.has_value()) {
+      // Still loading, nothing else will mark the sprite changed once it is.
+      self.dirty = true;
+      return;
+    }
+
+    u16 flags = 0;
+    if (comp.sort_y)
+      flags |= GPU::RENDER_FLAGS_2D_SORT_Y;
+    if (comp.flip_x)
+      flags |= GPU::RENDER_FLAGS_2D_FLIP_X;
+
+    if (const auto transform_it = entity_transforms.find(e); transform_it != entity_transforms.end()) {
+      self.render_queue_2d.add(
+        flags,
+        tc.position.y,
+        SlotMap_decode_id(transform_it->second).index,
+        *material,
+        distance
+      );
+    } else {
+      OX_LOG_WARN("No registered transform for sprite entity: {}", e.name().c_str());
+    }
+  });
+
+  return true;
+}
+} // namespace ox
@@ -51,6 +51,7 @@ CoreComponentsModule::CoreComponentsModule(flecs::world& world) {
   registry.bind_enum<CameraComponent::Projection>("CameraProjection");
   registry.bind_enum<LightComponent::LightType>("LightType");
   registry.bind_enum<RigidBodyComponent::BodyType>("RigidBodyType");
+  registry.bind_enum<MeshColliderComponent::ShapeType>("MeshColliderShape");
   registry.bind_enum<GPU::TonemapType>("TonemapType");
 
   {
@@ -135,7 +136,8 @@ CoreComponentsModule::CoreComponentsModule(flecs::world& world) {
       &C::rotation_by_speed_start,
       &C::rotation_by_speed_end,
       &C::rotation_by_speed_min_speed,
-      &C::rotation_by_speed_max_speed>();
+      &C::rotation_by_speed_max_speed,
+      &C::gpu_simulation>();
   }
 
   {
@@ -288,7 +290,7 @@ CoreComponentsModule::CoreComponentsModule(flecs::world& world) {
 
   {
     using C = MeshColliderComponent;
-    registry.bind<&C::offset, &C::friction, &C::restitution>();
+    registry.bind<&C::shape_type, &C::max_convex_parts, &C::offset, &C::friction, &C::restitution>();
   }
 
   {
@@ -348,5 +350,15 @@ CoreComponentsModule::CoreComponentsModule(flecs::world& world) {
     using C = TonemappingComponent;
     registry.bind<&C::tonemap_type>();
   }
+
+  {
+    using C = NetRelevancy;
+    registry.bind<&C::priority, &C::update_interval>();
+  }
+
+  {
+    using C = NetInputAck;
+    registry.bind<&C::sequence>().tags<Networked>();
+  }
 }
 } // namespace ox
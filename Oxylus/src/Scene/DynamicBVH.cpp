@@ -0,0 +1,333 @@
+#include "Scene/DynamicBVH.hpp"
+
+#include <tracy/Tracy.hpp>
+
+namespace ox {
+namespace {
+auto combine(const AABB& a, const AABB& b) -> AABB { return AABB(glm::min(a.min, b.min), glm::max(a.max, b.max)); }
+
+auto surface_area(const AABB& aabb) -> f32 {
+  const auto d = aabb.max - aabb.min;
+  return 2.0f * (d.x * d.y + d.y * d.z + d.z * d.x);
+}
+
+auto contains(const AABB& outer, const AABB& inner) -> bool {
+  return glm::all(glm::lessThanEqual(outer.min, inner.min)) && glm::all(glm::greaterThanEqual(outer.max, inner.max));
+}
+
+auto fatten(const AABB& aabb, f32 margin) -> AABB { return AABB(aabb.min - margin, aabb.max + margin); }
+} // namespace
+
+auto DynamicBVH::create_proxy(this DynamicBVH& self, const AABB& aabb, u64 user_data) -> u32 {
+  ZoneScoped;
+
+  const auto proxy = self.allocate_node();
+  auto& node = self.nodes[proxy];
+  node.aabb = fatten(aabb, AABB_MARGIN);
+  node.user_data = user_data;
+  node.height = 0;
+
+  self.insert_leaf(proxy);
+  self.proxy_count += 1;
+
+  return proxy;
+}
+
+auto DynamicBVH::destroy_proxy(this DynamicBVH& self, u32 proxy) -> void {
+  ZoneScoped;
+
+  OX_CHECK_LT(proxy, self.nodes.size());
+  OX_ASSERT(self.nodes[proxy].is_leaf());
+
+  self.remove_leaf(proxy);
+  self.free_node(proxy);
+  self.proxy_count -= 1;
+}
+
+auto DynamicBVH::move_proxy(this DynamicBVH& self, u32 proxy, const AABB& aabb) -> bool {
+  ZoneScoped;
+
+  OX_CHECK_LT(proxy, self.nodes.size());
+  OX_ASSERT(self.nodes[proxy].is_leaf());
+
+  const auto fat_aabb = fatten(aabb, AABB_MARGIN);
+  const auto& tree_aabb = self.nodes[proxy].aabb;
+  // Still enclosed, and the old bounds aren't so much bigger (shrunk object) that they'd
+  // degrade the tree.
+  if (contains(tree_aabb, aabb) && contains(fatten(fat_aabb, 4.0f * AABB_MARGIN), tree_aabb)) {
+    return false;
+  }
+
+  self.remove_leaf(proxy);
+  self.nodes[proxy].aabb = fat_aabb;
+  self.insert_leaf(proxy);
+
+  return true;
+}
+
+auto DynamicBVH::clear(this DynamicBVH& self) -> void {
+  self.nodes.clear();
+  self.root = NULL_NODE;
+  self.free_list = NULL_NODE;
+  self.proxy_count = 0;
+}
+
+auto DynamicBVH::ray_intersects(
+  const AABB& aabb, const glm::vec3& origin, const glm::vec3& inv_direction, f32 t_min, f32 t_max, f32& distance
+) -> bool {
+  const auto t1 = (aabb.min - origin) * inv_direction;
+  const auto t2 = (aabb.max - origin) * inv_direction;
+  const auto near = glm::min(t1, t2);
+  const auto far = glm::max(t1, t2);
+
+  const auto enter = glm::max(t_min, glm::max(near.x, glm::max(near.y, near.z)));
+  const auto exit = glm::min(t_max, glm::min(far.x, glm::min(far.y, far.z)));
+  distance = enter;
+
+  return enter <= exit;
+}
+
+auto DynamicBVH::validate(this const DynamicBVH& self) -> bool {
+  if (self.root == NULL_NODE)
+    return self.proxy_count == 0;
+
+  if (self.nodes[self.root].parent != NULL_NODE)
+    return false;
+
+  u32 leaf_count = 0;
+  auto visit = [&self, &leaf_count](this auto& visitor, u32 index) -> bool {
+    const auto& node = self.nodes[index];
+    if (node.is_leaf()) {
+      leaf_count += 1;
+      return node.height == 0 && node.child2 == NULL_NODE;
+    }
+
+    const auto& child1 = self.nodes[node.child1];
+    const auto& child2 = self.nodes[node.child2];
+    if (child1.parent != index || child2.parent != index)
+      return false;
+    if (node.height != 1 + glm::max(child1.height, child2.height))
+      return false;
+    if (glm::abs(child1.height - child2.height) > 1)
+      return false;
+    if (!contains(node.aabb, child1.aabb) || !contains(node.aabb, child2.aabb))
+      return false;
+
+    return visitor(node.child1) && visitor(node.child2);
+  };
+
+  return visit(self.root) && leaf_count == self.proxy_count;
+}
+
+auto DynamicBVH::allocate_node(this DynamicBVH& self) -> u32 {
+  if (self.free_list == NULL_NODE) {
+    self.nodes.emplace_back();
+    return static_cast<u32>(self.nodes.size() - 1);
+  }
+
+  const auto index = self.free_list;
+  self.free_list = self.nodes[index].parent;
+  self.nodes[index] = {};
+
+  return index;
+}
+
+auto DynamicBVH::free_node(this DynamicBVH& self, u32 node) -> void {
+  self.nodes[node] = {};
+  self.nodes[node].parent = self.free_list;
+  self.free_list = node;
+}
+
+auto DynamicBVH::insert_leaf(this DynamicBVH& self, u32 leaf) -> void {
+  if (self.root == NULL_NODE) {
+    self.root = leaf;
+    self.nodes[leaf].parent = NULL_NODE;
+    return;
+  }
+
+  // Descend towards the sibling that increases the total surface area the least.
+  const auto leaf_aabb = self.nodes[leaf].aabb;
+  auto index = self.root;
+  while (!self.nodes[index].is_leaf()) {
+    const auto& node = self.nodes[index];
+    const auto area = surface_area(node.aabb);
+    const auto combined_area = surface_area(combine(node.aabb, leaf_aabb));
+
+    // Cost of pairing the leaf with this node, and the cost pushed onto the children by going deeper.
+    const auto cost = 2.0f * combined_area;
+    const auto inheritance_cost = 2.0f * (combined_area - area);
+
+    const auto descend_cost = [&](u32 child_index) {
+      const auto& child = self.nodes[child_index];
+      const auto combined = surface_area(combine(leaf_aabb, child.aabb));
+      return (child.is_leaf() ? combined : combined - surface_area(child.aabb)) + inheritance_cost;
+    };
+    const auto cost1 = descend_cost(node.child1);
+    const auto cost2 = descend_cost(node.child2);
+
+    if (cost < cost1 && cost < cost2)
+      break;
+
+    index = cost1 < cost2 ? node.child1 : node.child2;
+  }
+
+  const auto sibling = index;
+  const auto old_parent = self.nodes[sibling].parent;
+  const auto new_parent = self.allocate_node();
+  {
+    auto& node = self.nodes[new_parent];
+    node.parent = old_parent;
+    node.aabb = combine(leaf_aabb, self.nodes[sibling].aabb);
+    node.height = self.nodes[sibling].height + 1;
+    node.child1 = sibling;
+    node.child2 = leaf;
+  }
+  self.nodes[sibling].parent = new_parent;
+  self.nodes[leaf].parent = new_parent;
+
+  if (old_parent != NULL_NODE) {
+    auto& parent = self.nodes[old_parent];
+    if (parent.child1 == sibling) {
+      parent.child1 = new_parent;
+    } else {
+      parent.child2 = new_parent;
+    }
+  } else {
+    self.root = new_parent;
+  }
+
+  self.refit_ancestors(self.nodes[leaf].parent);
+}
+
+auto DynamicBVH::remove_leaf(this DynamicBVH& self, u32 leaf) -> void {
+  if (leaf == self.root) {
+    self.root = NULL_NODE;
+    return;
+  }
+
+  const auto parent = self.nodes[leaf].parent;
+  const auto grand_parent = self.nodes[parent].parent;
+  const auto sibling = self.nodes[parent].child1 == leaf ? self.nodes[parent].child2 : self.nodes[parent].child1;
+
+  self.free_node(parent);
+  if (grand_parent == NULL_NODE) {
+    self.root = sibling;
+    self.nodes[sibling].parent = NULL_NODE;
+    return;
+  }
+
+  auto& grand = self.nodes[grand_parent];
+  if (grand.child1 == parent) {
+    grand.child1 = sibling;
+  } else {
+    grand.child2 = sibling;
+  }
+  self.nodes[sibling].parent = grand_parent;
+
+  self.refit_ancestors(grand_parent);
+}
+
+auto DynamicBVH::refit_ancestors(this DynamicBVH& self, u32 index) -> void {
+  while (index != NULL_NODE) {
+    index = self.balance(index);
+
+    auto& node = self.nodes[index];
+    const auto& child1 = self.nodes[node.child1];
+    const auto& child2 = self.nodes[node.child2];
+    node.height = 1 + glm::max(child1.height, child2.height);
+    node.aabb = combine(child1.aabb, child2.aabb);
+
+    index = node.parent;
+  }
+}
+
+// Rotates the taller grandchild up when `a`'s subtrees differ in height by more than one. Returns the
+// index of the node that now sits where `a` was.
+auto DynamicBVH::balance(this DynamicBVH& self, u32 a) -> u32 {
+  auto& node_a = self.nodes[a];
+  if (node_a.is_leaf() || node_a.height < 2)
+    return a;
+
+  const auto b = node_a.child1;
+  const auto c = node_a.child2;
+  auto& node_b = self.nodes[b];
+  auto& node_c = self.nodes[c];
+  const auto balance = node_c.height - node_b.height;
+
+  const auto replace_in_parent = [&self](u32 parent, u32 old_child, u32 new_child) {
+    if (parent == NULL_NODE) {
+      self.root = new_child;
+    } else if (self.nodes[parent].child1 == old_child) {
+      self.nodes[parent].child1 = new_child;
+    } else {
+      self.nodes[parent].child2 = new_child;
+    }
+  };
+
+  if (balance > 1) {
+    const auto f = node_c.child1;
+    const auto g = node_c.child2;
+    auto& node_f = self.nodes[f];
+    auto& node_g = self.nodes[g];
+
+    node_c.child1 = a;
+    node_c.parent = node_a.parent;
+    node_a.parent = c;
+    replace_in_parent(node_c.parent, a, c);
+
+    if (node_f.height > node_g.height) {
+      node_c.child2 = f;
+      node_a.child2 = g;
+      node_g.parent = a;
+      node_a.aabb = combine(node_b.aabb, node_g.aabb);
+      node_c.aabb = combine(node_a.aabb, node_f.aabb);
+      node_a.height = 1 + glm::max(node_b.height, node_g.height);
+      node_c.height = 1 + glm::max(node_a.height, node_f.height);
+    } else {
+      node_c.child2 = g;
+      node_a.child2 = f;
+      node_f.parent = a;
+      node_a.aabb = combine(node_b.aabb, node_f.aabb);
+      node_c.aabb = combine(node_a.aabb, node_g.aabb);
+      node_a.height = 1 + glm::max(node_b.height, node_f.height);
+      node_c.height = 1 + glm::max(node_a.height, node_g.height);
+    }
+
+    return c;
+  }
+
+  if (balance < -1) {
+    const auto d = node_b.child1;
+    const auto e = node_b.child2;
+    auto& node_d = self.nodes[d];
+    auto& node_e = self.nodes[e];
+
+    node_b.child1 = a;
+    node_b.parent = node_a.parent;
+    node_a.parent = b;
+    replace_in_parent(node_b.parent, a, b);
+
+    if (node_d.height > node_e.height) {
+      node_b.child2 = d;
+      node_a.child1 = e;
+      node_e.parent = a;
+      node_a.aabb = combine(node_c.aabb, node_e.aabb);
+      node_b.aabb = combine(node_a.aabb, node_d.aabb);
+      node_a.height = 1 + glm::max(node_c.height, node_e.height);
+      node_b.height = 1 + glm::max(node_a.height, node_d.height);
+    } else {
+      node_b.child2 = e;
+      node_a.child1 = d;
+      node_d.parent = a;
+      node_a.aabb = combine(node_c.aabb, node_d.aabb);
+      node_b.aabb = combine(node_a.aabb, node_e.aabb);
+      node_a.height = 1 + glm::max(node_c.height, node_d.height);
+      node_b.height = 1 + glm::max(node_a.height, node_e.height);
+    }
+
+    return b;
+  }
+
+  return a;
+}
+} // namespace ox
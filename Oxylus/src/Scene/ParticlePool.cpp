@@ -0,0 +1,270 @@
+#include "Scene/ParticlePool.hpp"
+
+#include <glm/gtc/packing.hpp>
+#include <tracy/Tracy.hpp>
+
+#include "Core/JobManager.hpp"
+#include "Scene/Components.hpp"
+#include "Utils/Random.hpp"
+
+namespace ox {
+namespace {
+// Curves are evaluated as `base + slope * factor`, a disabled curve collapses to a constant so the
+// kernel never has to branch on the component flags.
+struct Curve3 {
+  f32 base[3] = {};
+  f32 slope[3] = {};
+
+  // Same direction as the previous per-entity evaluation: factor 1 -> start, 0 -> end.
+  static auto make(bool enabled, const glm::vec3& start, const glm::vec3& end, f32 disabled_value) -> Curve3 {
+    if (!enabled)
+      return {.base = {disabled_value, disabled_value, disabled_value}, .slope = {}};
+
+    return {.base = {end.x, end.y, end.z}, .slope = {start.x - end.x, start.y - end.y, start.z - end.z}};
+  }
+};
+
+struct Curve4 {
+  f32 base[4] = {};
+  f32 slope[4] = {};
+
+  static auto make(bool enabled, const glm::vec4& start, const glm::vec4& end) -> Curve4 {
+    if (!enabled)
+      return {.base = {1.f, 1.f, 1.f, 1.f}, .slope = {}};
+
+    return {
+      .base = {end.x, end.y, end.z, end.w},
+      .slope = {start.x - end.x, start.y - end.y, start.z - end.z, start.w - end.w},
+    };
+  }
+};
+
+struct SpeedRange {
+  f32 min = 0.f;
+  f32 inv_range = 0.f;
+
+  static auto make(f32 min_speed, f32 max_speed) -> SpeedRange {
+    const auto range = max_speed - min_speed;
+    return {.min = min_speed, .inv_range = range != 0.f ? 1.f / range : 0.f};
+  }
+
+  auto factor(f32 speed) const -> f32 { return glm::clamp((speed - min) * inv_range, 0.f, 1.f); }
+};
+
+auto pack_unorm(f32 v) -> u32 { return static_cast<u32>(glm::clamp(v, 0.f, 1.f) * 255.f + 0.5f); }
+
+auto slerp_curve(glm::quat start, glm::quat end, f32 factor) -> glm::quat {
+  if (glm::dot(start, end) < 0.0f)
+    end = -end;
+  return glm::slerp(end, start, factor);
+}
+} // namespace
+
+auto ParticlePool::resize(this ParticlePool& self, u32 new_capacity) -> void {
+  ZoneScoped;
+
+  self.position_x.resize(new_capacity);
+  self.position_y.resize(new_capacity);
+  self.position_z.resize(new_capacity);
+  self.velocity_x.resize(new_capacity);
+  self.velocity_y.resize(new_capacity);
+  self.velocity_z.resize(new_capacity);
+  self.life_remaining.resize(new_capacity);
+  self.size_x.resize(new_capacity);
+  self.size_y.resize(new_capacity);
+  self.color.resize(new_capacity);
+  self.rotation.resize(new_capacity, glm::quat::wxyz(1.f, 0.f, 0.f, 0.f));
+
+  self.capacity = new_capacity;
+  self.alive_count = glm::min(self.alive_count, new_capacity);
+}
+
+auto ParticlePool::clear(this ParticlePool& self) -> void { self.alive_count = 0; }
+
+auto ParticlePool::emit(
+  this ParticlePool& self, const ParticleSystemComponent& component, const glm::vec3& origin, u32 count
+) -> u32 {
+  ZoneScoped;
+
+  const auto emitted = glm::min(count, self.capacity - self.alive_count);
+  const auto color = glm::packUnorm4x8(component.start_color);
+  const auto spread = component.position_end - component.position_start;
+
+  for (u32 i = self.alive_count; i < self.alive_count + emitted; i++) {
+    self.position_x[i] = origin.x + component.position_start.x + Random::get_float() * spread.x;
+    self.position_y[i] = origin.y + component.position_start.y + Random::get_float() * spread.y;
+    self.position_z[i] = origin.z + component.position_start.z + Random::get_float() * spread.z;
+    self.velocity_x[i] = component.start_velocity.x;
+    self.velocity_y[i] = component.start_velocity.y;
+    self.velocity_z[i] = component.start_velocity.z;
+    self.life_remaining[i] = component.start_lifetime;
+    self.size_x[i] = component.start_size.x;
+    self.size_y[i] = component.start_size.y;
+    self.color[i] = color;
+    self.rotation[i] = component.start_rotation;
+  }
+
+  self.alive_count += emitted;
+
+  return emitted;
+}
+
+auto ParticlePool::simulate(
+  this ParticlePool& self, const ParticleSystemComponent& c, f32 delta_time, u32 begin, u32 end
+) -> void {
+  ZoneScoped;
+
+  const auto dt = delta_time;
+  const auto inv_lifetime = c.start_lifetime > 0.f ? 1.f / c.start_lifetime : 0.f;
+
+  const auto velocity_curve = Curve3::make(
+    c.velocity_over_lifetime_enabled, c.velocity_over_lifetime_start, c.velocity_over_lifetime_end, 1.f
+  );
+  const auto force_curve = Curve3::make(
+    c.force_over_lifetime_enabled, c.force_over_lifetime_start, c.force_over_lifetime_end, 0.f
+  );
+  const auto color_time_curve = Curve4::make(
+    c.color_over_lifetime_enabled, c.color_over_lifetime_start, c.color_over_lifetime_end
+  );
+  const auto color_speed_curve = Curve4::make(c.color_by_speed_enabled, c.color_by_speed_start, c.color_by_speed_end);
+  const auto size_time_curve = Curve3::make(
+    c.size_over_lifetime_enabled, c.size_over_lifetime_start, c.size_over_lifetime_end, 1.f
+  );
+  const auto size_speed_curve = Curve3::make(
+    c.size_by_speed_enabled, c.size_by_speed_start, c.size_by_speed_end, 1.f
+  );
+  const auto color_speed = SpeedRange::make(c.color_by_speed_min_speed, c.color_by_speed_max_speed);
+  const auto size_speed = SpeedRange::make(c.size_by_speed_min_speed, c.size_by_speed_max_speed);
+  const auto gravity = c.gravity_modifier * -9.8f;
+  const f32 start_color[4] = {c.start_color.x, c.start_color.y, c.start_color.z, c.start_color.w};
+  const f32 start_size[2] = {c.start_size.x, c.start_size.y};
+
+  auto* __restrict px = self.position_x.data();
+  auto* __restrict py = self.position_y.data();
+  auto* __restrict pz = self.position_z.data();
+  auto* __restrict vx = self.velocity_x.data();
+  auto* __restrict vy = self.velocity_y.data();
+  auto* __restrict vz = self.velocity_z.data();
+  auto* __restrict life = self.life_remaining.data();
+  auto* __restrict sx = self.size_x.data();
+  auto* __restrict sy = self.size_y.data();
+  auto* __restrict col = self.color.data();
+
+  for (u32 i = begin; i < end; i++) {
+    life[i] -= dt;
+    const auto t = glm::clamp(life[i] * inv_lifetime, 0.f, 1.f);
+
+    vx[i] += (force_curve.base[0] + force_curve.slope[0] * t) * dt;
+    vy[i] += (force_curve.base[1] + force_curve.slope[1] * t + gravity) * dt;
+    vz[i] += (force_curve.base[2] + force_curve.slope[2] * t) * dt;
+
+    const auto evx = vx[i] * (velocity_curve.base[0] + velocity_curve.slope[0] * t);
+    const auto evy = vy[i] * (velocity_curve.base[1] + velocity_curve.slope[1] * t);
+    const auto evz = vz[i] * (velocity_curve.base[2] + velocity_curve.slope[2] * t);
+
+    px[i] += evx * dt;
+    py[i] += evy * dt;
+    pz[i] += evz * dt;
+
+    const auto speed = glm::sqrt(evx * evx + evy * evy + evz * evz);
+    const auto cs = color_speed.factor(speed);
+    const auto ss = size_speed.factor(speed);
+
+    f32 rgba[4];
+    for (u32 k = 0; k < 4; k++) {
+      rgba[k] = start_color[k] * (color_time_curve.base[k] + color_time_curve.slope[k] * t) *
+                (color_speed_curve.base[k] + color_speed_curve.slope[k] * cs);
+    }
+    col[i] = pack_unorm(rgba[0]) | (pack_unorm(rgba[1]) << 8) | (pack_unorm(rgba[2]) << 16) |
+             (pack_unorm(rgba[3]) << 24);
+
+    sx[i] = start_size[0] * (size_time_curve.base[0] + size_time_curve.slope[0] * t) *
+            (size_speed_curve.base[0] + size_speed_curve.slope[0] * ss);
+    sy[i] = start_size[1] * (size_time_curve.base[1] + size_time_curve.slope[1] * t) *
+            (size_speed_curve.base[1] + size_speed_curve.slope[1] * ss);
+  }
+
+  // Rotation needs slerps, keep them out of the hot loop unless a curve actually uses them.
+  if (c.rotation_over_lifetime_enabled || c.rotation_by_speed_enabled) {
+    const auto rotation_speed = SpeedRange::make(c.rotation_by_speed_min_speed, c.rotation_by_speed_max_speed);
+    for (u32 i = begin; i < end; i++) {
+      const auto t = glm::clamp(life[i] * inv_lifetime, 0.f, 1.f);
+      auto rotation = c.start_rotation;
+      if (c.rotation_over_lifetime_enabled)
+        rotation = rotation * slerp_curve(c.rotation_over_lifetime_start, c.rotation_over_lifetime_end, t);
+      if (c.rotation_by_speed_enabled) {
+        const auto velocity = glm::vec3(
+          vx[i] * (velocity_curve.base[0] + velocity_curve.slope[0] * t),
+          vy[i] * (velocity_curve.base[1] + velocity_curve.slope[1] * t),
+          vz[i] * (velocity_curve.base[2] + velocity_curve.slope[2] * t)
+        );
+        rotation = rotation * slerp_curve(
+                                c.rotation_by_speed_start,
+                                c.rotation_by_speed_end,
+                                rotation_speed.factor(glm::length(velocity))
+                              );
+      }
+      self.rotation[i] = glm::normalize(rotation);
+    }
+  }
+}
+
+auto ParticlePool::compact(this ParticlePool& self) -> void {
+  ZoneScoped;
+
+  u32 i = 0;
+  while (i < self.alive_count) {
+    if (self.life_remaining[i] > 0.f) {
+      i++;
+      continue;
+    }
+
+    // Don't advance, the particle moved into `i` still has to be checked.
+    self.alive_count -= 1;
+    if (i != self.alive_count)
+      self.move_particle(i, self.alive_count);
+  }
+}
+
+auto ParticlePool::update(
+  this ParticlePool& self, const ParticleSystemComponent& component, f32 delta_time, JobManager* job_man
+) -> void {
+  ZoneScoped;
+
+  if (self.alive_count == 0)
+    return;
+
+  const auto thread_count = job_man ? job_man->get_thread_count() : 1_u32;
+  if (thread_count <= 1 || self.alive_count < PARALLEL_THRESHOLD) {
+    self.simulate(component, delta_time, 0, self.alive_count);
+  } else {
+    const auto chunk_size = glm::max(MIN_CHUNK_SIZE, (self.alive_count + thread_count - 1) / thread_count);
+    auto barrier = Barrier::create();
+    for (u32 begin = 0; begin < self.alive_count; begin += chunk_size) {
+      const auto end = glm::min(begin + chunk_size, self.alive_count);
+      auto job = Job::create([&self, &component, delta_time, begin, end]() {
+        self.simulate(component, delta_time, begin, end);
+      });
+      job->signal(barrier);
+      job_man->submit(std::move(job));
+    }
+    barrier->wait(*job_man);
+  }
+
+  self.compact();
+}
+
+auto ParticlePool::move_particle(this ParticlePool& self, u32 dst, u32 src) -> void {
+  self.position_x[dst] = self.position_x[src];
+  self.position_y[dst] = self.position_y[src];
+  self.position_z[dst] = self.position_z[src];
+  self.velocity_x[dst] = self.velocity_x[src];
+  self.velocity_y[dst] = self.velocity_y[src];
+  self.velocity_z[dst] = self.velocity_z[src];
+  self.life_remaining[dst] = self.life_remaining[src];
+  self.size_x[dst] = self.size_x[src];
+  self.size_y[dst] = self.size_y[src];
+  self.color[dst] = self.color[src];
+  self.rotation[dst] = self.rotation[src];
+}
+} // namespace ox
@@ -14,6 +14,7 @@
 #include <Jolt/Physics/Collision/Shape/MeshShape.h>
 #include <Jolt/Physics/Collision/Shape/MutableCompoundShape.h>
 #include <Jolt/Physics/Collision/Shape/RotatedTranslatedShape.h>
+#include <Jolt/Physics/Collision/Shape/ScaledShape.h>
 #include <Jolt/Physics/Collision/Shape/SphereShape.h>
 #include <Jolt/Physics/Collision/Shape/TaperedCapsuleShape.h>
 // clang-format on
@@ -420,6 +421,14 @@ auto Scene::init(this Scene& self, const std::string& name) -> void {
 
   self.component_db.import_module(self.world.import<CoreComponentsModule>());
 
+  self.rigidbody_query = self.world.query_builder<const TransformComponent, RigidBodyComponent>().cached().build();
+  self.character_query = self.world
+                           .query_builder<const TransformComponent, CharacterControllerComponent>()
+                           .cached()
+                           .build();
+  self.transform_query = self.world.query_builder().with<TransformComponent>().cached().build();
+  self.mesh_query = self.world.query_builder<const MeshComponent>().cached().build();
+
   if (App::has_mod<Renderer>()) {
     auto& renderer = App::mod<Renderer>();
     self.renderer_instance = renderer.new_instance(self);
@@ -430,7 +439,7 @@ auto Scene::init(this Scene& self, const std::string& name) -> void {
   }
 
   auto& physics = App::mod<Physics>();
-  self.physics_system = physics.new_system();
+  self.physics_system = physics.new_system(self.physics_capacity);
   self.physics_debug_renderer = physics.new_debug_renderer();
 
   self.world.observer<TransformComponent>()
@@ -461,6 +470,7 @@ auto Scene::init(this Scene& self, const std::string& name) -> void {
       if (auto id = self.get_entity_transform_id(entity)) {
         if (auto* transform = self.get_entity_transform(*id)) {
           mc.world_aabb = mc.baked_aabb.get_transformed(transform->world);
+          self.update_spatial_proxy(entity, mc.world_aabb);
         }
       }
     });
@@ -471,18 +481,49 @@ auto Scene::init(this Scene& self, const std::string& name) -> void {
       if (mc.model_uuid) {
         self.detach_mesh(it.entity(i));
       }
+      self.remove_spatial_proxy(it.entity(i));
     });
 
   self.world.observer<TransformComponent, SpriteComponent>()
     .event(flecs::OnSet)
     .event(flecs::OnAdd)
+    .event(flecs::OnRemove)
     .each([&self](flecs::iter& it, usize i, TransformComponent&, SpriteComponent& sprite) {
       auto entity = it.entity(i);
+      if (it.event() == flecs::OnRemove) {
+        self.remove_spatial_proxy(entity);
+        return;
+      }
+
       // Set sprite rect
       if (auto id = self.get_entity_transform_id(entity)) {
         if (auto* transform = self.get_entity_transform(*id)) {
           sprite.rect = AABB(glm::vec3(-0.5, -0.5, -0.5), glm::vec3(0.5, 0.5, 0.5));
           sprite.rect = sprite.rect.get_transformed(transform->world);
+          self.update_spatial_proxy(entity, sprite.rect);
+        }
+      }
+    });
+
+  self.world.observer<TransformComponent, LightComponent>()
+    .event(flecs::OnSet)
+    .event(flecs::OnRemove)
+    .each([&self](flecs::iter& it, usize i, TransformComponent&, LightComponent& lc) {
+      auto entity = it.entity(i);
+      // Directional lights have no bounds, and a mesh or sprite on the same entity owns the proxy.
+      if (entity.has<MeshComponent>() || entity.has<SpriteComponent>()) {
+        return;
+      }
+      if (it.event() == flecs::OnRemove || lc.type == LightComponent::LightType::Directional) {
+        self.remove_spatial_proxy(entity);
+        return;
+      }
+
+      if (auto id = self.get_entity_transform_id(entity)) {
+        if (auto* transform = self.get_entity_transform(*id)) {
+          const auto radius = glm::vec3(lc.radius);
+          const glm::vec3 position = transform->world[3];
+          self.update_spatial_proxy(entity, AABB(position - radius, position + radius));
         }
       }
     });
@@ -554,39 +595,42 @@ auto Scene::init(this Scene& self, const std::string& name) -> void {
     }
   });
 
-  self.world.observer<AudioListenerComponent>()
-    .event(flecs::OnSet)
-    .event(flecs::OnAdd)
-    .each([](flecs::iter& it, usize i, AudioListenerComponent& c) {
-      auto& audio_engine = App::mod<AudioEngine>();
-      audio_engine.set_listener_cone(c.listener_index, c.cone_inner_angle, c.cone_outer_angle, c.cone_outer_gain);
-    });
+  // Skipped without an audio engine, like on a headless server.
+  if (App::has_mod<AudioEngine>()) {
+    self.world.observer<AudioListenerComponent>()
+      .event(flecs::OnSet)
+      .event(flecs::OnAdd)
+      .each([](flecs::iter& it, usize i, AudioListenerComponent& c) {
+        auto& audio_engine = App::mod<AudioEngine>();
+        audio_engine.set_listener_cone(c.listener_index, c.cone_inner_angle, c.cone_outer_angle, c.cone_outer_gain);
+      });
 
-  self.world.observer<AudioSourceComponent>()
-    .event(flecs::OnSet)
-    .event(flecs::OnAdd)
-    .each([](flecs::iter& it, usize i, AudioSourceComponent& c) {
-      auto& asset_man = App::mod<AssetManager>();
-      auto audio_asset = asset_man.get_audio(c.audio_source);
-      if (!audio_asset)
-        return;
+    self.world.observer<AudioSourceComponent>()
+      .event(flecs::OnSet)
+      .event(flecs::OnAdd)
+      .each([](flecs::iter& it, usize i, AudioSourceComponent& c) {
+        auto& asset_man = App::mod<AssetManager>();
+        auto audio_asset = asset_man.get_audio(c.audio_source);
+        if (!audio_asset)
+          return;
 
-      auto& audio_engine = App::mod<AudioEngine>();
-      audio_engine.set_source_volume(audio_asset->get_source(), c.volume);
-      audio_engine.set_source_pitch(audio_asset->get_source(), c.pitch);
-      audio_engine.set_source_looping(audio_asset->get_source(), c.looping);
-      audio_engine.set_source_attenuation_model(
-        audio_asset->get_source(),
-        static_cast<AudioEngine::AttenuationModelType>(c.attenuation_model)
-      );
-      audio_engine.set_source_roll_off(audio_asset->get_source(), c.roll_off);
-      audio_engine.set_source_min_gain(audio_asset->get_source(), c.min_gain);
-      audio_engine.set_source_max_gain(audio_asset->get_source(), c.max_gain);
-      audio_engine.set_source_min_distance(audio_asset->get_source(), c.min_distance);
-      audio_engine.set_source_max_distance(audio_asset->get_source(), c.max_distance);
-      audio_engine
-        .set_source_cone(audio_asset->get_source(), c.cone_inner_angle, c.cone_outer_angle, c.cone_outer_gain);
-    });
+        auto& audio_engine = App::mod<AudioEngine>();
+        audio_engine.set_source_volume(audio_asset->get_source(), c.volume);
+        audio_engine.set_source_pitch(audio_asset->get_source(), c.pitch);
+        audio_engine.set_source_looping(audio_asset->get_source(), c.looping);
+        audio_engine.set_source_attenuation_model(
+          audio_asset->get_source(),
+          static_cast<AudioEngine::AttenuationModelType>(c.attenuation_model)
+        );
+        audio_engine.set_source_roll_off(audio_asset->get_source(), c.roll_off);
+        audio_engine.set_source_min_gain(audio_asset->get_source(), c.min_gain);
+        audio_engine.set_source_max_gain(audio_asset->get_source(), c.max_gain);
+        audio_engine.set_source_min_distance(audio_asset->get_source(), c.min_distance);
+        audio_engine.set_source_max_distance(audio_asset->get_source(), c.max_distance);
+        audio_engine
+          .set_source_cone(audio_asset->get_source(), c.cone_inner_angle, c.cone_outer_angle, c.cone_outer_gain);
+      });
+  }
 
   self.world.observer<SpriteAnimationComponent>()
     .event(flecs::OnSet)
@@ -655,7 +699,6 @@ auto Scene::init(this Scene& self, const std::string& name) -> void {
   self.world.observer<ParticleSystemComponent>()
     .event(flecs::OnSet)
     .event(flecs::OnAdd)
-    .event(flecs::OnRemove)
     .each([](flecs::iter& it, usize i, ParticleSystemComponent& c) {
       auto& asset_man = App::mod<AssetManager>();
       if (it.event() == flecs::OnAdd) {
@@ -667,19 +710,12 @@ auto Scene::init(this Scene& self, const std::string& name) -> void {
           c.material = asset_man.create_asset(AssetType::Material, {});
         asset_man.load_asset(c.material);
 
-        auto parent = it.entity(i);
-        for (u32 k = 0; k < c.max_particles; k++) {
-          auto particle = it.world().entity().set<TransformComponent>({{}, {}, {0.5f, 0.5f, 0.5f}});
-          particle.set<ParticleComponent>({.life_remaining = c.start_lifetime});
-          c.particles.emplace_back(particle);
-          particle.child_of(parent);
-        }
-      } else if (it.event() == flecs::OnRemove) {
-        for (auto p : c.particles) {
-          flecs::entity e{it.world(), p};
-          e.destruct();
-        }
+        c.pool.resize(c.gpu_simulation ? 0 : c.max_particles);
       } else if (it.event() == flecs::OnSet) {
+        const auto pool_capacity = c.gpu_simulation ? 0 : c.max_particles;
+        if (c.pool.capacity != pool_capacity)
+          c.pool.resize(pool_capacity);
+
         // is_loaded() takes and releases the read guard internally; don't hold one across
         // load_asset() (which re-locks the registry).
         if (!asset_man.is_loaded(c.material)) {
@@ -707,42 +743,47 @@ auto Scene::init(this Scene& self, const std::string& name) -> void {
 
   // --- Main Systems ---
 
-  self.world.system<const TransformComponent, AudioListenerComponent>("audio_listener_update")
-    .kind(flecs::PreUpdate)
-    .each([&self](const flecs::entity& e, const TransformComponent& tc, AudioListenerComponent& ac) {
-      if (ac.active) {
-        auto& audio_engine = App::mod<AudioEngine>();
-        const glm::mat4 inverted = glm::inverse(self.get_world_transform(e));
-        const glm::vec3 forward = normalize(glm::vec3(inverted[2]));
-        audio_engine.set_listener_position(ac.listener_index, tc.position);
-        audio_engine.set_listener_direction(ac.listener_index, -forward);
-        audio_engine.set_listener_cone(ac.listener_index, ac.cone_inner_angle, ac.cone_outer_angle, ac.cone_outer_gain);
-      }
-    });
+  // Same as the audio observers, nothing to update without an engine.
+  if (App::has_mod<AudioEngine>()) {
+    self.world.system<const TransformComponent, AudioListenerComponent>("audio_listener_update")
+      .kind(flecs::PreUpdate)
+      .each([&self](const flecs::entity& e, const TransformComponent& tc, AudioListenerComponent& ac) {
+        if (ac.active) {
+          auto& audio_engine = App::mod<AudioEngine>();
+          const glm::mat4 inverted = glm::inverse(self.get_world_transform(e));
+          const glm::vec3 forward = normalize(glm::vec3(inverted[2]));
+          audio_engine.set_listener_position(ac.listener_index, tc.position);
+          audio_engine.set_listener_direction(ac.listener_index, -forward);
+          audio_engine
+            .set_listener_cone(ac.listener_index, ac.cone_inner_angle, ac.cone_outer_angle, ac.cone_outer_gain);
+        }
+      });
 
-  self.world.system<const TransformComponent, AudioSourceComponent>("audio_source_update")
-    .kind(flecs::PreUpdate)
-    .each([](const flecs::entity& e, const TransformComponent& tc, const AudioSourceComponent& ac) {
-      auto& asset_man = App::mod<AssetManager>();
-      if (auto audio = asset_man.get_audio(ac.audio_source)) {
-        auto& audio_engine = App::mod<AudioEngine>();
-        audio_engine.set_source_attenuation_model(
-          audio->get_source(),
-          static_cast<AudioEngine::AttenuationModelType>(ac.attenuation_model)
-        );
-        audio_engine.set_source_volume(audio->get_source(), ac.volume);
-        audio_engine.set_source_pitch(audio->get_source(), ac.pitch);
-        audio_engine.set_source_looping(audio->get_source(), ac.looping);
-        audio_engine.set_source_spatialization(audio->get_source(), ac.looping);
-        audio_engine.set_source_roll_off(audio->get_source(), ac.roll_off);
-        audio_engine.set_source_min_gain(audio->get_source(), ac.min_gain);
-        audio_engine.set_source_max_gain(audio->get_source(), ac.max_gain);
-        audio_engine.set_source_min_distance(audio->get_source(), ac.min_distance);
-        audio_engine.set_source_max_distance(audio->get_source(), ac.max_distance);
-        audio_engine.set_source_cone(audio->get_source(), ac.cone_inner_angle, ac.cone_outer_angle, ac.cone_outer_gain);
-        audio_engine.set_source_doppler_factor(audio->get_source(), ac.doppler_factor);
-      }
-    });
+    self.world.system<const TransformComponent, AudioSourceComponent>("audio_source_update")
+      .kind(flecs::PreUpdate)
+      .each([](const flecs::entity& e, const TransformComponent& tc, const AudioSourceComponent& ac) {
+        auto& asset_man = App::mod<AssetManager>();
+        if (auto audio = asset_man.get_audio(ac.audio_source)) {
+          auto& audio_engine = App::mod<AudioEngine>();
+          audio_engine.set_source_attenuation_model(
+            audio->get_source(),
+            static_cast<AudioEngine::AttenuationModelType>(ac.attenuation_model)
+          );
+          audio_engine.set_source_volume(audio->get_source(), ac.volume);
+          audio_engine.set_source_pitch(audio->get_source(), ac.pitch);
+          audio_engine.set_source_looping(audio->get_source(), ac.looping);
+          audio_engine.set_source_spatialization(audio->get_source(), ac.looping);
+          audio_engine.set_source_roll_off(audio->get_source(), ac.roll_off);
+          audio_engine.set_source_min_gain(audio->get_source(), ac.min_gain);
+          audio_engine.set_source_max_gain(audio->get_source(), ac.max_gain);
+          audio_engine.set_source_min_distance(audio->get_source(), ac.min_distance);
+          audio_engine.set_source_max_distance(audio->get_source(), ac.max_distance);
+          audio_engine
+            .set_source_cone(audio->get_source(), ac.cone_inner_angle, ac.cone_outer_angle, ac.cone_outer_gain);
+          audio_engine.set_source_doppler_factor(audio->get_source(), ac.doppler_factor);
+        }
+      });
+  }
 
   // --- Physics Systems ---
 
@@ -754,46 +795,32 @@ auto Scene::init(this Scene& self, const std::string& name) -> void {
     .run([&self](flecs::iter& it) {
       OX_CHECK_NULL(self.physics_system);
       auto& p = App::mod<Physics>();
+      // Nothing is recorded while nobody would look at it.
+      if (self.contact_listener_3d) {
+        auto enabled = self.collect_contacts;
+        for (const auto& [_, system] : self.lua_systems) {
+          enabled |= system->has_contact_callbacks();
+        }
+        self.contact_listener_3d->contacts.enabled = enabled;
+      }
       self.physics_system->Update(self.physics_interval, 1, p.get_temp_allocator(), p.get_job_system());
+      self.rigidbody_sync.step(self.world, *self.physics_system);
+      self.dispatch_contacts();
     });
 
-  self.world.system<TransformComponent, RigidBodyComponent>("rigidbody_update")
+  // Driven by the bodies Jolt reports as awake rather than a query over every rigidbody, so only the
+  // transforms it actually wrote are marked modified.
+  self.world.system("physics_interpolate")
     .kind(flecs::OnUpdate)
-    .tick_source(physics_tick_source)
-    .each([&self](const flecs::entity& e, TransformComponent& tc, RigidBodyComponent& rb) {
-      if (!rb.runtime_body)
-        return;
-
-      const auto* body = static_cast<const JPH::Body*>(rb.runtime_body);
-      const auto& body_interface = self.physics_system->GetBodyInterface();
-
-      if (!body_interface.IsActive(body->GetID()))
-        return;
-
-      const JPH::Vec3 position = body->GetPosition();
-      const JPH::Quat rotation = body->GetRotation();
-
-      rb.previous_translation = rb.translation;
-      rb.previous_rotation = rb.rotation;
-      rb.translation = {position.GetX(), position.GetY(), position.GetZ()};
-      rb.rotation = glm::quat::wxyz(rotation.GetW(), rotation.GetX(), rotation.GetY(), rotation.GetZ());
-    });
-
-  self.world.system<TransformComponent, const RigidBodyComponent>("physics_interpolate")
-    .kind(flecs::OnUpdate)
-    .each([physics_tick_source](const flecs::entity& e, TransformComponent& tc, const RigidBodyComponent& rb) {
-      if (!rb.runtime_body)
-        return;
-
+    .run([&self, physics_tick_source](flecs::iter& it) {
       const auto* timer = physics_tick_source.try_get<flecs::Timer>();
       const f32 alpha = (timer && timer->timeout > 0.f)
                           ? std::clamp(static_cast<f32>(timer->time / timer->timeout), 0.0f, 1.0f)
                           : 1.0f;
 
-      tc.position = glm::mix(rb.previous_translation, rb.translation, alpha);
-      tc.rotation = glm::slerp(rb.previous_rotation, rb.rotation, alpha);
-
-      e.modified<TransformComponent>();
+      self.rigidbody_sync.interpolate(self.world, alpha);
+      self.refresh_transforms(self.rigidbody_sync.written);
+      self.rigidbody_sync.written.clear();
     });
 
   self.world.system<TransformComponent, CharacterControllerComponent>("character_controller_update")
@@ -821,39 +848,20 @@ auto Scene::init(this Scene& self, const std::string& name) -> void {
 
   self.world.system<const TransformComponent, ParticleSystemComponent>("particle_system_update")
     .kind(flecs::PostUpdate)
-    .each([](flecs::iter& it, usize i, const TransformComponent& tc, ParticleSystemComponent& component) {
-      const auto emit = [&it, &component](flecs::entity parent, glm::vec3 position, u32 count) {
-        if (component.active_particle_count >= component.max_particles)
-          return;
-
-        for (uint32_t pool_idx = 0; pool_idx < count; ++pool_idx) {
-          if (++component.pool_index >= component.max_particles)
-            component.pool_index = 0;
-
-          auto particle = flecs::entity{it.world(), component.particles[component.pool_index]};
-
-          const auto random_float = [](f32 min, f32 max) {
-            static Random random = {};
-            f32 r = random.get_float();
-            return min + r * (max - min);
-          };
-
-          auto new_position = position;
-          new_position.x += random_float(component.position_start.x, component.position_end.x);
-          new_position.y += random_float(component.position_start.y, component.position_end.y);
-          new_position.z += random_float(component.position_start.z, component.position_end.z);
-
-          particle.set<TransformComponent>({new_position});
-          particle.set<ParticleComponent>({.life_remaining = component.start_lifetime});
-        }
-      };
-
-      OX_CHECK_EQ(component.particles.size(), component.max_particles);
-
+    .each([](flecs::iter& it, usize i, const TransformComponent&, ParticleSystemComponent& component) {
       auto entity = it.entity(i);
+      const auto position = glm::vec3(Scene::get_world_transform(entity)[3]);
 
       const float sim_ts = it.delta_time() * component.simulation_speed;
 
+      component.gpu_emit_count = 0;
+      const auto emit = [&component, &position](u32 count) {
+        if (component.gpu_simulation)
+          component.gpu_emit_count += count;
+        else
+          component.pool.emit(component, position, count);
+      };
+
       if (component.playing && !component.looping)
         component.system_time += sim_ts;
       const float delay = component.start_delay;
@@ -861,130 +869,41 @@ auto Scene::init(this Scene& self, const std::string& name) -> void {
         component.playing &&
         (component.looping || (component.system_time <= delay + component.duration && component.system_time > delay))
       ) {
-        // Emit particles in unit time
-        component.spawn_time += sim_ts;
-        if (component.spawn_time >= 1.0f / static_cast<float>(component.rate_over_time)) {
-          component.spawn_time = 0.0f;
-          emit(entity, tc.position, 1);
+        // Emit particles in unit time, carrying the remainder so high rates aren't capped at one
+        // particle per frame.
+        if (component.rate_over_time > 0) {
+          component.spawn_time += sim_ts;
+          const auto rate = static_cast<f32>(component.rate_over_time);
+          const auto count = static_cast<u32>(component.spawn_time * rate);
+          if (count > 0) {
+            component.spawn_time -= static_cast<f32>(count) / rate;
+            emit(count);
+          }
         }
 
         // Emit particles over unit distance
-        if (glm::distance2(component.last_spawned_position, tc.position) > 1.0f) {
-          component.last_spawned_position = tc.position;
-          emit(entity, tc.position, component.rate_over_distance);
+        if (glm::distance2(component.last_spawned_position, position) > 1.0f) {
+          component.last_spawned_position = position;
+          emit(component.rate_over_distance);
         }
 
         // Emit bursts of particles over time
         component.burst_time += sim_ts;
-        if (component.burst_time >= component.burst_time) {
+        if (component.burst_time >= component.duration) {
           component.burst_time = 0.0f;
-          emit(entity, tc.position, component.burst_count);
+          emit(component.burst_count);
         }
       }
 
-      component.active_particle_count = 0;
-    });
-
-  self.world.system<TransformComponent, ParticleComponent>("particle_update")
-    .kind(flecs::PostUpdate)
-    .each([](flecs::iter& it, usize i, TransformComponent& particle_tc, ParticleComponent& particle) {
-      if (particle.life_remaining <= 0.0f)
+      if (component.gpu_simulation) {
+        // Alive count lives on the GPU and is never read back.
+        component.gpu_delta_time = sim_ts;
+        component.emitter_position = position;
         return;
+      }
 
-      auto evaluate_over_time = []<typename T>(T start, T end, f32 factor) -> T {
-        if constexpr (std::is_same_v<T, glm::quat>) {
-          if (glm::dot(start, end) < 0.0f)
-            end = -end;
-          return glm::slerp(end, start, factor);
-        } else {
-          return glm::lerp(end, start, factor);
-        }
-      };
-
-      auto evaluate_by_speed = []<typename T>(T start, T end, f32 min_speed, f32 max_speed, f32 speed) -> T {
-        f32 factor = math::inverse_lerp_clamped(min_speed, max_speed, speed);
-
-        if constexpr (std::is_same_v<T, glm::quat>) {
-          if (glm::dot(start, end) < 0.0f)
-            end = -end;
-          return glm::slerp(end, start, factor);
-        } else {
-          return glm::lerp(end, start, factor);
-        }
-      };
-
-      auto particle_entity = it.entity(i);
-      auto parent = particle_entity.parent();
-      auto component = parent.get<ParticleSystemComponent>();
-
-      float sim_ts = it.delta_time() * component.simulation_speed;
-
-      particle.life_remaining -= sim_ts;
-
-      const float t = glm::clamp(particle.life_remaining / component.start_lifetime, 0.0f, 1.0f);
-
-      glm::vec3 velocity = component.start_velocity;
-      if (component.velocity_over_lifetime_enabled)
-        velocity *= evaluate_over_time(component.velocity_over_lifetime_start, component.velocity_over_lifetime_end, t);
-
-      glm::vec3 force(0.0f);
-      if (component.force_over_lifetime_enabled)
-        force = evaluate_over_time(component.force_over_lifetime_start, component.force_over_lifetime_end, t);
-
-      force.y += component.gravity_modifier * -9.8f;
-      velocity += force * sim_ts;
-
-      const float velocity_magnitude = glm::length(velocity);
-
-      // Color
-      particle.color = component.start_color;
-      if (component.color_over_lifetime_enabled)
-        particle.color *= evaluate_over_time(component.color_over_lifetime_start, component.color_over_lifetime_end, t);
-      if (component.color_by_speed_enabled)
-        particle.color *= evaluate_by_speed(
-          component.color_by_speed_start,
-          component.color_by_speed_end,
-          component.color_by_speed_min_speed,
-          component.color_by_speed_max_speed,
-          velocity_magnitude
-        );
-
-      // Size
-      particle_tc.scale = component.start_size;
-      if (component.size_over_lifetime_enabled)
-        particle_tc
-          .scale *= evaluate_over_time(component.size_over_lifetime_start, component.size_over_lifetime_end, t);
-      if (component.size_by_speed_enabled)
-        particle_tc.scale *= evaluate_by_speed(
-          component.size_by_speed_start,
-          component.size_by_speed_end,
-          component.size_by_speed_min_speed,
-          component.size_by_speed_max_speed,
-          velocity_magnitude
-        );
-
-      // Rotation
-      particle_tc.rotation = component.start_rotation;
-      if (component.rotation_over_lifetime_enabled)
-        particle_tc.rotation += evaluate_over_time(
-          component.rotation_over_lifetime_start,
-          component.rotation_over_lifetime_end,
-          t
-        );
-      if (component.rotation_by_speed_enabled)
-        particle_tc.rotation += evaluate_by_speed(
-          component.rotation_by_speed_start,
-          component.rotation_by_speed_end,
-          component.rotation_by_speed_min_speed,
-          component.rotation_by_speed_max_speed,
-          velocity_magnitude
-        );
-
-      particle_tc.position += velocity * sim_ts;
-
-      particle_entity.modified<TransformComponent>();
-
-      ++component.active_particle_count;
+      component.pool.update(component, sim_ts, &App::get_job_manager());
+      component.active_particle_count = component.pool.alive_count;
     });
 
   self.world.system<const TransformComponent, CameraComponent>("camera_update")
@@ -995,19 +914,19 @@ auto Scene::init(this Scene& self, const std::string& name) -> void {
         Camera::update(cc, tc, ri->get_viewport_size());
     });
 
-  self.world.system<SpriteComponent>("sprite_aabb")
+  self.world.system<const SpriteComponent>("sprite_aabb")
     .kind(flecs::PostUpdate)
-    .each([cvar = &self.renderer_cvar](const flecs::entity entity, SpriteComponent& sprite) {
-      if (cvar->cvar_draw_bounding_boxes.get()) {
+    .each([cvar = &self.renderer_cvar](const flecs::entity entity, const SpriteComponent& sprite) {
+      if (cvar->cvar_draw_bounding_boxes.get() && App::has_mod<DebugRenderer>()) {
         auto& debug_renderer = App::mod<DebugRenderer>();
         debug_renderer.draw_aabb(sprite.rect, glm::vec4(1, 1, 1, 1.0f));
       }
     });
 
-  self.world.system<MeshComponent>("mesh_aabb")
+  self.world.system<const MeshComponent>("mesh_aabb")
     .kind(flecs::PostUpdate)
-    .each([cvar = &self.renderer_cvar](const flecs::entity entity, MeshComponent& mc) {
-      if (cvar->cvar_draw_bounding_boxes.get()) {
+    .each([cvar = &self.renderer_cvar](const flecs::entity entity, const MeshComponent& mc) {
+      if (cvar->cvar_draw_bounding_boxes.get() && App::has_mod<DebugRenderer>()) {
         auto& debug_renderer = App::mod<DebugRenderer>();
         debug_renderer.draw_aabb(mc.world_aabb, glm::vec4(0.f, 1.f, 0.f, 1.0f));
       }
@@ -1071,24 +990,71 @@ auto Scene::physics_init(this Scene& self) -> void {
   // Remove old bodies and reset callbacks
   self.physics_deinit();
 
+  // Jolt sizes everything once in `Init`, so a scene that outgrew its system gets a new one. It is
+  // empty at this point.
+  auto body_count = self.terrain ? 1_u32 : 0_u32;
+  auto moving_count = 0_u32;
+  self.rigidbody_query.each([&](const TransformComponent&, const RigidBodyComponent& rb) {
+    body_count += 1;
+    moving_count += rb.type != RigidBodyComponent::BodyType::Static;
+  });
+  self.character_query.each([&](const TransformComponent&, const CharacterControllerComponent&) {
+    body_count += 1;
+    moving_count += 1;
+  });
+
+  auto& physics = App::mod<Physics>();
+  const auto capacity = self.physics_cvar.capacity(body_count, moving_count);
+  physics.reserve_temp_allocator(capacity.temp_allocator_size);
+  if (capacity != self.physics_capacity) {
+    OX_LOG_INFO(
+      "Physics capacity: {} bodies, {} body pairs, {} contact constraints.",
+      capacity.max_bodies,
+      capacity.max_body_pairs,
+      capacity.max_contact_constraints
+    );
+    self.physics_system = physics.new_system(capacity);
+    self.physics_capacity = capacity;
+  }
+
   self.body_activation_listener_3d = std::make_unique<Physics3DBodyActivationListener>();
-  self.contact_listener_3d = std::make_unique<Physics3DContactListener>(&self);
+  self.contact_listener_3d = std::make_unique<Physics3DContactListener>();
+  self.contact_listener_3d->contacts.init(App::get_job_manager().get_thread_count());
   self.physics_system->SetBodyActivationListener(self.body_activation_listener_3d.get());
   self.physics_system->SetContactListener(self.contact_listener_3d.get());
 
-  // Rigidbodies
-  self.world.query_builder<const TransformComponent, RigidBodyComponent>().build().each(
-    [&self](flecs::entity e, const TransformComponent& tc, RigidBodyComponent& rb) {
+  // Rigidbodies, added in two batches so the broadphase takes each in one go instead of one
+  // insertion per body.
+  auto sleeping_bodies = std::vector<JPH::BodyID>{};
+  auto awake_bodies = std::vector<JPH::BodyID>{};
+  self.rigidbody_query.each(
+    [&](flecs::entity e, const TransformComponent& tc, RigidBodyComponent& rb) {
       if (rb.runtime_body == nullptr) {
         rb.previous_translation = rb.translation = tc.position;
         rb.previous_rotation = rb.rotation = tc.rotation;
-        self.create_rigidbody(e, tc, rb);
+        if (auto* body = self.build_rigidbody(e, tc, rb)) {
+          const auto awake = rb.awake && rb.type != RigidBodyComponent::BodyType::Static;
+          (awake ? awake_bodies : sleeping_bodies).push_back(body->GetID());
+        }
       }
     }
   );
 
+  auto& body_interface = self.physics_system->GetBodyInterface();
+  for (auto [bodies, activation] : {
+         std::pair(&sleeping_bodies, JPH::EActivation::DontActivate),
+         std::pair(&awake_bodies, JPH::EActivation::Activate),
+       }) {
+    if (bodies->empty()) {
+      continue;
+    }
+    const auto count = static_cast<i32>(bodies->size());
+    auto add_state = body_interface.AddBodiesPrepare(bodies->data(), count);
+    body_interface.AddBodiesFinalize(bodies->data(), count, add_state, activation);
+  }
+
   // Characters
-  self.world.query_builder<const TransformComponent, CharacterControllerComponent>().build().each(
+  self.character_query.each(
     [&self](flecs::entity e, const TransformComponent& tc, CharacterControllerComponent& ch) {
       if (ch.character == nullptr) {
         self.create_character_controller(e, tc, ch);
@@ -1106,7 +1072,7 @@ auto Scene::physics_deinit(this Scene& self) -> void {
 
   self.destroy_terrain_collision();
 
-  self.world.query_builder<RigidBodyComponent>().build().each([&self](const flecs::entity& e, RigidBodyComponent& rb) {
+  self.rigidbody_query.each([&self](const flecs::entity& e, const TransformComponent&, RigidBodyComponent& rb) {
     if (rb.runtime_body) {
       JPH::BodyInterface& body_interface = self.physics_system->GetBodyInterface();
       const auto* body = static_cast<const JPH::Body*>(rb.runtime_body);
@@ -1115,8 +1081,8 @@ auto Scene::physics_deinit(this Scene& self) -> void {
       rb.runtime_body = nullptr;
     }
   });
-  self.world.query_builder<CharacterControllerComponent>().build().each(
-    [&self](const flecs::entity& e, CharacterControllerComponent& ch) {
+  self.character_query.each(
+    [&self](const flecs::entity& e, const TransformComponent&, CharacterControllerComponent& ch) {
       if (ch.character) {
         JPH::BodyInterface& body_interface = self.physics_system->GetBodyInterface();
         auto* character = reinterpret_cast<JPH::Character*>(ch.character);
@@ -1126,6 +1092,8 @@ auto Scene::physics_deinit(this Scene& self) -> void {
     }
   );
 
+  self.rigidbody_sync.clear();
+  self.pending_mesh_colliders.clear();
   self.body_activation_listener_3d.reset();
   self.contact_listener_3d.reset();
 }
@@ -1180,6 +1148,7 @@ auto Scene::runtime_update(this Scene& self, const Timestep& delta_time) -> void
 
   self.run_deferred_functions();
   self.update_pending_model_spawns();
+  self.update_pending_mesh_colliders();
 
   if (auto* rml_context = self.get_rml_context()) {
     rml_context->Update();
@@ -1191,12 +1160,26 @@ auto Scene::runtime_update(this Scene& self, const Timestep& delta_time) -> void
     for (auto& [_, system] : self.lua_systems) {
       system->on_scene_update(&self, static_cast<f32>(delta_time.get_seconds()));
     }
+
+    // Then the ones declared `parallel`, with their writes merged in before the world progresses.
+    self.parallel_lua_scripts.clear();
+    for (auto& [_, system] : self.lua_systems) {
+      if (auto* parallel = system->get_parallel()) {
+        self.parallel_lua_scripts.emplace_back(parallel);
+      }
+    }
+    App::mod<LuaManager>().get_workers().run(
+      self.world,
+      self.parallel_lua_scripts,
+      &App::get_job_manager(),
+      static_cast<f32>(delta_time.get_seconds())
+    );
   }
 
   // TODO: Pass our delta_time?
   self.world.progress();
 
-  if (self.renderer_cvar.cvar_enable_physics_debug_renderer.get()) {
+  if (self.renderer_cvar.cvar_enable_physics_debug_renderer.get() && App::has_mod<DebugRenderer>()) {
     JPH::BodyManager::DrawSettings settings{};
     settings.mDrawShape = true;
     settings.mDrawShapeWireframe = true;
@@ -1210,9 +1193,14 @@ auto Scene::runtime_update(this Scene& self, const Timestep& delta_time) -> void
   }
 
   // Only while running: outside play mode there is no body to keep in sync, and the readback the
-  // rebuild needs is expensive enough that sculpting should not pay for it.
-  if (self.running && self.terrain != nullptr && self.terrain->collision_dirty) {
-    self.create_terrain_collision();
+  // rebuild needs is expensive enough that sculpting should not pay for it. Strokes only read back
+  // and patch what they touched.
+  if (self.running && self.terrain != nullptr) {
+    if (self.terrain->collision_dirty) {
+      self.create_terrain_collision();
+    } else if (!self.terrain->collision_dirty_texels.is_empty()) {
+      self.update_terrain_collision_region();
+    }
   }
 
   if (self.renderer_instance) {
@@ -1296,6 +1284,7 @@ auto Scene::runtime_update(this Scene& self, const Timestep& delta_time) -> void
     }
   }
   self.dirty_transforms.clear();
+  self.dirty_lights.clear();
   self.dirty_mesh_instances.clear();
   self.meshes_dirty = false;
 
@@ -1382,6 +1371,73 @@ auto Scene::cast_ray(this const Scene& self, const RayCast& ray_cast)
   return collector;
 }
 
+auto Scene::run_physics_queries(this const Scene& self, const PhysicsQueryBatch& batch, PhysicsQueryResults& results)
+  -> void {
+  ZoneScoped;
+
+  if (self.physics_system == nullptr) {
+    batch.prepare_results(results);
+    return;
+  }
+
+  batch.run(*self.physics_system, &App::get_job_manager(), results);
+}
+
+auto Scene::query_aabb(this const Scene& self, const AABB& aabb) -> std::vector<flecs::entity> {
+  ZoneScoped;
+
+  std::vector<flecs::entity> entities = {};
+  self.spatial_index.query(aabb, [&](u64 id) {
+    entities.emplace_back(self.world.c_ptr(), id);
+    return true;
+  });
+
+  return entities;
+}
+
+auto Scene::query_sphere(this const Scene& self, const Sphere& sphere) -> std::vector<flecs::entity> {
+  ZoneScoped;
+
+  std::vector<flecs::entity> entities = {};
+  self.spatial_index.query(sphere, [&](u64 id) {
+    entities.emplace_back(self.world.c_ptr(), id);
+    return true;
+  });
+
+  return entities;
+}
+
+auto Scene::query_frustum(this const Scene& self, const Frustum& frustum) -> std::vector<flecs::entity> {
+  ZoneScoped;
+
+  std::vector<flecs::entity> entities = {};
+  self.spatial_index.query(frustum, [&](u64 id) {
+    entities.emplace_back(self.world.c_ptr(), id);
+    return true;
+  });
+
+  return entities;
+}
+
+auto Scene::query_ray(this const Scene& self, const RayCast& ray) -> std::vector<flecs::entity> {
+  ZoneScoped;
+
+  std::vector<std::pair<f32, u64>> hits = {};
+  self.spatial_index.ray_cast(ray, [&](u64 id, f32 distance) {
+    hits.emplace_back(distance, id);
+    return true;
+  });
+  std::ranges::sort(hits, {}, &std::pair<f32, u64>::first);
+
+  std::vector<flecs::entity> entities = {};
+  entities.reserve(hits.size());
+  for (const auto& [_, id] : hits) {
+    entities.emplace_back(self.world.c_ptr(), id);
+  }
+
+  return entities;
+}
+
 auto Scene::defer_function(this Scene& self, const std::function<void(Scene* scene)>& func) -> void {
   ZoneScoped;
 
@@ -1666,6 +1722,36 @@ auto Scene::update_pending_model_spawns(this Scene& self) -> void {
   }
 }
 
+auto Scene::update_pending_mesh_colliders(this Scene& self) -> void {
+  ZoneScoped;
+
+  if (self.pending_mesh_colliders.empty()) {
+    return;
+  }
+
+  // Bodies whose mesh is still loading queue themselves again.
+  auto pending = std::move(self.pending_mesh_colliders);
+  self.pending_mesh_colliders.clear();
+  for (auto entity : pending) {
+    if (!entity.is_alive()) {
+      continue;
+    }
+
+    const auto* tc = entity.try_get<TransformComponent>();
+    auto* rb = entity.try_get_mut<RigidBodyComponent>();
+    if (tc == nullptr || rb == nullptr || rb->runtime_body != nullptr) {
+      continue;
+    }
+
+    if (is_mesh_collider_loading(entity)) {
+      self.pending_mesh_colliders.push_back(entity);
+      continue;
+    }
+
+    self.create_rigidbody(entity, *tc, *rb);
+  }
+}
+
 auto Scene::get_world_position(const flecs::entity entity) -> glm::vec3 {
   const auto& tc = entity.get<TransformComponent>();
   const auto parent = entity.parent();
@@ -1777,6 +1863,41 @@ auto Scene::remove_transform(this Scene& self, flecs::entity entity) -> void {
   self.entity_transforms_map.erase(it);
 }
 
+auto Scene::update_spatial_proxy(this Scene& self, flecs::entity entity, const AABB& aabb) -> void {
+  ZoneScoped;
+
+  if (auto it = self.entity_spatial_proxies.find(entity); it != self.entity_spatial_proxies.end()) {
+    self.spatial_index.move_proxy(it->second, aabb);
+    return;
+  }
+
+  self.entity_spatial_proxies.emplace(entity, self.spatial_index.create_proxy(aabb, entity.id()));
+}
+
+auto Scene::refresh_transforms(this Scene&, std::span<const flecs::entity> entities) -> void {
+  ZoneScoped;
+
+  for (auto entity : entities) {
+    if (entity.is_alive()) {
+      entity.modified<TransformComponent>();
+    }
+  }
+}
+
+auto Scene::remove_spatial_proxy(this Scene& self, flecs::entity entity) -> void {
+  ZoneScoped;
+
+  // The index is already gone by the time the world's own teardown fires OnRemove.
+  if (self.tearing_down) {
+    return;
+  }
+
+  if (auto it = self.entity_spatial_proxies.find(entity); it != self.entity_spatial_proxies.end()) {
+    self.spatial_index.destroy_proxy(it->second);
+    self.entity_spatial_proxies.erase(it);
+  }
+}
+
 auto Scene::bake_terrain(this Scene& self) -> void {
   ZoneScoped;
 
@@ -1955,43 +2076,49 @@ auto Scene::detach_mesh(this Scene& self, flecs::entity entity) -> bool {
   return true;
 }
 
-auto Scene::on_contact_added(
-  const JPH::Body& body1,
-  const JPH::Body& body2,
-  const JPH::ContactManifold& manifold,
-  const JPH::ContactSettings& settings
-) -> void {
-  ZoneScoped;
+auto Scene::get_contacts(this const Scene& self) -> std::span<const ContactEvent> { return self.contacts; }
 
-  auto write_lock = std::unique_lock(physics_mutex);
+auto Scene::dispatch_contacts(this Scene& self) -> void {
+  ZoneScoped;
 
-  for (auto& [_, system] : lua_systems) {
-    system->on_contact_added(this, body1, body2, manifold, settings);
+  if (!self.contact_listener_3d) {
+    return;
   }
-}
-
-auto Scene::on_contact_persisted(
-  const JPH::Body& body1,
-  const JPH::Body& body2,
-  const JPH::ContactManifold& manifold,
-  const JPH::ContactSettings& settings
-) -> void {
-  ZoneScoped;
 
-  auto write_lock = std::unique_lock(physics_mutex);
+  self.contact_listener_3d->contacts.merge(self.contacts);
+  if (self.contacts.empty()) {
+    return;
+  }
 
-  for (auto& [_, system] : lua_systems) {
-    system->on_contact_persisted(this, body1, body2, manifold, settings);
+  // Removed contacts only know their bodies, the bodies that are still around tell their entities.
+  const auto& lock_interface = self.physics_system->GetBodyLockInterfaceNoLock();
+  for (auto& contact : self.contacts) {
+    if (contact.kind == ContactEventKind::Removed) {
+      const auto* body1 = lock_interface.TryGetBody(contact.body1);
+      const auto* body2 = lock_interface.TryGetBody(contact.body2);
+      contact.entity1 = body1 ? body1->GetUserData() : 0;
+      contact.entity2 = body2 ? body2->GetUserData() : 0;
+    }
   }
-}
 
-auto Scene::on_contact_removed(const JPH::SubShapeIDPair& sub_shape_pair) -> void {
-  ZoneScoped;
+  for (auto& [_, system] : self.lua_systems) {
+    if (!system->has_contact_callbacks()) {
+      continue;
+    }
 
-  auto write_lock = std::unique_lock(physics_mutex);
+    for (const auto& contact : self.contacts) {
+      if (!system->wants_contact(contact)) {
+        continue;
+      }
 
-  for (auto& [_, system] : lua_systems) {
-    system->on_contact_removed(this, sub_shape_pair);
+      const auto* body1 = lock_interface.TryGetBody(contact.body1);
+      const auto* body2 = lock_interface.TryGetBody(contact.body2);
+      switch (contact.kind) {
+        case ContactEventKind::Added    : system->on_contact_added(&self, body1, body2, contact); break;
+        case ContactEventKind::Persisted: system->on_contact_persisted(&self, body1, body2, contact); break;
+        case ContactEventKind::Removed  : system->on_contact_removed(&self, contact); break;
+      }
+    }
   }
 }
 
@@ -2028,6 +2155,84 @@ auto Scene::create_rigidbody(
     component.runtime_body = nullptr;
   }
 
+  auto* body = self.build_rigidbody(entity, transform, component);
+  if (body == nullptr) {
+    return;
+  }
+
+  JPH::EActivation activation = component.awake && component.type != RigidBodyComponent::BodyType::Static
+                                  ? JPH::EActivation::Activate
+                                  : JPH::EActivation::DontActivate;
+  body_interface.AddBody(body->GetID(), activation);
+}
+
+namespace {
+// The model or the mesh the collider is cooked from is still on its way.
+auto is_mesh_collider_loading(flecs::entity entity) -> bool {
+  const auto* mesh = entity.try_get<MeshComponent>();
+  if (mesh == nullptr) {
+    return false;
+  }
+
+  auto& asset_man = App::mod<AssetManager>();
+  auto model = asset_man.get_model(mesh->model_uuid);
+  if (!model) {
+    return asset_man.is_loading(mesh->model_uuid);
+  }
+
+  return !model->is_mesh_ready(mesh->mesh_index) && !model->is_fully_loaded();
+}
+
+auto cook_mesh_collider(
+  flecs::entity entity, const MeshColliderComponent& collider, RigidBodyComponent::BodyType body_type
+) -> JPH::ShapeSettings::ShapeResult {
+  ZoneScoped;
+
+  auto result = JPH::ShapeSettings::ShapeResult{};
+  const auto* mesh = entity.try_get<MeshComponent>();
+  if (mesh == nullptr) {
+    result.SetError("Mesh colliders need a MeshComponent");
+    return result;
+  }
+
+  const auto is_static = body_type == RigidBodyComponent::BodyType::Static;
+  auto type = CookedShapeType::ConvexHull;
+  switch (collider.shape_type) {
+    case MeshColliderComponent::Auto       : type = is_static ? CookedShapeType::Triangles : type; break;
+    case MeshColliderComponent::Triangles  : type = CookedShapeType::Triangles; break;
+    case MeshColliderComponent::ConvexHull : type = CookedShapeType::ConvexHull; break;
+    case MeshColliderComponent::ConvexParts: type = CookedShapeType::ConvexParts; break;
+  }
+  if (type == CookedShapeType::Triangles && body_type == RigidBodyComponent::BodyType::Dynamic) {
+    OX_LOG_WARN("{} is dynamic, which triangles cannot be. Using convex parts instead.", entity.name().c_str());
+    type = CookedShapeType::ConvexParts;
+  }
+
+  // Cooked shapes are cached next to the model they come from.
+  auto& asset_man = App::mod<AssetManager>();
+  auto cache_directory = std::filesystem::path{};
+  if (auto asset = asset_man.get_asset(mesh->model_uuid); asset && !asset->path.empty()) {
+    cache_directory = asset->path.parent_path() / ".colliders";
+  }
+
+  auto model = asset_man.get_model(mesh->model_uuid);
+  if (!model || mesh->mesh_index >= model->collision_meshes.size() || !model->is_mesh_ready(mesh->mesh_index)) {
+    result.SetError("Mesh collider's model is not loaded");
+    return result;
+  }
+
+  const auto& collision_mesh = model->collision_meshes[mesh->mesh_index];
+  return App::mod<Physics>().shape_cache.get_or_cook(
+    collision_mesh.positions, collision_mesh.indices, type, collider.max_convex_parts, cache_directory
+  );
+}
+} // namespace
+
+auto Scene::build_rigidbody(
+  this Scene& self, flecs::entity entity, const TransformComponent& transform, RigidBodyComponent& component
+) -> JPH::Body* {
+  ZoneScoped;
+
   JPH::MutableCompoundShapeSettings compound_shape_settings = {};
   float max_scale_component = glm::max(glm::max(transform.scale.x, transform.scale.y), transform.scale.z);
 
@@ -2088,16 +2293,31 @@ auto Scene::create_rigidbody(
     shape_settings.SetDensity(glm::max(0.001f, cycc->density));
     shape_result = shape_settings.Create();
     offset = cycc->offset;
+  } else if (const auto* mcc = entity.try_get<MeshColliderComponent>()) {
+    // Created once the mesh is in, see `update_pending_mesh_colliders`.
+    if (is_mesh_collider_loading(entity)) {
+      if (std::ranges::find(self.pending_mesh_colliders, entity) == self.pending_mesh_colliders.end()) {
+        self.pending_mesh_colliders.push_back(entity);
+      }
+      return nullptr;
+    }
+
+    // The cooked shape is shared, so it carries no material and the collider's goes on the body.
+    shape_result = cook_mesh_collider(entity, *mcc, component.type);
+    if (shape_result.IsValid() && transform.scale != glm::vec3(1.0f)) {
+      shape_result = JPH::ScaledShapeSettings(shape_result.Get(), math::to_jolt(transform.scale)).Create();
+    }
+    offset = mcc->offset;
   }
 
   if (shape_result.HasError()) {
     OX_LOG_ERROR("Jolt shape error: {}", shape_result.GetError().c_str());
   }
 
-  if (!shape_result.IsEmpty()) {
+  if (shape_result.IsValid()) {
     compound_shape_settings.AddShape({offset.x, offset.y, offset.z}, JPH::Quat::sIdentity(), shape_result.Get());
   } else {
-    return; // No Shape
+    return nullptr; // No Shape
   }
 
   // Body
@@ -2135,19 +2355,26 @@ auto Scene::create_rigidbody(
   body_settings.mRestitution = component.restitution;
 
   body_settings.mIsSensor = component.is_sensor;
+  if (const auto* mcc = entity.try_get<MeshColliderComponent>()) {
+    body_settings.mFriction = mcc->friction;
+    body_settings.mRestitution = mcc->restitution;
+  }
 
-  JPH::Body* body = body_interface.CreateBody(body_settings);
-
-  OX_CHECK_NULL(body, "Jolt is out of bodies!");
-
-  JPH::EActivation activation = component.awake && component.type != RigidBodyComponent::BodyType::Static
-                                  ? JPH::EActivation::Activate
-                                  : JPH::EActivation::DontActivate;
-  body_interface.AddBody(body->GetID(), activation);
+  JPH::Body* body = self.physics_system->GetBodyInterface().CreateBody(body_settings);
+  if (body == nullptr) {
+    OX_LOG_ERROR(
+      "Physics is full ({} bodies), {} gets no rigidbody. Raise ph.max_bodies or enable ph.auto_capacity.",
+      self.physics_system->GetMaxBodies(),
+      entity_name
+    );
+    return nullptr;
+  }
 
   body->SetUserData(static_cast<u64>(entity.id()));
 
   component.runtime_body = body;
+
+  return body;
 }
 
 auto Scene::create_terrain_collision(this Scene& self) -> void {
@@ -2213,11 +2440,15 @@ auto Scene::create_terrain_collision(this Scene& self) -> void {
 
   auto& body_interface = self.physics_system->GetBodyInterface();
   auto* body = body_interface.CreateBody(body_settings);
-  OX_CHECK_NULL(body, "Jolt is out of bodies!");
+  if (body == nullptr) {
+    OX_LOG_ERROR("Physics is full ({} bodies), terrain will not collide.", self.physics_system->GetMaxBodies());
+    return;
+  }
 
   body->SetUserData(static_cast<u64>(self.terrain_entity.id()));
   body_interface.AddBody(body->GetID(), JPH::EActivation::DontActivate);
   self.terrain_body_id = body->GetID();
+  self.terrain_shape = shape_result.Get();
 }
 
 auto Scene::destroy_terrain_collision(this Scene& self) -> void {
@@ -2231,6 +2462,57 @@ auto Scene::destroy_terrain_collision(this Scene& self) -> void {
   body_interface.RemoveBody(self.terrain_body_id);
   body_interface.DestroyBody(self.terrain_body_id);
   self.terrain_body_id = JPH::BodyID();
+  self.terrain_shape = nullptr;
+}
+
+auto Scene::update_terrain_collision_region(this Scene& self) -> void {
+  ZoneScoped;
+
+  auto* terrain = self.terrain.get();
+  if (terrain == nullptr) {
+    return;
+  }
+  if (self.terrain_body_id.IsInvalid() || self.terrain_shape == nullptr) {
+    terrain->collision_dirty_texels = {};
+    return;
+  }
+
+  const auto samples = terrain->download_collision_region(App::get_rendercontext());
+  if (samples.is_empty()) {
+    return;
+  }
+
+  // Jolt re-encodes the touched blocks, the body and its broadphase entry stay where they are.
+  auto* shape = static_cast<JPH::HeightFieldShape*>(self.terrain_shape.GetPtr());
+  const auto previous_center_of_mass = shape->GetCenterOfMass();
+  const auto sample_count = terrain->collision_sample_count;
+  const auto size = samples.size();
+  const auto* heights = terrain->collision_heights.data() + static_cast<usize>(samples.min.y) * sample_count +
+                        samples.min.x;
+  shape->SetHeights(
+    samples.min.x,
+    samples.min.y,
+    size.x,
+    size.y,
+    heights,
+    static_cast<intptr_t>(sample_count),
+    *App::mod<Physics>().get_temp_allocator()
+  );
+
+  auto& body_interface = self.physics_system->GetBodyInterface();
+  const auto activation = JPH::EActivation::DontActivate;
+  body_interface.NotifyShapeChanged(self.terrain_body_id, previous_center_of_mass, false, activation);
+
+  // Whatever was resting on the changed ground has to notice it moved.
+  const auto world_min = terrain->world_min();
+  const auto cell_size = terrain->world_size / static_cast<f32>(sample_count - 1);
+  const auto area_min = world_min + glm::vec2(samples.min) * cell_size;
+  const auto area_max = world_min + glm::vec2(samples.max) * cell_size;
+  const auto area = JPH::AABox(
+    JPH::Vec3(area_min.x, terrain->base_height(), area_min.y),
+    JPH::Vec3(area_max.x, terrain->base_height() + terrain->height_scale(), area_max.y)
+  );
+  body_interface.ActivateBodiesInAABox(area, {}, {});
 }
 
 auto Scene::sync_terrain_edits(this Scene& self) -> void {
@@ -2507,6 +2789,7 @@ auto Scene::to_json(this const Scene& self) -> JsonWriter {
   writer["name"] = self.scene_name;
 
   self.renderer_cvar.to_json(writer);
+  self.physics_cvar.to_json(writer);
 
   writer["scripts"].begin_array();
   for (auto& [script_uuid, system] : self.lua_systems) {
@@ -2517,8 +2800,7 @@ auto Scene::to_json(this const Scene& self) -> JsonWriter {
   writer.end_array();
 
   writer["entities"].begin_array();
-  const auto q = self.world.query_builder().with<TransformComponent>().build();
-  q.each([&writer](flecs::entity e) {
+  self.transform_query.each([&writer](flecs::entity e) {
     if (e.parent() == flecs::entity::null() && !e.has<Hidden>()) {
       entity_to_json(writer, e);
     }
@@ -2578,6 +2860,11 @@ auto Scene::from_json(this Scene& self, const std::string& json) -> bool {
     self.renderer_cvar.from_json(config_json.value());
   }
 
+  auto physics_json = doc["physics"];
+  if (!physics_json.error()) {
+    self.physics_cvar.from_json(physics_json.value());
+  }
+
   std::vector<UUID> requested_assets = {};
 
   auto scripts_array = doc["scripts"];
@@ -2637,7 +2924,7 @@ auto Scene::from_json(this Scene& self, const std::string& json) -> bool {
 
   // Assets are only requested after every entity exists, so meshes whose model was still unloaded
   // when their component was set could not be attached. Attach them now that the models are in.
-  self.world.query_builder<MeshComponent>().build().each([&self](flecs::entity e, MeshComponent& mc) {
+  self.mesh_query.each([&self](flecs::entity e, const MeshComponent& mc) {
     if (mc.model_uuid && !self.entity_to_mesh_instance_map.contains(e)) {
       self.attach_mesh(e, mc.model_uuid, mc.mesh_index, mc.material_uuid);
     }
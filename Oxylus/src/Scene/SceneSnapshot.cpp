@@ -1,90 +1,194 @@
 #include "Scene/SceneSnapshot.hpp"
 
-#include <fmt/base.h>
+#include <algorithm>
 
-#include "Scene/Components.hpp"
+#include "Scene/SnapshotCapture.hpp"
 
 namespace ox {
-auto SceneSnapshotBuilder::set_current(this SceneSnapshotBuilder& self, SceneState& new_state) -> void {
+auto SceneState::find(this const SceneState& self, flecs::entity_t entity_id) -> const EntityState* {
+  auto it = std::ranges::lower_bound(self.entities, entity_id, {}, &EntityState::entity_id);
+  if (it == self.entities.end() || it->entity_id != entity_id) {
+    return nullptr;
+  }
+
+  return &*it;
+}
+
+auto SceneState::components_of(this const SceneState& self, const EntityState& entity)
+  -> std::span<const ComponentState> {
+  return std::span(self.components).subspan(entity.first_component, entity.component_count);
+}
+
+auto SceneState::find_component(this const SceneState& self, const EntityState& entity, flecs::id_t id)
+  -> const ComponentState* {
+  const auto components = self.components_of(entity);
+  auto it = std::ranges::lower_bound(components, id, {}, &ComponentState::id);
+  if (it == components.end() || it->id != id) {
+    return nullptr;
+  }
+
+  return &*it;
+}
+
+auto SceneState::bytes_of(this const SceneState& self, const ComponentState& component) -> std::span<const u8> {
+  return std::span(self.data).subspan(component.offset, component.size);
+}
+
+auto SceneState::was_removed(this const SceneState& self, flecs::entity_t entity_id) -> bool {
+  return std::ranges::binary_search(self.removed_entities, entity_id);
+}
+
+auto SceneState::was_removed(this const SceneState& self, flecs::entity_t entity_id, flecs::id_t id) -> bool {
+  return std::ranges::binary_search(self.removed_components, RemovedComponent{.entity_id = entity_id, .id = id});
+}
+
+auto SceneState::push_entity(this SceneState& self, flecs::entity_t entity_id) -> void {
+  self.entities.push_back({.entity_id = entity_id, .first_component = static_cast<u32>(self.components.size())});
+}
+
+auto SceneState::push_component(this SceneState& self, flecs::id_t id, u64 hash, std::span<const u8> bytes) -> void {
+  self.entities.back().component_count += 1;
+  self.components.push_back({
+    .id = id,
+    .hash = hash,
+    .offset = static_cast<u32>(self.data.size()),
+    .size = static_cast<u32>(bytes.size()),
+  });
+  self.data.insert(self.data.end(), bytes.begin(), bytes.end());
+}
+
+auto SceneState::push_entity(this SceneState& self, const SceneState& from, const EntityState& entity) -> void {
+  self.push_entity(entity.entity_id);
+  for (const auto& component : from.components_of(entity)) {
+    self.push_component(component.id, component.hash, from.bytes_of(component));
+  }
+}
+
+auto SceneState::is_valid(this const SceneState& self) -> bool {
   ZoneScoped;
 
-  auto& current = self.current();
-  current.clear();
-  current = new_state; // There is gotta be a way to optimize this copy
+  for (auto i = 0_sz; i < self.entities.size(); i++) {
+    const auto& entity = self.entities[i];
+    if (i > 0 && self.entities[i - 1].entity_id >= entity.entity_id) {
+      return false;
+    }
+
+    if (static_cast<u64>(entity.first_component) + entity.component_count > self.components.size()) {
+      return false;
+    }
+
+    const auto components = self.components_of(entity);
+    for (auto j = 1_sz; j < components.size(); j++) {
+      if (components[j - 1].id >= components[j].id) {
+        return false;
+      }
+    }
+  }
+
+  for (const auto& component : self.components) {
+    if (static_cast<u64>(component.offset) + component.size > self.data.size()) {
+      return false;
+    }
+  }
+
+  return std::ranges::is_sorted(self.removed_entities) && std::ranges::is_sorted(self.removed_components);
 }
 
-auto SceneSnapshotBuilder::advance(this SceneSnapshotBuilder& self) -> void {
+auto SceneSnapshotBuilder::find(this SceneSnapshotBuilder& self, u8 sequence) -> SceneState* {
   ZoneScoped;
 
-  self.current_sequence = (self.current_sequence + 1) % MAX_SEQUENCES;
-  self.states[self.current_sequence].clear();
-  self.acks[self.current_sequence] = false;
+  const auto slot = sequence % MAX_SEQUENCES;
+  if (!self.valid[slot] || self.sequences[slot] != sequence) {
+    return nullptr;
+  }
+
+  return &self.states[slot];
 }
 
-auto SceneSnapshotBuilder::find_last_acked(this SceneSnapshotBuilder& self) -> option<u8> {
+auto SceneSnapshotBuilder::store(this SceneSnapshotBuilder& self, u8 sequence, const SceneState& state) -> void {
   ZoneScoped;
 
-  for (auto i = 1_u8; i < MAX_SEQUENCES; i++) {
-    auto seq = static_cast<u8>((self.current_sequence + MAX_SEQUENCES - 1) % MAX_SEQUENCES);
-    if (self.acks[seq]) {
-      return seq;
-    }
+  const auto slot = sequence % MAX_SEQUENCES;
+  if (&self.states[slot] != &state) {
+    self.states[slot] = state;
   }
+  self.sequences[slot] = sequence;
+  self.valid[slot] = true;
+}
+
+auto SceneSnapshotBuilder::claim(this SceneSnapshotBuilder& self, u8 sequence) -> SceneState& {
+  ZoneScoped;
+
+  const auto slot = sequence % MAX_SEQUENCES;
+  self.valid[slot] = false;
+  self.states[slot].clear();
+
+  return self.states[slot];
+}
+
+auto SceneSnapshotBuilder::advance(this SceneSnapshotBuilder& self) -> void {
+  ZoneScoped;
 
-  return nullopt;
+  self.current_sequence += 1;
+  const auto slot = self.current_sequence % MAX_SEQUENCES;
+  self.states[slot].clear();
+  self.sequences[slot] = self.current_sequence;
+  self.valid[slot] = true;
 }
 
-auto SceneSnapshotBuilder::delta(this SceneSnapshotBuilder& self) -> SceneState {
+auto SceneSnapshotBuilder::delta(this SceneSnapshotBuilder& self, const SceneState* baseline) -> SceneState {
   ZoneScoped;
 
   auto delta = SceneState{};
-  const auto& current_state = self.states[self.current_sequence];
-  auto last_acked = self.find_last_acked();
-  if (!last_acked.has_value()) {
+  const auto& current_state = self.current();
+  if (!baseline) {
     return current_state;
   }
 
-  const auto& last_state = self.states[last_acked.value()];
-  // check for changed entities
-  for (const auto& [entity_id, entity_state] : current_state.entities) {
-    auto last_it = last_state.entities.find(entity_id);
-    if (last_it != last_state.entities.end()) {
-      // this entity exist beteen current sequence and last sequence
-      const auto& [last_entity_id, last_entity_state] = *last_it;
-      auto delta_entity = EntityState{.entity_id = entity_id};
-      auto changed = false;
-      // check for changed components
-      for (const auto& [component_id, component_state] : entity_state.components) {
-        auto prev_component_it = last_entity_state.components.find(component_id);
-        if (prev_component_it == last_entity_state.components.end() ||
-            prev_component_it->second.hash != component_state.hash) {
-          delta_entity.components.emplace(component_id, component_state);
-          changed = true; // we've inserted new/changed component
-        }
-      }
+  // Both entity lists are sorted, so one walk over them finds new, changed and removed entities.
+  const auto& last_state = *baseline;
+  auto last_it = last_state.entities.begin();
+  for (const auto& entity : current_state.entities) {
+    while (last_it != last_state.entities.end() && last_it->entity_id < entity.entity_id) {
+      delta.removed_entities.push_back(last_it->entity_id);
+      ++last_it;
+    }
 
-      // check for removed components
-      for (const auto& [component_id, _] : last_entity_state.components) {
-        if (!entity_state.components.contains(component_id)) {
-          delta_entity.removed_components.emplace(component_id);
-          changed = true; // the component has been removed in current seq.
-        }
+    if (last_it == last_state.entities.end() || last_it->entity_id != entity.entity_id) {
+      // new entity
+      delta.push_entity(current_state, entity);
+      continue;
+    }
+
+    const auto& last_entity = *last_it++;
+    auto changed = false;
+    delta.push_entity(entity.entity_id);
+    // check for changed components
+    for (const auto& component : current_state.components_of(entity)) {
+      const auto* last_component = last_state.find_component(last_entity, component.id);
+      if (!last_component || last_component->hash != component.hash) {
+        delta.push_component(component.id, component.hash, current_state.bytes_of(component));
+        changed = true;
       }
+    }
 
-      if (changed) {
-        delta.entities.emplace(entity_id, std::move(delta_entity));
+    // check for removed components
+    for (const auto& component : last_state.components_of(last_entity)) {
+      if (!current_state.find_component(entity, component.id)) {
+        delta.removed_components.push_back({.entity_id = entity.entity_id, .id = component.id});
+        changed = true;
       }
-    } else {
-      // new entity
-      delta.entities.emplace(entity_id, entity_state);
+    }
+
+    // Nothing was pushed for an unchanged entity but itself.
+    if (!changed) {
+      delta.entities.pop_back();
     }
   }
 
   // check for removed entities
-  for (const auto& [entity_id, _] : last_state.entities) {
-    if (!current_state.entities.contains(entity_id)) {
-      delta.removed_entities.insert(entity_id);
-    }
+  for (; last_it != last_state.entities.end(); ++last_it) {
+    delta.removed_entities.push_back(last_it->entity_id);
   }
 
   return delta;
@@ -93,33 +197,7 @@ auto SceneSnapshotBuilder::delta(this SceneSnapshotBuilder& self) -> SceneState
 auto SceneSnapshotBuilder::take_snapshot(flecs::world& world, SceneState& state) -> void {
   ZoneScoped;
 
-  world.query_builder()
-    .with<Networked>() //
-    .each([&](flecs::entity component) {
-      auto component_id = component.raw_id();
-      auto is_component = component.has<flecs::Component>();
-      auto component_info = flecs::Component{};
-      if (is_component) {
-        component_info = component.get<flecs::Component>();
-      }
-
-      world.query_builder()
-        .with(component) //
-        .each([&](flecs::entity entity) {
-          auto entity_id = entity.id();
-          auto component_state = ComponentState{.id = component_id, .hash = ~0_u64};
-          if (is_component) {
-            auto* component_data = entity.get(component_id);
-            component_state.hash = ankerl::unordered_dense::detail::wyhash::hash(component_data, component_info.size);
-            component_state.buffer.resize(component_info.size);
-            std::memcpy(component_state.buffer.data(), component_data, component_info.size);
-          }
-
-          auto& entity_state = state.entities[entity_id];
-          entity_state.entity_id = entity_id;
-          entity_state.components.emplace(component_id, std::move(component_state));
-        });
-    });
+  auto capture = SnapshotCapture{};
+  capture.capture(world, nullptr, state);
 }
-
 } // namespace ox
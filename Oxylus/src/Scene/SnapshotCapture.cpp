@@ -0,0 +1,178 @@
+#include "Scene/SnapshotCapture.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+#include "Scene/Components.hpp"
+
+namespace ox {
+auto SnapshotCapture::capture(this SnapshotCapture& self, flecs::world& world, SceneSnapshotBuilder& snapshots)
+  -> void {
+  ZoneScoped;
+
+  const SceneState* previous = nullptr;
+  if (self.has_last_sequence && self.last_sequence != snapshots.current_sequence) {
+    previous = snapshots.find(self.last_sequence);
+  }
+
+  self.capture(world, previous, snapshots.current());
+  self.has_last_sequence = true;
+  self.last_sequence = snapshots.current_sequence;
+}
+
+auto SnapshotCapture::capture(
+  this SnapshotCapture& self, flecs::world& world, const SceneState* previous, SceneState& out
+) -> void {
+  ZoneScoped;
+
+  self.refresh_components(world);
+  if (previous == &out) {
+    previous = nullptr;
+  }
+
+  for (auto& [_, table] : self.tables) {
+    table.changed = false;
+    table.seen = false;
+  }
+  self.table_order.clear();
+
+  // Every query is walked to the end, even for tables that are already known to have changed,
+  // iterating is what resets their change state for the next capture.
+  for (auto& component : self.components) {
+    component.query.run([&self](flecs::iter& it) {
+      while (it.next()) {
+        auto* table = it.table().get_table();
+        auto [table_it, inserted] = self.tables.try_emplace(table);
+        auto& table_capture = table_it->second;
+        if (!table_capture.seen) {
+          table_capture.seen = true;
+          table_capture.changed = inserted;
+          self.table_order.push_back(table);
+        }
+        table_capture.changed |= it.changed();
+      }
+    });
+  }
+
+  out.clear();
+  const auto* world_handle = world.c_ptr();
+  for (auto* table : self.table_order) {
+    auto& table_capture = self.tables.find(table)->second;
+    const auto row_count = static_cast<u32>(ecs_table_count(table));
+    const auto* entity_ids = ecs_table_entities(table);
+
+    // `components` is sorted by id, so every entity's components come out sorted as well.
+    self.columns.clear();
+    auto stride = 0_u32;
+    for (const auto& component : self.components) {
+      if (!ecs_table_has_id(world_handle, table, component.id)) {
+        continue;
+      }
+
+      const auto* data = static_cast<const u8*>(ecs_table_get_id(world_handle, table, component.id, 0));
+      if (component.size > 0 && !data) {
+        continue;
+      }
+
+      self.columns.push_back({.id = component.id, .size = component.size, .offset = stride, .data = data});
+      stride += component.size;
+    }
+
+    const auto column_count = static_cast<u32>(self.columns.size());
+    const auto component_count = row_count * column_count;
+    const auto data_size = row_count * stride;
+    const auto first_component = static_cast<u32>(out.components.size());
+    const auto data_offset = static_cast<u32>(out.data.size());
+    const auto unchanged = previous && !table_capture.changed && table_capture.component_count == component_count &&
+                           table_capture.data_size == data_size &&
+                           std::ranges::equal(table_capture.entities, std::span(entity_ids, row_count));
+
+    if (unchanged) {
+      // Same rows in the same order, only where the bytes live in `data` moves.
+      const auto components = std::span(previous->components)
+                                .subspan(table_capture.first_component, table_capture.component_count);
+      for (auto component : components) {
+        component.offset = component.offset - table_capture.data_offset + data_offset;
+        out.components.push_back(component);
+      }
+      const auto bytes = std::span(previous->data).subspan(table_capture.data_offset, table_capture.data_size);
+      out.data.insert(out.data.end(), bytes.begin(), bytes.end());
+    } else {
+      out.components.resize(first_component + component_count);
+      out.data.resize(data_offset + data_size);
+      auto* components = out.components.data() + first_component;
+      auto* data = out.data.data() + data_offset;
+
+      for (auto column_index = 0_u32; column_index < column_count; column_index++) {
+        const auto& column = self.columns[column_index];
+        for (auto row = 0_u32; row < row_count; row++) {
+          const auto offset = row * stride + column.offset;
+          auto& component = components[row * column_count + column_index];
+          component = {.id = column.id, .hash = ~0_u64, .offset = data_offset + offset, .size = column.size};
+          if (column.size > 0) {
+            const auto* src = column.data + static_cast<usize>(row) * column.size;
+            std::memcpy(data + offset, src, column.size);
+            component.hash = ankerl::unordered_dense::detail::wyhash::hash(src, column.size);
+          }
+        }
+      }
+    }
+
+    for (auto row = 0_u32; row < row_count; row++) {
+      out.entities.push_back({
+        .entity_id = entity_ids[row],
+        .first_component = first_component + row * column_count,
+        .component_count = column_count,
+      });
+    }
+
+    table_capture.first_component = first_component;
+    table_capture.component_count = component_count;
+    table_capture.data_offset = data_offset;
+    table_capture.data_size = data_size;
+    table_capture.entities.assign(entity_ids, entity_ids + row_count);
+  }
+
+  for (auto it = self.tables.begin(); it != self.tables.end();) {
+    it = it->second.seen ? std::next(it) : self.tables.erase(it);
+  }
+
+  std::ranges::sort(out.entities, {}, &EntityState::entity_id);
+}
+
+auto SnapshotCapture::refresh_components(this SnapshotCapture& self, flecs::world& world) -> void {
+  ZoneScoped;
+
+  if (self.world_handle != world.c_ptr()) {
+    self.world_handle = world.c_ptr();
+    self.networked_query = world.query_builder().with<Networked>().cached().build();
+    self.components.clear();
+    self.tables.clear();
+  }
+
+  // Only a handful of components, checking every capture is cheap and catches late registrations.
+  self.networked_ids.clear();
+  self.networked_query.each([&self](flecs::entity component) { self.networked_ids.push_back(component.raw_id()); });
+  std::ranges::sort(self.networked_ids);
+  if (std::ranges::equal(self.networked_ids, self.components, {}, {}, &NetworkedComponent::id)) {
+    return;
+  }
+
+  self.components.clear();
+  self.tables.clear();
+  for (const auto id : self.networked_ids) {
+    const auto component = flecs::entity(world, id);
+    auto size = 0_u32;
+    if (component.has<flecs::Component>()) {
+      size = static_cast<u32>(component.get<flecs::Component>().size);
+    }
+
+    // Tags have no column to read, they only tell which tables to visit.
+    auto builder = world.query_builder().with(id);
+    if (size > 0) {
+      builder.in();
+    }
+    self.components.push_back({.id = id, .size = size, .query = builder.cached().detect_changes().build()});
+  }
+}
+} // namespace ox
@@ -0,0 +1,590 @@
+#include "Scene/SnapshotCodec.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <flecs/addons/meta.h>
+#include <glm/gtc/quaternion.hpp>
+#include <limits>
+
+#include "Memory/Buffer.hpp"
+#include "Scene/Components.hpp"
+
+namespace ox {
+namespace {
+using Field = SnapshotComponentLayout::Field;
+using FieldKind = SnapshotComponentLayout::FieldKind;
+
+static_assert(sizeof(glm::quat) == 4 * sizeof(u32));
+
+// Beyond 2^24 steps an f32 can't resolve every step anymore and decoding then re-encoding a value
+// would no longer give back the same word, which both ends rely on to agree on the baseline.
+constexpr auto MAX_QUANTIZED_STEPS = static_cast<f64>(1 << 24);
+// Step words stay below 2^25, words with the top bit set carry the f32 itself without its lowest
+// mantissa bit instead.
+constexpr auto RAW_FLOAT_BIT = 1_u32 << 31;
+
+auto quantize(f32 value, f32 precision) -> u32 {
+  if (std::isnan(value)) {
+    return 0;
+  }
+
+  // Dropping the bit first keeps the range check on the value the other end decodes.
+  const auto bits = std::bit_cast<u32>(value) & ~1_u32;
+  const auto steps = static_cast<f64>(std::bit_cast<f32>(bits)) / static_cast<f64>(precision);
+  if (std::abs(steps) > MAX_QUANTIZED_STEPS) {
+    return RAW_FLOAT_BIT | (bits >> 1);
+  }
+
+  return zigzag_encode(static_cast<i32>(std::llround(steps)));
+}
+
+auto dequantize(u32 word, f32 precision) -> f32 {
+  if (word & RAW_FLOAT_BIT) {
+    return std::bit_cast<f32>(word << 1);
+  }
+
+  return static_cast<f32>(static_cast<f64>(zigzag_decode(word)) * static_cast<f64>(precision));
+}
+
+// Walks the ops the same way `IEntitySerializer::serialize_ops` does, offsets of nested ops are
+// relative to their struct.
+auto collect_fields(
+  flecs::world& world,
+  flecs::entity_t quat_type,
+  flecs::meta::op_t* ops,
+  i32 op_count,
+  u32 base,
+  std::vector<Field>& fields
+) -> void {
+  for (auto i = 0_i32; i < op_count; i++) {
+    const auto& op = ops[i];
+    const auto offset = base + static_cast<u32>(op.offset);
+    switch (op.kind) {
+      case EcsOpF32: {
+        fields.push_back({.kind = FieldKind::F32, .offset = offset, .size = sizeof(f32)});
+      } break;
+      case EcsOpPushStruct: {
+        if (op.type == quat_type) {
+          fields.push_back({.kind = FieldKind::Quat, .offset = offset, .size = sizeof(glm::quat)});
+        } else {
+          collect_fields(world, quat_type, ops + i + 1, op.op_count - 2, offset, fields);
+        }
+      } break;
+      case EcsOpForward: {
+        auto type = flecs::entity(world, op.type);
+        if (op.type == quat_type) {
+          fields.push_back({.kind = FieldKind::Quat, .offset = offset, .size = sizeof(glm::quat)});
+        } else if (type.has<flecs::TypeSerializer>()) {
+          const auto& ts = type.get<flecs::TypeSerializer>();
+          auto* type_ops = ecs_vec_first_t(&ts.ops, flecs::meta::op_t);
+          collect_fields(world, quat_type, type_ops, ecs_vec_count(&ts.ops), offset, fields);
+        }
+      } break;
+      default: {
+      } break;
+    }
+
+    i += op.op_count - 1;
+  }
+}
+
+auto make_layout(flecs::id_t id, u32 size, std::vector<Field>& typed_fields) -> SnapshotComponentLayout {
+  std::ranges::sort(typed_fields, {}, &Field::offset);
+
+  auto layout = SnapshotComponentLayout{.id = id, .size = size};
+  auto offset = 0_u32;
+  const auto add_raw = [&](u32 end) {
+    while (offset < end) {
+      const auto chunk = glm::min(end - offset, static_cast<u32>(sizeof(u32)));
+      layout.fields.push_back({.kind = FieldKind::Raw, .offset = offset, .size = chunk});
+      layout.word_count += 1;
+      offset += chunk;
+    }
+  };
+
+  for (const auto& field : typed_fields) {
+    if (field.offset < offset || field.offset + field.size > size) {
+      continue;
+    }
+
+    add_raw(field.offset);
+    layout.fields.push_back(field);
+    layout.word_count += field.size / sizeof(u32);
+    offset = field.offset + field.size;
+  }
+  add_raw(size);
+
+  return layout;
+}
+
+auto find_layout(const SnapshotCodec& codec, flecs::id_t id, usize size) -> const SnapshotComponentLayout* {
+  auto it = codec.layouts.find(id);
+  if (it == codec.layouts.end() || it->second.size != size) {
+    return nullptr;
+  }
+
+  return &it->second;
+}
+
+auto word_count_of(const SnapshotComponentLayout* layout, usize size) -> usize {
+  return layout ? layout->word_count : (size + sizeof(u32) - 1) / sizeof(u32);
+}
+
+// Components without a layout are plain 4 byte chunks.
+auto to_words(
+  const SnapshotComponentLayout* layout,
+  std::span<const u8> bytes,
+  const SnapshotQuantization& quantization,
+  std::vector<u32>& words
+) -> void {
+  words.assign(word_count_of(layout, bytes.size()), 0);
+  if (!layout) {
+    std::memcpy(words.data(), bytes.data(), bytes.size());
+    return;
+  }
+
+  auto* word = words.data();
+  for (const auto& field : layout->fields) {
+    const auto* src = bytes.data() + field.offset;
+    switch (field.kind) {
+      case FieldKind::Raw: {
+        std::memcpy(word, src, field.size);
+        word += 1;
+      } break;
+      case FieldKind::F32: {
+        if (quantization.enabled) {
+          auto value = 0.0f;
+          std::memcpy(&value, src, sizeof(f32));
+          *word = quantize(value, quantization.float_precision);
+        } else {
+          std::memcpy(word, src, sizeof(f32));
+        }
+        word += 1;
+      } break;
+      case FieldKind::Quat: {
+        if (quantization.enabled) {
+          auto rotation = glm::quat{};
+          std::memcpy(&rotation, src, sizeof(glm::quat));
+          // q and -q are the same rotation, keeping w positive makes it one less sign to send.
+          if (rotation.w < 0.0f) {
+            rotation = -rotation;
+          }
+          word[0] = quantize(rotation.x, quantization.quat_precision);
+          word[1] = quantize(rotation.y, quantization.quat_precision);
+          word[2] = quantize(rotation.z, quantization.quat_precision);
+          word[3] = quantize(rotation.w, quantization.quat_precision);
+        } else {
+          std::memcpy(word, src, sizeof(glm::quat));
+        }
+        word += 4;
+      } break;
+    }
+  }
+}
+
+auto from_words(
+  const SnapshotComponentLayout* layout,
+  std::span<const u32> words,
+  const SnapshotQuantization& quantization,
+  std::span<u8> bytes
+) -> void {
+  if (!layout) {
+    std::memcpy(bytes.data(), words.data(), bytes.size());
+    return;
+  }
+
+  const auto* word = words.data();
+  for (const auto& field : layout->fields) {
+    auto* dst = bytes.data() + field.offset;
+    switch (field.kind) {
+      case FieldKind::Raw: {
+        std::memcpy(dst, word, field.size);
+        word += 1;
+      } break;
+      case FieldKind::F32: {
+        if (quantization.enabled) {
+          const auto value = dequantize(*word, quantization.float_precision);
+          std::memcpy(dst, &value, sizeof(f32));
+        } else {
+          std::memcpy(dst, word, sizeof(f32));
+        }
+        word += 1;
+      } break;
+      case FieldKind::Quat: {
+        if (quantization.enabled) {
+          auto rotation = glm::quat{};
+          rotation.x = dequantize(word[0], quantization.quat_precision);
+          rotation.y = dequantize(word[1], quantization.quat_precision);
+          rotation.z = dequantize(word[2], quantization.quat_precision);
+          rotation.w = dequantize(word[3], quantization.quat_precision);
+          std::memcpy(dst, &rotation, sizeof(glm::quat));
+        } else {
+          std::memcpy(dst, word, sizeof(glm::quat));
+        }
+        word += 4;
+      } break;
+    }
+  }
+}
+
+// (zero word count, literal count, literals...) until every word is covered.
+auto write_runs(BufferWriter& writer, std::span<const u32> words, std::span<const u32> baseline) -> bool {
+  const auto delta_at = [&](usize i) { return words[i] ^ (i < baseline.size() ? baseline[i] : 0_u32); };
+
+  auto ok = true;
+  auto i = 0_sz;
+  while (i < words.size()) {
+    auto zeros = 0_sz;
+    while (i + zeros < words.size() && delta_at(i + zeros) == 0) {
+      zeros += 1;
+    }
+
+    auto literals = 0_sz;
+    while (i + zeros + literals < words.size() && delta_at(i + zeros + literals) != 0) {
+      literals += 1;
+    }
+
+    ok &= writer.write_varint(zeros);
+    ok &= writer.write_varint(literals);
+    for (auto j = 0_sz; j < literals; j++) {
+      ok &= writer.write_varint(delta_at(i + zeros + j));
+    }
+
+    i += zeros + literals;
+  }
+
+  return ok;
+}
+
+auto read_runs(BufferReader& reader, usize word_count, std::span<const u32> baseline, std::vector<u32>& words) -> bool {
+  words.assign(word_count, 0);
+
+  auto i = 0_sz;
+  while (i < word_count) {
+    const auto zeros = reader.read_varint();
+    const auto literals = reader.read_varint();
+    if (!zeros.has_value() || !literals.has_value() || *zeros + *literals == 0 || *zeros > word_count - i ||
+        *literals > word_count - i - *zeros) {
+      return false;
+    }
+
+    i += *zeros;
+    for (auto j = 0_u64; j < *literals; j++) {
+      const auto word = reader.read_varint();
+      if (!word.has_value() || *word > ~0_u32) {
+        return false;
+      }
+      words[i++] = static_cast<u32>(*word);
+    }
+  }
+
+  for (auto j = 0_sz; j < baseline.size() && j < word_count; j++) {
+    words[j] ^= baseline[j];
+  }
+
+  return true;
+}
+} // namespace
+
+auto SnapshotCodec::from_world(flecs::world& world, const SnapshotQuantization& quantization) -> SnapshotCodec {
+  ZoneScoped;
+
+  auto codec = SnapshotCodec{.quantization = quantization};
+  world.query_builder()
+    .with<Networked>() //
+    .each([&](flecs::entity component) { codec.add_component(world, component); });
+
+  return codec;
+}
+
+auto SnapshotCodec::add_component(this SnapshotCodec& self, flecs::world& world, flecs::entity component) -> void {
+  ZoneScoped;
+
+  // Tags carry no data, they only ever cost their id.
+  if (!component.has<flecs::Component>()) {
+    return;
+  }
+
+  const auto size = component.get<flecs::Component>().size;
+  const auto quat_type = world.component<glm::quat>().id();
+  auto fields = std::vector<Field>{};
+  if (component.id() == quat_type) {
+    fields.push_back({.kind = FieldKind::Quat, .offset = 0, .size = sizeof(glm::quat)});
+  } else if (component.has<flecs::TypeSerializer>()) {
+    const auto& ts = component.get<flecs::TypeSerializer>();
+    auto* ops = ecs_vec_first_t(&ts.ops, flecs::meta::op_t);
+    collect_fields(world, quat_type, ops, ecs_vec_count(&ts.ops), 0, fields);
+  }
+
+  self.layouts.insert_or_assign(component.raw_id(), make_layout(component.raw_id(), static_cast<u32>(size), fields));
+}
+
+// Payload layout, every number is a varint:
+//   removed entity count + id deltas
+//   per changed entity: id delta (never 0), removed component count + ids, then (component id, size,
+//   word runs) per changed component in increasing id order, terminated by a 0 component id
+//   0 to end the entity list
+// Removals go first so the receiver can rebuild the state in one sorted pass over its baseline.
+auto SnapshotCodec::encode(
+  this const SnapshotCodec& self, const SceneState* baseline, const SceneState& current, std::vector<u8>& out
+) -> bool {
+  ZoneScoped;
+
+  auto max_size = 2 * MAX_VARINT_SIZE + current.entities.size() * 3 * MAX_VARINT_SIZE;
+  for (const auto& component : current.components) {
+    // A literal costs at most one run header and one u32 varint.
+    const auto* layout = find_layout(self, component.id, component.size);
+    max_size += 3 * MAX_VARINT_SIZE + word_count_of(layout, component.size) * 15;
+  }
+  if (baseline) {
+    max_size += (baseline->entities.size() + baseline->components.size()) * MAX_VARINT_SIZE;
+  }
+
+  const auto start = out.size();
+  out.resize(start + max_size);
+  auto writer = BufferWriter(std::span(out).subspan(start));
+
+  // Both entity lists are sorted, ids go out as small deltas.
+  const auto baseline_entities = baseline ? std::span(baseline->entities) : std::span<const EntityState>{};
+  const auto for_each_removed_entity = [&](const auto& fn) {
+    auto current_it = current.entities.begin();
+    for (const auto& entity : baseline_entities) {
+      while (current_it != current.entities.end() && current_it->entity_id < entity.entity_id) {
+        ++current_it;
+      }
+      if (current_it == current.entities.end() || current_it->entity_id != entity.entity_id) {
+        fn(entity.entity_id);
+      }
+    }
+  };
+
+  auto ok = true;
+  auto removed_entity_count = 0_sz;
+  for_each_removed_entity([&](flecs::entity_t) { removed_entity_count += 1; });
+  ok &= writer.write_varint(removed_entity_count);
+  auto previous_id = flecs::entity_t{0};
+  for_each_removed_entity([&](flecs::entity_t entity_id) {
+    ok &= writer.write_varint(entity_id - previous_id);
+    previous_id = entity_id;
+  });
+
+  auto words = std::vector<u32>{};
+  auto baseline_words = std::vector<u32>{};
+  auto baseline_it = baseline_entities.begin();
+  previous_id = 0;
+  for (const auto& entity : current.entities) {
+    while (baseline_it != baseline_entities.end() && baseline_it->entity_id < entity.entity_id) {
+      ++baseline_it;
+    }
+
+    const EntityState* baseline_entity = nullptr;
+    if (baseline_it != baseline_entities.end() && baseline_it->entity_id == entity.entity_id) {
+      baseline_entity = &*baseline_it;
+    }
+
+    const auto entity_start = writer.size();
+    ok &= writer.write_varint(entity.entity_id - previous_id);
+
+    const auto baseline_components = baseline_entity ? baseline->components_of(*baseline_entity)
+                                                     : std::span<const ComponentState>{};
+    auto removed_count = 0_sz;
+    for (const auto& component : baseline_components) {
+      removed_count += !current.find_component(entity, component.id);
+    }
+    ok &= writer.write_varint(removed_count);
+    if (removed_count > 0) {
+      for (const auto& component : baseline_components) {
+        if (!current.find_component(entity, component.id)) {
+          ok &= writer.write_varint(component.id);
+        }
+      }
+    }
+
+    auto changed = !baseline_entity || removed_count > 0;
+    for (const auto& component : current.components_of(entity)) {
+      const auto* baseline_component = baseline_entity ? baseline->find_component(*baseline_entity, component.id)
+                                                        : nullptr;
+      if (component.size == 0) {
+        if (!baseline_component) {
+          ok &= writer.write_varint(component.id);
+          ok &= writer.write_varint(0);
+          changed = true;
+        }
+        continue;
+      }
+
+      const auto* layout = find_layout(self, component.id, component.size);
+      to_words(layout, current.bytes_of(component), self.quantization, words);
+      baseline_words.clear();
+      if (baseline_component && baseline_component->size == component.size) {
+        to_words(layout, baseline->bytes_of(*baseline_component), self.quantization, baseline_words);
+        if (words == baseline_words) {
+          continue;
+        }
+      }
+
+      ok &= writer.write_varint(component.id);
+      ok &= writer.write_varint(component.size);
+      ok &= write_runs(writer, words, baseline_words);
+      changed = true;
+    }
+    ok &= writer.write_varint(0);
+
+    if (!changed) {
+      writer.offset = entity_start;
+      continue;
+    }
+
+    previous_id = entity.entity_id;
+  }
+  ok &= writer.write_varint(0);
+
+  out.resize(start + writer.size());
+
+  return ok;
+}
+
+auto SnapshotCodec::decode(
+  this const SnapshotCodec& self, const SceneState* baseline, std::span<const u8> payload, SceneState& out
+) -> bool {
+  ZoneScoped;
+
+  out.clear();
+  auto reader = BufferReader(payload);
+
+  const auto removed_entity_count = reader.read_varint();
+  if (!removed_entity_count.has_value() || *removed_entity_count > reader.remaining()) {
+    return false;
+  }
+
+  auto entity_id = flecs::entity_t{0};
+  for (auto i = 0_u64; i < *removed_entity_count; i++) {
+    const auto id_delta = reader.read_varint();
+    if (!id_delta.has_value() || *id_delta == 0) {
+      return false;
+    }
+    entity_id += *id_delta;
+    out.removed_entities.push_back(entity_id);
+  }
+
+  // Baseline entities before `end_id` carry over untouched, unless this delta removed them.
+  const auto baseline_entities = baseline ? std::span(baseline->entities) : std::span<const EntityState>{};
+  auto baseline_it = baseline_entities.begin();
+  const auto copy_baseline_until = [&](flecs::entity_t end_id) {
+    for (; baseline_it != baseline_entities.end() && baseline_it->entity_id < end_id; ++baseline_it) {
+      if (!out.was_removed(baseline_it->entity_id)) {
+        out.push_entity(*baseline, *baseline_it);
+      }
+    }
+  };
+
+  auto words = std::vector<u32>{};
+  auto baseline_words = std::vector<u32>{};
+  auto bytes = std::vector<u8>{};
+  auto removed_ids = std::vector<flecs::id_t>{};
+  entity_id = 0;
+  while (true) {
+    const auto id_delta = reader.read_varint();
+    if (!id_delta.has_value()) {
+      return false;
+    }
+    if (*id_delta == 0) {
+      break;
+    }
+
+    entity_id += *id_delta;
+    if (out.was_removed(entity_id)) {
+      return false;
+    }
+
+    copy_baseline_until(entity_id);
+    const EntityState* baseline_entity = nullptr;
+    if (baseline_it != baseline_entities.end() && baseline_it->entity_id == entity_id) {
+      baseline_entity = &*baseline_it++;
+    }
+
+    const auto removed_count = reader.read_varint();
+    if (!removed_count.has_value() || *removed_count > reader.remaining()) {
+      return false;
+    }
+
+    removed_ids.clear();
+    for (auto i = 0_u64; i < *removed_count; i++) {
+      const auto component_id = reader.read_varint();
+      if (!component_id.has_value()) {
+        return false;
+      }
+      removed_ids.push_back(*component_id);
+    }
+    std::ranges::sort(removed_ids);
+    for (const auto component_id : removed_ids) {
+      out.removed_components.push_back({.entity_id = entity_id, .id = component_id});
+    }
+
+    // Changed components come in increasing id order, merged with what the baseline already had.
+    const auto baseline_components = baseline_entity ? baseline->components_of(*baseline_entity)
+                                                     : std::span<const ComponentState>{};
+    auto baseline_component_it = baseline_components.begin();
+    const auto copy_components_until = [&](flecs::id_t end_id) {
+      for (; baseline_component_it != baseline_components.end() && baseline_component_it->id < end_id;
+           ++baseline_component_it) {
+        const auto& component = *baseline_component_it;
+        if (!std::ranges::binary_search(removed_ids, component.id)) {
+          out.push_component(component.id, component.hash, baseline->bytes_of(component));
+        }
+      }
+    };
+
+    out.push_entity(entity_id);
+    auto previous_component_id = flecs::id_t{0};
+    while (true) {
+      const auto component_id = reader.read_varint();
+      if (!component_id.has_value()) {
+        return false;
+      }
+      if (*component_id == 0) {
+        break;
+      }
+      if (*component_id <= previous_component_id) {
+        return false;
+      }
+      previous_component_id = *component_id;
+
+      const auto size = reader.read_varint();
+      if (!size.has_value() || *size > MAX_COMPONENT_SIZE) {
+        return false;
+      }
+
+      copy_components_until(*component_id);
+      const ComponentState* baseline_component = nullptr;
+      if (baseline_component_it != baseline_components.end() && baseline_component_it->id == *component_id) {
+        baseline_component = &*baseline_component_it++;
+      }
+
+      if (*size == 0) {
+        out.push_component(*component_id, ~0_u64, {});
+        continue;
+      }
+
+      const auto* layout = find_layout(self, *component_id, *size);
+      baseline_words.clear();
+      if (baseline_component && baseline_component->size == *size) {
+        to_words(layout, baseline->bytes_of(*baseline_component), self.quantization, baseline_words);
+      }
+
+      if (!read_runs(reader, word_count_of(layout, *size), baseline_words, words)) {
+        return false;
+      }
+
+      bytes.resize(*size);
+      from_words(layout, words, self.quantization, bytes);
+      out.push_component(*component_id, ankerl::unordered_dense::detail::wyhash::hash(bytes.data(), *size), bytes);
+    }
+    copy_components_until(std::numeric_limits<flecs::id_t>::max());
+  }
+  copy_baseline_until(std::numeric_limits<flecs::entity_t>::max());
+
+  return reader.eof();
+}
+} // namespace ox
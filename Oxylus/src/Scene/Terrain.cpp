@@ -2,6 +2,10 @@
 
 #include <algorithm>
 #include <bit>
+#include <cmath>
+#include <limits>
+#include <span>
+#include <utility>
 #include <vuk/runtime/CommandBuffer.hpp>
 #include <vuk/vsl/Core.hpp>
 
@@ -460,18 +464,12 @@ auto Terrain::bake(this Terrain& self, RenderContext& render_context) -> void {
   render_context.wait_on_multiple(waits);
 }
 
-auto Terrain::download_collision_heights(this Terrain& self, RenderContext& render_context) -> void {
-  ZoneScoped;
-
-  self.collision_heights.clear();
-  self.collision_sample_count = 0;
-
-  if (!self.is_baked()) {
-    return;
-  }
-
-  const auto extent = self.heightmap.get_extent();
-  const auto format = self.heightmap.get_format();
+namespace {
+auto read_heightmap_texels(const Texture& heightmap, const TerrainRect& texels, RenderContext& render_context)
+  -> std::vector<u16> {
+  const auto size = texels.size();
+  const auto format = heightmap.get_format();
+  const auto extent = vuk::Extent3D{.width = size.x, .height = size.y, .depth = 1};
   auto staging = render_context.allocate_buffer_super(
     vuk::MemoryUsage::eGPUtoCPU,
     vuk::compute_image_size(format, extent),
@@ -480,7 +478,7 @@ auto Terrain::download_collision_heights(this Terrain& self, RenderContext& rend
 
   auto download_pass = vuk::make_pass(
     "terrain heightmap readback",
-    [](
+    [texels, extent](
       vuk::CommandBuffer& cmd_list, //
       VUK_IA(vuk::eCopyRead) heightmap,
       VUK_BA(vuk::eCopyWrite) dst
@@ -492,7 +490,8 @@ auto Terrain::download_collision_heights(this Terrain& self, RenderContext& rend
            .mipLevel = heightmap->base_level,
            .baseArrayLayer = heightmap->base_layer,
            .layerCount = heightmap->layer_count},
-        .imageExtent = heightmap->base_mip_extent(),
+        .imageOffset = {static_cast<i32>(texels.min.x), static_cast<i32>(texels.min.y), 0},
+        .imageExtent = extent,
       };
       cmd_list.copy_image_to_buffer(heightmap, dst, region);
 
@@ -500,54 +499,275 @@ auto Terrain::download_collision_heights(this Terrain& self, RenderContext& rend
     }
   );
 
-  auto [heightmap, downloaded] = download_pass(
-    self.heightmap.acquire("terrain heightmap", vuk::eComputeSampled),
+  auto [src, downloaded] = download_pass(
+    heightmap.acquire("terrain heightmap", vuk::eComputeSampled),
     vuk::acquire_buf("terrain heightmap readback", *staging, vuk::eNone)
   );
 
   auto waits = std::array{
-    vuk::UntypedValue(std::move(heightmap).as_released(vuk::eComputeSampled, vuk::DomainFlagBits::eGraphicsQueue)),
+    vuk::UntypedValue(std::move(src).as_released(vuk::eComputeSampled, vuk::DomainFlagBits::eGraphicsQueue)),
     vuk::UntypedValue(std::move(downloaded).as_released(vuk::eHostRead, vuk::DomainFlagBits::eGraphicsQueue)),
   };
   render_context.wait_on_multiple(waits);
 
-  const auto* texels = reinterpret_cast<const u16*>(staging->mapped_ptr);
-  if (texels == nullptr) {
+  const auto* mapped = reinterpret_cast<const u16*>(staging->mapped_ptr);
+  if (mapped == nullptr) {
     OX_LOG_ERROR("Terrain heightmap readback buffer came back unmapped.");
-    return;
+    return {};
   }
 
-  const auto sample_count = terrain_collision_sample_count(self.collision_resolution);
-  const auto width = static_cast<i32>(extent.width);
-  const auto height = static_cast<i32>(extent.height);
-
-  const auto texel = [texels, width, height](i32 x, i32 y) -> f32 {
-    const auto cx = std::clamp(x, 0, width - 1);
-    const auto cy = std::clamp(y, 0, height - 1);
-    return static_cast<f32>(texels[static_cast<usize>(cy) * static_cast<usize>(width) + static_cast<usize>(cx)]) /
-           65535.0f;
-  };
+  return std::vector<u16>(mapped, mapped + static_cast<usize>(size.x) * size.y);
+}
 
-  self.collision_heights.resize(static_cast<usize>(sample_count) * sample_count);
-  self.collision_sample_count = sample_count;
+// Bilinear, matching how the renderer samples the heightmap. `texels` holds `texel_rect` of the
+// `map_size` heightmap, which has to cover every texel `samples` reads.
+auto resample_collision_heights(
+  Terrain& terrain,
+  std::span<const u16> texels,
+  const TerrainRect& texel_rect,
+  glm::uvec2 map_size,
+  const TerrainRect& samples
+) -> void {
+  const auto sample_count = terrain.collision_sample_count;
+  const auto texel_min = glm::ivec2(texel_rect.min);
+  const auto texel_max = glm::ivec2(texel_rect.max) - 1;
+  const auto row_length = static_cast<usize>(texel_rect.size().x);
+
+  const auto texel = [&](i32 x, i32 y) -> f32 {
+    const auto cx = std::clamp(x, texel_min.x, texel_max.x) - texel_min.x;
+    const auto cy = std::clamp(y, texel_min.y, texel_max.y) - texel_min.y;
+    return static_cast<f32>(texels[static_cast<usize>(cy) * row_length + static_cast<usize>(cx)]) / 65535.0f;
+  };
 
-  const auto base = self.base_height();
-  const auto scale = self.height_scale();
-  const auto map_size = glm::vec2(extent.width, extent.height);
+  const auto base = terrain.base_height();
+  const auto scale = terrain.height_scale();
+  const auto map_extent = glm::vec2(map_size);
   const auto inv_last_sample = 1.0f / static_cast<f32>(sample_count - 1);
 
-  for (auto y = 0_u32; y < sample_count; y++) {
-    for (auto x = 0_u32; x < sample_count; x++) {
+  for (auto y = samples.min.y; y < samples.max.y; y++) {
+    for (auto x = samples.min.x; x < samples.max.x; x++) {
       const auto uv = glm::vec2(x, y) * inv_last_sample;
-      const auto coord = uv * map_size - 0.5f;
+      const auto coord = uv * map_extent - 0.5f;
       const auto lo = glm::ivec2(glm::floor(coord));
       const auto frac = coord - glm::vec2(lo);
 
       const auto top = glm::mix(texel(lo.x, lo.y), texel(lo.x + 1, lo.y), frac.x);
       const auto bottom = glm::mix(texel(lo.x, lo.y + 1), texel(lo.x + 1, lo.y + 1), frac.x);
 
-      self.collision_heights[static_cast<usize>(y) * sample_count + x] = base + glm::mix(top, bottom, frac.y) * scale;
+      const auto index = static_cast<usize>(y) * sample_count + x;
+      terrain.collision_heights[index] = base + glm::mix(top, bottom, frac.y) * scale;
+    }
+  }
+}
+} // namespace
+
+auto terrain_collision_samples_for_texels(const TerrainRect& texels, glm::uvec2 map_size, u32 sample_count)
+  -> TerrainRect {
+  if (texels.is_empty() || sample_count < TERRAIN_COLLISION_MIN_SAMPLES) {
+    return {};
+  }
+
+  // Sample `s` reads texels `floor(c)` and `floor(c) + 1` at `c = s * texels_per_cell - 0.5`, so
+  // texel `t` is read by `(t - 0.5) / texels_per_cell <= s < (t + 1.5) / texels_per_cell`.
+  const auto texels_per_cell = glm::vec2(map_size) / static_cast<f32>(sample_count - 1);
+  const auto first = glm::floor((glm::vec2(texels.min) - 0.5f) / texels_per_cell);
+  const auto last = glm::ceil((glm::vec2(texels.max) + 0.5f) / texels_per_cell);
+
+  const auto block = glm::uvec2(TERRAIN_COLLISION_BLOCK_SIZE);
+  const auto min = glm::uvec2(glm::clamp(first, glm::vec2(0.0f), glm::vec2(sample_count)));
+  const auto max = glm::uvec2(glm::clamp(last, glm::vec2(0.0f), glm::vec2(sample_count)));
+
+  return {
+    .min = min / block * block,
+    .max = glm::min((max + block - 1u) / block * block, glm::uvec2(sample_count)),
+  };
+}
+
+auto terrain_collision_texels_for_samples(const TerrainRect& samples, glm::uvec2 map_size, u32 sample_count)
+  -> TerrainRect {
+  if (samples.is_empty() || sample_count < 2 || map_size.x == 0 || map_size.y == 0) {
+    return {};
+  }
+
+  const auto texels_per_cell = glm::vec2(map_size) / static_cast<f32>(sample_count - 1);
+  const auto first = glm::floor(glm::vec2(samples.min) * texels_per_cell - 0.5f);
+  const auto last = glm::floor(glm::vec2(samples.max - 1u) * texels_per_cell - 0.5f) + 1.0f;
+  const auto max_texel = glm::vec2(map_size - 1u);
+
+  return {
+    .min = glm::uvec2(glm::clamp(first, glm::vec2(0.0f), max_texel)),
+    .max = glm::uvec2(glm::clamp(last, glm::vec2(0.0f), max_texel)) + 1u,
+  };
+}
+
+auto Terrain::download_collision_heights(this Terrain& self, RenderContext& render_context) -> void {
+  ZoneScoped;
+
+  self.collision_heights.clear();
+  self.collision_sample_count = 0;
+  self.collision_dirty_texels = {};
+
+  if (!self.is_baked()) {
+    return;
+  }
+
+  const auto extent = self.heightmap.get_extent();
+  const auto map_size = glm::uvec2(extent.width, extent.height);
+  const auto texel_rect = TerrainRect{.max = map_size};
+  const auto texels = read_heightmap_texels(self.heightmap, texel_rect, render_context);
+  if (texels.empty()) {
+    return;
+  }
+
+  const auto sample_count = terrain_collision_sample_count(self.collision_resolution);
+  self.collision_heights.resize(static_cast<usize>(sample_count) * sample_count);
+  self.collision_sample_count = sample_count;
+  resample_collision_heights(self, texels, texel_rect, map_size, {.max = glm::uvec2(sample_count)});
+}
+
+auto Terrain::download_collision_region(this Terrain& self, RenderContext& render_context) -> TerrainRect {
+  ZoneScoped;
+
+  const auto dirty = std::exchange(self.collision_dirty_texels, {});
+  const auto sample_count = self.collision_sample_count;
+  if (
+    dirty.is_empty() || !self.is_baked() ||
+    self.collision_heights.size() != static_cast<usize>(sample_count) * sample_count
+  ) {
+    return {};
+  }
+
+  const auto extent = self.heightmap.get_extent();
+  const auto map_size = glm::uvec2(extent.width, extent.height);
+  const auto samples = terrain_collision_samples_for_texels(dirty, map_size, sample_count);
+  const auto texel_rect = terrain_collision_texels_for_samples(samples, map_size, sample_count);
+  if (samples.is_empty() || texel_rect.is_empty()) {
+    return {};
+  }
+
+  const auto texels = read_heightmap_texels(self.heightmap, texel_rect, render_context);
+  if (texels.empty()) {
+    return {};
+  }
+
+  resample_collision_heights(self, texels, texel_rect, map_size, samples);
+
+  return samples;
+}
+
+auto Terrain::mark_brush_collision_dirty(this Terrain& self) -> void {
+  ZoneScoped;
+
+  // Nothing to patch yet, whoever builds the collider next reads everything anyway.
+  if (self.collision_dirty || self.collision_heights.empty()) {
+    self.collision_dirty = true;
+    return;
+  }
+
+  // The GPU traces a finer heightmap than the collision heights, a stroke can land there and still
+  // miss here. Nothing tells where it painted then, so everything gets read.
+  const auto hit = self.raycast_collision_heights(self.brush.ray_origin, self.brush.ray_direction);
+  if (!hit.has_value()) {
+    self.collision_dirty = true;
+    return;
+  }
+
+  // The brush regenerates `ceil(radius + 1)` texels around its hit. The collision heights are
+  // coarser than the heightmap the GPU traces against, so leave a couple of collision cells of
+  // room for the two hits landing apart.
+  const auto texel_size = self.texel_world_size();
+  const auto radius_texels = self.brush.radius_world / glm::max(texel_size.x, texel_size.y);
+  const auto texels_per_cell = glm::vec2(self.resolution) / static_cast<f32>(self.collision_sample_count - 1);
+  const auto footprint = static_cast<i32>(std::ceil(radius_texels + 1.0f)) + 1;
+  const auto pad = glm::ivec2(footprint) + glm::ivec2(glm::ceil(texels_per_cell * 2.0f));
+
+  const auto center = glm::ivec2(glm::floor((glm::vec2(hit->x, hit->z) - self.world_min()) / texel_size));
+  const auto resolution = glm::ivec2(self.resolution);
+  const auto stroke = TerrainRect{
+    .min = glm::uvec2(glm::clamp(center - pad, glm::ivec2(0), resolution)),
+    .max = glm::uvec2(glm::clamp(center + pad + 1, glm::ivec2(0), resolution)),
+  };
+  self.collision_dirty_texels = self.collision_dirty_texels.merged(stroke);
+}
+
+auto Terrain::collision_height_at(this const Terrain& self, glm::vec2 world_xz) -> f32 {
+  const auto sample_count = self.collision_sample_count;
+  if (sample_count < 2 || self.collision_heights.size() != static_cast<usize>(sample_count) * sample_count) {
+    return self.base_height();
+  }
+
+  const auto last = static_cast<f32>(sample_count - 1);
+  const auto uv = glm::clamp((world_xz - self.world_min()) / self.world_size, 0.0f, 1.0f);
+  const auto coord = uv * last;
+  const auto lo = glm::min(glm::uvec2(coord), glm::uvec2(sample_count - 2));
+  const auto frac = coord - glm::vec2(lo);
+
+  const auto height = [&](u32 x, u32 y) { return self.collision_heights[static_cast<usize>(y) * sample_count + x]; };
+  const auto top = glm::mix(height(lo.x, lo.y), height(lo.x + 1, lo.y), frac.x);
+  const auto bottom = glm::mix(height(lo.x, lo.y + 1), height(lo.x + 1, lo.y + 1), frac.x);
+
+  return glm::mix(top, bottom, frac.y);
+}
+
+auto Terrain::raycast_collision_heights(this const Terrain& self, const glm::vec3& origin, const glm::vec3& direction)
+  -> option<glm::vec3> {
+  ZoneScoped;
+
+  if (self.collision_sample_count < 2 || glm::dot(direction, direction) <= 0.0f) {
+    return nullopt;
+  }
+
+  // Clip the ray to the box the terrain can occupy.
+  const auto dir = glm::normalize(direction);
+  const auto world_min = self.world_min();
+  const auto box_min = glm::vec3(world_min.x, self.base_height(), world_min.y);
+  const auto box_max = box_min + glm::vec3(self.world_size.x, self.height_scale(), self.world_size.y);
+  auto t_near = 0.0f;
+  auto t_far = std::numeric_limits<f32>::max();
+  for (auto axis = 0; axis < 3; axis++) {
+    if (glm::abs(dir[axis]) < 1e-8f) {
+      if (origin[axis] < box_min[axis] || origin[axis] > box_max[axis]) {
+        return nullopt;
+      }
+      continue;
     }
+    auto t0 = (box_min[axis] - origin[axis]) / dir[axis];
+    auto t1 = (box_max[axis] - origin[axis]) / dir[axis];
+    if (t0 > t1) {
+      std::swap(t0, t1);
+    }
+    t_near = glm::max(t_near, t0);
+    t_far = glm::min(t_far, t1);
+  }
+  if (t_near > t_far) {
+    return nullopt;
   }
+
+  const auto below = [&](f32 t) {
+    const auto point = origin + dir * t;
+    return point.y <= self.collision_height_at({point.x, point.z});
+  };
+
+  // Half a cell at a time, then bisect the step that went under.
+  const auto cell_size = self.world_size / static_cast<f32>(self.collision_sample_count - 1);
+  const auto step = 0.5f * glm::min(cell_size.x, cell_size.y);
+  auto previous = t_near;
+  if (below(previous)) {
+    return origin + dir * previous;
+  }
+  while (previous < t_far) {
+    auto t = glm::min(previous + step, t_far);
+    if (below(t)) {
+      auto above = previous;
+      for (auto i = 0; i < 16; i++) {
+        const auto middle = (above + t) * 0.5f;
+        (below(middle) ? t : above) = middle;
+      }
+      return origin + dir * t;
+    }
+    previous = t;
+  }
+
+  return nullopt;
 }
 } // namespace ox
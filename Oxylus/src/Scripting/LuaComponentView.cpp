@@ -0,0 +1,600 @@
+#include "Scripting/LuaComponentView.hpp"
+
+#include <cstring>
+#include <flecs/addons/meta.h>
+#include <glm/gtc/quaternion.hpp>
+#include <sol/state.hpp>
+
+#include "Core/UUID.hpp"
+#include "Utils/Log.hpp"
+
+namespace ox {
+namespace {
+auto integer_kind(ecs_meta_op_kind_t kind) -> LuaFieldKind {
+  switch (kind) {
+    case EcsOpU8 : return LuaFieldKind::U8;
+    case EcsOpU16: return LuaFieldKind::U16;
+    case EcsOpU32: return LuaFieldKind::U32;
+    case EcsOpU64: return LuaFieldKind::U64;
+    case EcsOpI8 : return LuaFieldKind::I8;
+    case EcsOpI16: return LuaFieldKind::I16;
+    case EcsOpI64: return LuaFieldKind::I64;
+    default      : return LuaFieldKind::I32;
+  }
+}
+
+// The math types scripts already have usertypes for are read and written whole.
+auto value_kind(flecs::world& world, const ecs_type_info_t* type_info) -> LuaFieldKind {
+  if (type_info == world.type_info<glm::vec2>()) {
+    return LuaFieldKind::Vec2;
+  } else if (type_info == world.type_info<glm::ivec2>()) {
+    return LuaFieldKind::IVec2;
+  } else if (type_info == world.type_info<glm::vec3>()) {
+    return LuaFieldKind::Vec3;
+  } else if (type_info == world.type_info<glm::vec4>()) {
+    return LuaFieldKind::Vec4;
+  } else if (type_info == world.type_info<glm::quat>()) {
+    return LuaFieldKind::Quat;
+  }
+  return LuaFieldKind::Struct;
+}
+
+// Calls `f` with a `std::type_identity` of the C++ type behind a numeric kind.
+template <typename F>
+auto visit_number(LuaFieldKind kind, F&& f) -> bool {
+  switch (kind) {
+    case LuaFieldKind::Char: f(std::type_identity<c8>{}); return true;
+    case LuaFieldKind::U8  : f(std::type_identity<u8>{}); return true;
+    case LuaFieldKind::U16 : f(std::type_identity<u16>{}); return true;
+    case LuaFieldKind::U32 : f(std::type_identity<u32>{}); return true;
+    case LuaFieldKind::U64 : f(std::type_identity<u64>{}); return true;
+    case LuaFieldKind::I8  : f(std::type_identity<i8>{}); return true;
+    case LuaFieldKind::I16 : f(std::type_identity<i16>{}); return true;
+    case LuaFieldKind::I32 : f(std::type_identity<i32>{}); return true;
+    case LuaFieldKind::I64 : f(std::type_identity<i64>{}); return true;
+    case LuaFieldKind::F32 : f(std::type_identity<f32>{}); return true;
+    case LuaFieldKind::F64 : f(std::type_identity<f64>{}); return true;
+    default                : return false;
+  }
+}
+
+template <typename T>
+auto read_value(sol::this_state lua, const u8* ptr) -> sol::object {
+  return sol::make_object(lua, *reinterpret_cast<const T*>(ptr));
+}
+
+template <typename T, typename Value>
+auto write_value(u8* ptr, const Value& value) -> bool {
+  if (!value.is<T>()) {
+    return false;
+  }
+  *reinterpret_cast<T*>(ptr) = value.as<T>();
+  return true;
+}
+
+// Everything but nested structs, which only views can hand out.
+auto read_plain(sol::this_state lua, ecs_world_t* world, LuaFieldKind kind, const u8* ptr) -> sol::object {
+  auto result = sol::make_object(lua, sol::lua_nil);
+  if (visit_number(kind, [&]<typename T>(std::type_identity<T>) {
+        // Chars are small integers to flecs, not strings.
+        using Pushed = std::conditional_t<std::is_same_v<T, c8>, i32, T>;
+        result = sol::make_object(lua, static_cast<Pushed>(*reinterpret_cast<const T*>(ptr)));
+      })) {
+    return result;
+  }
+
+  switch (kind) {
+    case LuaFieldKind::Bool  : return read_value<bool>(lua, ptr);
+    case LuaFieldKind::Entity: {
+      return sol::make_object(lua, flecs::entity(world, *reinterpret_cast<const flecs::entity_t*>(ptr)));
+    }
+    case LuaFieldKind::CString: {
+      const auto* str = *reinterpret_cast<const c8* const*>(ptr);
+      return str != nullptr ? sol::make_object(lua, std::string_view(str)) : result;
+    }
+    case LuaFieldKind::String: {
+      return sol::make_object(lua, std::string_view(*reinterpret_cast<const std::string*>(ptr)));
+    }
+    case LuaFieldKind::UUID : return read_value<UUID>(lua, ptr);
+    case LuaFieldKind::Vec2 : return read_value<glm::vec2>(lua, ptr);
+    case LuaFieldKind::IVec2: return read_value<glm::ivec2>(lua, ptr);
+    case LuaFieldKind::Vec3 : return read_value<glm::vec3>(lua, ptr);
+    case LuaFieldKind::Vec4 : return read_value<glm::vec4>(lua, ptr);
+    case LuaFieldKind::Quat : return read_value<glm::quat>(lua, ptr);
+    default                 : return result;
+  }
+}
+
+auto read_field(sol::this_state lua, const LuaComponentView& view, const LuaComponentField& field, const u8* ptr)
+  -> sol::object {
+  if (field.kind == LuaFieldKind::Struct) {
+    auto nested = view;
+    nested.offset = view.offset + field.offset;
+    nested.layout = field.nested;
+    return sol::make_object(lua, nested);
+  }
+  return read_plain(lua, view.world, field.kind, ptr);
+}
+
+template <typename Value>
+auto assign_plain(LuaFieldKind kind, u8* ptr, const Value& value) -> bool {
+  auto assigned = false;
+  if (visit_number(kind, [&]<typename T>(std::type_identity<T>) {
+        if (value.get_type() == sol::type::number) {
+          *reinterpret_cast<T*>(ptr) = static_cast<T>(value.as<f64>());
+          assigned = true;
+        }
+      })) {
+    return assigned;
+  }
+
+  switch (kind) {
+    case LuaFieldKind::Bool  : return write_value<bool>(ptr, value);
+    case LuaFieldKind::Entity: {
+      if (value.is<flecs::entity>()) {
+        *reinterpret_cast<flecs::entity_t*>(ptr) = value.as<flecs::entity>().id();
+        return true;
+      } else if (value.get_type() == sol::type::number) {
+        *reinterpret_cast<flecs::entity_t*>(ptr) = static_cast<flecs::entity_t>(value.as<f64>());
+        return true;
+      }
+      return false;
+    }
+    case LuaFieldKind::CString: {
+      if (value.get_type() != sol::type::string) {
+        return false;
+      }
+      auto** str = reinterpret_cast<c8**>(ptr);
+      ecs_os_free(*str);
+      *str = ecs_os_strdup(value.as<std::string>().c_str());
+      return true;
+    }
+    case LuaFieldKind::String: {
+      if (value.get_type() != sol::type::string) {
+        return false;
+      }
+      *reinterpret_cast<std::string*>(ptr) = value.as<std::string_view>();
+      return true;
+    }
+    case LuaFieldKind::UUID : return write_value<UUID>(ptr, value);
+    case LuaFieldKind::Vec2 : return write_value<glm::vec2>(ptr, value);
+    case LuaFieldKind::IVec2: return write_value<glm::ivec2>(ptr, value);
+    case LuaFieldKind::Vec3 : return write_value<glm::vec3>(ptr, value);
+    case LuaFieldKind::Vec4 : return write_value<glm::vec4>(ptr, value);
+    case LuaFieldKind::Quat : return write_value<glm::quat>(ptr, value);
+    default                 : return false;
+  }
+}
+
+// Bytes a plain field takes, 0 for the ones that own memory and can't be staged.
+auto plain_size(LuaFieldKind kind) -> u32 {
+  auto size = 0_u32;
+  if (visit_number(kind, [&]<typename T>(std::type_identity<T>) { size = sizeof(T); })) {
+    return size;
+  }
+
+  switch (kind) {
+    case LuaFieldKind::Bool  : return sizeof(bool);
+    case LuaFieldKind::Entity: return sizeof(flecs::entity_t);
+    case LuaFieldKind::UUID  : return sizeof(UUID);
+    case LuaFieldKind::Vec2  : return sizeof(glm::vec2);
+    case LuaFieldKind::IVec2 : return sizeof(glm::ivec2);
+    case LuaFieldKind::Vec3  : return sizeof(glm::vec3);
+    case LuaFieldKind::Vec4  : return sizeof(glm::vec4);
+    case LuaFieldKind::Quat  : return sizeof(glm::quat);
+    default                  : return 0;
+  }
+}
+
+template <typename Value>
+auto stage_field(
+  LuaCommandBuffer& commands,
+  flecs::entity_t entity,
+  flecs::entity_t component,
+  u32 offset,
+  LuaFieldKind kind,
+  const Value& value
+) -> bool {
+  const auto size = plain_size(kind);
+  if (size == 0) {
+    OX_LOG_ERROR("Strings can't be written from a parallel script.");
+    return false;
+  }
+
+  alignas(16) auto buffer = std::array<u8, LuaCommandBuffer::MAX_VALUE_SIZE>{};
+  if (!assign_plain(kind, buffer.data(), value)) {
+    OX_LOG_ERROR("Can't assign a {}.", sol::type_name(value.lua_state(), value.get_type()));
+    return false;
+  }
+
+  commands.record(entity, component, offset, std::span(buffer.data(), size));
+  return true;
+}
+
+auto write_field(LuaComponentView& view, const LuaComponentField& field, const sol::stack_object& value) -> void {
+  if (!view.is_mutable) {
+    OX_LOG_ERROR("Can't write '{}', the component was read with get. Use get_mut to change it.", field.name);
+    return;
+  }
+
+  if (view.commands != nullptr) {
+    stage_field(*view.commands, view.entity, view.component, view.offset + field.offset, field.kind, value);
+    return;
+  }
+
+  auto* data = view.resolve();
+  if (data == nullptr) {
+    return;
+  }
+
+  if (!assign_plain(field.kind, data + field.offset, value)) {
+    OX_LOG_ERROR("Can't assign a {} to '{}'.", sol::type_name(value.lua_state(), value.get_type()), field.name);
+    return;
+  }
+
+  ecs_modified_id(view.world, view.entity, view.component);
+}
+
+auto check_live(const LuaColumnView& column) -> bool {
+  if (!column.is_live()) {
+    OX_LOG_ERROR("Column used after the iterator it came from moved on, take a new one from the iterator.");
+    return false;
+  }
+  return true;
+}
+} // namespace
+
+auto LuaComponentLayout::find(this const LuaComponentLayout& self, std::string_view name) -> const LuaComponentField* {
+  // Components have a handful of fields, a scan beats hashing the key.
+  for (const auto& field : self.fields) {
+    if (field.name == name) {
+      return &field;
+    }
+  }
+  return nullptr;
+}
+
+auto LuaComponentLayouts::get(this LuaComponentLayouts& self, ecs_world_t* world, flecs::entity_t type)
+  -> const LuaComponentLayout* {
+  ZoneScoped;
+
+  const auto* real_world = ecs_get_world(world);
+  auto& world_layouts = self.world_layouts(real_world);
+  if (auto it = world_layouts.find(type); it != world_layouts.end()) {
+    return it->second.get();
+  }
+
+  const auto* serializer = ecs_get(world, type, EcsTypeSerializer);
+  if (serializer == nullptr) {
+    // No meta yet, nothing to cache: it may still get members.
+    static const auto no_fields = LuaComponentLayout{};
+    return &no_fields;
+  }
+
+  auto layout = std::make_unique<LuaComponentLayout>();
+  const auto* ops = ecs_vec_first_t(&serializer->ops, flecs::meta::op_t);
+  self.collect_fields(world, ops, ecs_vec_count(&serializer->ops), *layout);
+
+  // Nested types may have been added while collecting, look the world up again.
+  auto& layouts = self.worlds[real_world];
+  return layouts.emplace(type, std::move(layout)).first->second.get();
+}
+
+auto LuaComponentLayouts::track(this LuaComponentLayouts& self, const ecs_world_t* world) -> void {
+  self.world_layouts(ecs_get_world(world));
+}
+
+auto LuaComponentLayouts::world_layouts(this LuaComponentLayouts& self, const ecs_world_t* real_world)
+  -> WorldLayouts& {
+  auto world_it = self.worlds.find(real_world);
+  if (world_it == self.worlds.end()) {
+    // Dropped along with the world. The layouts can go first, the world only holds on to a weak handle.
+    auto* handle = new std::weak_ptr<LuaComponentLayouts>(self.weak_from_this());
+    ecs_atfini(
+      const_cast<ecs_world_t*>(real_world),
+      [](ecs_world_t* fini_world, void* ctx) {
+        auto* layouts_handle = static_cast<std::weak_ptr<LuaComponentLayouts>*>(ctx);
+        if (auto layouts = layouts_handle->lock()) {
+          layouts->forget(fini_world);
+        }
+        delete layouts_handle;
+      },
+      handle
+    );
+    world_it = self.worlds.emplace(real_world, WorldLayouts{}).first;
+  }
+  return world_it->second;
+}
+
+auto LuaComponentLayouts::forget(this LuaComponentLayouts& self, const ecs_world_t* world) -> void {
+  self.worlds.erase(world);
+}
+
+auto LuaComponentLayouts::view(
+  this LuaComponentLayouts& self, flecs::entity entity, flecs::entity_t component, bool is_mutable
+) -> LuaComponentView {
+  return {
+    .world = entity.world().c_ptr(),
+    .entity = entity.id(),
+    .component = component,
+    .layout = self.get(entity.world().c_ptr(), component),
+    .is_mutable = is_mutable,
+    .commands = self.commands,
+  };
+}
+
+auto LuaComponentLayouts::column(
+  this LuaComponentLayouts& self, ecs_iter_t* it, flecs::entity_t component, std::string_view field_name
+) -> option<LuaColumnView> {
+  for (auto index = 0_i8; index < it->field_count; index++) {
+    if (ecs_field_id(it, index) != component || !ecs_field_is_set(it, index)) {
+      continue;
+    }
+
+    const auto* field = self.get(it->world, component)->find(field_name);
+    if (field == nullptr || field->kind == LuaFieldKind::Struct) {
+      return nullopt;
+    }
+
+    const auto size = ecs_field_size(it, index);
+    const auto is_self = ecs_field_is_self(it, index);
+    return LuaColumnView{
+      .world = it->world,
+      .data = static_cast<u8*>(ecs_field_w_size(it, size, index)) + field->offset,
+      .stride = is_self ? static_cast<u32>(size) : 0,
+      .count = static_cast<u32>(it->count),
+      .kind = field->kind,
+      .is_mutable = is_self && !ecs_field_is_readonly(it, index),
+      .commands = self.commands,
+      .entities = it->entities,
+      .component = component,
+      .offset = field->offset,
+      .layouts = &self,
+      .generation = self.column_generation,
+    };
+  }
+
+  return nullopt;
+}
+
+auto LuaComponentLayouts::collect_fields(
+  this LuaComponentLayouts& self,
+  ecs_world_t* world,
+  const flecs::meta::op_t* ops,
+  i32 op_count,
+  LuaComponentLayout& layout
+) -> void {
+  auto cpp_world = flecs::world(world);
+  for (auto i = 0_i32; i < op_count; i++) {
+    const auto& op = ops[i];
+    auto field = LuaComponentField{
+      .name = op.name ? op.name : "",
+      .offset = static_cast<u32>(op.offset),
+    };
+
+    auto supported = true;
+    switch (op.kind) {
+      case EcsOpBool : field.kind = LuaFieldKind::Bool; break;
+      case EcsOpChar : field.kind = LuaFieldKind::Char; break;
+      case EcsOpU8   :
+      case EcsOpByte : field.kind = LuaFieldKind::U8; break;
+      case EcsOpU16  : field.kind = LuaFieldKind::U16; break;
+      case EcsOpU32  : field.kind = LuaFieldKind::U32; break;
+      case EcsOpUPtr :
+      case EcsOpU64  : field.kind = LuaFieldKind::U64; break;
+      case EcsOpI8   : field.kind = LuaFieldKind::I8; break;
+      case EcsOpI16  : field.kind = LuaFieldKind::I16; break;
+      case EcsOpI32  : field.kind = LuaFieldKind::I32; break;
+      case EcsOpIPtr :
+      case EcsOpI64  : field.kind = LuaFieldKind::I64; break;
+      case EcsOpF32  : field.kind = LuaFieldKind::F32; break;
+      case EcsOpF64  : field.kind = LuaFieldKind::F64; break;
+      case EcsOpEnum : field.kind = integer_kind(op.underlying_kind); break;
+      case EcsOpEntity:
+      case EcsOpId    : field.kind = LuaFieldKind::Entity; break;
+      case EcsOpString: field.kind = LuaFieldKind::CString; break;
+      case EcsOpOpaqueValue: {
+        if (op.type == cpp_world.entity<std::string>()) {
+          field.kind = LuaFieldKind::String;
+        } else if (op.type == cpp_world.entity<UUID>()) {
+          field.kind = LuaFieldKind::UUID;
+        } else {
+          supported = false;
+        }
+      } break;
+      case EcsOpPushStruct:
+      case EcsOpForward   : {
+        // The unnamed struct around a component's own members.
+        if (op.kind == EcsOpPushStruct && field.name.empty()) {
+          self.collect_fields(world, ops + i + 1, op.op_count - 1, layout);
+          supported = false;
+          break;
+        }
+        field.kind = value_kind(cpp_world, ecs_get_type_info(world, op.type));
+        if (field.kind == LuaFieldKind::Struct) {
+          field.nested = self.get(world, op.type);
+        }
+      } break;
+      default: supported = false; break;
+    }
+
+    if (supported && !field.name.empty()) {
+      layout.fields.push_back(std::move(field));
+    }
+
+    i += op.op_count - 1;
+  }
+}
+
+auto LuaComponentView::resolve(this const LuaComponentView& self) -> u8* {
+  if (!ecs_is_alive(self.world, self.entity)) {
+    return nullptr;
+  }
+
+  // Looked up on every access: columns reallocate as entities join the table, so no pointer into the
+  // storage outlives the call that fetched it.
+  auto* data = static_cast<u8*>(ecs_get_mut_id(self.world, self.entity, self.component));
+  return data != nullptr ? data + self.offset : nullptr;
+}
+
+auto LuaCommandBuffer::record(
+  this LuaCommandBuffer& self,
+  flecs::entity_t entity,
+  flecs::entity_t component,
+  u32 offset,
+  std::span<const u8> value
+) -> void {
+  OX_CHECK_LE(value.size(), MAX_VALUE_SIZE);
+
+  auto& write = self.writes.emplace_back(FieldWrite{
+    .entity = entity,
+    .component = component,
+    .offset = offset,
+    .size = static_cast<u32>(value.size()),
+  });
+  std::memcpy(write.value.data(), value.data(), value.size());
+}
+
+auto LuaCommandBuffer::apply(this LuaCommandBuffer& self, ecs_world_t* world) -> void {
+  ZoneScoped;
+
+  for (const auto& write : self.writes) {
+    if (!ecs_is_alive(world, write.entity)) {
+      continue;
+    }
+    auto* data = static_cast<u8*>(ecs_get_mut_id(world, write.entity, write.component));
+    if (data == nullptr) {
+      continue;
+    }
+    std::memcpy(data + write.offset, write.value.data(), write.size);
+    if (self.seen.emplace(write.entity, write.component).second) {
+      self.modified.emplace_back(write.entity, write.component);
+    }
+  }
+
+  // Observers run after every write is in, so they see the whole frame's worth of them.
+  for (const auto& [entity, component] : self.modified) {
+    // An observer may have removed it in the meantime.
+    if (ecs_is_alive(world, entity) && ecs_has_id(world, entity, component)) {
+      ecs_modified_id(world, entity, component);
+    }
+  }
+
+  self.writes.clear();
+  self.modified.clear();
+  self.seen.clear();
+}
+
+auto bind_component_views(sol::state* state) -> void {
+  ZoneScoped;
+
+  state->new_usertype<LuaComponentView>(
+    "LuaComponentView",
+    sol::no_constructor,
+    sol::meta_function::index,
+    [](sol::this_state lua, LuaComponentView& view, std::string_view key) -> sol::object {
+      if (const auto* field = view.layout->find(key)) {
+        const auto* data = view.resolve();
+        return data != nullptr ? read_field(lua, view, *field, data + field->offset)
+                               : sol::make_object(lua, sol::lua_nil);
+      }
+
+      if (key == "component_id") {
+        return sol::make_object(lua, view.component);
+      }
+
+      // `view:set_position(value)`, from when components were handed out as tables of copies.
+      if (key.starts_with("set_")) {
+        if (const auto* field = view.layout->find(key.substr(4))) {
+          return sol::make_object(
+            lua,
+            sol::as_function([field](LuaComponentView& self, const sol::stack_object& value) {
+              write_field(self, *field, value);
+            })
+          );
+        }
+      }
+
+      return sol::make_object(lua, sol::lua_nil);
+    },
+    sol::meta_function::new_index,
+    [](LuaComponentView& view, std::string_view key, const sol::stack_object& value) {
+      if (const auto* field = view.layout->find(key)) {
+        write_field(view, *field, value);
+      } else {
+        OX_LOG_ERROR("Component has no field '{}'.", key);
+      }
+    }
+  );
+
+  // Indexed from 1 like any Lua array. `read` and `write` move the whole column at once, into and out
+  // of a table the script can keep reusing.
+  state->new_usertype<LuaColumnView>(
+    "LuaColumnView",
+    sol::no_constructor,
+    "count",
+    sol::readonly(&LuaColumnView::count),
+    "read",
+    [](sol::this_state lua, const LuaColumnView& column, sol::optional<sol::table> into) -> sol::object {
+      if (!check_live(column)) {
+        return sol::make_object(lua, sol::lua_nil);
+      }
+      auto values = into ? *into : sol::state_view(lua).create_table(static_cast<i32>(column.count));
+      for (u32 i = 0; i < column.count; i++) {
+        values.raw_set(i + 1, read_plain(lua, column.world, column.kind, column.at(i)));
+      }
+      // Whatever a longer table held before is no longer part of the column.
+      for (auto i = column.count + 1; values.raw_get<sol::object>(i).valid(); i++) {
+        values.raw_set(i, sol::lua_nil);
+      }
+      return values;
+    },
+    "write",
+    [](LuaColumnView& column, const sol::table& values) {
+      if (!check_live(column)) {
+        return;
+      }
+      if (!column.is_mutable) {
+        OX_LOG_ERROR("Can't write a column of a read only or shared term.");
+        return;
+      }
+      for (u32 i = 0; i < column.count; i++) {
+        const auto value = values.raw_get<sol::object>(i + 1);
+        if (value.valid() && column.commands != nullptr) {
+          if (!stage_field(*column.commands, column.entities[i], column.component, column.offset, column.kind, value)) {
+            return;
+          }
+        } else if (value.valid() && !assign_plain(column.kind, column.at(i), value)) {
+          OX_LOG_ERROR("Can't assign a {} to a column element.", sol::type_name(value.lua_state(), value.get_type()));
+          return;
+        }
+      }
+    },
+    sol::meta_function::length,
+    [](const LuaColumnView& column) { return column.is_live() ? column.count : 0; },
+    sol::meta_function::index,
+    [](sol::this_state lua, const LuaColumnView& column, i64 index) -> sol::object {
+      if (!check_live(column) || index < 1 || index > column.count) {
+        return sol::make_object(lua, sol::lua_nil);
+      }
+      return read_plain(lua, column.world, column.kind, column.at(static_cast<u32>(index - 1)));
+    },
+    sol::meta_function::new_index,
+    [](LuaColumnView& column, i64 index, const sol::stack_object& value) {
+      if (!check_live(column)) {
+        return;
+      }
+      if (!column.is_mutable || index < 1 || index > column.count) {
+        OX_LOG_ERROR("Can't write element {} of a column of {}.", index, column.count);
+        return;
+      }
+      if (column.commands != nullptr) {
+        const auto row = static_cast<u32>(index - 1);
+        stage_field(*column.commands, column.entities[row], column.component, column.offset, column.kind, value);
+      } else if (!assign_plain(column.kind, column.at(static_cast<u32>(index - 1)), value)) {
+        OX_LOG_ERROR("Can't assign a {} to a column element.", sol::type_name(value.lua_state(), value.get_type()));
+      }
+    }
+  );
+}
+} // namespace ox
@@ -0,0 +1,232 @@
+#include "Scripting/LuaFFIMath.hpp"
+
+#ifdef OX_LUAJIT
+  #include <cstddef>
+  #include <cstring>
+  #include <sol/state.hpp>
+
+  #include "Core/Types.hpp"
+  #include "Utils/Log.hpp"
+
+namespace ox::ffi_math {
+// The FFI structs below are copied to and from these bit for bit.
+static_assert(sizeof(glm::vec3) == 3 * sizeof(f32) && offsetof(glm::vec3, z) == 2 * sizeof(f32));
+static_assert(sizeof(glm::quat) == 4 * sizeof(f32) && offsetof(glm::quat, x) == 0 && offsetof(glm::quat, w) == 12);
+static_assert(sizeof(glm::mat4) == 16 * sizeof(f32));
+
+namespace {
+// Not exposed by LuaJIT's headers.
+constexpr int LUA_TYPE_CDATA = 10;
+
+// Registry references to `ffi.istype` and the three ctypes, per state.
+struct FFIMathRefs {
+  int is_type = LUA_NOREF;
+  int types[3] = {LUA_NOREF, LUA_NOREF, LUA_NOREF};
+};
+
+c8 REFS_KEY = 0;
+
+auto refs_of(lua_State* L) -> const FFIMathRefs* {
+  lua_pushlightuserdata(L, &REFS_KEY);
+  lua_rawget(L, LUA_REGISTRYINDEX);
+  const auto* refs = static_cast<const FFIMathRefs*>(lua_touserdata(L, -1));
+  lua_pop(L, 1);
+  return refs;
+}
+
+// Everything but the conversions stays in Lua, where the JIT can sink the temporaries of an
+// expression like `a + b * 2` instead of allocating each one.
+constexpr auto SOURCE = R"lua(
+local ffi = require("ffi")
+ffi.cdef [[
+typedef struct { float x, y, z; } ox_vec3;
+typedef struct { float x, y, z, w; } ox_quat;
+typedef struct { float m[16]; } ox_mat4;
+]]
+
+local sqrt = math.sqrt
+local istype = ffi.istype
+local vec3_t, quat_t, mat4_t
+
+local function operands(a, b)
+  if type(a) == "number" then
+    return a, a, a, b.x, b.y, b.z
+  elseif type(b) == "number" then
+    return a.x, a.y, a.z, b, b, b
+  end
+  return a.x, a.y, a.z, b.x, b.y, b.z
+end
+
+local vec3_methods = {
+  dot = function(a, b) return a.x * b.x + a.y * b.y + a.z * b.z end,
+  cross = function(a, b) return vec3_t(a.y * b.z - a.z * b.y, a.z * b.x - a.x * b.z, a.x * b.y - a.y * b.x) end,
+  length = function(v) return sqrt(v.x * v.x + v.y * v.y + v.z * v.z) end,
+  normalize = function(v)
+    local inv = 1 / sqrt(v.x * v.x + v.y * v.y + v.z * v.z)
+    return vec3_t(v.x * inv, v.y * inv, v.z * inv)
+  end,
+}
+
+vec3_t = ffi.metatype("ox_vec3", {
+  __add = function(a, b) local ax, ay, az, bx, by, bz = operands(a, b) return vec3_t(ax + bx, ay + by, az + bz) end,
+  __sub = function(a, b) local ax, ay, az, bx, by, bz = operands(a, b) return vec3_t(ax - bx, ay - by, az - bz) end,
+  __mul = function(a, b) local ax, ay, az, bx, by, bz = operands(a, b) return vec3_t(ax * bx, ay * by, az * bz) end,
+  __div = function(a, b) local ax, ay, az, bx, by, bz = operands(a, b) return vec3_t(ax / bx, ay / by, az / bz) end,
+  __unm = function(v) return vec3_t(-v.x, -v.y, -v.z) end,
+  __eq = function(a, b) return istype(vec3_t, a) and istype(vec3_t, b) and a.x == b.x and a.y == b.y and a.z == b.z end,
+  __tostring = function(v) return string.format("vec3(%g, %g, %g)", v.x, v.y, v.z) end,
+  __index = vec3_methods,
+})
+
+quat_t = ffi.metatype("ox_quat", {
+  __mul = function(a, b)
+    if istype(vec3_t, b) then
+      local tx, ty, tz = 2 * (a.y * b.z - a.z * b.y), 2 * (a.z * b.x - a.x * b.z), 2 * (a.x * b.y - a.y * b.x)
+      return vec3_t(
+        b.x + a.w * tx + a.y * tz - a.z * ty,
+        b.y + a.w * ty + a.z * tx - a.x * tz,
+        b.z + a.w * tz + a.x * ty - a.y * tx
+      )
+    end
+    return quat_t(
+      a.w * b.x + a.x * b.w + a.y * b.z - a.z * b.y,
+      a.w * b.y + a.y * b.w + a.z * b.x - a.x * b.z,
+      a.w * b.z + a.z * b.w + a.x * b.y - a.y * b.x,
+      a.w * b.w - a.x * b.x - a.y * b.y - a.z * b.z
+    )
+  end,
+  __eq = function(a, b)
+    return istype(quat_t, a) and istype(quat_t, b) and a.x == b.x and a.y == b.y and a.z == b.z and a.w == b.w
+  end,
+  __tostring = function(q) return string.format("quat(%g, %g, %g, %g)", q.w, q.x, q.y, q.z) end,
+})
+
+local function mat4_add(a, b, sign)
+  local m = mat4_t()
+  for i = 0, 15 do m.m[i] = a.m[i] + sign * b.m[i] end
+  return m
+end
+
+mat4_t = ffi.metatype("ox_mat4", {
+  __mul = function(a, b)
+    local m = mat4_t()
+    for c = 0, 3 do
+      for r = 0, 3 do
+        local sum = 0
+        for k = 0, 3 do sum = sum + a.m[k * 4 + r] * b.m[c * 4 + k] end
+        m.m[c * 4 + r] = sum
+      end
+    end
+    return m
+  end,
+  __add = function(a, b) return mat4_add(a, b, 1) end,
+  __sub = function(a, b) return mat4_add(a, b, -1) end,
+})
+
+-- Same constructors the usertypes had, glm's argument order included.
+vec3 = {
+  new = function(x, y, z)
+    if y == nil then return vec3_t(x or 0, x or 0, x or 0) end
+    return vec3_t(x, y, z)
+  end,
+}
+quat = {
+  new = function(w, x, y, z)
+    if w == nil then return quat_t(0, 0, 0, 1) end
+    if type(w) ~= "number" then return quat_t(w.x, w.y, w.z, w.w) end
+    return quat_t(x, y, z, w)
+  end,
+}
+mat4 = {
+  new = function(d)
+    d = d or 1
+    local m = mat4_t()
+    m.m[0], m.m[5], m.m[10], m.m[15] = d, d, d, d
+    return m
+  end,
+}
+
+-- The hottest of the glm functions, kept out of C++ for vec3s.
+for _, name in ipairs({ "length", "normalize" }) do
+  local bound, method = glm[name], vec3_methods[name]
+  glm[name] = function(v)
+    if istype(vec3_t, v) then return method(v) end
+    return bound(v)
+  end
+end
+for _, name in ipairs({ "dot", "cross" }) do
+  local bound, method = glm[name], vec3_methods[name]
+  glm[name] = function(a, b)
+    if istype(vec3_t, a) and istype(vec3_t, b) then return method(a, b) end
+    return bound(a, b)
+  end
+end
+local bound_distance = glm.distance
+glm.distance = function(a, b)
+  if istype(vec3_t, a) and istype(vec3_t, b) then return vec3_methods.length(a - b) end
+  return bound_distance(a, b)
+end
+
+return istype, vec3_t, quat_t, mat4_t
+)lua";
+} // namespace
+
+auto is(lua_State* L, int index, Kind kind) -> bool {
+  if (lua_type(L, index) != LUA_TYPE_CDATA) {
+    return false;
+  }
+  const auto* refs = refs_of(L);
+  if (!refs) {
+    return false;
+  }
+  if (index < 0 && index > LUA_REGISTRYINDEX) {
+    index = lua_gettop(L) + index + 1;
+  }
+  lua_rawgeti(L, LUA_REGISTRYINDEX, refs->is_type);
+  lua_rawgeti(L, LUA_REGISTRYINDEX, refs->types[static_cast<int>(kind)]);
+  lua_pushvalue(L, index);
+  lua_call(L, 2, 1);
+  const auto result = lua_toboolean(L, -1) != 0;
+  lua_pop(L, 1);
+  return result;
+}
+
+auto read(lua_State* L, int index, void* value, size_t size) -> void {
+  std::memcpy(value, lua_topointer(L, index), size);
+}
+
+auto push(lua_State* L, Kind kind, const void* value, size_t size) -> int {
+  const auto* refs = refs_of(L);
+  OX_CHECK_NULL(refs, "FFI math types are pushed before MathBinding ran.");
+
+  // Calling the ctype gives a zeroed struct whose storage is then filled in place.
+  lua_rawgeti(L, LUA_REGISTRYINDEX, refs->types[static_cast<int>(kind)]);
+  lua_call(L, 0, 1);
+  std::memcpy(const_cast<void*>(lua_topointer(L, -1)), value, size);
+  return 1;
+}
+
+auto bind(sol::state* state) -> void {
+  ZoneScoped;
+
+  auto result = state->safe_script(SOURCE, sol::script_pass_on_error, "=ffi_math");
+  if (!result.valid()) {
+    OX_LOG_ERROR("Failed to define the FFI math types: {}", result.get<sol::error>().what());
+    return;
+  }
+
+  auto* L = state->lua_state();
+  auto refs = FFIMathRefs{};
+  result.get<sol::object>(0).push(L);
+  refs.is_type = luaL_ref(L, LUA_REGISTRYINDEX);
+  for (int i = 0; i < 3; i++) {
+    result.get<sol::object>(i + 1).push(L);
+    refs.types[i] = luaL_ref(L, LUA_REGISTRYINDEX);
+  }
+
+  lua_pushlightuserdata(L, &REFS_KEY);
+  std::memcpy(lua_newuserdata(L, sizeof(FFIMathRefs)), &refs, sizeof(FFIMathRefs));
+  lua_rawset(L, LUA_REGISTRYINDEX);
+}
+} // namespace ox::ffi_math
+#endif
@@ -5,472 +5,24 @@
 #include <sol/state.hpp>
 
 #include "Core/Types.hpp"
-#include "Memory/Stack.hpp"
-#include "Scene/EntitySerializer.hpp"
 #include "Scene/Scene.hpp"
 #include "Utils/Log.hpp"
 
 struct ecs_world_t {};
 
 namespace ox {
-struct LuaEntitySerializer : IEntitySerializer {
-  sol::state* state;
-  sol::table table;
-  bool is_mutable;
-
-  LuaEntitySerializer(flecs::world& world_, sol::state* state_, sol::table table_, bool is_mutable_)
-      : IEntitySerializer(world_),
-        state(state_),
-        table(std::move(table_)),
-        is_mutable(is_mutable_) {}
-
-  auto on_primitive(std::string_view name, Primitive primitive) -> void override {
-    ZoneScoped;
-
-    memory::ScopedStack stack;
-    auto set_name = stack.format("set_{}", name);
-
-    std::visit(
-      ox::match{
-        [](const auto&) {},
-        [&](bool* v) {
-          table[name] = *v;
-          if (is_mutable) {
-            sol::table tbl = table;
-            std::string key(name);
-            table.set_function(set_name, [v, tbl, key](const sol::table& self, bool value) mutable {
-              *v = value;
-              tbl[key] = *v;
-            });
-          }
-        },
-        [&](c8* v) {
-          table[name] = *v;
-          if (is_mutable) {
-            sol::table tbl = table;
-            std::string key(name);
-            table.set_function(set_name, [v, tbl, key](const sol::table& self, c8 value) mutable {
-              *v = value;
-              tbl[key] = *v;
-            });
-          }
-        },
-        [&](i8* v) {
-          table[name] = *v;
-          if (is_mutable) {
-            sol::table tbl = table;
-            std::string key(name);
-            table.set_function(set_name, [v, tbl, key](const sol::table& self, i8 value) mutable {
-              *v = value;
-              tbl[key] = *v;
-            });
-          }
-        },
-        [&](u8* v) {
-          table[name] = *v;
-          if (is_mutable) {
-            sol::table tbl = table;
-            std::string key(name);
-            table.set_function(set_name, [v, tbl, key](const sol::table& self, u8 value) mutable {
-              *v = value;
-              tbl[key] = *v;
-            });
-          }
-        },
-        [&](i16* v) {
-          table[name] = *v;
-          if (is_mutable) {
-            sol::table tbl = table;
-            std::string key(name);
-            table.set_function(set_name, [v, tbl, key](const sol::table& self, i16 value) mutable {
-              *v = value;
-              tbl[key] = *v;
-            });
-          }
-        },
-        [&](u16* v) {
-          table[name] = *v;
-          if (is_mutable) {
-            sol::table tbl = table;
-            std::string key(name);
-            table.set_function(set_name, [v, tbl, key](const sol::table& self, u16 value) mutable {
-              *v = value;
-              tbl[key] = *v;
-            });
-          }
-        },
-        [&](i32* v) {
-          table[name] = *v;
-          if (is_mutable) {
-            sol::table tbl = table;
-            std::string key(name);
-            table.set_function(set_name, [v, tbl, key](const sol::table& self, i32 value) mutable {
-              *v = value;
-              tbl[key] = *v;
-            });
-          }
-        },
-        [&](u32* v) {
-          table[name] = *v;
-          if (is_mutable) {
-            sol::table tbl = table;
-            std::string key(name);
-            table.set_function(set_name, [v, tbl, key](const sol::table& self, u32 value) mutable {
-              *v = value;
-              tbl[key] = *v;
-            });
-          }
-        },
-        [&](i64* v) {
-          table[name] = *v;
-          if (is_mutable) {
-            sol::table tbl = table;
-            std::string key(name);
-            table.set_function(set_name, [v, tbl, key](const sol::table& self, i64 value) mutable {
-              *v = value;
-              tbl[key] = *v;
-            });
-          }
-        },
-        [&](u64* v) {
-          table[name] = *v;
-          if (is_mutable) {
-            sol::table tbl = table;
-            std::string key(name);
-            table.set_function(set_name, [v, tbl, key](const sol::table& self, u64 value) mutable {
-              *v = value;
-              tbl[key] = *v;
-            });
-          }
-        },
-        [&](f32* v) {
-          table[name] = *v;
-          if (is_mutable) {
-            sol::table tbl = table;
-            std::string key(name);
-            table.set_function(set_name, [v, tbl, key](const sol::table& self, f32 value) mutable {
-              *v = value;
-              tbl[key] = *v;
-            });
-          }
-        },
-        [&](f64* v) {
-          table[name] = *v;
-          if (is_mutable) {
-            sol::table tbl = table;
-            std::string key(name);
-            table.set_function(set_name, [v, tbl, key](const sol::table& self, f64 value) mutable {
-              *v = value;
-              tbl[key] = *v;
-            });
-          }
-        },
-      },
-      primitive
-    );
-  }
-
-  auto on_struct(std::string_view name, flecs::meta::op_t* ops, i32 op_count, void* base) -> void override {
-    ZoneScoped;
-
-    if (!name.empty()) {
-      memory::ScopedStack stack;
-      auto set_name = stack.format("set_{}", name);
-
-      if (ops->type_info == world.type_info<glm::vec2>()) {
-        auto vec = static_cast<glm::vec2*>(base);
-        table[name] = *vec;
-        if (is_mutable) {
-          sol::table tbl = table;
-          std::string key(name);
-          table.set_function(set_name, [vec, tbl, key](const sol::table& self, glm::vec2 value) mutable {
-            *vec = value;
-            tbl[key] = *vec;
-          });
-        }
-      } else if (ops->type_info == world.type_info<glm::vec3>()) {
-        auto vec = static_cast<glm::vec3*>(base);
-        table[name] = *vec;
-        if (is_mutable) {
-          sol::table tbl = table;
-          std::string key(name);
-          table.set_function(set_name, [vec, tbl, key](const sol::table& self, glm::vec3 value) mutable {
-            *vec = value;
-            tbl[key] = *vec;
-          });
-        }
-      } else if (ops->type_info == world.type_info<glm::vec4>()) {
-        auto vec = static_cast<glm::vec4*>(base);
-        table[name] = *vec;
-        if (is_mutable) {
-          sol::table tbl = table;
-          std::string key(name);
-          table.set_function(set_name, [vec, tbl, key](const sol::table& self, glm::vec4 value) mutable {
-            *vec = value;
-            tbl[key] = *vec;
-          });
-        }
-      } else if (ops->type_info == world.type_info<glm::quat>()) {
-        auto vec = static_cast<glm::quat*>(base);
-        table[name] = *vec;
-        if (is_mutable) {
-          sol::table tbl = table;
-          std::string key(name);
-          table.set_function(set_name, [vec, tbl, key](const sol::table& self, glm::quat value) mutable {
-            *vec = value;
-            tbl[key] = *vec;
-          });
-        }
-      } else {
-        auto nested_table = state->create_table();
-        auto nested_serializer = LuaEntitySerializer(world, state, nested_table, is_mutable);
-        nested_serializer.serialize_ops(ops + 1, op_count - 1, base);
-        table[name] = nested_table;
-      }
-    } else {
-      serialize_ops(ops + 1, op_count - 1, base);
-    }
-  }
-
-  auto on_string(std::string_view name, const c8** str) -> void override {
-    ZoneScoped;
-
-    if (str && *str) {
-      table[name] = *str;
-    }
-  }
-
-  auto on_entity(std::string_view name, flecs::entity* entity) -> void override {
-    ZoneScoped;
-
-    if (entity && entity->is_valid()) {
-      table[name] = entity->name().c_str();
-      if (is_mutable) {
-        memory::ScopedStack stack;
-        auto set_name = stack.format("set_{}", name);
-        table.set_function(set_name, [entity](const sol::table& self, flecs::entity value) { *entity = value; });
-      }
-    }
-  }
-
-  auto on_enum(std::string_view name, ecs_meta_op_kind_t underlying_kind, flecs::entity_t type, void* ptr)
-    -> void override {
-    ZoneScoped;
-
-    auto get_value = [&]() -> i64 {
-      switch (underlying_kind) {
-        case EcsOpU8 : return static_cast<i64>(*static_cast<u8*>(ptr));
-        case EcsOpU16: return static_cast<i64>(*static_cast<u16*>(ptr));
-        case EcsOpU32: return static_cast<i64>(*static_cast<u32*>(ptr));
-        case EcsOpU64: return static_cast<i64>(*static_cast<u64*>(ptr));
-        case EcsOpI8 : return static_cast<i64>(*static_cast<i8*>(ptr));
-        case EcsOpI16: return static_cast<i64>(*static_cast<i16*>(ptr));
-        case EcsOpI32: return static_cast<i64>(*static_cast<i32*>(ptr));
-        case EcsOpI64: return *static_cast<i64*>(ptr);
-        default      : return 0;
-      }
-    };
-
-    table[name] = get_value();
-    if (is_mutable) {
-      memory::ScopedStack stack;
-      auto set_name = stack.format("set_{}", name);
-      sol::table tbl = table;
-      std::string key(name);
-      table.set_function(set_name, [underlying_kind, ptr, tbl, key](const sol::table& self, i64 value) mutable {
-        switch (underlying_kind) {
-          case EcsOpU8 : *static_cast<u8*>(ptr) = static_cast<u8>(value); break;
-          case EcsOpU16: *static_cast<u16*>(ptr) = static_cast<u16>(value); break;
-          case EcsOpU32: *static_cast<u32*>(ptr) = static_cast<u32>(value); break;
-          case EcsOpU64: *static_cast<u64*>(ptr) = static_cast<u64>(value); break;
-          case EcsOpI8 : *static_cast<i8*>(ptr) = static_cast<i8>(value); break;
-          case EcsOpI16: *static_cast<i16*>(ptr) = static_cast<i16>(value); break;
-          case EcsOpI32: *static_cast<i32*>(ptr) = static_cast<i32>(value); break;
-          case EcsOpI64: *static_cast<i64*>(ptr) = value; break;
-          default      : break;
-        }
-        tbl[key] = value;
-      });
-    }
-  }
-
-  auto on_component(std::string_view name, flecs::id_t* component) -> void override {
-    ZoneScoped;
-
-    if (component && *component) {
-      flecs::entity comp_entity(world, *component);
-      if (comp_entity.is_valid()) {
-        table[name] = comp_entity.name().c_str();
-        if (is_mutable) {
-          memory::ScopedStack stack;
-          auto set_name = stack.format("set_{}", name);
-          table.set_function(set_name, [component](const sol::table& self, flecs::entity value) {
-            *component = value;
-          });
-        }
-      }
-    }
-  }
-
-  auto on_opaque_value(
-    std::string_view name, flecs::entity_t field_type, void* field_ptr, flecs::entity_t opaque_type, const void* value
-  ) -> void override {
-    ZoneScoped;
-    memory::ScopedStack stack;
-    auto set_name = stack.format("set_{}", name);
-
-    sol::table tbl = table;
-    std::string key(name);
-
-    if (field_type == world.entity<UUID>()) {
-      auto* uuid = static_cast<UUID*>(field_ptr);
-      table[name] = *uuid;
-      if (is_mutable) {
-        table.set_function(set_name, [uuid, tbl, key](const sol::table& self, UUID v) mutable {
-          *uuid = v;
-          tbl[key] = *uuid;
-        });
-      }
-      return;
-    }
-
-    if (opaque_type == flecs::Bool) {
-      auto* v = static_cast<bool*>(field_ptr);
-      table[name] = *v;
-      if (is_mutable) {
-        table.set_function(set_name, [v, tbl, key](const sol::table&, bool val) mutable {
-          *v = val;
-          tbl[key] = *v;
-        });
-      }
-    } else if (opaque_type == flecs::Char) {
-      auto* v = static_cast<c8*>(field_ptr);
-      table[name] = *v;
-      if (is_mutable) {
-        table.set_function(set_name, [v, tbl, key](const sol::table&, c8 val) mutable {
-          *v = val;
-          tbl[key] = *v;
-        });
-      }
-    } else if (opaque_type == flecs::U8) {
-      auto* v = static_cast<u8*>(field_ptr);
-      table[name] = *v;
-      if (is_mutable) {
-        table.set_function(set_name, [v, tbl, key](const sol::table&, u8 val) mutable {
-          *v = val;
-          tbl[key] = *v;
-        });
-      }
-    } else if (opaque_type == flecs::U16) {
-      auto* v = static_cast<u16*>(field_ptr);
-      table[name] = *v;
-      if (is_mutable) {
-        table.set_function(set_name, [v, tbl, key](const sol::table&, u16 val) mutable {
-          *v = val;
-          tbl[key] = *v;
-        });
-      }
-    } else if (opaque_type == flecs::U32) {
-      auto* v = static_cast<u32*>(field_ptr);
-      table[name] = *v;
-      if (is_mutable) {
-        table.set_function(set_name, [v, tbl, key](const sol::table&, u32 val) mutable {
-          *v = val;
-          tbl[key] = *v;
-        });
-      }
-    } else if (opaque_type == flecs::U64 || opaque_type == flecs::Uptr) {
-      auto* v = static_cast<u64*>(field_ptr);
-      table[name] = *v;
-      if (is_mutable) {
-        table.set_function(set_name, [v, tbl, key](const sol::table&, u64 val) mutable {
-          *v = val;
-          tbl[key] = *v;
-        });
-      }
-    } else if (opaque_type == flecs::I8) {
-      auto* v = static_cast<i8*>(field_ptr);
-      table[name] = *v;
-      if (is_mutable) {
-        table.set_function(set_name, [v, tbl, key](const sol::table&, i8 val) mutable {
-          *v = val;
-          tbl[key] = *v;
-        });
-      }
-    } else if (opaque_type == flecs::I16) {
-      auto* v = static_cast<i16*>(field_ptr);
-      table[name] = *v;
-      if (is_mutable) {
-        table.set_function(set_name, [v, tbl, key](const sol::table&, i16 val) mutable {
-          *v = val;
-          tbl[key] = *v;
-        });
-      }
-    } else if (opaque_type == flecs::I32) {
-      auto* v = static_cast<i32*>(field_ptr);
-      table[name] = *v;
-      if (is_mutable) {
-        table.set_function(set_name, [v, tbl, key](const sol::table&, i32 val) mutable {
-          *v = val;
-          tbl[key] = *v;
-        });
-      }
-    } else if (opaque_type == flecs::I64 || opaque_type == flecs::Iptr) {
-      auto* v = static_cast<i64*>(field_ptr);
-      table[name] = *v;
-      if (is_mutable) {
-        table.set_function(set_name, [v, tbl, key](const sol::table&, i64 val) mutable {
-          *v = val;
-          tbl[key] = *v;
-        });
-      }
-    } else if (opaque_type == flecs::F32) {
-      auto* v = static_cast<f32*>(field_ptr);
-      table[name] = *v;
-      if (is_mutable) {
-        table.set_function(set_name, [v, tbl, key](const sol::table&, f32 val) mutable {
-          *v = val;
-          tbl[key] = *v;
-        });
-      }
-    } else if (opaque_type == flecs::F64) {
-      auto* v = static_cast<f64*>(field_ptr);
-      table[name] = *v;
-      if (is_mutable) {
-        table.set_function(set_name, [v, tbl, key](const sol::table&, f64 val) mutable {
-          *v = val;
-          tbl[key] = *v;
-        });
-      }
-    } else if (opaque_type == flecs::String) {
-      auto** str = static_cast<const c8**>(field_ptr);
-      if (str && *str) {
-        table[name] = *str;
-      }
-    }
-  }
+namespace {
+struct LuaSystemCallback {
+  sol::function function = {};
+  std::shared_ptr<LuaComponentLayouts> layouts = nullptr;
 };
-
-static auto get_component_table(
-  sol::state* state, flecs::world& world, ecs_entity_t component_ty, void* component_ptr, bool is_mutable
-) -> sol::table {
-  ZoneScoped;
-
-  sol::table result = state->create_table();
-  result["component_id"] = component_ty;
-
-  if (component_ptr) {
-    auto serializer = LuaEntitySerializer(world, state, result, is_mutable);
-    serializer.serialize(flecs::entity(world, component_ty), component_ptr);
-  }
-
-  return result;
-}
+} // namespace
 
 auto FlecsBinding::bind(sol::state* state) -> void {
   ZoneScoped;
 
   auto flecs_table = state->create_named_table("flecs");
+  bind_component_views(state);
 
   // Phases
   flecs_table.set("OnStart", EcsOnStart);
@@ -502,23 +54,21 @@ auto FlecsBinding::bind(sol::state* state) -> void {
     [](ecs_iter_t* it) -> int32_t { return it->count; },
 
     "field",
-    [state](ecs_iter_t* it, i32 index, sol::table component_table) {
+    [state, layouts = layouts](ecs_iter_t* it, i32 index, sol::table component_table) {
       auto component = component_table.get<ecs_entity_t>("component_id");
       sol::table result = state->create_table();
       result["component_id"] = component;
 
       result.set_function(
         "at",
-        [it, state](const sol::table& self, int i) -> sol::table {
+        [it, layouts](const sol::table& self, int i) -> LuaComponentView {
           ecs_entity_t c = self["component_id"];
 
           OX_CHECK_LT(i, it->count);
           auto entity = it->entities[i];
 
-          auto e = flecs::entity{it->real_world, entity};
-          flecs::world world = e.world();
-
-          return get_component_table(state, world, c, e.get_mut(c), true);
+          // Through the iterator's stage, so writes are deferred until the system is done.
+          return layouts->view(flecs::entity{it->world, entity}, c, true);
         }
 
       );
@@ -536,7 +86,43 @@ auto FlecsBinding::bind(sol::state* state) -> void {
     },
 
     "query_next",
-    [](ecs_iter_t* it) -> bool { return ecs_query_next(it); }
+    [layouts = layouts](ecs_iter_t* it) -> bool {
+      layouts->expire_columns();
+      return ecs_query_next(it);
+    },
+
+    // All of one field over the current table, see `LuaColumnView`.
+    "column",
+    [layouts = layouts](ecs_iter_t* it, sol::table component_table, const std::string& field)
+      -> sol::optional<LuaColumnView> {
+      auto component = component_table.get<ecs_entity_t>("component_id");
+      if (auto column = layouts->column(it, component, field)) {
+        return *column;
+      }
+      return sol::nullopt;
+    }
+  );
+
+  // Runs `callback(it)` once per table the query matches, for scripts working a column at a time. The
+  // iterator lives in Lua memory rather than on this stack and is emptied once done, so a script that
+  // keeps it around is left with an iterator over nothing.
+  flecs_table.set_function(
+    "each_table",
+    [layouts = layouts](sol::this_state lua, ecs_query_t* query, sol::protected_function callback) {
+      auto it_object = sol::make_object(lua, ecs_query_iter(query->world, query));
+      auto* it = it_object.as<ecs_iter_t*>();
+      while (ecs_query_next(it)) {
+        auto result = callback(it_object);
+        layouts->expire_columns();
+        if (!result.valid()) {
+          sol::error err = result;
+          OX_LOG_ERROR("Lua each_table callback error: {}", err.what());
+          ecs_iter_fini(it);
+          break;
+        }
+      }
+      *it = {};
+    }
   );
 
   // --- world ---
@@ -562,7 +148,7 @@ auto FlecsBinding::bind(sol::state* state) -> void {
     },
 
     "system",
-    [state](
+    [state, layouts = layouts](
       ecs_world_t* world,
       const std::string& name,
       sol::table components,
@@ -591,17 +177,17 @@ auto FlecsBinding::bind(sol::state* state) -> void {
 
       system_desc.entity = ecs_entity_init(world, &entity_desc);
 
-      system_desc.callback_ctx = new std::shared_ptr<sol::function>(new sol::function(callback));
-      system_desc.callback_ctx_free = [](void* ctx) {
-        delete reinterpret_cast<std::shared_ptr<sol::function>*>(ctx);
-      };
+      system_desc.callback_ctx = new LuaSystemCallback{.function = callback, .layouts = layouts};
+      system_desc.callback_ctx_free = [](void* ctx) { delete reinterpret_cast<LuaSystemCallback*>(ctx); };
       system_desc.callback = [](ecs_iter_t* it) {
-        auto lua_callback = reinterpret_cast<std::shared_ptr<sol::function>*>(it->callback_ctx);
+        auto* lua_callback = reinterpret_cast<LuaSystemCallback*>(it->callback_ctx);
 
         OX_CHECK_NULL(lua_callback);
-        OX_CHECK_EQ((*lua_callback)->valid(), true);
+        OX_CHECK_EQ(lua_callback->function.valid(), true);
 
-        auto result = (**lua_callback)(it);
+        auto result = lua_callback->function(it);
+        // Columns of this table go with it.
+        lua_callback->layouts->expire_columns();
         if (!result.valid()) {
           sol::error err = result;
           OX_LOG_ERROR("Lua lambda function error: {}", err.what());
@@ -814,32 +400,29 @@ auto FlecsBinding::bind(sol::state* state) -> void {
     },
 
     "get",
-    [state](flecs::entity* e, sol::table component_table) -> sol::optional<sol::table> {
+    [layouts = layouts](flecs::entity* e, sol::table component_table) -> sol::optional<LuaComponentView> {
       auto component = component_table.get<ecs_entity_t>("component_id");
       if (!e->has(component))
         return sol::nullopt;
 
-      flecs::world world = e->world();
-      return get_component_table(state, world, component, const_cast<void*>(e->get(component)), false);
+      return layouts->view(*e, component, false);
     },
 
     "get_mut",
-    [state](flecs::entity* e, sol::table component_table) -> sol::optional<sol::table> {
+    [layouts = layouts](flecs::entity* e, sol::table component_table) -> sol::optional<LuaComponentView> {
       auto component = component_table.get<ecs_entity_t>("component_id");
       if (!e->has(component))
         return sol::nullopt;
 
-      flecs::world world = e->world();
-      return get_component_table(state, world, component, e->get_mut(component), true);
+      return layouts->view(*e, component, true);
     },
 
     "ensure",
-    [state](flecs::entity* e, sol::table component_table) -> sol::optional<sol::table> {
+    [layouts = layouts](flecs::entity* e, sol::table component_table) -> sol::optional<LuaComponentView> {
       auto component = component_table.get<ecs_entity_t>("component_id");
       e->ensure(component);
 
-      flecs::world world = e->world();
-      return get_component_table(state, world, component, e->get_mut(component), true);
+      return layouts->view(*e, component, true);
     },
 
     // only available with default values
@@ -24,10 +24,9 @@
 #endif
 
 namespace ox {
-auto LuaManager::init(this LuaManager& self) -> std::expected<void, std::string> {
-  ZoneScoped;
-  self.state = std::make_unique<sol::state>();
-  self.state->open_libraries(
+namespace {
+auto open_libraries(sol::state& state) -> void {
+  state.open_libraries(
     sol::lib::base,
     sol::lib::package,
     sol::lib::math,
@@ -35,6 +34,16 @@ auto LuaManager::init(this LuaManager& self) -> std::expected<void, std::string>
     sol::lib::os,
     sol::lib::string
   );
+#ifdef OX_LUAJIT
+  state.open_libraries(sol::lib::ffi, sol::lib::jit, sol::lib::bit32);
+#endif
+}
+} // namespace
+
+auto LuaManager::init(this LuaManager& self) -> std::expected<void, std::string> {
+  ZoneScoped;
+  self.state = std::make_unique<sol::state>();
+  open_libraries(*self.state);
 
   self.state->set_function(
     "require_script",
@@ -60,8 +69,8 @@ auto LuaManager::init(this LuaManager& self) -> std::expected<void, std::string>
 #define BIND(type) self.bind<type>(#type, self.state.get())
 
 #ifdef OX_LUA_BINDINGS
-  self.bind_log();
-  self.bind_vector();
+  bind_log(self.state.get());
+  bind_vector(self.state.get());
   BIND(AppBinding);
   BIND(AssetManagerBinding);
   BIND(AudioBinding);
@@ -76,12 +85,28 @@ auto LuaManager::init(this LuaManager& self) -> std::expected<void, std::string>
   BIND(VFSBinding);
   BIND(RMLBinding);
   BIND(NetworkBinding);
+
+  // Only what is safe to call off the main thread goes into the VMs of parallel scripts.
+  const auto slot_count = std::max(1_u32, App::get_job_manager().get_thread_count());
+  self.workers.init(slot_count, [](LuaWorker& worker) {
+    auto* state = worker.state.get();
+    open_libraries(*state);
+    bind_log(state);
+    bind_vector(state);
+
+    worker.bindings.emplace_back(std::make_unique<MathBinding>())->bind(state);
+    auto flecs_binding = std::make_unique<FlecsBinding>();
+    flecs_binding->bind(state);
+    worker.layouts = flecs_binding->get_layouts();
+    worker.bindings.emplace_back(std::move(flecs_binding));
+  });
 #endif
 
   return {};
 }
 
 auto LuaManager::deinit(this LuaManager& self) -> std::expected<void, std::string> {
+  self.workers.reset();
   self.state->collect_gc();
   self.state.reset();
 
@@ -100,19 +125,19 @@ auto LuaManager::deinit(this LuaManager& self) -> std::expected<void, std::strin
     )                                                                                                                  \
   );
 
-auto LuaManager::bind_log(this const LuaManager& self) -> void {
+auto LuaManager::bind_log(sol::state* state) -> void {
   ZoneScoped;
-  sol::table log = self.state->create_named_table("Oxlog");
+  sol::table log = state->create_named_table("Oxlog");
 
   SET_LOG_FUNCTIONS(log, "info", OX_LOG_INFO)
   SET_LOG_FUNCTIONS(log, "warn", OX_LOG_WARN)
   SET_LOG_FUNCTIONS(log, "error", OX_LOG_ERROR)
 }
 
-auto LuaManager::bind_vector(this const LuaManager& self) -> void {
+auto LuaManager::bind_vector(sol::state* state) -> void {
   ZoneScoped;
 
-  self.state->set_function("new_number_vector", []() { return std::vector<f64>{}; });
-  self.state->set_function("new_string_vector", []() { return std::vector<std::string>{}; });
+  state->set_function("new_number_vector", []() { return std::vector<f64>{}; });
+  state->set_function("new_string_vector", []() { return std::vector<std::string>{}; });
 }
 } // namespace ox
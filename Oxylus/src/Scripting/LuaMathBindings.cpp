@@ -3,11 +3,13 @@
 #include <glm/gtx/compatibility.hpp>
 #include <glm/gtx/quaternion.hpp>
 #include <sol/overload.hpp>
+#include <sol/property.hpp>
 #include <sol/state.hpp>
 #include <sol/types.hpp>
 
 #include "Core/Types.hpp"
 #include "Render/BoundingVolume.hpp"
+#include "Scripting/LuaFFIMath.hpp"
 #include "Scripting/LuaHelpers.hpp"
 
 namespace ox {
@@ -63,6 +65,7 @@ auto MathBinding::bind(sol::state* state) -> void {
   SET_TYPE_FIELD(ivec2, glm::ivec2, y);
   SET_MATH_FUNCTIONS(ivec2, glm::ivec2, int)
 
+#ifndef OX_LUAJIT
   auto vec3 = state->new_usertype<glm::vec3>(
     "vec3",
     sol::constructors<sol::types<float, float, float>, glm::vec3(float)>()
@@ -71,6 +74,7 @@ auto MathBinding::bind(sol::state* state) -> void {
   SET_TYPE_FIELD(vec3, glm::vec3, y);
   SET_TYPE_FIELD(vec3, glm::vec3, z);
   SET_MATH_FUNCTIONS(vec3, glm::vec3, float)
+#endif
 
   auto ivec3 = state->new_usertype<glm::ivec3>(
     "ivec3",
@@ -130,6 +134,7 @@ auto MathBinding::bind(sol::state* state) -> void {
     [](const glm::mat3& a, const glm::mat3& b) { return a * b; }
   );
 
+#ifndef OX_LUAJIT
   state->new_usertype<glm::mat4>(
     "mat4",
     sol::constructors<glm::mat4(float), glm::mat4()>(),
@@ -146,12 +151,21 @@ auto MathBinding::bind(sol::state* state) -> void {
   SET_TYPE_FIELD(quat, glm::quat, y);
   SET_TYPE_FIELD(quat, glm::quat, z);
   SET_TYPE_FIELD(quat, glm::quat, w);
+#endif
 
   state->new_enum<Intersection>("Intersection", {{"Outside", Outside}, {"Intersects", Intersects}, {"Inside", Inside}});
 
   auto aabb = state->new_usertype<AABB>("AABB", sol::constructors<AABB(), AABB(AABB), AABB(glm::vec3, glm::vec3)>());
-  SET_TYPE_FIELD(aabb, AABB, min);
-  SET_TYPE_FIELD(aabb, AABB, max);
+  // Copied in and out, so `aabb.min.x = 1` changes a copy on both backends. LuaJIT has no other
+  // choice, its vec3s are values.
+  aabb["min"] = sol::property(
+    [](const AABB& self) { return self.min; },
+    [](AABB& self, const glm::vec3& v) { self.min = v; }
+  );
+  aabb["max"] = sol::property(
+    [](const AABB& self) { return self.max; },
+    [](AABB& self, const glm::vec3& v) { self.max = v; }
+  );
   SET_TYPE_FUNCTION(aabb, AABB, get_center);
   SET_TYPE_FUNCTION(aabb, AABB, get_extents);
   SET_TYPE_FUNCTION(aabb, AABB, get_size);
@@ -219,6 +233,15 @@ auto MathBinding::bind(sol::state* state) -> void {
       [](const glm::vec4& vec) { return glm::normalize(vec); }
     )
   );
+  glm_table.set_function(
+    "dot",
+    sol::overload(
+      [](const glm::vec2& a, const glm::vec2& b) { return glm::dot(a, b); },
+      [](const glm::vec3& a, const glm::vec3& b) { return glm::dot(a, b); },
+      [](const glm::vec4& a, const glm::vec4& b) { return glm::dot(a, b); }
+    )
+  );
+  glm_table.set_function("cross", [](const glm::vec3& a, const glm::vec3& b) { return glm::cross(a, b); });
   glm_table.set_function("distance", [](const glm::vec3& a, const glm::vec3& b) { return glm::distance(a, b); });
   glm_table.set_function("radians", [](f32 degrees) { return glm::radians(degrees); });
   glm_table.set_function("degrees", [](f32 radians) { return glm::degrees(radians); });
@@ -227,5 +250,10 @@ auto MathBinding::bind(sol::state* state) -> void {
   });
   glm_table.set_function("atan2", [](f32 x, f32 y) { return glm::atan2(x, y); });
   glm_table.set_function("angle_axis", [](f32 angle, glm::vec3 v) -> glm::quat { return glm::angleAxis(angle, v); });
+
+#ifdef OX_LUAJIT
+  // Last, as it wraps some of the glm functions above.
+  ffi_math::bind(state);
+#endif
 }
 } // namespace ox
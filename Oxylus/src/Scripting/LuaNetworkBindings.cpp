@@ -1,5 +1,6 @@
 #include "Scripting/LuaNetworkBindings.hpp"
 
+#include <cmath>
 #include <sol/state.hpp>
 
 #include "Networking/NetworkManager.hpp"
@@ -24,11 +25,17 @@ auto rpc_params_from_lua(const sol::optional<sol::table>& params) -> ankerl::sve
     auto value = table.get<sol::object>(i);
     switch (value.get_type()) {
       case sol::type::number: {
+#ifdef OX_LUAJIT
+        // LuaJIT numbers are all doubles, integral ones are taken for ints.
+        const auto number = value.as<f64>();
+        const auto is_integer = std::trunc(number) == number && std::abs(number) < 9007199254740992.0;
+#else
         // Lua 5.4 tracks the integer subtype, keep it so ints don't arrive as floats.
         auto* L = value.lua_state();
         value.push(L);
         const auto is_integer = lua_isinteger(L, -1) != 0;
         lua_pop(L, 1);
+#endif
 
         if (is_integer) {
           values.emplace_back(RPCParameter{.value = value.as<i64>()});
@@ -36,7 +43,7 @@ auto rpc_params_from_lua(const sol::optional<sol::table>& params) -> ankerl::sve
           values.emplace_back(RPCParameter{.value = value.as<f64>()});
         }
       } break;
-      case sol::type::string : values.emplace_back(RPCParameter{.value = value.as<std::string>()}); break;
+      case sol::type::string : values.emplace_back(RPCParameter{.value = value.as<std::string_view>()}); break;
       case sol::type::boolean: values.emplace_back(RPCParameter{.value = static_cast<u8>(value.as<bool>())}); break;
       default                : {
         OX_LOG_ERROR("RPC parameter {} has an unsupported type, sending it as none.", i);
@@ -62,7 +69,7 @@ auto rpc_params_to_lua(sol::state_view lua, std::span<RPCParameter> params) -> s
           auto bytes = value;
           auto uuid = UUID::from_bytes(bytes);
           table[i + 1] = uuid.has_value() ? uuid->str() : std::string{};
-        } else if constexpr (std::is_same_v<T, std::vector<u8>>) {
+        } else if constexpr (std::is_same_v<T, std::span<const u8>>) {
           table[i + 1] = std::string(reinterpret_cast<const c8*>(value.data()), value.size());
         } else {
           table[i + 1] = value;
@@ -116,6 +123,9 @@ auto NetworkBinding::bind(sol::state* state) -> void {
     "rtt",
     &NetStats::rtt,
 
+    "rtt_variance",
+    &NetStats::rtt_variance,
+
     "last_sent_bytes",
     &NetStats::last_sent_bytes,
 
@@ -140,6 +150,9 @@ auto NetworkBinding::bind(sol::state* state) -> void {
   state->new_usertype<NetworkManager>(
     "NetworkManager",
 
+    "threaded_io",
+    &NetworkManager::threaded_io,
+
     "create_server",
     [](NetworkManager* self, u16 port, u32 max_clients) -> NetServer* {
       return self->create_server(port, max_clients);
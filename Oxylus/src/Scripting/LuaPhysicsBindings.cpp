@@ -11,6 +11,7 @@
 #include <Jolt/Physics/Character/Character.h>
 #include <sol/state.hpp>
 
+#include "Physics/PhysicsQueries.hpp"
 #include "Physics/RayCast.hpp"
 #include "Scene/Components.hpp"
 #include "Scene/Scene.hpp"
@@ -71,6 +72,100 @@ auto PhysicsBinding::bind(sol::state* state) -> void {
       -> std::vector<JPH::BroadPhaseCastResult> { return {collector.mHits.begin(), collector.mHits.end()}; }
   );
 
+  // Queries are numbered from 1 on this side, like everything else in Lua.
+  state->new_enum(
+    "PhysicsQueryKind",
+    "Ray",
+    PhysicsQueryKind::Ray,
+    "SphereCast",
+    PhysicsQueryKind::SphereCast,
+    "SphereOverlap",
+    PhysicsQueryKind::SphereOverlap
+  );
+
+  state->new_usertype<PhysicsQueryHit>(
+    "PhysicsQueryHit",
+    sol::no_constructor,
+    "body",
+    sol::readonly(&PhysicsQueryHit::body),
+    "entity",
+    sol::readonly(&PhysicsQueryHit::entity),
+    "point",
+    sol::readonly(&PhysicsQueryHit::point),
+    "normal",
+    sol::readonly(&PhysicsQueryHit::normal),
+    "fraction",
+    sol::readonly(&PhysicsQueryHit::fraction)
+  );
+
+  state->new_usertype<PhysicsQueryBatch>(
+    "PhysicsQueryBatch",
+    sol::constructors<PhysicsQueryBatch()>(),
+    "max_hits",
+    &PhysicsQueryBatch::max_hits,
+    "size",
+    [](const PhysicsQueryBatch& batch) { return batch.size(); },
+    "clear",
+    [](PhysicsQueryBatch& batch) { batch.clear(); },
+    "add_ray",
+    [](
+      PhysicsQueryBatch& batch, const glm::vec3& origin, const glm::vec3& direction, sol::optional<JPH::BodyID> ignore
+    ) { return batch.add_ray(origin, direction, ignore.value_or(JPH::BodyID{})) + 1; },
+    "add_sphere_cast",
+    [](
+      PhysicsQueryBatch& batch,
+      const glm::vec3& origin,
+      const glm::vec3& direction,
+      f32 radius,
+      sol::optional<JPH::BodyID> ignore
+    ) { return batch.add_sphere_cast(origin, direction, radius, ignore.value_or(JPH::BodyID{})) + 1; },
+    "add_sphere_overlap",
+    [](PhysicsQueryBatch& batch, const glm::vec3& center, f32 radius, sol::optional<JPH::BodyID> ignore) {
+      return batch.add_sphere_overlap(center, radius, ignore.value_or(JPH::BodyID{})) + 1;
+    },
+    // A whole array of `{ kind =, origin =, direction =, radius =, ignore = }` in one call.
+    "add_queries",
+    [](PhysicsQueryBatch& batch, const sol::table& queries) {
+      batch.queries.reserve(batch.queries.size() + queries.size());
+      for (usize i = 1; i <= queries.size(); i++) {
+        const sol::table query = queries[i];
+        batch.queries.push_back({
+          .kind = query.get_or("kind", PhysicsQueryKind::Ray),
+          .origin = query.get_or("origin", glm::vec3(0.0f)),
+          .direction = query.get_or("direction", glm::vec3(0.0f)),
+          .radius = query.get_or("radius", 0.0f),
+          .ignore_body = query.get_or("ignore", JPH::BodyID{}),
+        });
+      }
+    }
+  );
+
+  state->new_usertype<PhysicsQueryResults>(
+    "PhysicsQueryResults",
+    sol::constructors<PhysicsQueryResults()>(),
+    "size",
+    [](const PhysicsQueryResults& results) { return results.hit_counts.size(); },
+    "hit_count",
+    [](const PhysicsQueryResults& results, usize query) -> u32 {
+      return query >= 1 && query <= results.hit_counts.size() ? results.hit_counts[query - 1] : 0;
+    },
+    "hit",
+    [](const PhysicsQueryResults& results, usize query, sol::optional<u32> index) -> sol::optional<PhysicsQueryHit> {
+      const auto hit = index.value_or(1);
+      if (query < 1 || query > results.hit_counts.size() || hit < 1 || hit > results.hit_counts[query - 1]) {
+        return sol::nullopt;
+      }
+      return results.hits_of(query - 1)[hit - 1];
+    }
+  );
+
+  physics_table.set_function(
+    "run_queries",
+    [](Scene* scene, const PhysicsQueryBatch& batch, PhysicsQueryResults& results) {
+      scene->run_physics_queries(batch, results);
+    }
+  );
+
   physics_table.set_function("get_body", [](flecs::entity* e) -> JPH::Body* {
     auto* rb = e->try_get<RigidBodyComponent>();
     OX_CHECK_NULL(rb);
@@ -125,6 +220,43 @@ auto PhysicsBinding::bind(sol::state* state) -> void {
     [](JPH::BodyID& body_id1, JPH::BodyID& body_id2) { return body_id1 == body_id2; }
   );
 
+  state->new_enum(
+    "ContactEventKind",
+    "Added",
+    ContactEventKind::Added,
+    "Persisted",
+    ContactEventKind::Persisted,
+    "Removed",
+    ContactEventKind::Removed
+  );
+
+  state->new_usertype<ContactEvent>(
+    "ContactEvent",
+    sol::no_constructor,
+    "kind",
+    sol::readonly(&ContactEvent::kind),
+    "body1",
+    sol::readonly(&ContactEvent::body1),
+    "body2",
+    sol::readonly(&ContactEvent::body2),
+    "entity1",
+    sol::readonly(&ContactEvent::entity1),
+    "entity2",
+    sol::readonly(&ContactEvent::entity2),
+    "normal",
+    sol::readonly(&ContactEvent::normal),
+    "point",
+    sol::readonly(&ContactEvent::point),
+    "penetration_depth",
+    sol::readonly(&ContactEvent::penetration_depth),
+    "friction",
+    sol::readonly(&ContactEvent::friction),
+    "restitution",
+    sol::readonly(&ContactEvent::restitution),
+    "contact_count",
+    sol::readonly(&ContactEvent::contact_count)
+  );
+
   state->new_usertype<JPH::Body>(
     "Body",
     sol::no_constructor,
@@ -1,14 +1,23 @@
 #include "Scripting/LuaRMLBindings.hpp"
 
 #include <RmlUi/Core.h>
-#include <RmlUi/Lua.h>
+#ifndef OX_LUAJIT
+  #include <RmlUi/Lua.h>
+#endif
 #include <sol/state.hpp>
 
+#include "Utils/Log.hpp"
+
 namespace ox {
 auto RMLBinding::bind(sol::state* state) -> void {
   ZoneScoped;
 
+#ifdef OX_LUAJIT
+  // RmlUi's Lua plugin is built against PUC Lua only.
+  OX_LOG_WARN("RmlUi documents can't run Lua scripts on LuaJIT builds.");
+#else
   Rml::Lua::Initialise(state->lua_state());
+#endif
 
   sol::table rml_extensions = state->create_named_table("rmlui_ext");
   rml_extensions.set_function("ClearStyleCache", []() { Rml::Factory::ClearStyleSheetCache(); });
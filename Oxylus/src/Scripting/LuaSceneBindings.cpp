@@ -49,6 +49,15 @@ auto SceneBinding::bind(sol::state* state) -> void {
     return scene->get_local_transform(e)[3];
   });
 
+  scene_type.set_function("query_aabb", [](Scene* scene, const AABB& aabb) { return scene->query_aabb(aabb); });
+  scene_type.set_function("query_sphere", [](Scene* scene, const glm::vec3& center, f32 radius) {
+    return scene->query_sphere(Sphere(center, radius));
+  });
+  scene_type.set_function("query_frustum", [](Scene* scene, const glm::mat4& projection_view) {
+    return scene->query_frustum(Frustum::from_matrix(projection_view));
+  });
+  scene_type.set_function("query_ray", [](Scene* scene, const RayCast& ray) { return scene->query_ray(ray); });
+
   scene_type.set_function("defer", [](Scene* scene, sol::function func) {
     scene->defer_function([func](Scene* s) {
       ZoneScopedN("scene::defer lua function");
@@ -2,10 +2,10 @@
 
 #include <Jolt/Jolt.h>
 #include <Jolt/Physics/Body/Body.h>
-#include <Jolt/Physics/Collision/ContactListener.h>
 #include <sol/state.hpp>
 
 #include "Core/App.hpp"
+#include "Physics/ContactBuffer.hpp"
 #include "Scene/Scene.hpp"
 #include "Scripting/LuaManager.hpp"
 
@@ -110,6 +110,23 @@ auto LuaSystem::init_script(
   self.on_body_deactivated_func = std::make_unique<sol::protected_function>((*self.environment)["on_body_deactivated"]);
   reset_unused(self.on_body_deactivated_func);
 
+  // Declaring `parallel` adds a copy in every worker VM on top of this one, whose callbacks keep
+  // running on the main thread as usual.
+  self.parallel.reset();
+  if ((*self.environment)["parallel"].valid()) {
+    auto& workers = App::mod<LuaManager>().get_workers();
+    workers.mirror_components(*state);
+    self.parallel = workers.load(path, script);
+  }
+
+  auto* system = &self;
+  self.environment->set_function("subscribe_contacts", [system](flecs::entity* entity) {
+    system->contact_entities.emplace(entity->id());
+  });
+  self.environment->set_function("unsubscribe_contacts", [system](flecs::entity* entity) {
+    system->contact_entities.erase(entity->id());
+  });
+
   state->collect_gc();
 }
 
@@ -146,6 +163,8 @@ auto LuaSystem::reset_functions(this LuaSystem& self) -> void {
   self.on_contact_removed_func.reset();
   self.on_body_activated_func.reset();
   self.on_body_deactivated_func.reset();
+
+  self.parallel.reset();
 }
 
 auto LuaSystem::on_add(this const LuaSystem& self, Scene* scene) -> void {
@@ -219,50 +238,48 @@ auto LuaSystem::on_scene_stop(this const LuaSystem& self, Scene* scene) -> void
 }
 
 auto LuaSystem::on_contact_added(
-  this const LuaSystem& self,
-  Scene* scene,
-  const JPH::Body& body1,
-  const JPH::Body& body2,
-  const JPH::ContactManifold& manifold,
-  const JPH::ContactSettings& settings
+  this const LuaSystem& self, Scene* scene, const JPH::Body* body1, const JPH::Body* body2, const ContactEvent& contact
 ) -> void {
   ZoneScoped;
 
   if (!self.on_contact_added_func)
     return;
 
-  const auto result = self.on_contact_added_func->call(scene, &body1, &body2, manifold, settings);
+  const auto result = self.on_contact_added_func->call(scene, body1, body2, &contact);
   check_result(result, "on_contact_added");
 }
 
 auto LuaSystem::on_contact_persisted(
-  this const LuaSystem& self,
-  Scene* scene,
-  const JPH::Body& body1,
-  const JPH::Body& body2,
-  const JPH::ContactManifold& manifold,
-  const JPH::ContactSettings& settings
+  this const LuaSystem& self, Scene* scene, const JPH::Body* body1, const JPH::Body* body2, const ContactEvent& contact
 ) -> void {
   ZoneScoped;
 
   if (!self.on_contact_persisted_func)
     return;
 
-  const auto result = self.on_contact_persisted_func->call(scene, &body1, &body2, manifold, settings);
+  const auto result = self.on_contact_persisted_func->call(scene, body1, body2, &contact);
   check_result(result, "on_contact_persisted");
 }
 
-auto LuaSystem::on_contact_removed(this const LuaSystem& self, Scene* scene, const JPH::SubShapeIDPair& sub_shape_pair)
-  -> void {
+auto LuaSystem::on_contact_removed(this const LuaSystem& self, Scene* scene, const ContactEvent& contact) -> void {
   ZoneScoped;
 
   if (!self.on_contact_removed_func)
     return;
 
-  const auto result = self.on_contact_removed_func->call(scene, sub_shape_pair);
+  const auto result = self.on_contact_removed_func->call(scene, &contact);
   check_result(result, "on_contact_removed");
 }
 
+auto LuaSystem::has_contact_callbacks(this const LuaSystem& self) -> bool {
+  return self.on_contact_added_func || self.on_contact_persisted_func || self.on_contact_removed_func;
+}
+
+auto LuaSystem::wants_contact(this const LuaSystem& self, const ContactEvent& contact) -> bool {
+  return self.contact_entities.empty() || self.contact_entities.contains(contact.entity1) ||
+         self.contact_entities.contains(contact.entity2);
+}
+
 auto LuaSystem::on_body_activated(
   this const LuaSystem& self, Scene* scene, const JPH::BodyID& body_id, u64 body_user_data
 ) -> void {
@@ -0,0 +1,222 @@
+#include "Scripting/LuaWorkerPool.hpp"
+
+#include "Core/JobManager.hpp"
+#include "Utils/Log.hpp"
+
+// Pushed to pure scripts as the same usertype LuaFlecsBindings registers.
+struct ecs_world_t {};
+
+namespace ox {
+LuaParallelScript::~LuaParallelScript() {
+  if (query != nullptr) {
+    ecs_query_fini(query);
+  }
+}
+
+auto LuaWorkerPool::init(this LuaWorkerPool& self, u32 slot_count, const SetupFn& setup) -> void {
+  ZoneScoped;
+
+  self.workers.clear();
+  self.workers.reserve(slot_count);
+  for (u32 i = 0; i < slot_count; i++) {
+    auto worker = std::make_unique<LuaWorker>();
+    worker->state = std::make_unique<sol::state>();
+    setup(*worker);
+    OX_CHECK_NULL(worker->layouts, "Lua workers need a FlecsBinding.");
+    worker->layouts->commands = &worker->commands;
+    self.workers.emplace_back(std::move(worker));
+  }
+}
+
+auto LuaWorkerPool::mirror_components(this LuaWorkerPool& self, sol::state& main) -> void {
+  ZoneScoped;
+
+  for (const auto& [key, value] : main.globals()) {
+    if (key.get_type() != sol::type::string || value.get_type() != sol::type::table) {
+      continue;
+    }
+    const auto component = value.as<sol::table>().raw_get<sol::optional<flecs::entity_t>>("component_id");
+    if (!component) {
+      continue;
+    }
+    const auto name = key.as<std::string>();
+    for (auto& worker : self.workers) {
+      (*worker->state)[name] = worker->state->create_table_with("component_id", *component);
+    }
+  }
+}
+
+auto LuaWorkerPool::load(this LuaWorkerPool& self, const std::filesystem::path& path, const option<std::string>& source)
+  -> std::unique_ptr<LuaParallelScript> {
+  ZoneScoped;
+
+  if (self.workers.empty()) {
+    OX_LOG_ERROR("{} is declared parallel, but there are no Lua workers to run it on.", path);
+    return nullptr;
+  }
+
+  auto script = std::make_unique<LuaParallelScript>();
+  for (auto& worker : self.workers) {
+    auto& state = *worker->state;
+    auto environment = sol::environment(state, sol::create, state.globals());
+    const auto result = source.has_value()
+                          ? state.safe_script(*source, environment, sol::script_pass_on_error)
+                          : state.safe_script_file(path.string(), environment, sol::script_pass_on_error);
+    if (!result.valid()) {
+      const sol::error err = result;
+      OX_LOG_ERROR("Failed to load {} into a Lua worker: {}", path, err.what());
+      return nullptr;
+    }
+
+    auto function = environment.get<sol::optional<sol::protected_function>>("on_parallel_update");
+    if (!function) {
+      OX_LOG_ERROR("{} is declared parallel but has no on_parallel_update.", path);
+      return nullptr;
+    }
+    script->environments.emplace_back(std::move(environment));
+    script->functions.emplace_back(std::move(*function));
+  }
+
+  // Every copy ran the same chunk, the first one speaks for all of them.
+  const auto& environment = script->environments.front();
+  const auto mode = environment.get<sol::optional<std::string>>("parallel").value_or("");
+  if (mode == "pure") {
+    script->mode = LuaParallelMode::Pure;
+  } else if (mode == "partitioned") {
+    script->mode = LuaParallelMode::Partitioned;
+    const auto components = environment.get<sol::optional<sol::table>>("parallel_query");
+    if (components) {
+      for (const auto& [_, component] : *components) {
+        const auto id = component.as<sol::table>().get<sol::optional<flecs::entity_t>>("component_id");
+        if (!id) {
+          OX_LOG_ERROR("parallel_query of {} lists something that isn't a component.", path);
+          return nullptr;
+        }
+        script->terms.emplace_back(*id);
+      }
+    }
+    if (script->terms.empty() || script->terms.size() > FLECS_TERM_COUNT_MAX) {
+      OX_LOG_ERROR("{} is partitioned, list 1 to {} components in parallel_query.", path, FLECS_TERM_COUNT_MAX);
+      return nullptr;
+    }
+  } else {
+    OX_LOG_ERROR("{} declares an unknown parallel mode, expected \"pure\" or \"partitioned\".", path);
+    return nullptr;
+  }
+
+  return script;
+}
+
+auto LuaWorkerPool::run(
+  this LuaWorkerPool& self,
+  flecs::world& world,
+  std::span<LuaParallelScript* const> scripts,
+  JobManager* job_manager,
+  f32 delta_time
+) -> void {
+  ZoneScoped;
+
+  if (scripts.empty() || self.workers.empty()) {
+    return;
+  }
+
+  auto* c_world = world.c_ptr();
+  for (auto* script : scripts) {
+    if (script->mode == LuaParallelMode::Partitioned && script->world != c_world) {
+      if (script->query != nullptr) {
+        ecs_query_fini(script->query);
+      }
+      auto desc = ecs_query_desc_t{};
+      for (usize i = 0; i < script->terms.size(); i++) {
+        desc.terms[i].id = script->terms[i];
+      }
+      script->query = ecs_query_init(c_world, &desc);
+      script->world = c_world;
+    }
+  }
+  for (auto& worker : self.workers) {
+    worker->layouts->track(c_world);
+  }
+
+  // A stage per slot, for the structural changes scripts make. Put back afterwards, as the pipeline
+  // expects a flecs thread for every stage past the first.
+  const auto slot_count = static_cast<u32>(self.workers.size());
+  const auto stage_count = ecs_get_stage_count(c_world);
+  ecs_set_stage_count(c_world, static_cast<i32>(slot_count));
+  ecs_readonly_begin(c_world, true);
+
+  if (job_manager == nullptr || slot_count == 1) {
+    for (u32 slot = 0; slot < slot_count; slot++) {
+      self.run_slot(c_world, slot, scripts, delta_time);
+    }
+  } else {
+    auto barrier = Barrier::create();
+    for (u32 slot = 0; slot < slot_count; slot++) {
+      auto job = Job::create([&self, c_world, slot, scripts, delta_time]() {
+        self.run_slot(c_world, slot, scripts, delta_time);
+      });
+      job->signal(barrier);
+      job_manager->submit(std::move(job));
+    }
+    barrier->wait(*job_manager);
+  }
+
+  ecs_readonly_end(c_world);
+  ecs_set_stage_count(c_world, stage_count);
+
+  for (auto& worker : self.workers) {
+    worker->commands.apply(c_world);
+  }
+}
+
+auto LuaWorkerPool::run_slot(
+  this LuaWorkerPool& self,
+  ecs_world_t* world,
+  u32 slot,
+  std::span<LuaParallelScript* const> scripts,
+  f32 delta_time
+) -> void {
+  ZoneScopedN("LuaWorkerSlot");
+
+  const auto slot_count = static_cast<u32>(self.workers.size());
+  auto& worker = *self.workers[slot];
+  auto* stage = ecs_get_stage(world, static_cast<i32>(slot));
+
+  for (usize i = 0; i < scripts.size(); i++) {
+    auto* script = scripts[i];
+    auto& function = script->functions[slot];
+
+    if (script->mode == LuaParallelMode::Pure) {
+      // Dealt out by position, so a script keeps its VM and its writes keep their place in the merge
+      // for as long as the set of scripts stays the same.
+      if (i % slot_count != slot) {
+        continue;
+      }
+      const auto result = function(stage, delta_time);
+      if (!result.valid()) {
+        const sol::error err = result;
+        OX_LOG_ERROR("Error in on_parallel_update: {}", err.what());
+      }
+      continue;
+    }
+
+    // Handed to the script from Lua memory and emptied afterwards, like `flecs.each_table` does.
+    auto it = ecs_query_iter(stage, script->query);
+    auto slot_object = sol::make_object(
+      *worker.state, ecs_worker_iter(&it, static_cast<i32>(slot), static_cast<i32>(slot_count))
+    );
+    auto* slot_it = slot_object.as<ecs_iter_t*>();
+    while (ecs_worker_next(slot_it)) {
+      const auto result = function(slot_object, delta_time);
+      worker.layouts->expire_columns();
+      if (!result.valid()) {
+        const sol::error err = result;
+        OX_LOG_ERROR("Error in on_parallel_update: {}", err.what());
+        ecs_iter_fini(slot_it);
+        break;
+      }
+    }
+    *slot_it = {};
+  }
+}
+} // namespace ox
@@ -17,6 +17,20 @@ auto draw_stats_rows(memory::ScopedStack& stack, const NetStats& stats) -> void
   ImGui::TextUnformatted(stack.format_char("last_sent_packets: {}", stats.last_sent_packets));
 }
 
+auto draw_codec_row(memory::ScopedStack& stack, NetCompression compression) -> void {
+  constexpr static const char* CODEC_NAMES[] = {"none", "lz4", "zstd"};
+  ImGui::TextUnformatted(stack.format_char("compression: {}", CODEC_NAMES[static_cast<u8>(compression)]));
+}
+
+auto draw_compression_rows(memory::ScopedStack& stack, const NetCompressionStats& stats) -> void {
+  ImGui::TextUnformatted(stack.format_char("compression_ratio: {:.2f}", stats.ratio()));
+  ImGui::TextUnformatted(stack.format_char("compressed_packets: {}", stats.compressed_packets));
+  ImGui::TextUnformatted(stack.format_char("skipped_packets: {}", stats.skipped_packets));
+  ImGui::TextUnformatted(stack.format_char("decompressed_packets: {}", stats.decompressed_packets));
+  ImGui::TextUnformatted(stack.format_char("compress_ms: {:.2f}", stats.compress_ms));
+  ImGui::TextUnformatted(stack.format_char("decompress_ms: {:.2f}", stats.decompress_ms));
+}
+
 auto NetStatsViewer::draw_network_stats(const NetClient& client) -> void {
   ZoneScoped;
 
@@ -25,6 +39,10 @@ auto NetStatsViewer::draw_network_stats(const NetClient& client) -> void {
   if (ImGui::Begin("NetStats")) {
     ImGui::TextUnformatted(stack.format_char("client_id: {}", client.net_id));
     draw_stats_rows(stack, client.stats);
+    draw_codec_row(stack, client.compression);
+    if (client.compressor) {
+      draw_compression_rows(stack, client.compressor->stats);
+    }
   }
   ImGui::End();
 }
@@ -37,6 +55,11 @@ auto NetStatsViewer::draw_network_stats(NetServer& server) -> void {
   if (ImGui::Begin("NetStats")) {
     const auto client_ids = server.client_ids();
     ImGui::TextUnformatted(stack.format_char("connected clients: {}", client_ids.size()));
+    // One compressor serves every client, its totals are shown once.
+    if (server.compressor) {
+      ImGui::SeparatorText("compression");
+      draw_compression_rows(stack, server.compressor->stats);
+    }
 
     for (const auto client_id : client_ids) {
       const auto* client = server.client(client_id);
@@ -46,6 +69,7 @@ auto NetStatsViewer::draw_network_stats(NetServer& server) -> void {
 
       ImGui::SeparatorText(stack.format_char("client_id: {}", client->net_id));
       draw_stats_rows(stack, client->stats);
+      draw_codec_row(stack, client->compression);
     }
   }
   ImGui::End();
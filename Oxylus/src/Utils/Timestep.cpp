@@ -21,12 +21,10 @@ void Timestep::on_update(this Timestep& self) {
 
   {
     ZoneNamedN(z, "Sleep TimeStep to target fps", true);
-    constexpr f64 spin_threshold = 1.0;
-
     while (dt < self.max_frame_time) {
       f64 time_remaining = self.max_frame_time - dt;
-      if (time_remaining > spin_threshold) {
-        auto sleep_duration = std::chrono::duration<f64, std::milli>(time_remaining - spin_threshold);
+      if (time_remaining > self.spin_threshold) {
+        auto sleep_duration = std::chrono::duration<f64, std::milli>(time_remaining - self.spin_threshold);
         std::this_thread::sleep_for(sleep_duration);
       }
 
@@ -0,0 +1,83 @@
+#include <gtest/gtest.h>
+
+#include <chrono>
+
+#include "Asset/AssetManager.hpp"
+#include "Core/App.hpp"
+
+namespace {
+struct SimulationModule {
+  constexpr static auto MODULE_NAME = "SimulationModule";
+
+  auto init() -> std::expected<void, std::string> { return {}; }
+  auto deinit() -> std::expected<void, std::string> { return {}; }
+};
+
+struct PresentationModule {
+  constexpr static auto MODULE_NAME = "PresentationModule";
+  constexpr static auto SKIP_HEADLESS = true;
+
+  auto init() -> std::expected<void, std::string> { return {}; }
+  auto deinit() -> std::expected<void, std::string> { return {}; }
+};
+} // namespace
+
+class HeadlessAppTest : public ::testing::Test {
+protected:
+  void SetUp() override {
+    static char arg0[] = "HeadlessAppTest";
+    static char arg1[] = "--headless";
+    static char* test_argv[] = {arg0, arg1, nullptr};
+    app = std::make_unique<ox::App>(2, test_argv);
+  }
+
+  void TearDown() override { app.reset(); }
+
+  std::unique_ptr<ox::App> app = nullptr;
+};
+
+TEST_F(HeadlessAppTest, SkipsPresentationModules) {
+  EXPECT_TRUE(ox::App::is_headless());
+
+  app->with<SimulationModule>().with<PresentationModule>();
+  EXPECT_TRUE(ox::App::has_mod<SimulationModule>());
+  EXPECT_FALSE(ox::App::has_mod<PresentationModule>());
+}
+
+TEST_F(HeadlessAppTest, StepsAtTickRate) {
+  constexpr auto TICK_RATE = 100.0;
+  constexpr auto TICKS = 10;
+  app->with_tick_rate(TICK_RATE);
+
+  const auto start = std::chrono::steady_clock::now();
+  for (auto i = 0; i < TICKS; i++) {
+    app->step();
+  }
+  const auto elapsed = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+  EXPECT_GE(elapsed, TICKS * 1000.0 / TICK_RATE - 1.0);
+  EXPECT_DOUBLE_EQ(ox::App::get_timestep().get_max_frame_time(), 1000.0 / TICK_RATE);
+}
+
+// Without a renderer models keep the geometry colliders are cooked from, and nothing goes to the GPU.
+TEST_F(HeadlessAppTest, LoadsModelGeometry) {
+  app->with<ox::AssetManager>();
+  auto& asset_man = ox::App::mod<ox::AssetManager>();
+
+  const auto model_id = asset_man.load_model(
+    ox::ModelLoadInfo{
+      .vertices = {{.position = {0.f, 0.f, 0.f}}, {.position = {2.f, 0.f, 0.f}}, {.position = {0.f, 4.f, 0.f}}},
+      .indices = {0, 1, 2},
+    }
+  );
+  ASSERT_NE(model_id, ox::ModelID::Invalid);
+
+  auto model = asset_man.get_model(model_id);
+  ASSERT_TRUE(model);
+  EXPECT_TRUE(model->is_mesh_ready(0));
+  ASSERT_EQ(model->collision_meshes.size(), 1);
+  EXPECT_EQ(model->collision_meshes[0].positions.size(), 3);
+  EXPECT_EQ(model->collision_meshes[0].indices, (std::vector<u32>{0, 1, 2}));
+  EXPECT_EQ(model->gpu_meshes[0].bounds.aabb_extent, glm::vec3(2.f, 4.f, 0.f));
+  EXPECT_EQ(model->lod0_meshlet_counts[0], 0);
+}
@@ -0,0 +1,54 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <random>
+#include <vector>
+
+#include "Memory/TLSFAllocator.hpp"
+
+using namespace ox;
+
+TEST(TLSFAllocatorTest, AllocationsDoNotOverlap) {
+  auto allocator = TLSFAllocator{};
+  allocator.init(1024 * 1024);
+
+  auto allocations = std::vector<TLSFAllocator::Allocation>{};
+  for (auto size : {1_u32, 16_u32, 17_u32, 300_u32, 4096_u32, 70000_u32}) {
+    auto allocation = allocator.allocate(size);
+    ASSERT_TRUE(allocation.has_value()) << size;
+    EXPECT_EQ(allocation->offset % TLSFAllocator::ALIGNMENT, 0_u32);
+    EXPECT_GE(allocator.size_of(allocation->node), size);
+    allocations.push_back(allocation.value());
+  }
+
+  std::ranges::sort(allocations, {}, &TLSFAllocator::Allocation::offset);
+  for (auto i = 1_sz; i < allocations.size(); i++) {
+    const auto& prev = allocations[i - 1];
+    EXPECT_LE(prev.offset + allocator.size_of(prev.node), allocations[i].offset);
+  }
+}
+
+TEST(TLSFAllocatorTest, FreeingMergesNeighbours) {
+  constexpr auto CAPACITY = 64_u32 * 1024;
+  auto allocator = TLSFAllocator{};
+  allocator.init(CAPACITY);
+
+  auto nodes = std::vector<TLSFAllocator::NodeID>{};
+  while (auto allocation = allocator.allocate(1024)) {
+    nodes.push_back(allocation->node);
+  }
+  EXPECT_EQ(nodes.size(), CAPACITY / 1024);
+  EXPECT_FALSE(allocator.allocate(16).has_value());
+
+  // Freed in a scrambled order, merging has to stitch everything back into a single block.
+  auto rng = std::mt19937(7);
+  std::ranges::shuffle(nodes, rng);
+  for (const auto node : nodes) {
+    allocator.free(node);
+  }
+
+  EXPECT_EQ(allocator.free_size, CAPACITY);
+  auto whole = allocator.allocate(CAPACITY);
+  ASSERT_TRUE(whole.has_value());
+  EXPECT_EQ(whole->offset, 0_u32);
+}
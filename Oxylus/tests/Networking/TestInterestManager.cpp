@@ -0,0 +1,217 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+#include "Networking/InterestManager.hpp"
+#include "Scene/Components.hpp"
+#include "Scene/SnapshotCodec.hpp"
+
+using namespace ox;
+
+namespace {
+// Replicated without a transform, like a match scoreboard.
+struct NetScore {
+  i32 value = 0;
+};
+} // namespace
+
+class InterestManagerTest : public ::testing::Test {
+protected:
+  void SetUp() override {
+    world.component<TransformComponent>().add<Networked>();
+    world.component<NetScore>().add<Networked>();
+  }
+
+  auto spawn(const glm::vec3& position) -> flecs::entity {
+    return world.entity().set<TransformComponent>({.position = position});
+  }
+
+  auto tick(ClientInterest& client, SceneState& out) -> void {
+    state.clear();
+    SceneSnapshotBuilder::take_snapshot(world, state);
+    interest.update(world, state);
+    const auto previous = out;
+    interest.filter(client, state, &previous, out);
+  }
+
+  static auto contains(const std::vector<flecs::entity_t>& ids, flecs::entity entity) -> bool {
+    return std::ranges::find(ids, entity.id()) != ids.end();
+  }
+
+  static auto bytes_of(const SceneState& state, flecs::entity entity) -> std::vector<u8> {
+    const auto* entity_state = state.find(entity.id());
+    const auto bytes = state.bytes_of(state.components_of(*entity_state).front());
+    return {bytes.begin(), bytes.end()};
+  }
+
+  flecs::world world = {};
+  InterestManager interest = {};
+  SceneState state = {};
+};
+
+TEST_F(InterestManagerTest, EnterAndLeaveAreaOfInterest) {
+  auto viewer = spawn({0.f, 0.f, 0.f});
+  auto near = spawn({10.f, 0.f, 0.f});
+  auto far = spawn({1000.f, 0.f, 0.f});
+  auto flag = spawn({-1000.f, 0.f, 0.f}).add<AlwaysRelevant>();
+  auto score = world.entity().set<NetScore>({.value = 3});
+
+  auto client = ClientInterest{.viewer = viewer.id(), .radius_cells = 2};
+  auto out = SceneState{};
+  tick(client, out);
+
+  EXPECT_EQ(out.entities.size(), 4u);
+  EXPECT_FALSE(out.contains(far.id()));
+  for (const auto& entity : {viewer, near, flag, score}) {
+    EXPECT_TRUE(out.contains(entity.id()));
+    EXPECT_TRUE(contains(client.entered, entity));
+  }
+
+  // Two cells out enters, three cells out only keeps what is already relevant.
+  far.get_mut<TransformComponent>().position.x = 70.f;
+  near.get_mut<TransformComponent>().position.x = 100.f;
+  tick(client, out);
+  EXPECT_TRUE(contains(client.entered, far));
+  EXPECT_TRUE(out.contains(near.id()));
+  EXPECT_TRUE(client.left.empty());
+
+  near.get_mut<TransformComponent>().position.x = 200.f;
+  tick(client, out);
+  EXPECT_TRUE(client.entered.empty());
+  EXPECT_TRUE(contains(client.left, near));
+  EXPECT_FALSE(out.contains(near.id()));
+
+  far.destruct();
+  tick(client, out);
+  EXPECT_TRUE(contains(client.left, far));
+}
+
+TEST_F(InterestManagerTest, UsesWorldPositions) {
+  auto viewer = spawn({0.f, 0.f, 0.f});
+  auto parent = spawn({1000.f, 0.f, 0.f});
+  auto child = spawn({10.f, 0.f, 0.f}).child_of(parent);
+
+  auto client = ClientInterest{.viewer = viewer.id(), .radius_cells = 2};
+  auto out = SceneState{};
+  tick(client, out);
+  EXPECT_FALSE(out.contains(child.id()));
+
+  parent.get_mut<TransformComponent>().position.x = 0.f;
+  tick(client, out);
+  EXPECT_TRUE(contains(client.entered, child));
+}
+
+TEST_F(InterestManagerTest, BudgetAndUpdateIntervals) {
+  auto viewer = spawn({0.f, 0.f, 0.f});
+  auto entities = std::vector<flecs::entity>{};
+  for (u32 i = 0; i < 99; i++) {
+    entities.push_back(spawn({static_cast<f32>(i % 10), 0.f, static_cast<f32>(i / 10)}));
+  }
+  auto slow = entities[0].set<NetRelevancy>({.update_interval = 4});
+
+  auto client = ClientInterest{.viewer = viewer.id(), .max_updates = 10};
+  auto out = SceneState{};
+  for (u32 i = 0; i < 10; i++) {
+    tick(client, out);
+    EXPECT_EQ(client.entered.size(), 10u);
+  }
+  EXPECT_EQ(out.entities.size(), 100u);
+
+  // Without a budget, `slow` is only resent every 4 ticks and otherwise repeats its last state.
+  client.max_updates = 0;
+  tick(client, out);
+  auto last_sent = client.relevant.at(slow.id()).last_update_tick;
+  for (u32 i = 0; i < 8; i++) {
+    slow.get_mut<TransformComponent>().position.y += 1.f;
+    const auto previous = bytes_of(out, slow);
+    tick(client, out);
+
+    const auto sent = client.relevant.at(slow.id()).last_update_tick;
+    if (sent == last_sent) {
+      EXPECT_EQ(bytes_of(out, slow), previous);
+    } else {
+      EXPECT_EQ(sent - last_sent, 4u);
+      last_sent = sent;
+    }
+  }
+  EXPECT_EQ(client.relevant.at(entities[1].id()).last_update_tick, interest.tick);
+}
+
+// Hundreds of clients spread over a large map, each seeing its own neighbourhood. Reports the server
+// cost of bucketing plus filtering, and what it saves on the wire over sending everyone everything.
+TEST_F(InterestManagerTest, ScalesToManyClients) {
+  constexpr u32 ENTITY_COUNT = 20000;
+  constexpr u32 CLIENT_COUNT = 256;
+  constexpr u32 TICK_COUNT = 10;
+  constexpr f32 MAP_SIZE = 4096.f;
+
+  std::mt19937 rng{7};
+  std::uniform_real_distribution<f32> coordinate(0.f, MAP_SIZE);
+  std::uniform_real_distribution<f32> step(-2.f, 2.f);
+  auto entities = std::vector<flecs::entity>{};
+  for (u32 i = 0; i < ENTITY_COUNT; i++) {
+    entities.push_back(spawn({coordinate(rng), 0.f, coordinate(rng)}));
+  }
+
+  const auto codec = SnapshotCodec::from_world(world);
+  auto clients = std::vector<ClientInterest>(CLIENT_COUNT);
+  auto sent = std::vector<SceneState>(CLIENT_COUNT);
+  for (u32 c = 0; c < CLIENT_COUNT; c++) {
+    clients[c].viewer = entities[c * (ENTITY_COUNT / CLIENT_COUNT)].id();
+  }
+
+  auto previous_state = SceneState{};
+  auto filtered = std::vector<SceneState>(CLIENT_COUNT);
+  auto payload = std::vector<u8>{};
+  auto filtered_bytes = 0_u64;
+  auto unfiltered_bytes = 0_u64;
+  auto relevant_count = 0_u64;
+  auto filter_ms = 0.0;
+  for (u32 t = 0; t < TICK_COUNT; t++) {
+    for (u32 i = t % 4; i < ENTITY_COUNT; i += 4) {
+      entities[i].get_mut<TransformComponent>().position += glm::vec3(step(rng), 0.f, step(rng));
+    }
+
+    state.clear();
+    SceneSnapshotBuilder::take_snapshot(world, state);
+
+    const auto start = std::chrono::steady_clock::now();
+    interest.update(world, state);
+    for (u32 c = 0; c < CLIENT_COUNT; c++) {
+      interest.filter(clients[c], state, &sent[c], filtered[c]);
+    }
+    filter_ms += std::chrono::duration<f64, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+    // Every client acked the previous tick.
+    for (u32 c = 0; c < CLIENT_COUNT; c++) {
+      relevant_count += filtered[c].entities.size();
+      payload.clear();
+      ASSERT_TRUE(codec.encode(&sent[c], filtered[c], payload));
+      filtered_bytes += payload.size();
+      std::swap(sent[c], filtered[c]);
+    }
+    payload.clear();
+    ASSERT_TRUE(codec.encode(&previous_state, state, payload));
+    unfiltered_bytes += payload.size() * CLIENT_COUNT;
+    previous_state = state;
+  }
+
+  const auto average_relevant = static_cast<f64>(relevant_count) / (TICK_COUNT * CLIENT_COUNT);
+  std::printf(
+    "%u entities, %u clients: update + filter %.3f ms/tick, %.1f relevant entities per client, %llu B/tick "
+    "filtered vs %llu B/tick unfiltered\n",
+    ENTITY_COUNT,
+    CLIENT_COUNT,
+    filter_ms / TICK_COUNT,
+    average_relevant,
+    static_cast<unsigned long long>(filtered_bytes / TICK_COUNT),
+    static_cast<unsigned long long>(unfiltered_bytes / TICK_COUNT)
+  );
+  EXPECT_LT(average_relevant, ENTITY_COUNT / 20.0);
+  EXPECT_GT(average_relevant, 1.0);
+  EXPECT_LT(filtered_bytes, unfiltered_bytes);
+}
@@ -0,0 +1,221 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstdio>
+#include <enet.h>
+#include <glm/gtc/quaternion.hpp>
+#include <random>
+#include <vector>
+
+#include "Core/Base.hpp"
+#include "Memory/Buffer.hpp"
+#include "Networking/NetCompression.hpp"
+#include "Scene/Components.hpp"
+#include "Scene/SnapshotCodec.hpp"
+
+using namespace ox;
+
+namespace {
+struct NetTransform {
+  glm::vec3 position = {};
+  glm::quat rotation = {1.f, 0.f, 0.f, 0.f};
+  glm::vec3 scale = {1.f, 1.f, 1.f};
+};
+
+struct NetHealth {
+  i32 value = 100;
+  u32 team = 0;
+};
+} // namespace
+
+class NetCompressionTest : public ::testing::Test {
+protected:
+  static auto SetUpTestSuite() -> void { ASSERT_EQ(enet_initialize(), 0); }
+  static auto TearDownTestSuite() -> void { enet_deinitialize(); }
+
+  void SetUp() override {
+    world.component<glm::vec3>("glm::vec3")
+      .member("x", &glm::vec3::x)
+      .member("y", &glm::vec3::y)
+      .member("z", &glm::vec3::z);
+    world.component<glm::quat>("glm::quat")
+      .member("x", &glm::quat::x)
+      .member("y", &glm::quat::y)
+      .member("z", &glm::quat::z)
+      .member("w", &glm::quat::w);
+    world.component<NetTransform>("NetTransform")
+      .member("position", &NetTransform::position)
+      .member("rotation", &NetTransform::rotation)
+      .member("scale", &NetTransform::scale)
+      .add<Networked>();
+    world.component<NetHealth>("NetHealth")
+      .member("value", &NetHealth::value)
+      .member("team", &NetHealth::team)
+      .add<Networked>();
+  }
+
+  // Full snapshots of a crowd walking around, the way a joining client or one that lost its
+  // baseline gets them.
+  auto record_snapshots(u32 entity_count, u32 tick_count) -> std::vector<std::vector<u8>> {
+    auto position = std::uniform_real_distribution<f32>(-200.f, 200.f);
+    auto velocity = std::uniform_real_distribution<f32>(-0.5f, 0.5f);
+    auto entities = std::vector<flecs::entity>{};
+    auto velocities = std::vector<glm::vec3>{};
+    for (u32 i = 0; i < entity_count; i++) {
+      entities.push_back(
+        world.entity()
+          .set<NetTransform>({.position = {position(rng), 0.f, position(rng)}})
+          .set<NetHealth>({.value = 100, .team = i % 4})
+      );
+      velocities.push_back({velocity(rng), 0.f, velocity(rng)});
+    }
+
+    const auto codec = SnapshotCodec::from_world(world);
+    auto snapshots = std::vector<std::vector<u8>>{};
+    auto state = SceneState{};
+    auto payload = std::vector<u8>{};
+    for (u32 tick = 0; tick < tick_count; tick++) {
+      for (u32 i = 0; i < entity_count; i++) {
+        auto& transform = entities[i].get_mut<NetTransform>();
+        transform.position += velocities[i];
+        transform.rotation = glm::angleAxis(0.01f * static_cast<f32>(tick + i), glm::vec3(0.f, 1.f, 0.f));
+      }
+      if (tick % 10 == 0) {
+        entities[tick % entity_count].get_mut<NetHealth>().value -= 5;
+      }
+
+      SceneSnapshotBuilder::take_snapshot(world, state);
+      payload.clear();
+      EXPECT_TRUE(codec.encode(nullptr, state, payload));
+
+      auto packet = NetPacket::scene_delta({.sequence = static_cast<u8>(tick), .payload = payload});
+      EXPECT_TRUE(packet.has_value());
+      snapshots.emplace_back(packet->inner->data, packet->inner->data + packet->inner->dataLength);
+      packet->destroy();
+    }
+
+    return snapshots;
+  }
+
+  static auto make_packet(std::span<const u8> bytes) -> NetPacket {
+    auto* inner = enet_packet_create(bytes.data(), bytes.size(), ENET_PACKET_FLAG_RELIABLE);
+    return NetPacket::from_packet(inner).value();
+  }
+
+  // Compresses every packet and checks it comes back the same.
+  static auto round_trip(NetCompressor& compressor, NetCompression codec, std::span<const std::vector<u8>> packets)
+    -> bool {
+    for (const auto& bytes : packets) {
+      auto packet = make_packet(bytes);
+      compressor.compress(packet, codec);
+      auto decompressed = compressor.decompress(packet, codec);
+      auto same = false;
+      if (decompressed.has_value()) {
+        same = std::ranges::equal(bytes, std::span(decompressed->inner->data, decompressed->inner->dataLength));
+        enet_packet_destroy(decompressed->inner);
+      }
+      packet.destroy();
+      if (!same) {
+        return false;
+      }
+    }
+
+    return true;
+  }
+
+  flecs::world world = {};
+  std::mt19937 rng{7};
+};
+
+TEST_F(NetCompressionTest, RoundTripsAndNegotiates) {
+  const auto snapshots = record_snapshots(64, 8);
+
+  auto compressor = NetCompressor{};
+  EXPECT_TRUE(round_trip(compressor, NetCompression::LZ4, snapshots));
+  EXPECT_TRUE(round_trip(compressor, NetCompression::Zstd, snapshots));
+  EXPECT_EQ(compressor.stats.compressed_packets, snapshots.size() * 2);
+
+  // Too small to bother with.
+  auto small = make_packet(std::span(snapshots[0]).first(compressor.threshold - 1));
+  EXPECT_FALSE(compressor.compress(small, NetCompression::Zstd));
+  EXPECT_NE(small.type, NetPacketType::Compressed);
+  small.destroy();
+
+  // Cut short, it has to be rejected rather than read past the end.
+  auto packet = make_packet(snapshots[0]);
+  ASSERT_TRUE(compressor.compress(packet, NetCompression::LZ4));
+  auto truncated = make_packet(std::span(packet.inner->data, packet.inner->dataLength / 2));
+  EXPECT_FALSE(compressor.decompress(truncated, NetCompression::LZ4).has_value());
+  truncated.destroy();
+
+  // Only the codec negotiated with the sender is accepted.
+  EXPECT_FALSE(compressor.decompress(packet, NetCompression::Zstd).has_value());
+  EXPECT_FALSE(compressor.decompress(packet, NetCompression::None).has_value());
+  packet.destroy();
+
+  // A few bytes claiming to expand to megabytes are turned away before anything is allocated.
+  auto bomb = std::array<u8, 32>{};
+  auto bomb_writer = BufferWriter(bomb);
+  bomb_writer.write(NetPacketType::Compressed);
+  bomb_writer.write(NetCompression::LZ4);
+  ASSERT_TRUE(bomb_writer.write_varint(NetCompressor::MAX_DECOMPRESSED_SIZE));
+  auto bomb_packet = make_packet(bomb);
+  EXPECT_FALSE(compressor.decompress(bomb_packet, NetCompression::LZ4).has_value());
+  bomb_packet.destroy();
+
+  // Zstd needs the same dictionary on both ends, otherwise it falls back to LZ4.
+  auto remote = NetCompressor{};
+  EXPECT_EQ(compressor.negotiate(remote.supported(), remote.dictionary_id()), NetCompression::Zstd);
+  EXPECT_EQ(compressor.negotiate(remote.supported(), 1234), NetCompression::LZ4);
+  remote.enable_lz4 = false;
+  EXPECT_EQ(compressor.negotiate(remote.supported(), 1234), NetCompression::None);
+  EXPECT_EQ(compressor.negotiate(0, 0), NetCompression::None);
+}
+
+// Trains a dictionary on half of the recorded snapshots and compresses the other half with every
+// codec, reporting the ratio and the time it took.
+TEST_F(NetCompressionTest, SnapshotCorpusBenchmark) {
+  const auto snapshots = record_snapshots(96, 1000);
+  const auto training = std::span(snapshots).first(snapshots.size() / 2);
+  const auto corpus = std::span(snapshots).subspan(snapshots.size() / 2);
+
+  auto dictionary = NetCompressor::train_dictionary(training, 16 * 1024);
+  ASSERT_FALSE(dictionary.empty());
+
+  auto measure = [&](const char* name, NetCompressor& compressor, NetCompression codec) {
+    const auto start = std::chrono::steady_clock::now();
+    EXPECT_TRUE(round_trip(compressor, codec, corpus)) << name;
+    const auto ms = std::chrono::duration<f64, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+    const auto& stats = compressor.stats;
+    std::printf(
+      "%-12s %zu snapshots of %.0f bytes: ratio %.2f, compress %.3f ms, decompress %.3f ms, total %.1f ms\n",
+      name,
+      corpus.size(),
+      static_cast<f64>(stats.raw_bytes) / static_cast<f64>(std::max(stats.compressed_packets, 1_u64)),
+      stats.ratio(),
+      stats.compress_ms / static_cast<f64>(corpus.size()),
+      stats.decompress_ms / static_cast<f64>(corpus.size()),
+      ms
+    );
+    EXPECT_EQ(stats.compressed_packets, corpus.size()) << name;
+
+    return stats.ratio();
+  };
+
+  auto lz4 = NetCompressor{};
+  auto zstd = NetCompressor{};
+  auto zstd_dictionary = NetCompressor{};
+  ASSERT_TRUE(zstd_dictionary.set_dictionary(std::move(dictionary)));
+  EXPECT_NE(zstd_dictionary.dictionary_id(), 0_u32);
+
+  const auto lz4_ratio = measure("lz4", lz4, NetCompression::LZ4);
+  const auto zstd_ratio = measure("zstd", zstd, NetCompression::Zstd);
+  const auto dictionary_ratio = measure("zstd+dict", zstd_dictionary, NetCompression::Zstd);
+
+  EXPECT_GT(lz4_ratio, 1.0);
+  EXPECT_GE(zstd_ratio, lz4_ratio);
+  EXPECT_GT(dictionary_ratio, zstd_ratio);
+}
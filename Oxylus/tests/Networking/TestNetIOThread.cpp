@@ -0,0 +1,368 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <enet.h>
+#include <numeric>
+#include <thread>
+#include <vector>
+
+#include "Core/App.hpp"
+#include "Memory/MPSCQueue.hpp"
+#include "Networking/NetIOThread.hpp"
+#include "Networking/NetworkManager.hpp"
+
+using namespace ox;
+
+TEST(NetIOQueueTest, MPSCKeepsEveryProducersOrder) {
+  constexpr u32 PRODUCER_COUNT = 4;
+  constexpr u32 VALUE_COUNT = 100000;
+  auto queue = MPSCQueue<u64>(256);
+
+  auto producers = std::vector<std::jthread>{};
+  for (u32 producer = 0; producer < PRODUCER_COUNT; producer++) {
+    producers.emplace_back([&queue, producer] {
+      for (u32 i = 0; i < VALUE_COUNT; i++) {
+        auto value = (static_cast<u64>(producer) << 32) | i;
+        while (!queue.try_push(std::move(value))) {
+          std::this_thread::yield();
+        }
+      }
+    });
+  }
+
+  auto next = std::vector<u32>(PRODUCER_COUNT, 0);
+  for (auto received = 0_u64; received < PRODUCER_COUNT * VALUE_COUNT;) {
+    auto value = queue.try_pop();
+    if (!value.has_value()) {
+      std::this_thread::yield();
+      continue;
+    }
+
+    const auto producer = static_cast<u32>(*value >> 32);
+    ASSERT_EQ(static_cast<u32>(*value), next[producer]);
+    next[producer] += 1;
+    received += 1;
+  }
+}
+
+namespace {
+// Records which clients the game thread was told about.
+struct ThreadedServer : NetServer {
+  std::vector<NetClientID> connected = {};
+  std::vector<NetClientID> disconnected = {};
+
+  ThreadedServer(NetTransport* transport_) : NetServer(transport_) {}
+
+  auto on_client_connect(NetClientID client_id) -> void override { connected.push_back(client_id); }
+  auto on_client_disconnect(NetClientID client_id) -> void override { disconnected.push_back(client_id); }
+};
+} // namespace
+
+class NetIOThreadTest : public ::testing::Test {
+protected:
+  static auto SetUpTestSuite() -> void { ASSERT_EQ(enet_initialize(), 0); }
+  static auto TearDownTestSuite() -> void { enet_deinitialize(); }
+
+  struct HitchResult {
+    f64 rtt_mean = 0.0;
+    u32 rtt_max = 0;
+    f64 tick_mean_ms = 0.0;
+    f64 tick_jitter_ms = 0.0;
+    f64 tick_max_ms = 0.0;
+  };
+
+  // A server whose game thread runs 16 ms frames with a 50 ms hitch every tenth one, and a client
+  // that never stalls streaming reliable packets at it. The client sees how long acks take.
+  static auto run_hitch(bool threaded) -> HitchResult {
+    constexpr u32 FRAME_COUNT = 60;
+    constexpr auto FRAME_TIME = std::chrono::milliseconds(16);
+    constexpr auto HITCH_TIME = std::chrono::milliseconds(50);
+
+    // Port 0 lets the OS pick a free one, read back from the bound host.
+    auto address = ENetAddress{.host = ENET_HOST_ANY, .port = 0, .sin6_scope_id = 0};
+    auto* server_host = enet_host_create(&address, 4, NET_CHANNEL_COUNT, 0, 0);
+    auto* client_host = enet_host_create(nullptr, 1, NET_CHANNEL_COUNT, 0, 0);
+    EXPECT_NE(server_host, nullptr);
+    EXPECT_NE(client_host, nullptr);
+    if (!server_host || !client_host) {
+      return {};
+    }
+
+    const auto port = server_host->address.port;
+    EXPECT_NE(port, 0);
+    auto server_io = std::make_unique<NetIOThread>(server_host);
+    auto client_io = std::make_unique<NetIOThread>(client_host);
+    if (threaded) {
+      server_io->start();
+    }
+    client_io->start();
+    client_io->push({.kind = NetIOCommandKind::Connect, .port = port, .host_name = "127.0.0.1"});
+
+    // The client side, it owns the consuming end of `client_io->events`.
+    auto rtts = std::vector<u32>{};
+    auto client_done = std::atomic<bool>(false);
+    auto client = std::jthread([&] {
+      ENetPeer* peer = nullptr;
+      auto stats_seen = 0_u32;
+      while (!client_done.load(std::memory_order_relaxed)) {
+        while (auto event = client_io->events.try_pop()) {
+          if (event->kind == NetEventKind::Connect) {
+            peer = event->peer;
+          } else if (event->kind == NetEventKind::Stats && ++stats_seen > 3) {
+            // The first few still carry ENet's initial guess.
+            rtts.push_back(event->counters.rtt);
+          } else if (event->packet) {
+            enet_packet_destroy(event->packet);
+          }
+        }
+
+        if (peer) {
+          const auto payload = std::array<u8, 64>{};
+          client_io->send(peer, enet_packet_create(payload.data(), payload.size(), 0), true);
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+      }
+    });
+
+    auto tick_times = std::vector<f64>{};
+    auto event = ENetEvent{};
+    for (u32 frame = 0; frame < FRAME_COUNT; frame++) {
+      const auto start = std::chrono::steady_clock::now();
+      if (threaded) {
+        while (auto io_event = server_io->events.try_pop()) {
+          if (io_event->packet) {
+            enet_packet_destroy(io_event->packet);
+          }
+        }
+      } else {
+        while (enet_host_service(server_host, &event, 0) > 0) {
+          if (event.type == ENET_EVENT_TYPE_RECEIVE) {
+            enet_packet_destroy(event.packet);
+          }
+        }
+      }
+      tick_times.push_back(std::chrono::duration<f64, std::milli>(std::chrono::steady_clock::now() - start).count());
+
+      std::this_thread::sleep_for(frame % 10 == 9 ? HITCH_TIME : FRAME_TIME);
+    }
+
+    client_done = true;
+    client.join();
+    client_io.reset();
+    server_io.reset();
+    enet_host_destroy(client_host);
+    enet_host_destroy(server_host);
+
+    auto result = HitchResult{};
+    EXPECT_FALSE(rtts.empty());
+    if (!rtts.empty()) {
+      result.rtt_mean = std::accumulate(rtts.begin(), rtts.end(), 0.0) / static_cast<f64>(rtts.size());
+      result.rtt_max = std::ranges::max(rtts);
+    }
+
+    result.tick_mean_ms = std::accumulate(tick_times.begin(), tick_times.end(), 0.0) / FRAME_COUNT;
+    auto variance = 0.0;
+    for (const auto time : tick_times) {
+      variance += (time - result.tick_mean_ms) * (time - result.tick_mean_ms);
+    }
+    result.tick_jitter_ms = std::sqrt(variance / FRAME_COUNT);
+    result.tick_max_ms = std::ranges::max(tick_times);
+
+    return result;
+  }
+};
+
+TEST_F(NetIOThreadTest, HitchBenchmark) {
+  const auto inline_result = run_hitch(false);
+  const auto threaded_result = run_hitch(true);
+
+  const auto print = [](const char* mode, const HitchResult& result) {
+    std::printf(
+      "%s: rtt mean %.1f ms max %u ms, network tick mean %.3f ms jitter %.3f ms max %.3f ms\n",
+      mode,
+      result.rtt_mean,
+      result.rtt_max,
+      result.tick_mean_ms,
+      result.tick_jitter_ms,
+      result.tick_max_ms
+    );
+  };
+  print("main thread", inline_result);
+  // Acks no longer wait for the next frame, let alone the end of a hitch. Timings depend on the
+  // machine, so they are only reported.
+  print("I/O thread", threaded_result);
+}
+
+// The game thread stalls while more packets arrive than `events` holds. The I/O thread keeps
+// servicing the host and holds the rest back, they all come out, in order, once the game thread
+// drains again.
+TEST_F(NetIOThreadTest, HoldsEventsBackWhileTheGameThreadStalls) {
+  constexpr u32 PACKET_COUNT = NetIOThread::EVENT_CAPACITY + 2000;
+
+  auto address = ENetAddress{.host = ENET_HOST_ANY, .port = 0, .sin6_scope_id = 0};
+  auto* server_host = enet_host_create(&address, 1, NET_CHANNEL_COUNT, 0, 0);
+  auto* client_host = enet_host_create(nullptr, 1, NET_CHANNEL_COUNT, 0, 0);
+  ASSERT_NE(server_host, nullptr);
+  ASSERT_NE(client_host, nullptr);
+
+  auto server_io = std::make_unique<NetIOThread>(server_host);
+  auto client_io = std::make_unique<NetIOThread>(client_host);
+  server_io->start();
+  client_io->start();
+  client_io->push({.kind = NetIOCommandKind::Connect, .port = server_host->address.port, .host_name = "127.0.0.1"});
+
+  const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+  ENetPeer* peer = nullptr;
+  while (!peer && std::chrono::steady_clock::now() < deadline) {
+    while (auto event = client_io->events.try_pop()) {
+      if (event->kind == NetEventKind::Connect) {
+        peer = event->peer;
+      }
+    }
+    std::this_thread::yield();
+  }
+  ASSERT_NE(peer, nullptr);
+
+  for (u32 i = 0; i < PACKET_COUNT; i++) {
+    client_io->send(peer, enet_packet_create(&i, sizeof(i), 0), true);
+  }
+  std::this_thread::sleep_for(std::chrono::seconds(1));
+
+  auto received = 0_u32;
+  auto in_order = true;
+  while (received < PACKET_COUNT && std::chrono::steady_clock::now() < deadline + std::chrono::seconds(5)) {
+    while (auto event = server_io->events.try_pop()) {
+      if (event->kind != NetEventKind::Receive) {
+        continue;
+      }
+
+      auto index = 0_u32;
+      std::memcpy(&index, event->packet->data, sizeof(index));
+      in_order = in_order && index == received;
+      received += 1;
+      enet_packet_destroy(event->packet);
+    }
+    std::this_thread::yield();
+  }
+  EXPECT_EQ(received, PACKET_COUNT);
+  EXPECT_TRUE(in_order);
+
+  client_io.reset();
+  server_io.reset();
+  enet_host_destroy(client_host);
+  enet_host_destroy(server_host);
+}
+
+// A server and a client made by `NetworkManager` with `threaded_io` set, talking over a socket on
+// localhost. ENet runs on their I/O threads, everything handed to user code comes out of `tick`.
+class NetThreadedIOTest : public ::testing::Test {
+protected:
+  // ENet keeps its own allocator, `NetworkManager::init` would point it at a pool that goes away
+  // with the fixture.
+  static auto SetUpTestSuite() -> void { ASSERT_EQ(enet_initialize(), 0); }
+  static auto TearDownTestSuite() -> void { enet_deinitialize(); }
+
+  void SetUp() override {
+    loguru::g_stderr_verbosity = loguru::Verbosity_WARNING;
+
+    // The net code reports through the app's event system.
+    static char arg0[] = "NetThreadedIOTest";
+    static char* test_argv[] = {arg0, nullptr};
+    app = std::make_unique<App>(1, test_argv);
+
+    manager.threaded_io = true;
+  }
+
+  void TearDown() override {
+    while (!manager.clients.empty()) {
+      manager.destroy_client(manager.clients.back().get());
+    }
+    while (!manager.servers.empty()) {
+      manager.destroy_server(manager.servers.back().get());
+    }
+    app.reset();
+  }
+
+  // Ticks both ends until `done` holds, for at most five seconds.
+  template <typename F>
+  auto pump(NetServer* server, NetClient* client, F&& done) -> bool {
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+    while (std::chrono::steady_clock::now() < deadline) {
+      server->tick(ts);
+      client->tick(ts);
+      if (done()) {
+        return true;
+      }
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+
+    return false;
+  }
+
+  std::unique_ptr<App> app = nullptr;
+  NetworkManager manager = {};
+  Timestep ts = {};
+};
+
+TEST_F(NetThreadedIOTest, ConnectsCallsAndDisconnects) {
+  // Port 0 lets the OS pick a free one.
+  auto* server = manager.create_server<ThreadedServer>(0, 4);
+  auto* client = manager.create_client();
+  ASSERT_NE(server, nullptr);
+  ASSERT_NE(client, nullptr);
+
+  auto* server_transport = static_cast<EnetTransport*>(server->transport);
+  auto* client_transport = static_cast<EnetTransport*>(client->transport);
+  ASSERT_NE(server_transport->io_thread, nullptr);
+  ASSERT_NE(client_transport->io_thread, nullptr);
+  EXPECT_TRUE(server_transport->io_thread->is_running());
+  EXPECT_TRUE(client_transport->io_thread->is_running());
+
+  const auto game_thread = std::this_thread::get_id();
+  auto off_thread_calls = std::atomic<u32>(0);
+  auto pings = std::vector<f64>{};
+  auto pongs = std::vector<f64>{};
+  server->register_proc("ping", [&](NetClientID client_id, std::span<RPCParameter> params) {
+    off_thread_calls += std::this_thread::get_id() != game_thread;
+    pings.push_back(std::get<f64>(params[0].value));
+    const auto reply = std::array{RPCParameter{.value = pings.back() * 2.0}};
+    server->call_client(client_id, "pong", reply, true);
+  });
+  client->register_proc("pong", [&](NetClientID, std::span<RPCParameter> params) {
+    off_thread_calls += std::this_thread::get_id() != game_thread;
+    pongs.push_back(std::get<f64>(params[0].value));
+  });
+
+  ASSERT_TRUE(client->connect("127.0.0.1", server_transport->host->address.port, 5000.0));
+  // The server's handshake lists its procs, they are in once it arrived.
+  ASSERT_TRUE(pump(server, client, [&] {
+    return client->status == NetClientStatus::Connected && !client->remote_proc_ids.empty() &&
+           server->connected.size() == 1;
+  }));
+  EXPECT_EQ(server->client_ids().size(), 1_sz);
+
+  const auto ping = std::array{RPCParameter{.value = 21.0}};
+  ASSERT_TRUE(client->call_server("ping", ping, true));
+  ASSERT_TRUE(pump(server, client, [&] { return !pongs.empty(); }));
+  EXPECT_EQ(pings, std::vector<f64>{21.0});
+  EXPECT_EQ(pongs, std::vector<f64>{42.0});
+  EXPECT_EQ(off_thread_calls.load(), 0u);
+
+  client->disconnect(false);
+  ASSERT_TRUE(pump(server, client, [&] {
+    return client->status == NetClientStatus::Disconnected && server->disconnected.size() == 1;
+  }));
+  EXPECT_EQ(server->disconnected.front(), server->connected.front());
+  EXPECT_TRUE(server->client_ids().empty());
+
+  // Stopping the I/O threads runs what is still queued before the hosts go away.
+  manager.destroy_client(client);
+  manager.destroy_server(server);
+  EXPECT_TRUE(manager.transports.empty());
+}
@@ -0,0 +1,258 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <enet.h>
+#include <numeric>
+#include <random>
+#include <vector>
+
+#include "Core/App.hpp"
+#include "Networking/LoopbackTransport.hpp"
+#include "Networking/NetServer.hpp"
+#include "Scene/Components.hpp"
+#include "Scene/SnapshotCapture.hpp"
+#include "Scene/SnapshotCodec.hpp"
+
+using namespace ox;
+using namespace std::literals;
+
+namespace {
+struct LoadTransform {
+  f32 x = 0.f;
+  f32 y = 0.f;
+  f32 z = 0.f;
+  f32 yaw = 0.f;
+};
+
+struct LoadConfig {
+  u32 client_count = 32;
+  u32 entity_count = 500;
+  u32 tick_count = 300;
+  f64 tick_rate = 30.0;
+  // Calls each client makes every tick, the server answers with one broadcast per tick.
+  u32 rpcs_per_tick = 2;
+  NetLinkConditions conditions = {};
+};
+
+struct LoadResult {
+  u32 connected_clients = 0;
+  u64 snapshots_received = 0;
+  u64 rpcs_received = 0;
+  f64 down_bytes_per_client_second = 0.0;
+  f64 up_bytes_per_client_second = 0.0;
+  f64 server_tick_mean_ms = 0.0;
+  f64 server_tick_p99_ms = 0.0;
+  f64 snapshot_latency_p99_ms = 0.0;
+  f64 rpc_latency_p99_ms = 0.0;
+};
+
+auto percentile(std::vector<f64> values, f64 fraction) -> f64 {
+  if (values.empty()) {
+    return 0.0;
+  }
+
+  const auto index = static_cast<usize>(fraction * static_cast<f64>(values.size() - 1));
+  std::ranges::nth_element(values, values.begin() + static_cast<std::ptrdiff_t>(index));
+  return values[index];
+}
+
+// Measures how long after the server sent it each snapshot got decoded.
+struct LoadClient : NetClient {
+  const LoopbackNetwork* network = nullptr;
+  const std::array<f64, 256>* snapshot_sent_at = nullptr;
+  std::vector<f64>* snapshot_latencies = nullptr;
+  u64 snapshots_received = 0;
+
+  LoadClient(NetTransport* transport_) : NetClient(transport_) {}
+
+  auto on_scene_snapshot(u8 sequence, const SceneState&) -> void override {
+    snapshots_received += 1;
+    snapshot_latencies->push_back(network->now_ms - (*snapshot_sent_at)[sequence]);
+  }
+};
+} // namespace
+
+// One server and a crowd of clients on a simulated link, run for a fixed number of ticks on
+// simulated time. Nothing touches a socket, so it runs the same in CI as anywhere else.
+class NetLoadTest : public ::testing::Test {
+protected:
+  constexpr static u16 PORT = 7777;
+
+  static auto SetUpTestSuite() -> void { ASSERT_EQ(enet_initialize(), 0); }
+  static auto TearDownTestSuite() -> void { enet_deinitialize(); }
+
+  void SetUp() override {
+    loguru::g_stderr_verbosity = loguru::Verbosity_WARNING;
+
+    // The net code reports through the app's event system.
+    static char arg0[] = "NetLoadTest";
+    static char* test_argv[] = {arg0, nullptr};
+    app = std::make_unique<App>(1, test_argv);
+
+    world.component<LoadTransform>("LoadTransform")
+      .member("x", &LoadTransform::x)
+      .member("y", &LoadTransform::y)
+      .member("z", &LoadTransform::z)
+      .member("yaw", &LoadTransform::yaw)
+      .add<Networked>();
+  }
+
+  void TearDown() override { app.reset(); }
+
+  auto run(const LoadConfig& config) -> LoadResult {
+    const auto tick_ms = 1000.0 / config.tick_rate;
+    auto network = LoopbackNetwork(1234);
+    network.conditions = config.conditions;
+    auto rng = std::mt19937(1234);
+    auto step = std::uniform_real_distribution<f32>(-0.5f, 0.5f);
+    auto ts = Timestep{};
+
+    auto entities = std::vector<flecs::entity>{};
+    for (u32 i = 0; i < config.entity_count; i++) {
+      entities.push_back(world.entity().set<LoadTransform>({.x = step(rng) * 100.f, .z = step(rng) * 100.f}));
+    }
+    const auto codec = SnapshotCodec::from_world(world);
+    auto capture = SnapshotCapture{};
+    auto snapshots = SceneSnapshotBuilder{};
+    auto snapshot_sent_at = std::array<f64, 256>{};
+    auto snapshot_latencies = std::vector<f64>{};
+    auto rpc_latencies = std::vector<f64>{};
+
+    auto server_transport = LoopbackTransport(network, PORT);
+    auto server = NetServer(&server_transport);
+    server.register_proc("load_input", [&](NetClientID, std::span<RPCParameter> params) {
+      rpc_latencies.push_back(network.now_ms - std::get<f64>(params[0].value));
+    });
+
+    auto client_transports = std::vector<std::unique_ptr<LoopbackTransport>>{};
+    auto clients = std::vector<std::unique_ptr<LoadClient>>{};
+    auto rpcs_received = 0_u64;
+    for (u32 i = 0; i < config.client_count; i++) {
+      auto& transport = client_transports.emplace_back(std::make_unique<LoopbackTransport>(network));
+      auto& client = clients.emplace_back(std::make_unique<LoadClient>(transport.get()));
+      client->network = &network;
+      client->snapshot_sent_at = &snapshot_sent_at;
+      client->snapshot_latencies = &snapshot_latencies;
+      client->snapshot_codec = &codec;
+      client->register_proc("load_event", [&](NetClientID, std::span<RPCParameter> params) {
+        rpcs_received += 1;
+        rpc_latencies.push_back(network.now_ms - std::get<f64>(params[0].value));
+      });
+      client->connect("loopback", PORT, 5000.0);
+    }
+
+    auto server_tick_ms = std::vector<f64>{};
+    for (u32 tick = 0; tick < config.tick_count; tick++) {
+      network.advance(tick_ms);
+
+      const auto start = std::chrono::steady_clock::now();
+      server.tick(ts);
+      for (u32 i = tick % 4; i < entities.size(); i += 4) {
+        auto& transform = entities[i].get_mut<LoadTransform>();
+        transform.x += step(rng);
+        transform.z += step(rng);
+        transform.yaw += 0.05f;
+        entities[i].modified<LoadTransform>();
+      }
+      capture.capture(world, snapshots);
+      snapshot_sent_at[snapshots.current_sequence] = network.now_ms;
+      server.send_snapshots(snapshots, codec);
+      snapshots.advance();
+
+      const auto event_params = std::array{RPCParameter{.value = network.now_ms}, RPCParameter{.value = "tick"sv}};
+      server.broadcast_call("load_event", event_params, true);
+      server.flush_rpcs();
+      const auto server_time = std::chrono::steady_clock::now() - start;
+      server_tick_ms.push_back(std::chrono::duration<f64, std::milli>(server_time).count());
+
+      for (auto& client : clients) {
+        client->tick(ts);
+        if (client->status != NetClientStatus::Connected) {
+          continue;
+        }
+
+        for (u32 call = 0; call < config.rpcs_per_tick; call++) {
+          const auto input_params = std::array{
+            RPCParameter{.value = network.now_ms},
+            RPCParameter{.value = step(rng)},
+            RPCParameter{.value = step(rng)},
+          };
+          client->call_server("load_input", input_params, false);
+        }
+        client->flush_rpcs();
+      }
+    }
+
+    auto result = LoadResult{.rpcs_received = rpcs_received};
+    const auto seconds = static_cast<f64>(config.tick_count) * tick_ms * 0.001;
+    auto down_bytes = 0.0;
+    auto up_bytes = 0.0;
+    for (auto& client : clients) {
+      result.snapshots_received += client->snapshots_received;
+      if (client->status == NetClientStatus::Connected) {
+        result.connected_clients += 1;
+      }
+
+      if (auto counters = client->transport->peer_counters(client->remote_peer)) {
+        down_bytes += static_cast<f64>(counters->received_bytes);
+        up_bytes += static_cast<f64>(counters->sent_bytes);
+      }
+    }
+
+    result.down_bytes_per_client_second = down_bytes / config.client_count / seconds;
+    result.up_bytes_per_client_second = up_bytes / config.client_count / seconds;
+    result.server_tick_mean_ms = std::accumulate(server_tick_ms.begin(), server_tick_ms.end(), 0.0) /
+                                 static_cast<f64>(server_tick_ms.size());
+    result.server_tick_p99_ms = percentile(server_tick_ms, 0.99);
+    result.snapshot_latency_p99_ms = percentile(snapshot_latencies, 0.99);
+    result.rpc_latency_p99_ms = percentile(rpc_latencies, 0.99);
+
+    return result;
+  }
+
+  static auto print(const char* name, const LoadResult& result) -> void {
+    std::printf(
+      "%s: %u clients, down %.0f B/s up %.0f B/s per client, server tick mean %.3f ms p99 %.3f ms, "
+      "p99 latency snapshots %.1f ms rpcs %.1f ms\n",
+      name,
+      result.connected_clients,
+      result.down_bytes_per_client_second,
+      result.up_bytes_per_client_second,
+      result.server_tick_mean_ms,
+      result.server_tick_p99_ms,
+      result.snapshot_latency_p99_ms,
+      result.rpc_latency_p99_ms
+    );
+  }
+
+  std::unique_ptr<App> app = nullptr;
+  flecs::world world;
+};
+
+TEST_F(NetLoadTest, PerfectLinkDeliversEverything) {
+  const auto config = LoadConfig{.client_count = 4, .entity_count = 50, .tick_count = 60};
+  const auto result = run(config);
+  print("perfect link", result);
+
+  EXPECT_EQ(result.connected_clients, config.client_count);
+  EXPECT_GT(result.snapshots_received, 0_u64);
+  EXPECT_GT(result.rpcs_received, 0_u64);
+  // Nothing on the wire takes time, what is left is waiting for the next tick to flush.
+  EXPECT_LE(result.rpc_latency_p99_ms, 1000.0 / config.tick_rate + 1e-6);
+}
+
+TEST_F(NetLoadTest, BadLinkBenchmark) {
+  const auto config = LoadConfig{
+    .conditions = {.latency_ms = 50.0, .jitter_ms = 20.0, .loss = 0.05, .duplication = 0.01, .bandwidth = 256 * 1024},
+  };
+  const auto result = run(config);
+  print("bad link", result);
+
+  EXPECT_EQ(result.connected_clients, config.client_count);
+  EXPECT_GT(result.snapshots_received, 0_u64);
+  // Snapshots keep coming through loss, deltas fall back to whatever baseline was acked last.
+  EXPECT_GT(result.snapshots_received, config.client_count * config.tick_count / 2);
+  EXPECT_GE(result.snapshot_latency_p99_ms, config.conditions.latency_ms);
+}
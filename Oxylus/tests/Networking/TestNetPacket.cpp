@@ -1,6 +1,7 @@
 #include <algorithm>
 #include <ankerl/unordered_dense.h>
 #include <array>
+#include <cstdio>
 #include <cstring>
 #include <enet.h>
 #include <gmock/gmock.h>
@@ -29,16 +30,16 @@ protected:
   static auto make_test_state() -> ox::SceneState {
     auto state = ox::SceneState{};
 
-    auto entity = ox::EntityState{.entity_id = 42};
-    entity.components.emplace(7, ox::ComponentState{.id = 7, .hash = 0xabcdef_u64, .buffer = {1, 2, 3, 4, 5}});
+    const auto bytes = std::array<u8, 5>{1, 2, 3, 4, 5};
+    state.push_entity(42);
+    state.push_component(7, 0xabcdef_u64, bytes);
     // A tag, no data attached to it.
-    entity.components.emplace(9, ox::ComponentState{.id = 9, .hash = ~0_u64, .buffer = {}});
-    entity.removed_components.emplace(11);
-    state.entities.emplace(42, std::move(entity));
+    state.push_component(9, ~0_u64, {});
+    state.removed_components.push_back({.entity_id = 42, .id = 11});
 
     // An entity that only exists, without any component changes.
-    state.entities.emplace(43, ox::EntityState{.entity_id = 43});
-    state.removed_entities.emplace(1337);
+    state.push_entity(43);
+    state.removed_entities.push_back(1337);
 
     return state;
   }
@@ -61,6 +62,31 @@ TEST_F(NetPacketTest, HandshakeRoundTrip) {
   EXPECT_EQ(info->net_id, 0xdeadbeefcafe_u64);
 }
 
+TEST_F(NetPacketTest, SceneDeltaPayloadIsReadInPlace) {
+  const auto payload = std::vector<u8>{9, 8, 7, 6, 5, 4, 3, 2, 1};
+  auto sent = ox::NetPacket::scene_delta({
+    .sequence = 200,
+    .has_baseline = true,
+    .baseline_sequence = 190,
+    .payload = payload,
+  });
+  ASSERT_TRUE(sent.has_value());
+  OX_DEFER(&) { sent->destroy(); };
+
+  auto received = receive(sent.value());
+  ASSERT_TRUE(received.has_value());
+  auto delta = received->get_scene_delta();
+  ASSERT_TRUE(delta.has_value());
+  EXPECT_EQ(delta->sequence, 200);
+  EXPECT_TRUE(delta->has_baseline);
+  EXPECT_EQ(delta->baseline_sequence, 190);
+  EXPECT_THAT(delta->payload, testing::ElementsAreArray(payload));
+
+  // A view of the received packet, nothing was copied out of it.
+  const auto* packet_end = sent->inner->data + sent->inner->dataLength;
+  EXPECT_EQ(delta->payload.data() + delta->payload.size(), packet_end);
+}
+
 TEST_F(NetPacketTest, ClientAckRoundTrip) {
   auto sent = ox::NetPacket::client_ack({.acked = 17});
   ASSERT_TRUE(sent.has_value());
@@ -108,29 +134,41 @@ TEST_F(NetPacketTest, SceneSnapshotRoundTrip) {
 
   const auto& result = snapshot->state;
   ASSERT_EQ(result.entities.size(), 2_sz);
-  ASSERT_TRUE(result.entities.contains(42));
-  ASSERT_TRUE(result.entities.contains(43));
-  EXPECT_THAT(result.removed_entities, testing::UnorderedElementsAre(1337));
+  ASSERT_TRUE(result.contains(42));
+  ASSERT_TRUE(result.contains(43));
+  EXPECT_THAT(result.removed_entities, testing::ElementsAre(1337));
+  EXPECT_TRUE(result.was_removed(42, 11));
 
-  const auto& entity = result.entities.at(42);
+  const auto& entity = *result.find(42);
   EXPECT_EQ(entity.entity_id, 42_u64);
-  ASSERT_EQ(entity.components.size(), 2_sz);
-  EXPECT_THAT(entity.removed_components, testing::UnorderedElementsAre(11));
+  ASSERT_EQ(result.components_of(entity).size(), 2_sz);
 
-  const auto& component = entity.components.at(7);
+  const auto& component = *result.find_component(entity, 7);
   EXPECT_EQ(component.id, 7_u64);
   EXPECT_EQ(component.hash, 0xabcdef_u64);
-  EXPECT_THAT(component.buffer, testing::ElementsAre(1, 2, 3, 4, 5));
+  EXPECT_THAT(result.bytes_of(component), testing::ElementsAre(1, 2, 3, 4, 5));
 
-  const auto& tag = entity.components.at(9);
+  const auto& tag = *result.find_component(entity, 9);
   EXPECT_EQ(tag.id, 9_u64);
   EXPECT_EQ(tag.hash, ~0_u64);
-  EXPECT_TRUE(tag.buffer.empty());
+  EXPECT_TRUE(result.bytes_of(tag).empty());
 
-  const auto& empty_entity = result.entities.at(43);
+  const auto& empty_entity = *result.find(43);
   EXPECT_EQ(empty_entity.entity_id, 43_u64);
-  EXPECT_TRUE(empty_entity.components.empty());
-  EXPECT_TRUE(empty_entity.removed_components.empty());
+  EXPECT_TRUE(result.components_of(empty_entity).empty());
+}
+
+TEST_F(NetPacketTest, SceneSnapshotRejectsOutOfRangeComponents) {
+  auto state = make_test_state();
+  state.components.back().offset = 1000;
+
+  auto sent = ox::NetPacket::scene_snapshot(state, 4);
+  ASSERT_TRUE(sent.has_value());
+  OX_DEFER(&) { sent->destroy(); };
+
+  auto received = receive(sent.value());
+  ASSERT_TRUE(received.has_value());
+  EXPECT_FALSE(received->get_scene_snapshot().has_value());
 }
 
 TEST_F(NetPacketTest, SceneSnapshotRoundTripsEmptyState) {
@@ -176,9 +214,8 @@ TEST_F(NetPacketTest, SceneSnapshotRoundTripsComponentBufferLargerThanU16) {
   }
 
   auto state = ox::SceneState{};
-  auto entity = ox::EntityState{.entity_id = 1};
-  entity.components.emplace(2, ox::ComponentState{.id = 2, .hash = 3, .buffer = buffer});
-  state.entities.emplace(1, std::move(entity));
+  state.push_entity(1);
+  state.push_component(2, 3, buffer);
 
   auto sent = ox::NetPacket::scene_snapshot(state, 1);
   ASSERT_TRUE(sent.has_value());
@@ -190,7 +227,8 @@ TEST_F(NetPacketTest, SceneSnapshotRoundTripsComponentBufferLargerThanU16) {
   auto snapshot = received->get_scene_snapshot();
   ASSERT_TRUE(snapshot.has_value());
 
-  const auto& result = snapshot->state.entities.at(1).components.at(2).buffer;
+  const auto& result_state = snapshot->state;
+  const auto result = result_state.bytes_of(*result_state.find_component(*result_state.find(1), 2));
   ASSERT_EQ(result.size(), buffer_size);
   EXPECT_TRUE(std::ranges::equal(result, buffer));
 }
@@ -201,8 +239,9 @@ TEST_F(NetPacketTest, RPCRoundTripsEveryParameterType) {
   std::ranges::copy(uuid.bytes(), uuid_bytes.begin());
 
   const auto payload = std::array{0xdeadbeef_u32, 0xcafebabe_u32};
-  auto payload_bytes = std::vector<u8>(sizeof(payload));
-  std::memcpy(payload_bytes.data(), payload.data(), sizeof(payload));
+  auto payload_storage = std::vector<u8>(sizeof(payload));
+  std::memcpy(payload_storage.data(), payload.data(), sizeof(payload));
+  const auto payload_bytes = std::span<const u8>(payload_storage);
 
   const auto params = std::array{
     ox::RPCParameter{.value = std::monostate{}},
@@ -212,7 +251,7 @@ TEST_F(NetPacketTest, RPCRoundTripsEveryParameterType) {
     ox::RPCParameter{.value = -1234567890123_i64},
     ox::RPCParameter{.value = 1.5f},
     ox::RPCParameter{.value = 2.25},
-    ox::RPCParameter{.value = std::string("hello rpc")},
+    ox::RPCParameter{.value = "hello rpc"sv},
     ox::RPCParameter{.value = uuid_bytes},
     ox::RPCParameter{.value = payload_bytes},
   };
@@ -228,9 +267,14 @@ TEST_F(NetPacketTest, RPCRoundTripsEveryParameterType) {
 
   auto rpc = received->get_rpc();
   ASSERT_TRUE(rpc.has_value());
-  ASSERT_EQ(rpc->parameters.size(), params.size());
+  EXPECT_EQ(rpc->call_count, 1_u32);
 
-  const auto& result = rpc->parameters;
+  auto call = ox::NetRPCCall{};
+  ASSERT_TRUE(rpc->next({}, call));
+  ASSERT_EQ(call.parameters.size(), params.size());
+  EXPECT_FALSE(rpc->next({}, call));
+
+  const auto& result = call.parameters;
   EXPECT_TRUE(std::holds_alternative<std::monostate>(result[0].value));
   EXPECT_EQ(std::get<u8>(result[1].value), 200_u8);
   EXPECT_EQ(std::get<u16>(result[2].value), 40000_u16);
@@ -264,7 +308,10 @@ TEST_F(NetPacketTest, RPCRoundTripsWithoutParameters) {
 
   auto rpc = received->get_rpc();
   ASSERT_TRUE(rpc.has_value());
-  EXPECT_TRUE(rpc->parameters.empty());
+
+  auto call = ox::NetRPCCall{};
+  ASSERT_TRUE(rpc->next({}, call));
+  EXPECT_TRUE(call.parameters.empty());
 }
 
 TEST_F(NetPacketTest, RPCProcHashMatchesIdentifierHash) {
@@ -280,13 +327,122 @@ TEST_F(NetPacketTest, RPCProcHashMatchesIdentifierHash) {
   auto rpc = received->get_rpc();
   ASSERT_TRUE(rpc.has_value());
 
+  auto call = ox::NetRPCCall{};
+  ASSERT_TRUE(rpc->next({}, call));
+
   // This is how NetClient/NetServer::register_proc key their callbacks.
   const auto expected = ankerl::unordered_dense::detail::wyhash::hash(identifier.data(), identifier.size());
-  EXPECT_EQ(rpc->proc_hash, expected);
+  EXPECT_EQ(call.proc_hash, expected);
+}
+
+TEST_F(NetPacketTest, RPCBatchResolvesProcIdsAndHashes) {
+  const auto proc_hashes = std::array{111_u64, 222_u64, 333_u64};
+  const auto params = std::array{ox::RPCParameter{.value = 7_u8}, ox::RPCParameter{.value = "abc"sv}};
+  auto encoded_params = std::vector<u8>{};
+  ox::encode_rpc_parameters(params, encoded_params);
+
+  auto batch = ox::RPCBatch{};
+  batch.push(2_u32, proc_hashes[2], encoded_params);
+  // A proc the receiver didn't list in its handshake.
+  batch.push(ox::nullopt, 444_u64, {});
+  batch.push(0_u32, proc_hashes[0], encoded_params);
+
+  auto sent = ox::NetPacket::rpc_batch(batch);
+  ASSERT_TRUE(sent.has_value());
+  OX_DEFER(&) { sent->destroy(); };
+
+  auto received = receive(sent.value());
+  ASSERT_TRUE(received.has_value());
+  auto rpc = received->get_rpc();
+  ASSERT_TRUE(rpc.has_value());
+  ASSERT_EQ(rpc->call_count, 3_u32);
+
+  auto call = ox::NetRPCCall{};
+  const auto expected = std::array{333_u64, 444_u64, 111_u64};
+  for (const auto proc_hash : expected) {
+    ASSERT_TRUE(rpc->next(proc_hashes, call));
+    EXPECT_EQ(call.proc_hash, proc_hash);
+  }
+  EXPECT_FALSE(rpc->next(proc_hashes, call));
+
+  EXPECT_EQ(call.parameters.size(), 2_sz);
+  EXPECT_EQ(std::get<u8>(call.parameters[0].value), 7_u8);
+  EXPECT_EQ(call.parameters[1].as_str(), "abc"sv);
+}
+
+TEST_F(NetPacketTest, RPCBatchingBenchmark) {
+  // A chatty gameplay script: every tick it reports input, aim and a couple of ability uses.
+  constexpr u32 TICK_COUNT = 100;
+  const auto procs = std::array{"player_input"sv, "player_aim"sv, "use_ability"sv, "ping_marker"sv};
+  auto proc_hashes = std::vector<u64>{};
+  for (const auto proc : procs) {
+    proc_hashes.push_back(ankerl::unordered_dense::detail::wyhash::hash(proc.data(), proc.size()));
+  }
+
+  struct Call {
+    u32 proc = 0;
+    std::array<ox::RPCParameter, 3> params = {};
+  };
+  auto tick_calls = std::vector<Call>{};
+  for (u32 i = 0; i < 8; i++) {
+    tick_calls.push_back({.proc = 0, .params = {{{.value = static_cast<u8>(i)}, {.value = 1.0f}, {.value = -1.0f}}}});
+    tick_calls.push_back({.proc = 1, .params = {{{.value = 0.5f}, {.value = 0.25f}, {}}}});
+  }
+  tick_calls.push_back({.proc = 2, .params = {{{.value = 3_u8}, {.value = 1024_i32}, {}}}});
+  tick_calls.push_back({.proc = 3, .params = {{{.value = "enemy"sv}, {.value = 12_i32}, {.value = -40_i32}}}});
+
+  auto single_packets = 0_u32;
+  auto single_bytes = 0_sz;
+  auto batched_packets = 0_u32;
+  auto batched_bytes = 0_sz;
+  auto batched_calls = 0_u32;
+  auto encoded_params = std::vector<u8>{};
+  auto batch = ox::RPCBatch{};
+  for (u32 tick = 0; tick < TICK_COUNT; tick++) {
+    for (const auto& call : tick_calls) {
+      auto packet = ox::NetPacket::rpc(procs[call.proc], call.params);
+      ASSERT_TRUE(packet.has_value());
+      single_packets += 1;
+      single_bytes += packet->inner->dataLength;
+      packet->destroy();
+
+      encoded_params.clear();
+      ox::encode_rpc_parameters(call.params, encoded_params);
+      batch.push(call.proc, proc_hashes[call.proc], encoded_params);
+    }
+
+    auto packet = ox::NetPacket::rpc_batch(batch);
+    ASSERT_TRUE(packet.has_value());
+    OX_DEFER(&) { packet->destroy(); };
+    ASSERT_LE(packet->inner->dataLength, ox::RPCBatch::MAX_SIZE);
+    batched_packets += 1;
+    batched_bytes += packet->inner->dataLength;
+    batch.clear();
+
+    auto rpc = packet->get_rpc();
+    ASSERT_TRUE(rpc.has_value());
+    auto call = ox::NetRPCCall{};
+    while (rpc->next(proc_hashes, call)) {
+      batched_calls += 1;
+    }
+  }
+
+  std::printf(
+    "%u calls: %u packets / %zu bytes one per call, %u packets / %zu bytes batched\n",
+    single_packets,
+    single_packets,
+    single_bytes,
+    batched_packets,
+    batched_bytes
+  );
+
+  EXPECT_EQ(batched_calls, single_packets);
+  EXPECT_GE(single_packets, batched_packets * 5);
+  EXPECT_LT(batched_bytes, single_bytes);
 }
 
 TEST_F(NetPacketTest, RPCParameterAccessorsRejectMismatchedTypes) {
-  const auto param = ox::RPCParameter{.value = std::string("not a number")};
+  const auto param = ox::RPCParameter{.value = "not a number"sv};
 
   EXPECT_FALSE(param.as_f32().has_value());
   EXPECT_FALSE(param.as_int64().has_value());
@@ -358,19 +514,35 @@ TEST_F(NetPacketTest, GarbagePayloadIsRejected) {
 }
 
 TEST_F(NetPacketTest, ImplausibleContainerSizeIsRejected) {
-  // A hand rolled RPC packet claiming a billion parameters. Without an allocation limit on the
-  // deserializer this would try to allocate tens of gigabytes before looking at a single parameter.
-  auto [data, ser] = zpp::bits::data_out(zpp::bits::options::size_varint{});
-  ASSERT_FALSE(zpp::bits::failure(ser(ox::NetPacketType::RPC, 0_u64, zpp::bits::vsize_t{1'000'000'000})));
-
-  auto* raw = enet_packet_create(data.data(), data.size(), 0);
-  ASSERT_NE(raw, nullptr);
-  OX_DEFER(&) { enet_packet_destroy(raw); };
-
-  auto packet = ox::NetPacket::from_packet(raw);
-  ASSERT_TRUE(packet.has_value());
-  EXPECT_EQ(packet->type, ox::NetPacketType::RPC);
-  EXPECT_FALSE(packet->get_rpc().has_value());
+  // Hand rolled RPC packets claiming a billion calls, and one call with a billion parameters. Both
+  // have to be rejected before anything is sized by those counts.
+  auto [calls_data, calls_ser] = zpp::bits::data_out(zpp::bits::options::size_varint{});
+  ASSERT_FALSE(zpp::bits::failure(calls_ser(ox::NetPacketType::RPC, zpp::bits::vsize_t{1'000'000'000})));
+
+  auto* calls_raw = enet_packet_create(calls_data.data(), calls_data.size(), 0);
+  ASSERT_NE(calls_raw, nullptr);
+  OX_DEFER(&) { enet_packet_destroy(calls_raw); };
+
+  auto calls_packet = ox::NetPacket::from_packet(calls_raw);
+  ASSERT_TRUE(calls_packet.has_value());
+  EXPECT_EQ(calls_packet->type, ox::NetPacketType::RPC);
+  EXPECT_FALSE(calls_packet->get_rpc().has_value());
+
+  auto [params_data, params_ser] = zpp::bits::data_out(zpp::bits::options::size_varint{});
+  ASSERT_FALSE(zpp::bits::failure(params_ser(
+    ox::NetPacketType::RPC, zpp::bits::vsize_t{1}, zpp::bits::vsize_t{0}, 0_u64, zpp::bits::vsize_t{1'000'000'000}
+  )));
+
+  auto* params_raw = enet_packet_create(params_data.data(), params_data.size(), 0);
+  ASSERT_NE(params_raw, nullptr);
+  OX_DEFER(&) { enet_packet_destroy(params_raw); };
+
+  auto params_packet = ox::NetPacket::from_packet(params_raw);
+  ASSERT_TRUE(params_packet.has_value());
+  auto rpc = params_packet->get_rpc();
+  ASSERT_TRUE(rpc.has_value());
+  auto call = ox::NetRPCCall{};
+  EXPECT_FALSE(rpc->next({}, call));
 }
 
 TEST_F(NetPacketTest, UnknownPacketTypeIsNotClaimedByAnyGetter) {
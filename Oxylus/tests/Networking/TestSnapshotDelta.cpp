@@ -0,0 +1,393 @@
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <enet.h>
+#include <glm/gtc/quaternion.hpp>
+#include <random>
+#include <span>
+#include <vector>
+
+#include "Core/Base.hpp"
+#include "Networking/NetClient.hpp"
+#include "Scene/Components.hpp"
+#include "Scene/SnapshotCodec.hpp"
+
+using namespace ox;
+
+namespace {
+struct NetTransform {
+  glm::vec3 position = {};
+  glm::quat rotation = {1.f, 0.f, 0.f, 0.f};
+  glm::vec3 scale = {1.f, 1.f, 1.f};
+};
+
+// No floats, travels as raw words.
+struct NetHealth {
+  i32 value = 100;
+  u32 team = 0;
+};
+
+struct NetFrozen {};
+} // namespace
+
+class SnapshotDeltaTest : public ::testing::Test {
+protected:
+  static auto SetUpTestSuite() -> void { ASSERT_EQ(enet_initialize(), 0); }
+  static auto TearDownTestSuite() -> void { enet_deinitialize(); }
+
+  void SetUp() override {
+    world.component<glm::vec3>("glm::vec3")
+      .member("x", &glm::vec3::x)
+      .member("y", &glm::vec3::y)
+      .member("z", &glm::vec3::z);
+    world.component<glm::quat>("glm::quat")
+      .member("x", &glm::quat::x)
+      .member("y", &glm::quat::y)
+      .member("z", &glm::quat::z)
+      .member("w", &glm::quat::w);
+    world.component<NetTransform>("NetTransform")
+      .member("position", &NetTransform::position)
+      .member("rotation", &NetTransform::rotation)
+      .member("scale", &NetTransform::scale)
+      .add<Networked>();
+    world.component<NetHealth>("NetHealth")
+      .member("value", &NetHealth::value)
+      .member("team", &NetHealth::team)
+      .add<Networked>();
+    world.component<NetFrozen>("NetFrozen").add<Networked>();
+  }
+
+  auto spawn(u32 count) -> void {
+    std::uniform_real_distribution<f32> position(-500.f, 500.f);
+    for (u32 i = 0; i < count; i++) {
+      entities.push_back(
+        world.entity()
+          .set<NetTransform>({.position = {position(rng), 0.f, position(rng)}})
+          .set<NetHealth>({.value = 100, .team = i % 2})
+      );
+    }
+  }
+
+  auto snapshot() -> SceneState {
+    auto state = SceneState{};
+    SceneSnapshotBuilder::take_snapshot(world, state);
+    return state;
+  }
+
+  static auto bytes(const SceneState& state, flecs::entity_t entity_id, flecs::id_t component_id)
+    -> std::span<const u8> {
+    const auto* entity = state.find(entity_id);
+    EXPECT_TRUE(entity) << entity_id;
+    const auto* component = entity ? state.find_component(*entity, component_id) : nullptr;
+    EXPECT_TRUE(component) << entity_id << ": " << component_id;
+    return component ? state.bytes_of(*component) : std::span<const u8>{};
+  }
+
+  template <typename T>
+  auto read(const SceneState& state, flecs::entity entity) -> T {
+    const auto buffer = bytes(state, entity.id(), world.component<T>().raw_id());
+    auto value = T{};
+    EXPECT_EQ(buffer.size(), sizeof(T));
+    std::memcpy(&value, buffer.data(), glm::min(buffer.size(), sizeof(T)));
+    return value;
+  }
+
+  static auto expect_same_entities(const SceneState& expected, const SceneState& actual) -> void {
+    ASSERT_EQ(expected.entities.size(), actual.entities.size());
+    for (const auto& entity : expected.entities) {
+      const auto* actual_entity = actual.find(entity.entity_id);
+      ASSERT_TRUE(actual_entity) << entity.entity_id;
+      ASSERT_EQ(entity.component_count, actual_entity->component_count) << entity.entity_id;
+      for (const auto& component : expected.components_of(entity)) {
+        const auto* actual_component = actual.find_component(*actual_entity, component.id);
+        ASSERT_TRUE(actual_component) << entity.entity_id << ": " << component.id;
+        EXPECT_TRUE(std::ranges::equal(expected.bytes_of(component), actual.bytes_of(*actual_component)));
+        EXPECT_EQ(component.hash, actual_component->hash);
+      }
+    }
+  }
+
+  flecs::world world = {};
+  std::mt19937 rng{42};
+  std::vector<flecs::entity> entities = {};
+};
+
+TEST_F(SnapshotDeltaTest, ExactRoundTripAgainstBaseline) {
+  spawn(64);
+  entities[3].add<NetFrozen>();
+  const auto codec = SnapshotCodec::from_world(world, {.enabled = false});
+
+  const auto first = snapshot();
+  auto payload = std::vector<u8>{};
+  ASSERT_TRUE(codec.encode(nullptr, first, payload));
+  auto decoded_first = SceneState{};
+  ASSERT_TRUE(codec.decode(nullptr, payload, decoded_first));
+  expect_same_entities(first, decoded_first);
+
+  entities[0].get_mut<NetTransform>().position.x += 0.25f;
+  entities[1].get_mut<NetHealth>().team = 7;
+  const auto second = snapshot();
+
+  payload.clear();
+  ASSERT_TRUE(codec.encode(&first, second, payload));
+  // Two entities with one changed word each.
+  EXPECT_LT(payload.size(), 40u);
+
+  auto decoded_second = SceneState{};
+  ASSERT_TRUE(codec.decode(&decoded_first, payload, decoded_second));
+  expect_same_entities(second, decoded_second);
+  EXPECT_TRUE(decoded_second.removed_entities.empty());
+
+  // Nothing changed, nothing but the terminators.
+  payload.clear();
+  ASSERT_TRUE(codec.encode(&second, second, payload));
+  EXPECT_EQ(payload.size(), 2u);
+}
+
+TEST_F(SnapshotDeltaTest, QuantizedFieldsStayWithinPrecision) {
+  spawn(32);
+  std::uniform_real_distribution<f32> angle(-glm::pi<f32>(), glm::pi<f32>());
+  for (u32 i = 0; i < entities.size(); i++) {
+    const auto rotation = glm::angleAxis(angle(rng), glm::normalize(glm::vec3(1.f, static_cast<f32>(i), 2.f)));
+    // Half of them with w < 0, which is the same rotation.
+    entities[i].get_mut<NetTransform>().rotation = i % 2 ? -rotation : rotation;
+  }
+
+  const auto codec = SnapshotCodec::from_world(world);
+  const auto float_tolerance = codec.quantization.float_precision * 0.5f + 1e-4f;
+
+  const auto first = snapshot();
+  auto payload = std::vector<u8>{};
+  ASSERT_TRUE(codec.encode(nullptr, first, payload));
+  auto decoded_first = SceneState{};
+  ASSERT_TRUE(codec.decode(nullptr, payload, decoded_first));
+
+  for (const auto& entity : entities) {
+    const auto sent = read<NetTransform>(first, entity);
+    const auto received = read<NetTransform>(decoded_first, entity);
+    EXPECT_NEAR(sent.position.x, received.position.x, float_tolerance);
+    EXPECT_NEAR(sent.position.z, received.position.z, float_tolerance);
+    EXPECT_NEAR(glm::abs(glm::dot(sent.rotation, received.rotation)), 1.f, 1e-4f);
+    EXPECT_GE(received.rotation.w, 0.f);
+
+    const auto health = read<NetHealth>(decoded_first, entity);
+    EXPECT_EQ(health.value, 100);
+    EXPECT_EQ(health.team, read<NetHealth>(first, entity).team);
+  }
+
+  // The server encodes against its exact state, the client decodes against its quantized copy. Both
+  // have to land on the same words.
+  entities[5].get_mut<NetTransform>().position.y = 12.5f;
+  const auto second = snapshot();
+  payload.clear();
+  ASSERT_TRUE(codec.encode(&first, second, payload));
+  auto decoded_second = SceneState{};
+  ASSERT_TRUE(codec.decode(&decoded_first, payload, decoded_second));
+
+  EXPECT_NEAR(read<NetTransform>(decoded_second, entities[5]).position.y, 12.5f, float_tolerance);
+  for (const auto& entity : entities) {
+    if (entity != entities[5]) {
+      const auto transform_id = world.component<NetTransform>().raw_id();
+      EXPECT_TRUE(std::ranges::equal(
+        bytes(decoded_second, entity.id(), transform_id),
+        bytes(decoded_first, entity.id(), transform_id)
+      ));
+    }
+  }
+}
+
+// Past 2^24 steps positions stop being clamped and travel as floats, still the same words on both ends.
+TEST_F(SnapshotDeltaTest, FarFieldsKeepTheirValue) {
+  spawn(4);
+  entities[0].get_mut<NetTransform>().position = {100000.f, -54321.5f, 16384.f};
+  entities[1].get_mut<NetTransform>().position = {-3.0e9f, 0.f, 16383.f};
+
+  const auto codec = SnapshotCodec::from_world(world);
+  const auto first = snapshot();
+  auto payload = std::vector<u8>{};
+  ASSERT_TRUE(codec.encode(nullptr, first, payload));
+  auto decoded_first = SceneState{};
+  ASSERT_TRUE(codec.decode(nullptr, payload, decoded_first));
+
+  for (const auto& entity : {entities[0], entities[1]}) {
+    const auto sent = read<NetTransform>(first, entity).position;
+    const auto received = read<NetTransform>(decoded_first, entity).position;
+    for (u32 i = 0; i < 3; i++) {
+      // One dropped mantissa bit at worst.
+      EXPECT_NEAR(sent[i], received[i], glm::max(glm::abs(sent[i]) * 2e-7f, codec.quantization.float_precision));
+    }
+  }
+
+  // The decoded copy re-encodes to the same words, so an unchanged far entity costs nothing.
+  payload.clear();
+  ASSERT_TRUE(codec.encode(&decoded_first, first, payload));
+  EXPECT_EQ(payload.size(), 2u);
+}
+
+TEST_F(SnapshotDeltaTest, RemovalsAndTags) {
+  spawn(8);
+  entities[2].add<NetFrozen>();
+  const auto codec = SnapshotCodec::from_world(world, {.enabled = false});
+  const auto frozen_id = world.component<NetFrozen>().raw_id();
+  const auto health_id = world.component<NetHealth>().raw_id();
+
+  const auto first = snapshot();
+  auto payload = std::vector<u8>{};
+  ASSERT_TRUE(codec.encode(nullptr, first, payload));
+  auto decoded_first = SceneState{};
+  ASSERT_TRUE(codec.decode(nullptr, payload, decoded_first));
+  const auto* frozen = decoded_first.find_component(*decoded_first.find(entities[2].id()), frozen_id);
+  ASSERT_NE(frozen, nullptr);
+  EXPECT_EQ(frozen->hash, ~0_u64);
+
+  const auto destroyed_id = entities[5].id();
+  entities[2].remove<NetFrozen>();
+  entities[4].remove<NetHealth>();
+  entities[5].destruct();
+  entities[6].add<NetFrozen>();
+  const auto second = snapshot();
+
+  payload.clear();
+  ASSERT_TRUE(codec.encode(&first, second, payload));
+  auto decoded_second = SceneState{};
+  ASSERT_TRUE(codec.decode(&decoded_first, payload, decoded_second));
+  expect_same_entities(second, decoded_second);
+
+  EXPECT_TRUE(decoded_second.was_removed(destroyed_id));
+  EXPECT_FALSE(decoded_second.contains(destroyed_id));
+  EXPECT_TRUE(decoded_second.was_removed(entities[2].id(), frozen_id));
+  EXPECT_TRUE(decoded_second.was_removed(entities[4].id(), health_id));
+  frozen = decoded_second.find_component(*decoded_second.find(entities[6].id()), frozen_id);
+  ASSERT_NE(frozen, nullptr);
+  EXPECT_EQ(frozen->hash, ~0_u64);
+
+  for (usize size = 0; size < payload.size(); size++) {
+    auto truncated = SceneState{};
+    EXPECT_FALSE(codec.decode(&decoded_first, std::span(payload).first(size), truncated)) << "size = " << size;
+  }
+}
+
+// N entities replicated to M loopback clients. Acks reach the server a few ticks late and some never
+// arrive, so clients sit on different baselines like they would over a real link.
+TEST_F(SnapshotDeltaTest, BandwidthBenchmark) {
+  constexpr u32 ENTITY_COUNT = 1000;
+  constexpr u32 CLIENT_COUNT = 8;
+  constexpr u32 TICK_COUNT = 120;
+
+  spawn(ENTITY_COUNT);
+  const auto codec = SnapshotCodec::from_world(world);
+
+  struct PendingAck {
+    u32 tick = 0;
+    u8 sequence = 0;
+  };
+
+  auto clients = std::vector<NetClient>{};
+  clients.reserve(CLIENT_COUNT);
+  for (u32 i = 0; i < CLIENT_COUNT; i++) {
+    clients.emplace_back(nullptr, static_cast<ENetPeer*>(nullptr), i).snapshot_codec = &codec;
+  }
+  auto pending_acks = std::vector<std::vector<PendingAck>>(CLIENT_COUNT);
+
+  const auto packet_size = [](option<NetPacket> packet) -> u64 {
+    EXPECT_TRUE(packet.has_value());
+    const auto size = packet->inner->dataLength;
+    packet->destroy();
+    return size;
+  };
+
+  auto server = SceneSnapshotBuilder{};
+  auto full_bytes = 0_u64;
+  auto component_delta_bytes = 0_u64;
+  auto field_delta_bytes = 0_u64;
+  auto encode_ms = 0.0;
+  std::uniform_real_distribution<f32> step(-0.5f, 0.5f);
+
+  for (u32 tick = 0; tick < TICK_COUNT; tick++) {
+    // A quarter of the entities walk and turn each tick, the rest idle.
+    for (u32 i = tick % 4; i < entities.size(); i += 4) {
+      auto& transform = entities[i].get_mut<NetTransform>();
+      transform.position += glm::vec3(step(rng), 0.f, step(rng));
+      transform.rotation = glm::normalize(transform.rotation * glm::angleAxis(0.05f, glm::vec3(0.f, 1.f, 0.f)));
+    }
+    if (tick % 10 == 0) {
+      entities[tick].get_mut<NetHealth>().value -= 1;
+    }
+
+    SceneSnapshotBuilder::take_snapshot(world, server.current());
+    const auto sequence = server.current_sequence;
+    full_bytes += packet_size(NetPacket::scene_snapshot(server.current(), sequence)) * CLIENT_COUNT;
+
+    // Shared per baseline, like `NetServer::send_snapshots`.
+    auto payloads = ankerl::unordered_dense::map<u32, std::vector<u8>>{};
+    for (u32 c = 0; c < CLIENT_COUNT; c++) {
+      auto& client = clients[c];
+      std::erase_if(pending_acks[c], [&](const PendingAck& ack) {
+        if (ack.tick > tick) {
+          return false;
+        }
+        client.ack_snapshot(ack.sequence);
+        return true;
+      });
+
+      const auto* baseline = client.has_baseline ? server.find(client.baseline_sequence) : nullptr;
+      component_delta_bytes += packet_size(NetPacket::scene_snapshot(server.delta(baseline), sequence));
+
+      const auto key = baseline ? static_cast<u32>(client.baseline_sequence) : 0x100_u32;
+      auto [payload_it, inserted] = payloads.try_emplace(key);
+      if (inserted) {
+        const auto start = std::chrono::steady_clock::now();
+        ASSERT_TRUE(codec.encode(baseline, server.current(), payload_it->second));
+        encode_ms += std::chrono::duration<f64, std::milli>(std::chrono::steady_clock::now() - start).count();
+      }
+
+      const auto delta = NetSceneDeltaPacket{
+        .sequence = sequence,
+        .has_baseline = baseline != nullptr,
+        .baseline_sequence = client.baseline_sequence,
+        .payload = payload_it->second,
+      };
+      field_delta_bytes += packet_size(NetPacket::scene_delta(delta));
+
+      // Client side of `NetClient::handle_packet`.
+      const SceneState* client_baseline = nullptr;
+      if (delta.has_baseline) {
+        client_baseline = client.snapshots.find(delta.baseline_sequence);
+        ASSERT_NE(client_baseline, nullptr);
+      }
+      auto received = SceneState{};
+      ASSERT_TRUE(codec.decode(client_baseline, delta.payload, received));
+      ASSERT_EQ(received.entities.size(), ENTITY_COUNT);
+      client.snapshots.store(sequence, received);
+
+      if ((tick + c) % 7 != 0) {
+        pending_acks[c].push_back({.tick = tick + 1 + c % 4, .sequence = sequence});
+      }
+    }
+
+    server.advance();
+  }
+
+  const auto* last_received = clients.back().snapshots.find(static_cast<u8>(server.current_sequence - 1));
+  ASSERT_NE(last_received, nullptr);
+  for (const auto& entity : entities) {
+    const auto& transform = entity.get<NetTransform>();
+    const auto received = read<NetTransform>(*last_received, entity);
+    EXPECT_NEAR(transform.position.x, received.position.x, codec.quantization.float_precision);
+    EXPECT_NEAR(transform.position.z, received.position.z, codec.quantization.float_precision);
+  }
+
+  std::printf(
+    "%u entities, %u clients: full snapshots %llu B/tick, whole component deltas %llu B/tick, field deltas %llu "
+    "B/tick, encode %.3f ms/tick\n",
+    ENTITY_COUNT,
+    CLIENT_COUNT,
+    static_cast<unsigned long long>(full_bytes / TICK_COUNT),
+    static_cast<unsigned long long>(component_delta_bytes / TICK_COUNT),
+    static_cast<unsigned long long>(field_delta_bytes / TICK_COUNT),
+    encode_ms / TICK_COUNT
+  );
+  EXPECT_LT(field_delta_bytes, component_delta_bytes);
+}
@@ -0,0 +1,185 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <random>
+#include <span>
+#include <vector>
+
+#include "Networking/ClientPrediction.hpp"
+#include "Networking/SnapshotInterpolator.hpp"
+
+using namespace ox;
+
+class SnapshotInterpolationTest : public ::testing::Test {
+protected:
+  constexpr static flecs::entity_t ENTITY = 1000;
+
+  void SetUp() override {
+    transform_id = world.component<TransformComponent>().id();
+    ack_id = world.component<NetInputAck>().id();
+  }
+
+  template <typename T>
+  static auto bytes_of(const T& value) -> std::span<const u8> {
+    return {reinterpret_cast<const u8*>(&value), sizeof(T)};
+  }
+
+  auto make_state(f32 x, option<u32> input_ack = nullopt) -> SceneState {
+    const auto transform = TransformComponent{.position = {x, 0.f, 0.f}};
+    auto state = SceneState{};
+    state.push_entity(ENTITY);
+
+    // Components of an entity go in increasing id order.
+    auto push_transform = [&] {
+      state.push_component(transform_id, 0, bytes_of(transform));
+    };
+    if (!input_ack.has_value()) {
+      push_transform();
+      return state;
+    }
+
+    const auto ack = NetInputAck{.sequence = input_ack.value()};
+    if (transform_id > ack_id) {
+      state.push_component(ack_id, 0, bytes_of(ack));
+      push_transform();
+    } else {
+      push_transform();
+      state.push_component(ack_id, 0, bytes_of(ack));
+    }
+
+    return state;
+  }
+
+  flecs::world world;
+  flecs::id_t transform_id = 0;
+  flecs::id_t ack_id = 0;
+};
+
+TEST_F(SnapshotInterpolationTest, BlendsBetweenSnapshotsAtTheDelay) {
+  auto interpolator = SnapshotInterpolator(transform_id, 50.0);
+  ASSERT_DOUBLE_EQ(interpolator.delay_ms, 100.0);
+
+  interpolator.push(0, make_state(0.f));
+  interpolator.update(0.0);
+  ASSERT_NE(interpolator.find(ENTITY), nullptr);
+  EXPECT_FLOAT_EQ(interpolator.find(ENTITY)->position.x, 0.f);
+
+  for (u8 sequence = 1; sequence <= 3; sequence++) {
+    interpolator.push(sequence, make_state(10.f * sequence));
+  }
+
+  // Two snapshots behind the newest one.
+  interpolator.update(0.0);
+  EXPECT_FLOAT_EQ(interpolator.find(ENTITY)->position.x, 10.f);
+  interpolator.update(25.0);
+  EXPECT_FLOAT_EQ(interpolator.find(ENTITY)->position.x, 15.f);
+
+  // A snapshot the playback already moved past changes nothing.
+  interpolator.push(0, make_state(-100.f));
+  interpolator.update(0.0);
+  EXPECT_FLOAT_EQ(interpolator.find(ENTITY)->position.x, 15.f);
+}
+
+TEST_F(SnapshotInterpolationTest, PredictionReplaysUnackedInputs) {
+  auto prediction = ClientPrediction<f32>([](TransformComponent& state, const f32& input, f64 delta_ms) {
+    state.position.x += input * static_cast<f32>(delta_ms);
+  });
+
+  for (u32 i = 0; i < 5; i++) {
+    prediction.predict(1.f, 1.0);
+  }
+  EXPECT_FLOAT_EQ(prediction.state.position.x, 5.f);
+
+  // The server applied the first three inputs but got somewhere else, the last two are replayed on top.
+  ASSERT_TRUE(prediction.reconcile(7, make_state(2.5f, 3), ENTITY, transform_id, ack_id));
+  EXPECT_EQ(prediction.pending.size(), 2);
+  EXPECT_FLOAT_EQ(prediction.state.position.x, 4.5f);
+
+  // Older snapshots and older acks don't roll it back.
+  EXPECT_FALSE(prediction.reconcile(6, make_state(0.f, 4), ENTITY, transform_id, ack_id));
+  prediction.reconcile(2, TransformComponent{});
+  EXPECT_FLOAT_EQ(prediction.state.position.x, 4.5f);
+
+  EXPECT_FALSE(prediction.reconcile(8, make_state(0.f), ENTITY, transform_id, ack_id));
+}
+
+// An entity moving at constant speed, snapshots sent at 20 Hz over a link with jitter and loss,
+// rendered at 60 Hz. Compares how far it moves each frame against how far it actually moved, for
+// the interpolator and for snapping to the newest snapshot.
+TEST_F(SnapshotInterpolationTest, SmoothAtLowTickRateBenchmark) {
+  constexpr auto TICK_MS = 1000.0 / 20.0;
+  constexpr auto FRAME_MS = 1000.0 / 60.0;
+  constexpr auto LATENCY_MS = 30.0;
+  constexpr auto JITTER_MS = 40.0;
+  constexpr auto LOSS = 0.05;
+  constexpr auto SPEED = 0.01f;
+  constexpr auto DURATION_MS = 20'000.0;
+  constexpr auto WARMUP_MS = 1'000.0;
+
+  struct Arrival {
+    f64 at = 0.0;
+    u8 sequence = 0;
+    f32 x = 0.f;
+  };
+
+  auto rng = std::mt19937(1234);
+  auto jitter = std::uniform_real_distribution<f64>(0.0, JITTER_MS);
+  auto chance = std::uniform_real_distribution<f64>(0.0, 1.0);
+  auto arrivals = std::vector<Arrival>{};
+  for (u32 tick = 0; static_cast<f64>(tick) * TICK_MS < DURATION_MS; tick++) {
+    const auto sent_at = static_cast<f64>(tick) * TICK_MS;
+    if (chance(rng) >= LOSS) {
+      const auto x = SPEED * static_cast<f32>(sent_at);
+      arrivals.push_back({.at = sent_at + LATENCY_MS + jitter(rng), .sequence = static_cast<u8>(tick), .x = x});
+    }
+  }
+  std::ranges::sort(arrivals, {}, &Arrival::at);
+
+  auto interpolator = SnapshotInterpolator(transform_id, TICK_MS);
+  interpolator.delay_ms = 2.0 * TICK_MS + JITTER_MS;
+  auto interpolated_errors = std::vector<f64>{};
+  auto snapped_errors = std::vector<f64>{};
+  auto next_arrival = 0_sz;
+  auto last_interpolated = 0.f;
+  auto last_snapped = 0.f;
+  auto snapped_x = 0.f;
+  const auto expected = static_cast<f64>(SPEED) * FRAME_MS;
+
+  for (auto now = 0.0; now < DURATION_MS; now += FRAME_MS) {
+    for (; next_arrival < arrivals.size() && arrivals[next_arrival].at <= now; next_arrival++) {
+      const auto& arrival = arrivals[next_arrival];
+      interpolator.push(arrival.sequence, make_state(arrival.x));
+      snapped_x = std::max(snapped_x, arrival.x);
+    }
+
+    interpolator.update(FRAME_MS);
+    const auto* transform = interpolator.find(ENTITY);
+    if (!transform) {
+      continue;
+    }
+
+    const auto x = transform->position.x;
+    if (now >= WARMUP_MS) {
+      interpolated_errors.push_back(std::abs((x - last_interpolated) / expected - 1.0));
+      snapped_errors.push_back(std::abs((snapped_x - last_snapped) / expected - 1.0));
+    }
+    last_interpolated = x;
+    last_snapped = snapped_x;
+  }
+
+  auto p99 = [](std::vector<f64> errors) {
+    std::ranges::sort(errors);
+    return errors[errors.size() * 99 / 100];
+  };
+  const auto interpolated_p99 = p99(interpolated_errors);
+  const auto snapped_p99 = p99(snapped_errors);
+  std::printf(
+    "20 Hz snapshots at 60 Hz: p99 per-frame speed error interpolated %.1f%%, snapped %.1f%%\n",
+    interpolated_p99 * 100.0,
+    snapped_p99 * 100.0
+  );
+
+  EXPECT_LT(interpolated_p99, 0.25);
+  EXPECT_GT(snapped_p99, 1.0);
+}
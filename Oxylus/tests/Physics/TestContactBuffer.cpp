@@ -0,0 +1,252 @@
+// clang-format off
+#include <Jolt/Jolt.h>
+#include <Jolt/Core/Factory.h>
+#include <Jolt/Core/JobSystemThreadPool.h>
+#include <Jolt/Core/TempAllocator.h>
+#include <Jolt/Physics/Body/BodyCreationSettings.h>
+#include <Jolt/Physics/Collision/Shape/BoxShape.h>
+#include <Jolt/Physics/PhysicsSystem.h>
+#include <Jolt/RegisterTypes.h>
+// clang-format on
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <mutex>
+#include <random>
+#include <sol/sol.hpp>
+#include <thread>
+
+#include "Core/JobManager.hpp"
+#include "Physics/PhysicsInterfaces.hpp"
+
+using namespace ox;
+
+namespace {
+constexpr auto LUA_HANDLER = R"(
+contact_count = 0
+deepest = 0
+function on_contact(body1, body2, depth)
+  contact_count = contact_count + 1
+  if depth > deepest then deepest = depth end
+end
+)";
+
+// What contacts used to go through: every worker that finds one calls into Lua on the spot, one
+// at a time behind a lock.
+class SynchronousContactListener final : public JPH::ContactListener {
+public:
+  explicit SynchronousContactListener(sol::protected_function handler_) : handler(std::move(handler_)) {}
+
+  void OnContactAdded(
+    const JPH::Body& body1, const JPH::Body& body2, const JPH::ContactManifold& manifold, JPH::ContactSettings&
+  ) override {
+    call(body1.GetID(), body2.GetID(), manifold.mPenetrationDepth);
+  }
+
+  void OnContactPersisted(
+    const JPH::Body& body1, const JPH::Body& body2, const JPH::ContactManifold& manifold, JPH::ContactSettings&
+  ) override {
+    call(body1.GetID(), body2.GetID(), manifold.mPenetrationDepth);
+  }
+
+  void OnContactRemoved(const JPH::SubShapeIDPair& pair) override { call(pair.GetBody1ID(), pair.GetBody2ID(), 0.0f); }
+
+private:
+  std::mutex mutex = {};
+  sol::protected_function handler = {};
+
+  auto call(const JPH::BodyID& body1, const JPH::BodyID& body2, f32 depth) -> void {
+    auto lock = std::unique_lock(mutex);
+    handler(body1.GetIndexAndSequenceNumber(), body2.GetIndexAndSequenceNumber(), depth);
+  }
+};
+} // namespace
+
+class ContactBufferTest : public ::testing::Test {
+protected:
+  enum class Mode {
+    NoHandler,
+    Buffered,
+    Synchronous,
+  };
+
+  struct PileResult {
+    f64 step_ms = 0.0;
+    u64 recorded = 0;
+    u64 handler_calls = 0;
+  };
+
+  static auto SetUpTestSuite() -> void {
+    JPH::RegisterDefaultAllocator();
+    JPH::Factory::sInstance = new JPH::Factory();
+    JPH::RegisterTypes();
+  }
+
+  static auto TearDownTestSuite() -> void {
+    JPH::UnregisterTypes();
+    delete JPH::Factory::sInstance;
+    JPH::Factory::sInstance = nullptr;
+  }
+
+  void SetUp() override {
+    // Jolt's workers stand in for the job manager's, so each records into a list of its own.
+    job_system.SetThreadInitFunction([](i32 index) { this_thread_worker.id = static_cast<u32>(index); });
+    job_system.Init(JPH::cMaxPhysicsJobs, JPH::cMaxPhysicsBarriers, static_cast<i32>(worker_count));
+  }
+
+  // Boxes stacked in slightly crooked columns that topple into a pile on a floor.
+  static auto build_pile(JPH::PhysicsSystem& system, u32 body_count) -> void {
+    auto& body_interface = system.GetBodyInterface();
+    const auto floor = JPH::BodyCreationSettings(
+      new JPH::BoxShape(JPH::Vec3(100.f, 1.f, 100.f)),
+      JPH::RVec3(0.f, -1.f, 0.f),
+      JPH::Quat::sIdentity(),
+      JPH::EMotionType::Static,
+      PhysicsLayers::NON_MOVING
+    );
+    body_interface.CreateAndAddBody(floor, JPH::EActivation::DontActivate);
+
+    constexpr auto COLUMNS = 25_u32;
+    auto rng = std::mt19937(99);
+    auto offset = std::uniform_real_distribution<f32>(-0.2f, 0.2f);
+    auto box = JPH::Ref<JPH::Shape>(new JPH::BoxShape(JPH::Vec3::sReplicate(0.5f)));
+    for (u32 i = 0; i < body_count; i++) {
+      const auto column = i % (COLUMNS * COLUMNS);
+      const auto layer = i / (COLUMNS * COLUMNS);
+      const auto position = JPH::RVec3(
+        (static_cast<f32>(column % COLUMNS) - COLUMNS / 2.f) * 1.1f + offset(rng),
+        0.5f + static_cast<f32>(layer) * 1.05f,
+        (static_cast<f32>(column / COLUMNS) - COLUMNS / 2.f) * 1.1f + offset(rng)
+      );
+      const auto rotation = JPH::Quat::sRotation(JPH::Vec3::sAxisY(), offset(rng));
+      const auto motion = JPH::EMotionType::Dynamic;
+      const auto settings = JPH::BodyCreationSettings(box, position, rotation, motion, PhysicsLayers::MOVING);
+      body_interface.CreateAndAddBody(settings, JPH::EActivation::Activate);
+    }
+  }
+
+  auto run_pile(Mode mode, u32 body_count, u32 steps) -> PileResult {
+    auto lua = sol::state{};
+    lua.open_libraries(sol::lib::base);
+    lua.script(LUA_HANDLER);
+    sol::protected_function handler = lua["on_contact"];
+
+    auto system = JPH::PhysicsSystem{};
+    system.Init(body_count + 1, 0, 65536, 65536, layer_interface, object_vs_broad_phase, object_vs_object);
+
+    auto buffered = Physics3DContactListener{};
+    auto synchronous = SynchronousContactListener(handler);
+    if (mode == Mode::Synchronous) {
+      system.SetContactListener(&synchronous);
+    } else {
+      buffered.contacts.init(worker_count);
+      buffered.contacts.enabled = mode == Mode::Buffered;
+      system.SetContactListener(&buffered);
+    }
+
+    build_pile(system, body_count);
+    system.OptimizeBroadPhase();
+
+    auto result = PileResult{};
+    auto contacts = std::vector<ContactEvent>{};
+    const auto start = std::chrono::steady_clock::now();
+    for (u32 step = 0; step < steps; step++) {
+      system.Update(1.f / 60.f, 1, &temp_allocator, &job_system);
+      if (mode == Mode::Synchronous) {
+        continue;
+      }
+
+      result.recorded += buffered.contacts.merge(contacts);
+      EXPECT_TRUE(std::ranges::is_sorted(contacts, {}, [](const ContactEvent& contact) {
+        return std::pair(contact.body1.GetIndexAndSequenceNumber(), contact.body2.GetIndexAndSequenceNumber());
+      }));
+      for (const auto& contact : contacts) {
+        const auto body1 = contact.body1.GetIndexAndSequenceNumber();
+        const auto body2 = contact.body2.GetIndexAndSequenceNumber();
+        handler(body1, body2, contact.penetration_depth);
+      }
+    }
+    result.step_ms = std::chrono::duration<f64, std::milli>(std::chrono::steady_clock::now() - start).count() /
+                     static_cast<f64>(steps);
+    result.handler_calls = lua.get_or("contact_count", 0_u64);
+
+    return result;
+  }
+
+  BPLayerInterfaceImpl layer_interface = {};
+  ObjectVsBroadPhaseLayerFilterImpl object_vs_broad_phase = {};
+  ObjectLayerPairFilterImpl object_vs_object = {};
+  JPH::TempAllocatorImpl temp_allocator{64 * 1024 * 1024};
+  u32 worker_count = std::max(std::thread::hardware_concurrency(), 2u) - 1;
+  JPH::JobSystemThreadPool job_system = {};
+};
+
+TEST_F(ContactBufferTest, CollapsesAcrossThreads) {
+  auto buffer = ContactBuffer{};
+  const auto body1 = JPH::BodyID(3);
+  const auto body2 = JPH::BodyID(7);
+  auto contacts = std::vector<ContactEvent>{};
+  // Nothing is kept while it is off.
+  buffer.record_removed(body1, body2);
+  EXPECT_EQ(buffer.merge(contacts), 0);
+
+  // Two workers with lists of their own, two threads that aren't workers and the main thread.
+  buffer.init(2);
+  buffer.enabled = true;
+  auto workers = std::vector<std::jthread>{};
+  for (u32 i = 0; i < 4; i++) {
+    workers.emplace_back([&buffer, body1, body2, i] {
+      if (i < 2) {
+        this_thread_worker.id = i;
+      }
+      buffer.record_removed(body2, body1);
+      buffer.record_removed(body1, JPH::BodyID(i));
+    });
+  }
+  buffer.record_removed(body1, body2);
+  workers.clear();
+
+  EXPECT_EQ(buffer.merge(contacts), 9);
+  ASSERT_EQ(contacts.size(), 5);
+  const auto& pair = *std::ranges::find(contacts, body2, &ContactEvent::body2);
+  EXPECT_EQ(pair.kind, ContactEventKind::Removed);
+  EXPECT_EQ(pair.body1, body1);
+  EXPECT_EQ(pair.contact_count, 5);
+
+  // Everything was handed over.
+  EXPECT_EQ(buffer.merge(contacts), 0);
+  EXPECT_TRUE(contacts.empty());
+}
+
+// A 5k body pile with no contact handler, with a Lua handler fed from the buffer after every step,
+// and with the same handler called from the workers behind a lock, the way it used to be.
+TEST_F(ContactBufferTest, PileOf5kBodiesBenchmark) {
+  constexpr auto BODY_COUNT = 5000_u32;
+  constexpr auto STEPS = 90_u32;
+
+  const auto no_handler = run_pile(Mode::NoHandler, BODY_COUNT, STEPS);
+  const auto buffered = run_pile(Mode::Buffered, BODY_COUNT, STEPS);
+  const auto synchronous = run_pile(Mode::Synchronous, BODY_COUNT, STEPS);
+
+  std::printf(
+    "%u bodies, %u steps: no handler %.2f ms/step, buffered Lua handler %.2f ms/step (%llu calls of %llu "
+    "contacts), synchronous Lua handler %.2f ms/step (%llu calls)\n",
+    BODY_COUNT,
+    STEPS,
+    no_handler.step_ms,
+    buffered.step_ms,
+    static_cast<unsigned long long>(buffered.handler_calls),
+    static_cast<unsigned long long>(buffered.recorded),
+    synchronous.step_ms,
+    static_cast<unsigned long long>(synchronous.handler_calls)
+  );
+
+  EXPECT_EQ(no_handler.recorded, 0);
+  EXPECT_EQ(no_handler.handler_calls, 0);
+  EXPECT_GT(buffered.handler_calls, 0);
+  EXPECT_LE(buffered.handler_calls, buffered.recorded);
+  EXPECT_GT(synchronous.handler_calls, 0);
+}
@@ -0,0 +1,175 @@
+// clang-format off
+#include <Jolt/Jolt.h>
+#include <Jolt/Core/Factory.h>
+#include <Jolt/Core/JobSystemThreadPool.h>
+#include <Jolt/Core/TempAllocator.h>
+#include <Jolt/Physics/Body/BodyCreationSettings.h>
+#include <Jolt/Physics/Collision/Shape/BoxShape.h>
+#include <Jolt/Physics/PhysicsSystem.h>
+#include <Jolt/RegisterTypes.h>
+// clang-format on
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <thread>
+
+#include "Physics/PhysicsCVar.hpp"
+
+using namespace ox;
+
+namespace {
+auto elapsed_ms(std::chrono::steady_clock::time_point start) -> f64 {
+  return std::chrono::duration<f64, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+} // namespace
+
+class PhysicsCapacityTest : public ::testing::Test {
+protected:
+  static auto SetUpTestSuite() -> void {
+    JPH::RegisterDefaultAllocator();
+    JPH::Factory::sInstance = new JPH::Factory();
+    JPH::RegisterTypes();
+  }
+
+  static auto TearDownTestSuite() -> void {
+    JPH::UnregisterTypes();
+    delete JPH::Factory::sInstance;
+    JPH::Factory::sInstance = nullptr;
+  }
+
+  // A flat grid of static tiles with dynamic boxes raining down on the middle of it. Bodies go in
+  // either in one batch per activation the way `Scene::physics_init` adds them, or one by one.
+  static auto load_city(JPH::PhysicsSystem& system, u32 static_count, u32 dynamic_count, bool batched) -> u32 {
+    auto& body_interface = system.GetBodyInterface();
+    auto tile = JPH::Ref<JPH::Shape>(new JPH::BoxShape(JPH::Vec3(0.5f, 0.5f, 0.5f)));
+    auto box = JPH::Ref<JPH::Shape>(new JPH::BoxShape(JPH::Vec3::sReplicate(0.25f)));
+
+    auto created = 0_u32;
+    auto add = [&](std::vector<JPH::BodyID>& ids, JPH::EActivation activation) {
+      created += static_cast<u32>(ids.size());
+      if (!batched) {
+        for (const auto& id : ids) {
+          body_interface.AddBody(id, activation);
+        }
+        return;
+      }
+      const auto count = static_cast<i32>(ids.size());
+      auto state = body_interface.AddBodiesPrepare(ids.data(), count);
+      body_interface.AddBodiesFinalize(ids.data(), count, state, activation);
+    };
+
+    auto ids = std::vector<JPH::BodyID>{};
+    const auto side = static_cast<u32>(std::ceil(std::sqrt(static_cast<f64>(static_count))));
+    for (u32 i = 0; i < static_count; i++) {
+      const auto position = JPH::RVec3(
+        static_cast<f32>(i % side) - static_cast<f32>(side) / 2.f,
+        -0.5f,
+        static_cast<f32>(i / side) - static_cast<f32>(side) / 2.f
+      );
+      const auto settings = JPH::BodyCreationSettings(
+        tile, position, JPH::Quat::sIdentity(), JPH::EMotionType::Static, PhysicsLayers::NON_MOVING
+      );
+      if (auto* body = body_interface.CreateBody(settings)) {
+        ids.push_back(body->GetID());
+      }
+    }
+    add(ids, JPH::EActivation::DontActivate);
+
+    ids.clear();
+    constexpr auto COLUMNS = 50_u32;
+    for (u32 i = 0; i < dynamic_count; i++) {
+      const auto column = i % (COLUMNS * COLUMNS);
+      const auto position = JPH::RVec3(
+        static_cast<f32>(column % COLUMNS) * 0.6f - 15.f,
+        0.5f + static_cast<f32>(i / (COLUMNS * COLUMNS)) * 0.6f,
+        static_cast<f32>(column / COLUMNS) * 0.6f - 15.f
+      );
+      const auto settings = JPH::BodyCreationSettings(
+        box, position, JPH::Quat::sIdentity(), JPH::EMotionType::Dynamic, PhysicsLayers::MOVING
+      );
+      if (auto* body = body_interface.CreateBody(settings)) {
+        ids.push_back(body->GetID());
+      }
+    }
+    add(ids, JPH::EActivation::Activate);
+
+    system.OptimizeBroadPhase();
+
+    return created;
+  }
+
+  Physics physics = {};
+  JPH::TempAllocatorImplWithMallocFallback temp_allocator{10 * 1024 * 1024};
+  JPH::JobSystemThreadPool job_system{
+    JPH::cMaxPhysicsJobs,
+    JPH::cMaxPhysicsBarriers,
+    static_cast<i32>(std::max(std::thread::hardware_concurrency(), 2u) - 1)
+  };
+};
+
+TEST_F(PhysicsCapacityTest, SizesFromScene) {
+  auto cvar = PhysicsCVar{};
+  const auto defaults = PhysicsCapacity{};
+
+  // Small scenes keep what the CVars ask for.
+  EXPECT_EQ(cvar.capacity(10, 5), defaults);
+
+  const auto big = cvar.capacity(110'000, 10'000);
+  EXPECT_GE(big.max_bodies, 110'000);
+  EXPECT_GT(big.max_body_pairs, defaults.max_body_pairs);
+  EXPECT_GT(big.max_contact_constraints, defaults.max_contact_constraints);
+  EXPECT_GT(big.temp_allocator_size, defaults.temp_allocator_size);
+
+  cvar.cvar_auto_capacity.set(0);
+  cvar.cvar_max_bodies.set(4096);
+  const auto fixed = cvar.capacity(110'000, 10'000);
+  EXPECT_EQ(fixed.max_bodies, 4096);
+  EXPECT_EQ(fixed.max_body_pairs, defaults.max_body_pairs);
+
+  // A system that is too small runs out instead of taking the process down.
+  auto system = physics.new_system({.max_bodies = 16});
+  EXPECT_EQ(load_city(*system, 32, 0, true), 16);
+}
+
+// 100k static and 10k dynamic bodies, loaded with one broadphase insertion per body and with two
+// batches, then simulated for a second.
+TEST_F(PhysicsCapacityTest, LargeSceneBenchmark) {
+  constexpr auto STATIC_COUNT = 100'000_u32;
+  constexpr auto DYNAMIC_COUNT = 10'000_u32;
+  constexpr auto STEPS = 60_u32;
+
+  const auto capacity = PhysicsCVar{}.capacity(STATIC_COUNT + DYNAMIC_COUNT, DYNAMIC_COUNT);
+
+  auto start = std::chrono::steady_clock::now();
+  auto single = physics.new_system(capacity);
+  EXPECT_EQ(load_city(*single, STATIC_COUNT, DYNAMIC_COUNT, false), STATIC_COUNT + DYNAMIC_COUNT);
+  const auto single_ms = elapsed_ms(start);
+  single.reset();
+
+  start = std::chrono::steady_clock::now();
+  auto system = physics.new_system(capacity);
+  EXPECT_EQ(load_city(*system, STATIC_COUNT, DYNAMIC_COUNT, true), STATIC_COUNT + DYNAMIC_COUNT);
+  const auto batched_ms = elapsed_ms(start);
+
+  start = std::chrono::steady_clock::now();
+  for (u32 step = 0; step < STEPS; step++) {
+    ASSERT_EQ(system->Update(1.f / 60.f, 1, &temp_allocator, &job_system), JPH::EPhysicsUpdateError::None);
+  }
+  const auto step_ms = elapsed_ms(start) / static_cast<f64>(STEPS);
+
+  std::printf(
+    "%u static + %u dynamic bodies: load one by one %.1f ms, batched %.1f ms, step %.2f ms\n",
+    STATIC_COUNT,
+    DYNAMIC_COUNT,
+    single_ms,
+    batched_ms,
+    step_ms
+  );
+
+  EXPECT_EQ(system->GetNumBodies(), STATIC_COUNT + DYNAMIC_COUNT);
+  EXPECT_GT(system->GetNumActiveBodies(JPH::EBodyType::RigidBody), 0);
+}
@@ -0,0 +1,225 @@
+// clang-format off
+#include <Jolt/Jolt.h>
+#include <Jolt/Core/Factory.h>
+#include <Jolt/Physics/Body/BodyCreationSettings.h>
+#include <Jolt/Physics/Collision/CastResult.h>
+#include <Jolt/Physics/Collision/CollisionCollectorImpl.h>
+#include <Jolt/Physics/Collision/NarrowPhaseQuery.h>
+#include <Jolt/Physics/Collision/RayCast.h>
+#include <Jolt/Physics/Collision/Shape/BoxShape.h>
+#include <Jolt/Physics/PhysicsSystem.h>
+#include <Jolt/RegisterTypes.h>
+// clang-format on
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <cstdio>
+#include <vector>
+
+#include "Core/JobManager.hpp"
+#include "Physics/PhysicsInterfaces.hpp"
+#include "Physics/PhysicsQueries.hpp"
+#include "Utils/OxMath.hpp"
+
+using namespace ox;
+
+class PhysicsQueriesTest : public ::testing::Test {
+protected:
+  static auto SetUpTestSuite() -> void {
+    JPH::RegisterDefaultAllocator();
+    JPH::Factory::sInstance = new JPH::Factory();
+    JPH::RegisterTypes();
+  }
+
+  static auto TearDownTestSuite() -> void {
+    JPH::UnregisterTypes();
+    delete JPH::Factory::sInstance;
+    JPH::Factory::sInstance = nullptr;
+  }
+
+  // A `GRID` x `GRID` field of unit boxes on the XZ plane, 4 apart, each with its index as user data.
+  void SetUp() override {
+    system.Init(GRID * GRID, 0, 1024, 1024, layer_interface, object_vs_broad_phase, object_vs_object);
+    auto& body_interface = system.GetBodyInterface();
+    auto box = JPH::Ref<JPH::Shape>(new JPH::BoxShape(JPH::Vec3::sReplicate(0.5f)));
+    for (u32 z = 0; z < GRID; z++) {
+      for (u32 x = 0; x < GRID; x++) {
+        auto settings = JPH::BodyCreationSettings(
+          box,
+          JPH::RVec3(box_position(x, z)),
+          JPH::Quat::sIdentity(),
+          JPH::EMotionType::Static,
+          PhysicsLayers::NON_MOVING
+        );
+        settings.mUserData = z * GRID + x;
+        bodies.push_back(body_interface.CreateAndAddBody(settings, JPH::EActivation::DontActivate));
+      }
+    }
+    system.OptimizeBroadPhase();
+  }
+
+  static auto box_position(u32 x, u32 z) -> JPH::Vec3 {
+    return {static_cast<f32>(x) * 4.0f, 0.0f, static_cast<f32>(z) * 4.0f};
+  }
+
+  constexpr static u32 GRID = 32;
+
+  BPLayerInterfaceImpl layer_interface = {};
+  ObjectVsBroadPhaseLayerFilterImpl object_vs_broad_phase = {};
+  ObjectLayerPairFilterImpl object_vs_object = {};
+  JPH::PhysicsSystem system = {};
+  std::vector<JPH::BodyID> bodies = {};
+};
+
+TEST_F(PhysicsQueriesTest, RaysAndSpheres) {
+  auto batch = PhysicsQueryBatch{};
+  const auto down = batch.add_ray({8.0f, 10.0f, 8.0f}, {0.0f, -20.0f, 0.0f});
+  const auto miss = batch.add_ray({2.0f, 10.0f, 2.0f}, {0.0f, -20.0f, 0.0f});
+  const auto ignored = batch.add_ray({8.0f, 10.0f, 8.0f}, {0.0f, -20.0f, 0.0f}, bodies[2 * GRID + 2]);
+  const auto cast = batch.add_sphere_cast({-5.0f, 0.0f, 0.0f}, {10.0f, 0.0f, 0.0f}, 0.25f);
+  const auto overlap = batch.add_sphere_overlap({2.0f, 0.0f, 0.0f}, 1.75f);
+  const auto pointless = batch.add_sphere_overlap({0.0f, 0.0f, 0.0f}, 0.0f);
+
+  auto results = PhysicsQueryResults{};
+  batch.run(system, nullptr, results);
+  ASSERT_EQ(results.hit_counts.size(), batch.size());
+
+  ASSERT_EQ(results.hit_counts[down], 1);
+  const auto& top = results.hits_of(down)[0];
+  EXPECT_EQ(top.body, bodies[2 * GRID + 2]);
+  EXPECT_EQ(top.entity, 2 * GRID + 2);
+  EXPECT_NEAR(top.point.y, 0.5f, 1e-3f);
+  EXPECT_NEAR(top.normal.y, 1.0f, 1e-3f);
+  EXPECT_NEAR(top.fraction, 9.5f / 20.0f, 1e-3f);
+
+  EXPECT_EQ(results.hit_counts[miss], 0);
+  EXPECT_EQ(results.hit_counts[ignored], 0);
+
+  ASSERT_EQ(results.hit_counts[cast], 1);
+  const auto& side = results.hits_of(cast)[0];
+  EXPECT_EQ(side.body, bodies[0]);
+  EXPECT_NEAR(side.point.x, -0.5f, 1e-2f);
+  EXPECT_NEAR(side.normal.x, -1.0f, 1e-2f);
+  EXPECT_NEAR(side.fraction, 4.25f / 10.0f, 1e-3f);
+
+  // Reaches both of the first two boxes, only the one slot is filled.
+  EXPECT_EQ(results.hit_counts[overlap], 1);
+  EXPECT_EQ(results.hit_counts[pointless], 0);
+}
+
+TEST_F(PhysicsQueriesTest, KeepsTheClosestHits) {
+  // Along the first row of boxes, grazing all of them.
+  auto batch = PhysicsQueryBatch{.max_hits = 4};
+  const auto row = batch.add_ray({-10.0f, 0.0f, 0.0f}, {200.0f, 0.0f, 0.0f});
+  const auto overlap = batch.add_sphere_overlap({2.0f, 0.0f, 0.0f}, 1.75f);
+
+  auto results = PhysicsQueryResults{};
+  batch.run(system, nullptr, results);
+
+  const auto hits = results.hits_of(row);
+  ASSERT_EQ(hits.size(), 4);
+  for (u32 i = 0; i < hits.size(); i++) {
+    EXPECT_EQ(hits[i].body, bodies[i]);
+    EXPECT_NEAR(hits[i].point.x, static_cast<f32>(i) * 4.0f - 0.5f, 1e-3f);
+  }
+
+  const auto touching = results.hits_of(overlap);
+  ASSERT_EQ(touching.size(), 2);
+  EXPECT_NE(touching[0].body, touching[1].body);
+}
+
+// Rays from above the grid at every box and between them: spread over the job manager, the results
+// are the very same as on one thread.
+TEST_F(PhysicsQueriesTest, ParallelMatchesSerial) {
+  auto batch = PhysicsQueryBatch{.max_hits = 2};
+  for (u32 i = 0; i < 4096; i++) {
+    const auto x = static_cast<f32>(i % 64) * 2.0f;
+    const auto z = static_cast<f32>(i / 64) * 2.0f;
+    if (i % 3 == 0) {
+      batch.add_sphere_cast({x, 10.0f, z}, {1.0f, -20.0f, 0.0f}, 0.5f);
+    } else {
+      batch.add_ray({x, 10.0f, z}, {1.0f, -20.0f, 0.0f});
+    }
+  }
+
+  auto serial = PhysicsQueryResults{};
+  batch.run(system, nullptr, serial);
+
+  JobManager job_man = {};
+  job_man.set_thread_count(4);
+  ASSERT_TRUE(job_man.init().has_value());
+  auto parallel = PhysicsQueryResults{};
+  batch.run(system, &job_man, parallel);
+  job_man.shutdown();
+
+  ASSERT_EQ(serial.hit_counts, parallel.hit_counts);
+  auto hit_total = 0_u32;
+  for (usize i = 0; i < batch.size(); i++) {
+    const auto a = serial.hits_of(i);
+    const auto b = parallel.hits_of(i);
+    for (usize k = 0; k < a.size(); k++) {
+      EXPECT_EQ(a[k].body, b[k].body);
+      EXPECT_EQ(a[k].point, b[k].point);
+      EXPECT_EQ(a[k].fraction, b[k].fraction);
+    }
+    hit_total += static_cast<u32>(a.size());
+  }
+  EXPECT_GT(hit_total, 0);
+}
+
+// 10k rays one at a time, each with a collector of its own as `Scene::cast_ray` does, against the
+// same rays as one batch on a single thread and over the job manager.
+TEST_F(PhysicsQueriesTest, TenThousandRaysBenchmark) {
+  constexpr auto RAY_COUNT = 10000_u32;
+
+  auto batch = PhysicsQueryBatch{};
+  for (u32 i = 0; i < RAY_COUNT; i++) {
+    const auto t = static_cast<f32>(i) / RAY_COUNT;
+    batch.add_ray({t * GRID * 4.0f, 10.0f, static_cast<f32>(i % 97) * 1.3f}, {3.0f, -20.0f, 2.0f});
+  }
+
+  const auto& narrow_phase = system.GetNarrowPhaseQuery();
+  auto start = std::chrono::steady_clock::now();
+  auto single_hits = 0_u32;
+  for (const auto& query : batch.queries) {
+    auto collector = JPH::AllHitCollisionCollector<JPH::CastRayCollector>{};
+    narrow_phase.CastRay(
+      JPH::RRayCast(JPH::RVec3(math::to_jolt(query.origin)), math::to_jolt(query.direction)),
+      JPH::RayCastSettings{},
+      collector
+    );
+    collector.Sort();
+    single_hits += collector.HadHit() ? 1 : 0;
+  }
+  const auto single_ms = std::chrono::duration<f64, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+  auto results = PhysicsQueryResults{};
+  start = std::chrono::steady_clock::now();
+  batch.run(system, nullptr, results);
+  const auto serial_ms = std::chrono::duration<f64, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+  JobManager job_man = {};
+  job_man.set_thread_count(4);
+  ASSERT_TRUE(job_man.init().has_value());
+  start = std::chrono::steady_clock::now();
+  batch.run(system, &job_man, results);
+  const auto parallel_ms = std::chrono::duration<f64, std::milli>(std::chrono::steady_clock::now() - start).count();
+  job_man.shutdown();
+
+  auto batch_hits = 0_u32;
+  for (auto count : results.hit_counts) {
+    batch_hits += count;
+  }
+
+  std::printf(
+    "%u rays: one at a time %.3f ms, batched %.3f ms, batched over 4 workers %.3f ms (%u hits)\n",
+    RAY_COUNT,
+    single_ms,
+    serial_ms,
+    parallel_ms,
+    batch_hits
+  );
+
+  EXPECT_EQ(batch_hits, single_hits);
+}
@@ -0,0 +1,209 @@
+// clang-format off
+#include <Jolt/Jolt.h>
+#include <Jolt/Core/Factory.h>
+#include <Jolt/Core/JobSystemThreadPool.h>
+#include <Jolt/Core/TempAllocator.h>
+#include <Jolt/Physics/Body/BodyCreationSettings.h>
+#include <Jolt/Physics/Collision/Shape/BoxShape.h>
+#include <Jolt/Physics/PhysicsSystem.h>
+#include <Jolt/RegisterTypes.h>
+// clang-format on
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <thread>
+
+#include "Physics/PhysicsInterfaces.hpp"
+#include "Physics/RigidBodySync.hpp"
+#include "Scene/Components.hpp"
+
+using namespace ox;
+
+class RigidBodySyncTest : public ::testing::Test {
+protected:
+  static auto SetUpTestSuite() -> void {
+    JPH::RegisterDefaultAllocator();
+    JPH::Factory::sInstance = new JPH::Factory();
+    JPH::RegisterTypes();
+  }
+
+  static auto TearDownTestSuite() -> void {
+    JPH::UnregisterTypes();
+    delete JPH::Factory::sInstance;
+    JPH::Factory::sInstance = nullptr;
+  }
+
+  // Boxes resting on a floor, far enough apart that none touch. The first `awake_count` start falling
+  // from a little above it, the rest are created asleep.
+  auto build(u32 body_count, u32 awake_count) -> void {
+    system.Init(body_count + 1, 0, 65536, 65536, layer_interface, object_vs_broad_phase, object_vs_object);
+    auto& body_interface = system.GetBodyInterface();
+    const auto floor = JPH::BodyCreationSettings(
+      new JPH::BoxShape(JPH::Vec3(1000.f, 1.f, 1000.f)),
+      JPH::RVec3(0.f, -1.f, 0.f),
+      JPH::Quat::sIdentity(),
+      JPH::EMotionType::Static,
+      PhysicsLayers::NON_MOVING
+    );
+    body_interface.CreateAndAddBody(floor, JPH::EActivation::DontActivate);
+
+    constexpr auto COLUMNS = 150_u32;
+    auto box = JPH::Ref<JPH::Shape>(new JPH::BoxShape(JPH::Vec3::sReplicate(0.5f)));
+    for (u32 i = 0; i < body_count; i++) {
+      const auto awake = i < awake_count;
+      const auto position = JPH::RVec3(
+        (static_cast<f32>(i % COLUMNS) - COLUMNS / 2.f) * 2.f,
+        awake ? 3.f : 0.5f,
+        (static_cast<f32>(i / COLUMNS) - COLUMNS / 2.f) * 2.f
+      );
+      const auto motion = JPH::EMotionType::Dynamic;
+      const auto rotation = JPH::Quat::sIdentity();
+      const auto settings = JPH::BodyCreationSettings(box, position, rotation, motion, PhysicsLayers::MOVING);
+      auto* body = body_interface.CreateBody(settings);
+
+      auto entity = world.entity();
+      entity.set<TransformComponent>({.position = math::from_jolt(JPH::Vec3(position))});
+      auto& rb = entity.ensure<RigidBodyComponent>();
+      rb.runtime_body = body;
+      rb.previous_translation = rb.translation = entity.get<TransformComponent>().position;
+      body->SetUserData(entity.id());
+      body_interface.AddBody(body->GetID(), awake ? JPH::EActivation::Activate : JPH::EActivation::DontActivate);
+    }
+    system.OptimizeBroadPhase();
+
+    modified_count = 0;
+    world.observer<TransformComponent>().event(flecs::OnSet).each([this](TransformComponent&) {
+      modified_count += 1;
+    });
+  }
+
+  auto update() -> void { system.Update(1.f / 60.f, 1, &temp_allocator, &job_system); }
+
+  flecs::world world = {};
+  u64 modified_count = 0;
+  BPLayerInterfaceImpl layer_interface = {};
+  ObjectVsBroadPhaseLayerFilterImpl object_vs_broad_phase = {};
+  ObjectLayerPairFilterImpl object_vs_object = {};
+  JPH::TempAllocatorImpl temp_allocator{32 * 1024 * 1024};
+  JPH::JobSystemThreadPool job_system{
+    JPH::cMaxPhysicsJobs,
+    JPH::cMaxPhysicsBarriers,
+    static_cast<i32>(std::max(std::thread::hardware_concurrency(), 2u) - 1)
+  };
+  JPH::PhysicsSystem system = {};
+};
+
+TEST_F(RigidBodySyncTest, FollowsAwakeBodies) {
+  build(64, 8);
+
+  auto sync = RigidBodySync{};
+  update();
+  sync.step(world, system);
+  EXPECT_EQ(sync.awake_count(), 8);
+  EXPECT_TRUE(sync.written.empty());
+
+  sync.interpolate(world, 0.5f);
+  EXPECT_EQ(sync.written.size(), 8);
+  for (auto entity : sync.written) {
+    const auto& rb = entity.get<RigidBodyComponent>();
+    const auto& tc = entity.get<TransformComponent>();
+    EXPECT_LT(rb.translation.y, rb.previous_translation.y);
+    EXPECT_NEAR(tc.position.y, (rb.translation.y + rb.previous_translation.y) * 0.5f, 1e-4f);
+  }
+  sync.written.clear();
+
+  // Until they land and fall asleep, at which point each is put down once more and then left alone.
+  auto put_to_rest = 0_sz;
+  for (u32 step = 0; step < 600 && sync.awake_count() != 0; step++) {
+    update();
+    sync.step(world, system);
+    put_to_rest += sync.written.size();
+    sync.written.clear();
+  }
+  EXPECT_EQ(sync.awake_count(), 0);
+  EXPECT_EQ(put_to_rest, 8);
+
+  world.each([](const TransformComponent& tc, const RigidBodyComponent& rb) {
+    EXPECT_NEAR(tc.position.y, 0.5f, 0.05f);
+    EXPECT_EQ(tc.position, rb.translation);
+  });
+
+  update();
+  sync.step(world, system);
+  sync.interpolate(world, 1.0f);
+  EXPECT_TRUE(sync.written.empty());
+}
+
+// 20k rigidbodies of which 200 are awake: the per-entity loop that checks every body and fires an
+// observer per transform it writes, against syncing and marking modified only the bodies Jolt reports
+// as awake.
+TEST_F(RigidBodySyncTest, MostlySleeping20kBenchmark) {
+  constexpr auto BODY_COUNT = 20000_u32;
+  constexpr auto AWAKE_COUNT = 200_u32;
+  constexpr auto FRAMES = 60_u32;
+
+  build(BODY_COUNT, AWAKE_COUNT);
+  update();
+
+  auto rigidbodies = world.query<TransformComponent, RigidBodyComponent>();
+  const auto& body_interface = system.GetBodyInterfaceNoLock();
+  auto start = std::chrono::steady_clock::now();
+  for (u32 frame = 0; frame < FRAMES; frame++) {
+    // Systems run deferred, the observers fire once the frame's commands are merged.
+    world.defer_begin();
+    rigidbodies.each([&](TransformComponent&, RigidBodyComponent& rb) {
+      const auto* body = static_cast<const JPH::Body*>(rb.runtime_body);
+      if (body_interface.IsActive(body->GetID())) {
+        rb.previous_translation = rb.translation;
+        rb.translation = math::from_jolt(JPH::Vec3(body->GetPosition()));
+      }
+    });
+    rigidbodies.each([&](flecs::entity e, TransformComponent& tc, RigidBodyComponent& rb) {
+      tc.position = glm::mix(rb.previous_translation, rb.translation, 0.5f);
+      tc.rotation = glm::slerp(rb.previous_rotation, rb.rotation, 0.5f);
+      e.modified<TransformComponent>();
+    });
+    world.defer_end();
+  }
+  const auto per_entity_ms = std::chrono::duration<f64, std::milli>(std::chrono::steady_clock::now() - start).count() /
+                             static_cast<f64>(FRAMES);
+  const auto per_entity_modified = modified_count;
+
+  auto sync = RigidBodySync{};
+  modified_count = 0;
+  auto written = 0_sz;
+  start = std::chrono::steady_clock::now();
+  for (u32 frame = 0; frame < FRAMES; frame++) {
+    world.defer_begin();
+    sync.step(world, system);
+    sync.interpolate(world, 0.5f);
+    // What Scene::refresh_transforms does with them.
+    for (auto entity : sync.written) {
+      entity.modified<TransformComponent>();
+    }
+    written += sync.written.size();
+    sync.written.clear();
+    world.defer_end();
+  }
+  const auto synced_ms = std::chrono::duration<f64, std::milli>(std::chrono::steady_clock::now() - start).count() /
+                         static_cast<f64>(FRAMES);
+
+  std::printf(
+    "%u rigidbodies, %u awake: per-entity sync %.3f ms/frame (%llu observer calls), awake-only sync %.3f ms/frame "
+    "(%llu transforms written)\n",
+    BODY_COUNT,
+    AWAKE_COUNT,
+    per_entity_ms,
+    static_cast<unsigned long long>(per_entity_modified),
+    synced_ms,
+    static_cast<unsigned long long>(written)
+  );
+
+  EXPECT_EQ(per_entity_modified, static_cast<u64>(BODY_COUNT) * FRAMES);
+  EXPECT_EQ(modified_count, written);
+  EXPECT_EQ(sync.awake_count(), AWAKE_COUNT);
+  EXPECT_EQ(written, static_cast<usize>(AWAKE_COUNT) * FRAMES);
+}
@@ -0,0 +1,126 @@
+// clang-format off
+#include <Jolt/Jolt.h>
+#include <Jolt/Core/Factory.h>
+#include <Jolt/RegisterTypes.h>
+// clang-format on
+
+#include <gtest/gtest.h>
+
+#include <filesystem>
+#include <vector>
+
+#include "Physics/ShapeCache.hpp"
+
+using namespace ox;
+
+class ShapeCacheTest : public ::testing::Test {
+protected:
+  static auto SetUpTestSuite() -> void {
+    JPH::RegisterDefaultAllocator();
+    JPH::Factory::sInstance = new JPH::Factory();
+    JPH::RegisterTypes();
+  }
+
+  static auto TearDownTestSuite() -> void {
+    JPH::UnregisterTypes();
+    delete JPH::Factory::sInstance;
+    JPH::Factory::sInstance = nullptr;
+  }
+
+  void SetUp() override {
+    cache_directory = std::filesystem::temp_directory_path() / "ox_shape_cache_test";
+    std::filesystem::remove_all(cache_directory);
+  }
+
+  void TearDown() override { std::filesystem::remove_all(cache_directory); }
+
+  // A closed box with vertices of its own.
+  auto add_box(glm::vec3 min, glm::vec3 max) -> void {
+    const auto base = static_cast<u32>(positions.size());
+    for (u32 corner = 0; corner < 8; corner++) {
+      positions.emplace_back(corner & 1 ? max.x : min.x, corner & 2 ? max.y : min.y, corner & 4 ? max.z : min.z);
+    }
+
+    constexpr u32 FACES[] = {
+      0, 2, 1, 1, 2, 3, 4, 5, 6, 5, 7, 6, 0, 1, 4, 1, 5, 4,
+      2, 6, 3, 3, 6, 7, 0, 4, 2, 2, 4, 6, 1, 3, 5, 3, 7, 5,
+    };
+    for (auto index : FACES) {
+      indices.push_back(base + index);
+    }
+  }
+
+  std::vector<glm::vec3> positions = {};
+  std::vector<u32> indices = {};
+  std::filesystem::path cache_directory = {};
+};
+
+TEST_F(ShapeCacheTest, CooksAndShares) {
+  add_box({0.f, 0.f, 0.f}, {2.f, 1.f, 1.f});
+
+  auto cache = ShapeCache{};
+  auto triangles = cache.get_or_cook(positions, indices, CookedShapeType::Triangles, 0, {});
+  ASSERT_TRUE(triangles.IsValid());
+  EXPECT_EQ(triangles.Get()->GetSubType(), JPH::EShapeSubType::Mesh);
+
+  auto hull = cache.get_or_cook(positions, indices, CookedShapeType::ConvexHull, 0, {});
+  ASSERT_TRUE(hull.IsValid());
+  EXPECT_EQ(hull.Get()->GetSubType(), JPH::EShapeSubType::ConvexHull);
+  EXPECT_NEAR(hull.Get()->GetVolume(), 2.f, 0.05f);
+
+  // The same mesh, even from another copy of it, gets the very same shape.
+  const auto copy = positions;
+  auto again = cache.get_or_cook(copy, indices, CookedShapeType::ConvexHull, 0, {});
+  EXPECT_EQ(again.Get(), hull.Get());
+  EXPECT_EQ(cache.stats.cooked, 2);
+  EXPECT_EQ(cache.stats.shared, 1);
+
+  // A convex mesh is not worth splitting.
+  auto parts = cache.get_or_cook(positions, indices, CookedShapeType::ConvexParts, 8, {});
+  ASSERT_TRUE(parts.IsValid());
+  EXPECT_EQ(parts.Get()->GetSubType(), JPH::EShapeSubType::ConvexHull);
+}
+
+TEST_F(ShapeCacheTest, ConvexPartsFollowTheMesh) {
+  // An L with a gap: one hull around it would fill the empty corner.
+  add_box({0.f, 0.f, 0.f}, {4.f, 1.f, 1.f});
+  add_box({0.f, 1.5f, 0.f}, {1.f, 4.5f, 1.f});
+
+  const auto hull = ShapeCache::cook(positions, indices, CookedShapeType::ConvexHull, 0);
+  const auto parts = ShapeCache::cook(positions, indices, CookedShapeType::ConvexParts, 8);
+  ASSERT_TRUE(hull.IsValid());
+  ASSERT_TRUE(parts.IsValid());
+  EXPECT_EQ(parts.Get()->GetSubType(), JPH::EShapeSubType::StaticCompound);
+  EXPECT_NEAR(parts.Get()->GetVolume(), 7.f, 0.1f);
+  EXPECT_GT(hull.Get()->GetVolume(), 10.f);
+
+  // Capped at one part it is the plain hull again.
+  const auto single = ShapeCache::cook(positions, indices, CookedShapeType::ConvexParts, 1);
+  ASSERT_TRUE(single.IsValid());
+  EXPECT_NEAR(single.Get()->GetVolume(), hull.Get()->GetVolume(), 0.01f);
+}
+
+TEST_F(ShapeCacheTest, RestoresFromDisk) {
+  add_box({0.f, 0.f, 0.f}, {4.f, 1.f, 1.f});
+  add_box({0.f, 1.5f, 0.f}, {1.f, 4.5f, 1.f});
+
+  auto cooking = ShapeCache{};
+  auto cooked = cooking.get_or_cook(positions, indices, CookedShapeType::ConvexParts, 8, cache_directory);
+  ASSERT_TRUE(cooked.IsValid());
+  EXPECT_EQ(cooking.stats.cooked, 1);
+  const auto hash = ShapeCache::content_hash(positions, indices, CookedShapeType::ConvexParts, 8);
+  EXPECT_TRUE(std::filesystem::exists(ShapeCache::cache_path(cache_directory, hash)));
+
+  auto loading = ShapeCache{};
+  auto loaded = loading.get_or_cook(positions, indices, CookedShapeType::ConvexParts, 8, cache_directory);
+  ASSERT_TRUE(loaded.IsValid());
+  EXPECT_EQ(loading.stats.loaded, 1);
+  EXPECT_EQ(loading.stats.cooked, 0);
+  EXPECT_EQ(loaded.Get()->GetSubType(), cooked.Get()->GetSubType());
+  EXPECT_NEAR(loaded.Get()->GetVolume(), cooked.Get()->GetVolume(), 1e-4f);
+
+  // Another part limit is another shape, it does not pick up the file above.
+  auto other = loading.get_or_cook(positions, indices, CookedShapeType::ConvexParts, 1, cache_directory);
+  ASSERT_TRUE(other.IsValid());
+  EXPECT_EQ(loading.stats.cooked, 1);
+}
@@ -0,0 +1,156 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <glm/gtc/matrix_transform.hpp>
+#include <random>
+
+#include "Scene/DynamicBVH.hpp"
+
+using namespace ox;
+
+class DynamicBVHTest : public ::testing::Test {
+protected:
+  auto random_aabb(f32 world_extent, f32 max_size) -> AABB {
+    std::uniform_real_distribution<f32> position(-world_extent, world_extent);
+    std::uniform_real_distribution<f32> size(0.01f, max_size);
+    const auto min = glm::vec3(position(rng), position(rng), position(rng));
+    return AABB(min, min + glm::vec3(size(rng), size(rng), size(rng)));
+  }
+
+  auto populate(u32 count, f32 world_extent = 100.f) -> void {
+    for (u32 i = 0; i < count; i++) {
+      const auto aabb = random_aabb(world_extent, 2.f);
+      proxies.push_back(bvh.create_proxy(aabb, i));
+      bounds.push_back(aabb);
+    }
+  }
+
+  template <typename T>
+  auto collect(const T& shape) -> std::vector<u64> {
+    std::vector<u64> hits = {};
+    bvh.query(shape, [&hits](u64 id) {
+      hits.push_back(id);
+      return true;
+    });
+    std::ranges::sort(hits);
+    return hits;
+  }
+
+  std::mt19937 rng{1234};
+  DynamicBVH bvh = {};
+  std::vector<u32> proxies = {};
+  std::vector<AABB> bounds = {};
+};
+
+TEST_F(DynamicBVHTest, AABBQueryMatchesBruteForce) {
+  populate(2000);
+  ASSERT_TRUE(bvh.validate());
+
+  for (u32 q = 0; q < 50; q++) {
+    const auto query = random_aabb(100.f, 30.f);
+    std::vector<u64> expected = {};
+    for (u32 i = 0; i < bounds.size(); i++) {
+      if (bvh.get_fat_aabb(proxies[i]).intersects_fast(query))
+        expected.push_back(i);
+    }
+    EXPECT_EQ(collect(query), expected);
+  }
+}
+
+TEST_F(DynamicBVHTest, SphereAndRayQueriesFindContainedProxies) {
+  populate(2000);
+
+  const auto sphere = Sphere(glm::vec3(0.f), 20.f);
+  const auto sphere_hits = collect(sphere);
+  for (u32 i = 0; i < bounds.size(); i++) {
+    if (sphere.intersects(bounds[i])) {
+      EXPECT_TRUE(std::ranges::binary_search(sphere_hits, i)) << i;
+    }
+  }
+
+  const auto target = bounds[7].get_center();
+  const auto ray = RayCast(glm::vec3(-200.f, target.y, target.z), glm::vec3(1.f, 0.f, 0.f));
+  bool found = false;
+  bvh.ray_cast(ray, [&](u64 id, f32 distance) {
+    if (id == 7) {
+      found = true;
+      EXPECT_NEAR(distance, bvh.get_fat_aabb(proxies[7]).min.x + 200.f, 1e-3f);
+    }
+    return true;
+  });
+  EXPECT_TRUE(found);
+}
+
+TEST_F(DynamicBVHTest, FrustumQuery) {
+  populate(500);
+
+  const auto projection = glm::perspective(glm::radians(60.f), 1.f, 0.1f, 50.f);
+  const auto view = glm::lookAt(glm::vec3(0.f), glm::vec3(0.f, 0.f, -1.f), glm::vec3(0.f, 1.f, 0.f));
+  const auto frustum = Frustum::from_matrix(projection * view);
+
+  const auto in_front = bvh.create_proxy(AABB(glm::vec3(-0.5f, -0.5f, -10.5f), glm::vec3(0.5f, 0.5f, -9.5f)), 10000);
+  const auto behind = bvh.create_proxy(AABB(glm::vec3(-0.5f, -0.5f, 9.5f), glm::vec3(0.5f, 0.5f, 10.5f)), 10001);
+
+  const auto hits = collect(frustum);
+  EXPECT_TRUE(std::ranges::binary_search(hits, bvh.get_user_data(in_front)));
+  EXPECT_FALSE(std::ranges::binary_search(hits, bvh.get_user_data(behind)));
+}
+
+TEST_F(DynamicBVHTest, MoveAndDestroyKeepTreeValid) {
+  populate(1000);
+
+  // Small moves stay inside the fat bounds.
+  const auto nudged = AABB(bounds[0].min + 0.01f, bounds[0].max + 0.01f);
+  EXPECT_FALSE(bvh.move_proxy(proxies[0], nudged));
+
+  std::uniform_real_distribution<f32> offset(-10.f, 10.f);
+  for (u32 i = 0; i < proxies.size(); i += 2) {
+    const auto delta = glm::vec3(offset(rng), offset(rng), offset(rng));
+    bounds[i] = AABB(bounds[i].min + delta, bounds[i].max + delta);
+    bvh.move_proxy(proxies[i], bounds[i]);
+  }
+  ASSERT_TRUE(bvh.validate());
+
+  for (u32 i = 1; i < proxies.size(); i += 2) {
+    bvh.destroy_proxy(proxies[i]);
+  }
+  ASSERT_TRUE(bvh.validate());
+  EXPECT_EQ(bvh.get_proxy_count(), 500u);
+
+  for (u32 i = 0; i < proxies.size(); i += 2) {
+    const auto hits = collect(bounds[i]);
+    EXPECT_TRUE(std::ranges::binary_search(hits, i)) << i;
+  }
+}
+
+TEST_F(DynamicBVHTest, ScalesToManyProxies) {
+  constexpr u32 COUNT = 1000000;
+  // Four times the proxies of a 2000 unit world at the same density.
+  constexpr f32 WORLD_EXTENT = 3200.f;
+
+  const auto build_start = std::chrono::steady_clock::now();
+  populate(COUNT, WORLD_EXTENT);
+  const auto build_ms = std::chrono::duration<f64, std::milli>(std::chrono::steady_clock::now() - build_start);
+
+  // Balanced: well under 2 * log2(n).
+  EXPECT_LE(bvh.get_height(), 2 * static_cast<i32>(std::log2(COUNT)));
+
+  u64 total_hits = 0;
+  const auto query_start = std::chrono::steady_clock::now();
+  for (u32 q = 0; q < 1000; q++) {
+    total_hits += collect(random_aabb(WORLD_EXTENT, 20.f)).size();
+  }
+  const auto query_ms = std::chrono::duration<f64, std::milli>(std::chrono::steady_clock::now() - query_start);
+
+  std::printf(
+    "%u proxies: build %.2f ms, height %d, 1000 queries %.3f ms (%llu hits)\n",
+    COUNT,
+    build_ms.count(),
+    bvh.get_height(),
+    query_ms.count(),
+    static_cast<unsigned long long>(total_hits)
+  );
+}
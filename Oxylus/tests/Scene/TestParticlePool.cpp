@@ -0,0 +1,115 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <glm/gtc/packing.hpp>
+
+#include "Core/JobManager.hpp"
+#include "Scene/Components.hpp"
+
+using namespace ox;
+
+class ParticlePoolTest : public ::testing::Test {
+protected:
+  void SetUp() override {
+    component.start_lifetime = 1.0f;
+    component.start_velocity = {0.f, 2.f, 0.f};
+    component.position_start = {};
+    component.position_end = {};
+    component.pool.resize(8);
+  }
+
+  ParticleSystemComponent component = {};
+};
+
+TEST_F(ParticlePoolTest, EmitIsClampedToCapacity) {
+  auto& pool = component.pool;
+
+  EXPECT_EQ(pool.emit(component, {1.f, 2.f, 3.f}, 5), 5u);
+  EXPECT_EQ(pool.emit(component, {}, 5), 3u);
+  EXPECT_EQ(pool.alive_count, 8u);
+  EXPECT_EQ(pool.emit(component, {}, 1), 0u);
+
+  EXPECT_FLOAT_EQ(pool.position_x[0], 1.f);
+  EXPECT_FLOAT_EQ(pool.position_y[0], 2.f);
+  EXPECT_FLOAT_EQ(pool.position_z[0], 3.f);
+  EXPECT_FLOAT_EQ(pool.life_remaining[0], component.start_lifetime);
+}
+
+TEST_F(ParticlePoolTest, SimulateIntegratesVelocityAndGravity) {
+  auto& pool = component.pool;
+  component.gravity_modifier = 1.f;
+
+  pool.emit(component, {}, 1);
+  pool.update(component, 0.1f, nullptr);
+
+  ASSERT_EQ(pool.alive_count, 1u);
+  EXPECT_NEAR(pool.velocity_y[0], 2.f - 0.98f, 1e-5f);
+  EXPECT_NEAR(pool.position_y[0], (2.f - 0.98f) * 0.1f, 1e-5f);
+  EXPECT_NEAR(pool.life_remaining[0], 0.9f, 1e-5f);
+}
+
+TEST_F(ParticlePoolTest, DisabledCurvesKeepStartValues) {
+  auto& pool = component.pool;
+  component.start_color = {1.f, 0.f, 0.f, 1.f};
+  component.start_size = {2.f, 3.f, 1.f, 1.f};
+
+  pool.emit(component, {}, 1);
+  pool.update(component, 0.5f, nullptr);
+
+  EXPECT_EQ(pool.color[0], glm::packUnorm4x8(component.start_color));
+  EXPECT_FLOAT_EQ(pool.size_x[0], 2.f);
+  EXPECT_FLOAT_EQ(pool.size_y[0], 3.f);
+}
+
+TEST_F(ParticlePoolTest, CompactKeepsLiveParticlesPacked) {
+  auto& pool = component.pool;
+
+  pool.emit(component, {}, 6);
+  for (u32 i = 0; i < 6; i++) {
+    pool.position_x[i] = static_cast<f32>(i);
+  }
+  pool.life_remaining[0] = 0.f;
+  pool.life_remaining[3] = -1.f;
+  pool.life_remaining[5] = 0.f;
+
+  pool.compact();
+
+  ASSERT_EQ(pool.alive_count, 3u);
+  std::vector<f32> alive = {pool.position_x.begin(), pool.position_x.begin() + pool.alive_count};
+  std::ranges::sort(alive);
+  EXPECT_EQ(alive, (std::vector<f32>{1.f, 2.f, 4.f}));
+}
+
+TEST_F(ParticlePoolTest, ParticlesDieAfterLifetime) {
+  auto& pool = component.pool;
+
+  pool.emit(component, {}, 4);
+  pool.update(component, 0.6f, nullptr);
+  EXPECT_EQ(pool.alive_count, 4u);
+  pool.update(component, 0.6f, nullptr);
+  EXPECT_EQ(pool.alive_count, 0u);
+}
+
+TEST_F(ParticlePoolTest, ParallelUpdateMatchesSerial) {
+  constexpr u32 COUNT = ParticlePool::PARALLEL_THRESHOLD * 2;
+  component.gravity_modifier = 1.f;
+  component.size_over_lifetime_enabled = true;
+
+  auto serial = component;
+  serial.pool.resize(COUNT);
+  serial.pool.emit(serial, {}, COUNT);
+  auto parallel = serial;
+
+  JobManager job_man = {};
+  job_man.set_thread_count(4);
+  ASSERT_TRUE(job_man.init().has_value());
+
+  serial.pool.update(serial, 0.016f, nullptr);
+  parallel.pool.update(parallel, 0.016f, &job_man);
+
+  job_man.shutdown();
+
+  ASSERT_EQ(serial.pool.alive_count, parallel.pool.alive_count);
+  EXPECT_EQ(serial.pool.position_y, parallel.pool.position_y);
+  EXPECT_EQ(serial.pool.size_x, parallel.pool.size_x);
+}
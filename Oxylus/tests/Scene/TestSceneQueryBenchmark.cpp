@@ -0,0 +1,229 @@
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <cstdio>
+
+#include "Memory/SlotMap.hpp"
+#include "Render/LightGather.hpp"
+#include "Render/SpriteGather.hpp"
+#include "Scene/Components.hpp"
+
+using namespace ox;
+
+// Runs the renderer's light and sprite gathers on a bare world, so the per-frame cost of cached,
+// change-tracked queries can be measured without a device.
+class SceneQueryBenchmark : public ::testing::Test {
+protected:
+  constexpr static u32 LIGHT_COUNT = 2048;
+  constexpr static u32 SPRITE_COUNT = 16384;
+  constexpr static u32 FRAME_COUNT = 200;
+
+  void SetUp() override {
+    for (u32 i = 0; i < LIGHT_COUNT; i++) {
+      world.entity()
+        .set<TransformComponent>({.position = {static_cast<f32>(i), 0.f, 0.f}})
+        .set<LightComponent>({.type = LightComponent::LightType::Point});
+    }
+    for (u32 i = 0; i < SPRITE_COUNT; i++) {
+      auto e = world.entity()
+                 .set<TransformComponent>({.position = {0.f, static_cast<f32>(i), 0.f}})
+                 .set<SpriteComponent>({});
+      entity_transforms.emplace(e, transforms.create_slot());
+    }
+
+    // Read-only per-frame work, like the bounding box systems in the scene.
+    world.system<const SpriteComponent>().each([this](const SpriteComponent&) { system_reads += 1; });
+  }
+
+  auto gather(LightGather& light_gather) -> GPU::SceneFlags {
+    dirty_lights.clear();
+    return light_gather.gather(lights, entity_lights, dirty_lights);
+  }
+
+  auto gather(SpriteGather& sprite_gather) -> bool {
+    return sprite_gather.gather(camera_z, entity_transforms, material_index);
+  }
+
+  template <typename F>
+  auto measure(F&& frame) -> f64 {
+    const auto start = std::chrono::steady_clock::now();
+    for (u32 i = 0; i < FRAME_COUNT; i++) {
+      world.progress();
+      frame();
+    }
+    const auto elapsed = std::chrono::duration<f64, std::milli>(std::chrono::steady_clock::now() - start);
+    return elapsed.count() / FRAME_COUNT;
+  }
+
+  flecs::world world = {};
+  u64 system_reads = 0;
+
+  SlotMap<GPU::Light, GPU::LightID> lights = {};
+  ankerl::unordered_dense::map<flecs::entity, GPU::LightID> entity_lights = {};
+  std::vector<GPU::LightID> dirty_lights = {};
+
+  f32 camera_z = 10.0f;
+  SlotMap<GPU::Transforms, GPU::TransformID> transforms = {};
+  ankerl::unordered_dense::map<flecs::entity, GPU::TransformID> entity_transforms = {};
+  // Every material but `loading` is in.
+  option<UUID> loading = nullopt;
+  std::function<option<u32>(const UUID&)> material_index = [this](const UUID& uuid) -> option<u32> {
+    if (uuid == loading) {
+      return nullopt;
+    }
+    return 0;
+  };
+};
+
+TEST_F(SceneQueryBenchmark, ChangeDetectionIgnoresReadOnlySystems) {
+  auto sprites = world.query_builder<const TransformComponent, const SpriteComponent>()
+                   .cached()
+                   .detect_changes()
+                   .build();
+
+  EXPECT_TRUE(sprites.changed());
+  sprites.each([](const TransformComponent&, const SpriteComponent&) {});
+  EXPECT_FALSE(sprites.changed());
+
+  world.progress();
+  EXPECT_GT(system_reads, 0u);
+  EXPECT_FALSE(sprites.changed());
+
+  auto e = sprites.first();
+  e.get_mut<TransformComponent>().position.z = 1.f;
+  e.modified<TransformComponent>();
+  EXPECT_TRUE(sprites.changed());
+}
+
+TEST_F(SceneQueryBenchmark, GathersOnlyChangedLights) {
+  auto light_gather = LightGather{};
+  light_gather.init(world);
+
+  gather(light_gather);
+  EXPECT_EQ(light_gather.gather_count, 1u);
+  EXPECT_EQ(dirty_lights.size(), LIGHT_COUNT);
+  EXPECT_EQ(entity_lights.size(), LIGHT_COUNT);
+
+  world.progress();
+  gather(light_gather);
+  EXPECT_EQ(light_gather.gather_count, 1u);
+  EXPECT_TRUE(dirty_lights.empty());
+
+  auto light = entity_lights.begin()->first;
+  light.get_mut<TransformComponent>().position.y = 5.f;
+  light.modified<TransformComponent>();
+  gather(light_gather);
+  EXPECT_EQ(light_gather.gather_count, 2u);
+  EXPECT_FALSE(dirty_lights.empty());
+  EXPECT_EQ(lights.slot(entity_lights[light])->position.y, 5.f);
+
+  light.destruct();
+  gather(light_gather);
+  EXPECT_EQ(entity_lights.size(), LIGHT_COUNT - 1);
+}
+
+// The light's own table is never written when its parent moves.
+TEST_F(SceneQueryBenchmark, FollowsParentedLights) {
+  auto parent = world.entity().set<TransformComponent>({});
+  auto child = world.entity()
+                 .child_of(parent)
+                 .set<TransformComponent>({.position = {1.f, 0.f, 0.f}})
+                 .set<LightComponent>({.type = LightComponent::LightType::Point});
+
+  auto light_gather = LightGather{};
+  light_gather.init(world);
+  gather(light_gather);
+  EXPECT_EQ(lights.slot(entity_lights[child])->position.x, 1.f);
+
+  // Nothing moved, nothing to upload.
+  gather(light_gather);
+  EXPECT_TRUE(dirty_lights.empty());
+
+  parent.get_mut<TransformComponent>().position.x = 10.f;
+  parent.modified<TransformComponent>();
+  gather(light_gather);
+  ASSERT_EQ(dirty_lights.size(), 1u);
+  EXPECT_EQ(dirty_lights[0], entity_lights[child]);
+  EXPECT_EQ(lights.slot(entity_lights[child])->position.x, 11.f);
+}
+
+TEST_F(SceneQueryBenchmark, GathersOnlyChangedSprites) {
+  auto sprite_gather = SpriteGather{};
+  sprite_gather.init(world);
+
+  EXPECT_TRUE(gather(sprite_gather));
+  EXPECT_EQ(sprite_gather.render_queue_2d.sprite_data.size(), SPRITE_COUNT);
+
+  // Read-only systems keep the queue.
+  world.progress();
+  EXPECT_FALSE(gather(sprite_gather));
+  EXPECT_EQ(sprite_gather.gather_count, 1u);
+
+  auto sprite = entity_transforms.begin()->first;
+  sprite.get_mut<TransformComponent>().position.z = 1.f;
+  sprite.modified<TransformComponent>();
+  EXPECT_TRUE(gather(sprite_gather));
+  EXPECT_FALSE(gather(sprite_gather));
+
+  sprite.destruct();
+  EXPECT_TRUE(gather(sprite_gather));
+  EXPECT_EQ(sprite_gather.render_queue_2d.sprite_data.size(), SPRITE_COUNT - 1);
+
+  // Sort distances change with the camera's z.
+  camera_z = 20.0f;
+  EXPECT_TRUE(gather(sprite_gather));
+  EXPECT_FALSE(gather(sprite_gather));
+}
+
+// A sprite whose material isn't in yet keeps the gather running until it is.
+TEST_F(SceneQueryBenchmark, RegathersSpritesUntilTheirMaterialLoads) {
+  loading = UUID::generate_random();
+  auto sprite = world.entity().set<TransformComponent>({}).set<SpriteComponent>({.material = *loading});
+  entity_transforms.emplace(sprite, transforms.create_slot());
+
+  auto sprite_gather = SpriteGather{};
+  sprite_gather.init(world);
+  EXPECT_TRUE(gather(sprite_gather));
+  EXPECT_TRUE(gather(sprite_gather));
+  EXPECT_EQ(sprite_gather.render_queue_2d.sprite_data.size(), SPRITE_COUNT);
+
+  loading = nullopt;
+  EXPECT_TRUE(gather(sprite_gather));
+  EXPECT_EQ(sprite_gather.render_queue_2d.sprite_data.size(), SPRITE_COUNT + 1);
+  EXPECT_FALSE(gather(sprite_gather));
+}
+
+TEST_F(SceneQueryBenchmark, StaticSceneFrameTime) {
+  // A gather that starts over every frame, as if nothing were tracked.
+  const auto rebuilt_ms = measure([&] {
+    auto light_gather = LightGather{};
+    light_gather.init(world);
+    gather(light_gather);
+    auto sprite_gather = SpriteGather{};
+    sprite_gather.init(world);
+    gather(sprite_gather);
+  });
+  ASSERT_EQ(entity_lights.size(), LIGHT_COUNT);
+
+  auto light_gather = LightGather{};
+  light_gather.init(world);
+  auto sprite_gather = SpriteGather{};
+  sprite_gather.init(world);
+  const auto cached_ms = measure([&] {
+    gather(light_gather);
+    gather(sprite_gather);
+  });
+  EXPECT_EQ(entity_lights.size(), LIGHT_COUNT);
+  EXPECT_EQ(sprite_gather.render_queue_2d.sprite_data.size(), SPRITE_COUNT);
+  // Nothing moves, only the first frame gathers.
+  EXPECT_EQ(light_gather.gather_count, 1u);
+  EXPECT_EQ(sprite_gather.gather_count, 1u);
+
+  std::printf(
+    "%u lights, %u sprites: rebuilt gathers %.4f ms/frame, cached gathers %.4f ms/frame\n",
+    LIGHT_COUNT,
+    SPRITE_COUNT,
+    rebuilt_ms,
+    cached_ms
+  );
+}
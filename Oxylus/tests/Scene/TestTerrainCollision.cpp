@@ -0,0 +1,216 @@
+// clang-format off
+#include <Jolt/Jolt.h>
+#include <Jolt/Core/Factory.h>
+#include <Jolt/Core/TempAllocator.h>
+#include <Jolt/Physics/Collision/Shape/HeightFieldShape.h>
+#include <Jolt/RegisterTypes.h>
+// clang-format on
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <vector>
+
+#include "Scene/Terrain.hpp"
+
+using namespace ox;
+
+class TerrainCollisionTest : public ::testing::Test {
+protected:
+  static auto SetUpTestSuite() -> void {
+    JPH::RegisterDefaultAllocator();
+    JPH::Factory::sInstance = new JPH::Factory();
+    JPH::RegisterTypes();
+  }
+
+  static auto TearDownTestSuite() -> void {
+    JPH::UnregisterTypes();
+    delete JPH::Factory::sInstance;
+    JPH::Factory::sInstance = nullptr;
+  }
+
+  // Rolling hills, `sample_count` per side, with a bump of `bump` in the middle.
+  static auto hills(u32 sample_count, f32 bump = 0.0f) -> std::vector<f32> {
+    auto heights = std::vector<f32>(static_cast<usize>(sample_count) * sample_count);
+    const auto center = static_cast<f32>(sample_count) * 0.5f;
+    for (u32 y = 0; y < sample_count; y++) {
+      for (u32 x = 0; x < sample_count; x++) {
+        const auto distance = glm::length(glm::vec2(x, y) - center);
+        heights[static_cast<usize>(y) * sample_count + x] = 50.0f + 20.0f * std::sin(x * 0.05f) * std::cos(y * 0.07f) +
+                                                            bump * glm::max(0.0f, 1.0f - distance / 12.0f);
+      }
+    }
+    return heights;
+  }
+
+  static auto build_shape(const std::vector<f32>& heights, u32 sample_count) -> JPH::Ref<JPH::HeightFieldShape> {
+    auto settings = JPH::HeightFieldShapeSettings(
+      heights.data(),
+      JPH::Vec3::sZero(),
+      JPH::Vec3::sReplicate(1.0f),
+      sample_count
+    );
+    settings.mBlockSize = TERRAIN_COLLISION_BLOCK_SIZE;
+    settings.mMinHeightValue = 0.0f;
+    settings.mMaxHeightValue = 100.0f;
+    const auto result = settings.Create();
+    EXPECT_FALSE(result.HasError());
+    return static_cast<JPH::HeightFieldShape*>(result.Get().GetPtr());
+  }
+
+  JPH::TempAllocatorImpl temp_allocator{16 * 1024 * 1024};
+};
+
+TEST_F(TerrainCollisionTest, DirtyTexelsMapToTheSamplesReadingThem) {
+  constexpr auto MAP_SIZE = glm::uvec2(2048, 1024);
+  constexpr auto SAMPLE_COUNT = 256_u32;
+  const auto texels_per_cell = glm::vec2(MAP_SIZE) / static_cast<f32>(SAMPLE_COUNT - 1);
+
+  // The texels a sample resamples from, the same way `Terrain` does.
+  const auto reads = [&](u32 sample, u32 axis, u32 texel) {
+    const auto coord = static_cast<f32>(sample) * texels_per_cell[axis] - 0.5f;
+    const auto lo = static_cast<i32>(std::floor(coord));
+    const auto last = static_cast<i32>(MAP_SIZE[axis]) - 1;
+    return std::clamp(lo, 0, last) == static_cast<i32>(texel) || std::clamp(lo + 1, 0, last) == static_cast<i32>(texel);
+  };
+
+  for (const auto& dirty : {
+         TerrainRect{.min = {0, 0}, .max = {1, 1}},
+         TerrainRect{.min = {1000, 500}, .max = {1040, 530}},
+         TerrainRect{.min = {2040, 1020}, .max = {2048, 1024}},
+         TerrainRect{.min = {0, 0}, .max = MAP_SIZE},
+       }) {
+    const auto samples = terrain_collision_samples_for_texels(dirty, MAP_SIZE, SAMPLE_COUNT);
+    ASSERT_FALSE(samples.is_empty());
+    EXPECT_EQ(samples.min % TERRAIN_COLLISION_BLOCK_SIZE, glm::uvec2(0));
+    EXPECT_EQ(samples.size() % TERRAIN_COLLISION_BLOCK_SIZE, glm::uvec2(0));
+    EXPECT_LE(samples.max.x, SAMPLE_COUNT);
+    EXPECT_LE(samples.max.y, SAMPLE_COUNT);
+
+    // Every sample reading a dirty texel is inside, on both axes.
+    for (u32 axis = 0; axis < 2; axis++) {
+      for (u32 sample = 0; sample < SAMPLE_COUNT; sample++) {
+        for (auto texel = dirty.min[axis]; texel < dirty.max[axis]; texel++) {
+          if (reads(sample, axis, texel)) {
+            EXPECT_GE(sample, samples.min[axis]);
+            EXPECT_LT(sample, samples.max[axis]);
+          }
+        }
+      }
+    }
+
+    // And the readback covers everything those samples read.
+    const auto texels = terrain_collision_texels_for_samples(samples, MAP_SIZE, SAMPLE_COUNT);
+    for (u32 axis = 0; axis < 2; axis++) {
+      for (auto sample = samples.min[axis]; sample < samples.max[axis]; sample++) {
+        for (u32 texel = 0; texel < MAP_SIZE[axis]; texel++) {
+          if (reads(sample, axis, texel)) {
+            EXPECT_GE(texel, texels.min[axis]);
+            EXPECT_LT(texel, texels.max[axis]);
+          }
+        }
+      }
+    }
+  }
+
+  EXPECT_TRUE(terrain_collision_samples_for_texels({}, MAP_SIZE, SAMPLE_COUNT).is_empty());
+}
+
+TEST_F(TerrainCollisionTest, BrushStrokesMarkTheirFootprint) {
+  auto terrain = Terrain{};
+  terrain.world_size = {1024.0f, 1024.0f};
+  terrain.height_range = {0.0f, 100.0f};
+  terrain.resolution = {2048, 2048};
+  terrain.collision_dirty = false;
+
+  // No heights to find the stroke on yet, so everything has to be read.
+  terrain.mark_brush_collision_dirty();
+  EXPECT_TRUE(terrain.collision_dirty);
+  terrain.collision_dirty = false;
+
+  terrain.collision_sample_count = 256;
+  terrain.collision_heights = std::vector<f32>(256 * 256, 25.0f);
+
+  terrain.brush.radius_world = 8.0f;
+  terrain.brush.ray_origin = {100.0f, 200.0f, -50.0f};
+  terrain.brush.ray_direction = {0.0f, -1.0f, 0.0f};
+  const auto hit = terrain.raycast_collision_heights(terrain.brush.ray_origin, terrain.brush.ray_direction);
+  ASSERT_TRUE(hit.has_value());
+  EXPECT_NEAR(hit->y, 25.0f, 0.01f);
+
+  terrain.mark_brush_collision_dirty();
+  EXPECT_FALSE(terrain.collision_dirty);
+  const auto dirty = terrain.collision_dirty_texels;
+  ASSERT_FALSE(dirty.is_empty());
+  // Two texels per meter, the stroke is centered on its hit and a little wider than the brush.
+  const auto center = glm::vec2(dirty.min + dirty.max) * 0.5f;
+  EXPECT_NEAR(center.x, (100.0f + 512.0f) * 2.0f, 1.0f);
+  EXPECT_NEAR(center.y, (-50.0f + 512.0f) * 2.0f, 1.0f);
+  EXPECT_GE(dirty.size().x, 32);
+  EXPECT_LT(dirty.size().x, 128);
+
+  // A stroke that misses the collision heights may still have painted, so everything is read. A
+  // second one grows the rect.
+  terrain.brush.ray_direction = {0.0f, 1.0f, 0.0f};
+  terrain.mark_brush_collision_dirty();
+  EXPECT_TRUE(terrain.collision_dirty);
+  EXPECT_EQ(terrain.collision_dirty_texels.min, dirty.min);
+  EXPECT_EQ(terrain.collision_dirty_texels.max, dirty.max);
+  terrain.collision_dirty = false;
+
+  terrain.brush.ray_origin = {-300.0f, 200.0f, -300.0f};
+  terrain.brush.ray_direction = glm::normalize(glm::vec3(1.0f, -1.0f, 0.0f));
+  terrain.mark_brush_collision_dirty();
+  EXPECT_LT(terrain.collision_dirty_texels.min.x, dirty.min.x);
+  EXPECT_EQ(terrain.collision_dirty_texels.max, dirty.max);
+}
+
+// One brush stroke on a 2048x2048 collider: rebuilding the whole height field against setting the
+// heights of the stroke's blocks.
+TEST_F(TerrainCollisionTest, SetHeightsMatchesRebuildBenchmark) {
+  constexpr auto SAMPLE_COUNT = 2048_u32;
+  const auto before = hills(SAMPLE_COUNT);
+  const auto after = hills(SAMPLE_COUNT, 10.0f);
+
+  auto start = std::chrono::steady_clock::now();
+  const auto rebuilt = build_shape(after, SAMPLE_COUNT);
+  const auto rebuild_ms = std::chrono::duration<f64, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+  auto patched = build_shape(before, SAMPLE_COUNT);
+  const auto map_size = glm::uvec2(SAMPLE_COUNT);
+  const auto bump = TerrainRect{.min = glm::uvec2(SAMPLE_COUNT / 2 - 13), .max = glm::uvec2(SAMPLE_COUNT / 2 + 14)};
+  const auto samples = terrain_collision_samples_for_texels(bump, map_size, SAMPLE_COUNT);
+  const auto size = samples.size();
+  start = std::chrono::steady_clock::now();
+  patched->SetHeights(
+    samples.min.x,
+    samples.min.y,
+    size.x,
+    size.y,
+    after.data() + static_cast<usize>(samples.min.y) * SAMPLE_COUNT + samples.min.x,
+    SAMPLE_COUNT,
+    temp_allocator
+  );
+  const auto patch_ms = std::chrono::duration<f64, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+  std::printf(
+    "%ux%u height field: rebuild %.3f ms, SetHeights over %ux%u samples %.3f ms\n",
+    SAMPLE_COUNT,
+    SAMPLE_COUNT,
+    rebuild_ms,
+    size.x,
+    size.y,
+    patch_ms
+  );
+
+  // Block quantization is 8 bits of each block's own range, both come out within that of the source.
+  for (auto y = samples.min.y - 8; y < samples.max.y + 8; y++) {
+    for (auto x = samples.min.x - 8; x < samples.max.x + 8; x++) {
+      const auto expected = after[static_cast<usize>(y) * SAMPLE_COUNT + x];
+      EXPECT_NEAR(patched->GetPosition(x, y).GetY(), expected, 0.1f);
+      EXPECT_NEAR(patched->GetPosition(x, y).GetY(), rebuilt->GetPosition(x, y).GetY(), 0.1f);
+    }
+  }
+}
@@ -0,0 +1,188 @@
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <cstdio>
+#include <glm/gtc/quaternion.hpp>
+#include <glm/gtx/transform.hpp>
+#include <sol/sol.hpp>
+
+#include "Render/BoundingVolume.hpp"
+#include "Scripting/LuaMathBindings.hpp"
+#include "Utils/Log.hpp"
+
+using namespace ox;
+
+// Runs against whichever backend the build picked, the `luajit` option swaps vec3, quat and mat4 for
+// FFI structs and the scripts below have to behave the same on both.
+class LuaMathTest : public ::testing::Test {
+protected:
+  void SetUp() override {
+    loguru::g_stderr_verbosity = loguru::Verbosity_WARNING;
+
+    lua.open_libraries(sol::lib::base, sol::lib::package, sol::lib::math, sol::lib::string, sol::lib::table);
+#ifdef OX_LUAJIT
+    lua.open_libraries(sol::lib::ffi, sol::lib::jit, sol::lib::bit32);
+#endif
+    math_binding.bind(&lua);
+  }
+
+  auto run(const c8* script) -> sol::protected_function_result {
+    auto result = lua.safe_script(script, sol::script_pass_on_error);
+    EXPECT_TRUE(result.valid()) << result.get<sol::error>().what();
+    return result;
+  }
+
+  sol::state lua = {};
+  MathBinding math_binding = {};
+};
+
+TEST_F(LuaMathTest, Arithmetic) {
+  auto result = run(R"(
+    local a = vec3.new(1, 2, 3)
+    local b = vec3.new(4, 5, 6)
+    assert(a + b == vec3.new(5, 7, 9))
+    assert(b - a == vec3.new(3))
+    assert(a * 2 == vec3.new(2, 4, 6) and 2 * a == a * 2)
+    assert(b / b == vec3.new(1) and -a == vec3.new(-1, -2, -3))
+    assert(a ~= b)
+    return glm.length(vec3.new(3, 4, 0)), glm.normalize(vec3.new(0, 0, 5)), glm.distance(a, b)
+  )");
+  EXPECT_FLOAT_EQ(result.get<f32>(0), 5.f);
+  EXPECT_EQ(result.get<glm::vec3>(1), glm::vec3(0.f, 0.f, 1.f));
+  EXPECT_FLOAT_EQ(result.get<f32>(2), glm::sqrt(27.f));
+}
+
+TEST_F(LuaMathTest, CrossesIntoCppByValue) {
+  lua.set_function("scale_by", [](const glm::vec3& v, f32 s) { return v * s; });
+  lua.set_function("rotate", [](const glm::quat& q, const glm::vec3& v) { return q * v; });
+
+  auto result = run(R"(
+    local v = scale_by(vec3.new(1, 2, 3), 2)
+    assert(v.x == 2 and v.y == 4 and v.z == 6)
+    local m = glm.translate(mat4.new(1), vec3.new(1, 2, 3))
+    local q = glm.angle_axis(math.pi / 2, vec3.new(0, 1, 0))
+    return v, m, q, rotate(q, vec3.new(1, 0, 0))
+  )");
+  EXPECT_EQ(result.get<glm::vec3>(0), glm::vec3(2.f, 4.f, 6.f));
+  EXPECT_EQ(result.get<glm::mat4>(1), glm::translate(glm::vec3(1.f, 2.f, 3.f)));
+
+  const auto q = glm::angleAxis(glm::half_pi<f32>(), glm::vec3(0.f, 1.f, 0.f));
+  EXPECT_EQ(result.get<glm::quat>(2), q);
+  const auto rotated = result.get<glm::vec3>(3);
+  EXPECT_NEAR(rotated.x, 0.f, 1e-6f);
+  EXPECT_NEAR(rotated.z, -1.f, 1e-6f);
+}
+
+TEST_F(LuaMathTest, DotAndCross) {
+  auto result = run(R"(
+    assert(glm.dot(vec2.new(1, 2), vec2.new(3, 4)) == 11)
+    assert(glm.dot(vec3.new(1, 2, 3), vec3.new(4, 5, 6)) == 32)
+    assert(glm.dot(vec4.new(1, 2, 3, 4), vec4.new(5, 6, 7, 8)) == 70)
+    assert(not pcall(glm.cross, vec2.new(1, 0), vec2.new(0, 1)))
+    return glm.cross(vec3.new(1, 0, 0), vec3.new(0, 1, 0))
+  )");
+  EXPECT_EQ(result.get<glm::vec3>(), glm::vec3(0.f, 0.f, 1.f));
+}
+
+// vec3 members are read and written whole, on Lua 5.4 as much as on LuaJIT where vec3s are values.
+TEST_F(LuaMathTest, Vec3MembersAreCopies) {
+  auto result = run(R"(
+    local box = AABB.new(vec3.new(0), vec3.new(1))
+    box.min.x = 5
+    local min = box.min
+    min.y = 7
+    local unchanged = box.min
+    box.max = vec3.new(2, 3, 4)
+    return unchanged, box.max, box
+  )");
+  EXPECT_EQ(result.get<glm::vec3>(0), glm::vec3(0.f));
+  EXPECT_EQ(result.get<glm::vec3>(1), glm::vec3(2.f, 3.f, 4.f));
+  EXPECT_EQ(result.get<AABB>(2).max, glm::vec3(2.f, 3.f, 4.f));
+}
+
+#ifdef OX_LUAJIT
+TEST_F(LuaMathTest, FFIQuatAndMat4MatchGlm) {
+  auto result = run(R"(
+    local q = glm.angle_axis(0.7, glm.normalize(vec3.new(1, 2, 3)))
+    local r = glm.angle_axis(-1.3, vec3.new(0, 0, 1))
+    local m = glm.translate(mat4.new(), vec3.new(1, 2, 3))
+    local n = glm.translate(mat4.new(2), vec3.new(-4, 0, 1))
+    return q * r, q * vec3.new(1, 2, 3), m * n, m + n - m
+  )");
+
+  const auto q = glm::angleAxis(0.7f, glm::normalize(glm::vec3(1.f, 2.f, 3.f)));
+  const auto r = glm::angleAxis(-1.3f, glm::vec3(0.f, 0.f, 1.f));
+  const auto m = glm::translate(glm::vec3(1.f, 2.f, 3.f));
+  const auto n = glm::translate(glm::mat4(2.f), glm::vec3(-4.f, 0.f, 1.f));
+
+  const auto qr = result.get<glm::quat>(0);
+  const auto expected_qr = q * r;
+  for (glm::length_t i = 0; i < 4; i++) {
+    EXPECT_NEAR(qr[i], expected_qr[i], 1e-6f);
+  }
+  const auto rotated = result.get<glm::vec3>(1);
+  const auto expected_rotated = q * glm::vec3(1.f, 2.f, 3.f);
+  for (glm::length_t i = 0; i < 3; i++) {
+    EXPECT_NEAR(rotated[i], expected_rotated[i], 1e-5f);
+  }
+  EXPECT_EQ(result.get<glm::mat4>(2), m * n);
+  EXPECT_EQ(result.get<glm::mat4>(3), n);
+}
+#endif
+
+// 1000 particles under gravity and drag for 100 steps, nothing but vec3 arithmetic. Built with and
+// without the `luajit` option this compares sol usertypes on Lua 5.4 with FFI structs on LuaJIT.
+TEST_F(LuaMathTest, ParticlesBenchmark) {
+  constexpr auto PARTICLE_COUNT = 1000_u32;
+  constexpr auto STEPS = 100_u32;
+
+  run(R"(
+    positions, velocities = {}, {}
+    for i = 1, 1000 do
+      positions[i] = vec3.new(i, 0, 0)
+      velocities[i] = vec3.new(0, 10, 1)
+    end
+    local gravity = vec3.new(0, -9.81, 0)
+    function step(dt)
+      local moved = 0
+      for i = 1, #positions do
+        local v = (velocities[i] + gravity * dt) * 0.99
+        velocities[i] = v
+        positions[i] = positions[i] + v * dt
+        moved = moved + glm.length(v * dt)
+      end
+      return moved
+    end
+  )");
+
+  auto step = lua.get<sol::protected_function>("step");
+  lua.collect_garbage();
+  const auto memory_before = lua.memory_used();
+  const auto start = std::chrono::steady_clock::now();
+  auto moved = 0.0;
+  for (u32 i = 0; i < STEPS; i++) {
+    const auto result = step(1.0 / 60.0);
+    ASSERT_TRUE(result.valid());
+    moved += result.get<f64>();
+  }
+  const auto ms = std::chrono::duration<f64, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+#ifdef OX_LUAJIT
+  constexpr auto BACKEND = "LuaJIT, FFI structs";
+#else
+  constexpr auto BACKEND = "Lua 5.4, usertypes";
+#endif
+  std::printf(
+    "%u particles for %u steps on %s: %.3f ms (%.0f KB allocated on the way)\n",
+    PARTICLE_COUNT,
+    STEPS,
+    BACKEND,
+    ms,
+    static_cast<f64>(lua.memory_used() - memory_before) / 1024.0
+  );
+
+  EXPECT_GT(moved, 0.0);
+  const auto last = lua["positions"][PARTICLE_COUNT].get<glm::vec3>();
+  EXPECT_FLOAT_EQ(last.x, static_cast<f32>(PARTICLE_COUNT));
+  EXPECT_LT(last.y, 10.f);
+}
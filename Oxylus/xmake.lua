@@ -10,6 +10,11 @@ target("Oxylus")
 
     add_options("profile")
     add_options("llvmpipe")
+    add_options("luajit")
+    if has_config("luajit") then
+        -- Has to come ahead of sol in every file that binds vec3, quat or mat4.
+        add_forceincludes("Scripting/LuaFFIMath.hpp", { public = true })
+    end
     if not has_config("lua_bindings") then
         remove_files("./src/Scripting/*Bindings*")
     else
@@ -85,6 +90,8 @@ target("Oxylus")
         "ktx-ox",
         "zpp_bits",
         "enet-ox",
+        "lz4",
+        "zstd",
         "flecs",
         "imgui",
         "vk-bootstrap",
@@ -97,7 +104,7 @@ target("Oxylus")
         "simdutf",
         "joltphysics",
         "glm",
-        "lua",
+        has_config("luajit") and "luajit" or "lua",
         "sol2",
         "toml++",
         "loguru",
@@ -8,6 +8,12 @@ option("lua_bindings")
     set_showmenu(true)
     set_description("Enable Lua bindings")
 
+option("luajit")
+    set_default(false)
+    set_showmenu(true)
+    set_description("Run scripts on LuaJIT instead of Lua 5.4, with vec3/quat/mat4 as FFI structs")
+    add_defines("OX_LUAJIT=1", "SOL_LUAJIT=1", { public = true })
+
 option("tests")
     set_default(false)
     set_showmenu(true)
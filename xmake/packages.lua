@@ -10,6 +10,7 @@ packages = {
   ["libsdl3 3.4.12"] = { configs = { x11 = true, wayland = false } },
   ["ktx-ox v4.4.0"] = { system = false, debug = false },
   ["zstd v1.5.7"] = { system = false },
+  ["lz4 v1.10.0"] = { system = false },
   ["shader-slang v2026.12.2"] = { configs = { shared = true }, system = false },
   ["spirv-tools 1.4.335+0"] = { system = false },
   ["enet-ox v2.6.5"] = {
@@ -70,7 +71,6 @@ packages = {
       system_tracing = true,
     },
   },
-  ["lua " .. lua_version] = {},
   ["sol2 c1f95a773c6f8f4fde8ca3efe872e7286afe4444"] = { configs = { includes_lua = false } },
   ["unordered_dense v4.8.1"] = {},
   ["svector v1.0.3"] = {},
@@ -79,13 +79,20 @@ packages = {
   ["rmlui f7b297e2c8fc44c5e85df498dbae91762c0769a5"] = {
     configs = {
       shared = false,
-      lua = true,
+      -- The plugin only builds against PUC Lua.
+      lua = not has_config("luajit"),
     },
     debug = is_mode("debug")
   },
   ["zpp_bits v4.7.1"] = {},
 }
 
+if has_config("luajit") then
+  packages["luajit v2.1.0-beta3"] = {}
+else
+  packages["lua " .. lua_version] = {}
+end
+
 if has_config("tests") then
   packages["gtest"] = {
     debug = is_mode("debug"),
@@ -120,7 +127,10 @@ confs = {
     },
   },
 
-  {
+}
+
+if not has_config("luajit") then
+  table.insert(confs, {
     package = "lua",
     override = "rmlui.lua",
     configs = {
@@ -128,8 +138,8 @@ confs = {
       version = lua_version,
       system = false,
     }
-  }
-}
+  })
+end
 
 function require_packages()
   add_requireconfs("python", { override = true, system = true })